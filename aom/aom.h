@@ -58,7 +58,8 @@ enum aom_com_control_id {
    * for its control ids. These should be migrated to something like the
    * AOM_DECODER_CTRL_ID_START range next time we're ready to break the ABI.
    */
-  AV1_GET_REFERENCE = 128, /**< get a pointer to a reference frame */
+  AV1_GET_REFERENCE = 128,   /**< get a pointer to a reference frame */
+  AV1_SET_THREAD_POOL = 129, /**< run on the threads of the process-wide pool */
   AOM_COMMON_CTRL_ID_MAX,
   AOM_DECODER_CTRL_ID_START = 256
 };
@@ -122,6 +123,21 @@ typedef struct av1_ref_frame {
   aom_image_t img; /**< img structure to populate (output) */
 } av1_ref_frame_t;
 
+/*!\brief Shared thread pool settings
+ *
+ * Settings of AV1_SET_THREAD_POOL. Every encoder and decoder instance of the
+ * process that sets num_threads to a non-zero value runs its jobs on the
+ * threads of a single pool instead of threads of its own. The pool has as
+ * many threads as the largest num_threads set while it exists, up to 64, and
+ * its threads end when the last instance leaves it or is destroyed. The
+ * instances still split their work according to their own thread count.
+ * The decoder keeps its own threads in frame parallel mode.
+ */
+typedef struct aom_thread_pool_cfg {
+  unsigned int num_threads; /**< threads of the pool, 0 to leave it */
+  int priority; /**< jobs of instances with a higher priority run first */
+} aom_thread_pool_cfg_t;
+
 /*!\cond */
 /*!\brief aom decoder control function parameter type
  *
@@ -143,6 +159,8 @@ AOM_CTRL_USE_TYPE(AOM_SET_DBG_DISPLAY_MV, int)
 #define AOM_CTRL_AOM_SET_DBG_DISPLAY_MV
 AOM_CTRL_USE_TYPE(AV1_GET_REFERENCE, av1_ref_frame_t *)
 #define AOM_CTRL_AV1_GET_REFERENCE
+AOM_CTRL_USE_TYPE(AV1_SET_THREAD_POOL, aom_thread_pool_cfg_t *)
+#define AOM_CTRL_AV1_SET_THREAD_POOL
 
 /*!\endcond */
 /*! @} - end defgroup aom */
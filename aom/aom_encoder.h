@@ -64,7 +64,7 @@ extern "C" {
  * fields to structures
  */
 #define AOM_ENCODER_ABI_VERSION \
-  (5 + AOM_CODEC_ABI_VERSION) /**<\hideinitializer*/
+  (6 + AOM_CODEC_ABI_VERSION) /**<\hideinitializer*/
 
 /*! \brief Encoder capabilities bitfield
  *
@@ -159,6 +159,7 @@ enum aom_codec_cx_pkt_kind {
   AOM_CODEC_STATS_PKT,       /**< Two-pass statistics for this frame */
   AOM_CODEC_FPMB_STATS_PKT,  /**< first pass mb statistics for this frame */
   AOM_CODEC_PSNR_PKT,        /**< PSNR statistics for this frame */
+  AOM_CODEC_FPMV_STATS_PKT,  /**< first pass mb motion vectors for this frame */
   AOM_CODEC_CUSTOM_PKT = 256 /**< Algorithm extensions  */
 };
 
@@ -187,6 +188,7 @@ typedef struct aom_codec_cx_pkt {
     } frame;                            /**< data for compressed frame packet */
     aom_fixed_buf_t twopass_stats;      /**< data for two-pass packet */
     aom_fixed_buf_t firstpass_mb_stats; /**< first pass mb packet */
+    aom_fixed_buf_t firstpass_mvs;      /**< first pass mb mv packet */
     struct aom_psnr_pkt {
       unsigned int samples[4]; /**< Number of samples, total/y/u/v */
       uint64_t sse[4];         /**< sum squared error, total/y/u/v */
@@ -467,6 +469,14 @@ typedef struct aom_codec_enc_cfg {
    */
   aom_fixed_buf_t rc_firstpass_mb_stats_in;
 
+  /*!\brief first pass mb motion vector buffer.
+   *
+   * A buffer containing all of the first pass mb motion vector packets
+   * produced in the first pass, concatenated. It is only read when the
+   * AV1E_SET_FIRSTPASS_MVS control is enabled.
+   */
+  aom_fixed_buf_t rc_firstpass_mvs_in;
+
   /*!\brief Target data rate
    *
    * Target bandwidth to use for this stream, in kilobits per second.
@@ -559,6 +559,70 @@ enum aome_enc_control_id {
    * Supported in codecs: AV1
    */
   AV1E_SET_RENDER_SIZE,
+
+  /*!\brief Codec control function to enable row based multi-threading.
+   *
+   * When enabled, the superblock rows of each tile are encoded as separate
+   * jobs, with every row kept at least one superblock behind the row above
+   * it. This allows the encoder to use more threads than there are tile
+   * columns. The encoded stream depends on this setting, but not on the
+   * number of threads used.
+   *             0 = off
+   *             1 = on
+   *
+   * By default, this feature is off.
+   *
+   * Supported in codecs: AV1
+   */
+  AV1E_SET_ROW_MT,
+
+  /*!\brief Codec control function to pass first pass motion vectors to the
+   * last pass.
+   *
+   * When enabled, the first pass outputs the motion vectors it finds for
+   * each 16x16 macroblock in AOM_CODEC_FPMV_STATS_PKT packets, and the last
+   * pass reads them back from rc_firstpass_mvs_in to start its motion
+   * searches from. The control should be set in both passes, before the
+   * first frame is encoded.
+   *             0 = off
+   *             1 = on
+   *
+   * By default, this feature is off.
+   *
+   * Supported in codecs: AV1
+   */
+  AV1E_SET_FIRSTPASS_MVS,
+
+  /*!\brief Codec control function to cache the transform rate distortion
+   * results of inter blocks.
+   *
+   * When enabled, the rate distortion search reuses the results of an inter
+   * transform block whose residual was already evaluated in the frame. The
+   * encoded stream does not depend on this setting.
+   *             0 = off
+   *             1 = on
+   *
+   * By default, this feature is on.
+   *
+   * Supported in codecs: AV1
+   */
+  AV1E_SET_TX_RD_CACHE,
+
+  /*!\brief Codec control function to interpolate the up-sampled reference
+   * frames of the sub-pixel motion search on the fly.
+   *
+   * When enabled, the encoder does not keep reference frames up-sampled 8x in
+   * each direction and computes the sub-pixel positions it searches from the
+   * reference frames instead. The encoded stream does not depend on this
+   * setting.
+   *             0 = only for frames larger than 1080p
+   *             1 = always
+   *
+   * By default, this feature is only used for frames larger than 1080p.
+   *
+   * Supported in codecs: AV1
+   */
+  AV1E_SET_UPSAMPLED_REFS_ON_THE_FLY,
 };
 
 /*!\brief aom 1-D scaling mode
@@ -758,6 +822,18 @@ AOM_CTRL_USE_TYPE(AV1E_SET_COLOR_RANGE, int)
 AOM_CTRL_USE_TYPE(AV1E_SET_RENDER_SIZE, int *)
 #define AOM_CTRL_AV1E_SET_RENDER_SIZE
 
+AOM_CTRL_USE_TYPE(AV1E_SET_ROW_MT, unsigned int)
+#define AOM_CTRL_AV1E_SET_ROW_MT
+
+AOM_CTRL_USE_TYPE(AV1E_SET_FIRSTPASS_MVS, unsigned int)
+#define AOM_CTRL_AV1E_SET_FIRSTPASS_MVS
+
+AOM_CTRL_USE_TYPE(AV1E_SET_TX_RD_CACHE, unsigned int)
+#define AOM_CTRL_AV1E_SET_TX_RD_CACHE
+
+AOM_CTRL_USE_TYPE(AV1E_SET_UPSAMPLED_REFS_ON_THE_FLY, unsigned int)
+#define AOM_CTRL_AV1E_SET_UPSAMPLED_REFS_ON_THE_FLY
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
@@ -330,3 +330,31 @@ void aom_yv12_copy_y_c(const YV12_BUFFER_CONFIG *src_ybc,
     dst += dst_ybc->y_stride;
   }
 }
+
+// Copies luma rows vstart to vend - 1.
+void aom_yv12_partial_copy_y_c(const YV12_BUFFER_CONFIG *src_ybc,
+                               YV12_BUFFER_CONFIG *dst_ybc, int vstart,
+                               int vend) {
+  int row;
+  const uint8_t *src = src_ybc->y_buffer + vstart * src_ybc->y_stride;
+  uint8_t *dst = dst_ybc->y_buffer + vstart * dst_ybc->y_stride;
+
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (src_ybc->flags & YV12_FLAG_HIGHBITDEPTH) {
+    const uint16_t *src16 = CONVERT_TO_SHORTPTR(src);
+    uint16_t *dst16 = CONVERT_TO_SHORTPTR(dst);
+    for (row = vstart; row < vend; ++row) {
+      memcpy(dst16, src16, src_ybc->y_width * sizeof(uint16_t));
+      src16 += src_ybc->y_stride;
+      dst16 += dst_ybc->y_stride;
+    }
+    return;
+  }
+#endif
+
+  for (row = vstart; row < vend; ++row) {
+    memcpy(dst, src, src_ybc->y_width);
+    src += src_ybc->y_stride;
+    dst += dst_ybc->y_stride;
+  }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_UTIL_AOM_ATOMICS_H_
+#define AOM_UTIL_AOM_ATOMICS_H_
+
+#include "./aom_config.h"
+
+#if CONFIG_MULTITHREAD && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// An int shared between threads. All the operations below are sequentially
+// consistent, so a store followed by a load of another aom_atomic_int in one
+// thread cannot be reordered.
+typedef struct aom_atomic_int { volatile int value; } aom_atomic_int;
+
+static INLINE void aom_atomic_init(aom_atomic_int *atomic, int value) {
+  atomic->value = value;
+}
+
+#if !CONFIG_MULTITHREAD
+static INLINE int aom_atomic_load(const aom_atomic_int *atomic) {
+  return atomic->value;
+}
+
+static INLINE void aom_atomic_store(aom_atomic_int *atomic, int value) {
+  atomic->value = value;
+}
+
+static INLINE int aom_atomic_add(aom_atomic_int *atomic, int value) {
+  return atomic->value += value;
+}
+#elif defined(__GNUC__) || defined(__clang__)
+static INLINE int aom_atomic_load(const aom_atomic_int *atomic) {
+  return __atomic_load_n(&atomic->value, __ATOMIC_SEQ_CST);
+}
+
+static INLINE void aom_atomic_store(aom_atomic_int *atomic, int value) {
+  __atomic_store_n(&atomic->value, value, __ATOMIC_SEQ_CST);
+}
+
+static INLINE int aom_atomic_add(aom_atomic_int *atomic, int value) {
+  return __atomic_add_fetch(&atomic->value, value, __ATOMIC_SEQ_CST);
+}
+#elif defined(_MSC_VER)
+// The interlocked functions are full memory barriers.
+static INLINE int aom_atomic_load(const aom_atomic_int *atomic) {
+  return _InterlockedCompareExchange((volatile long *)&atomic->value, 0, 0);
+}
+
+static INLINE void aom_atomic_store(aom_atomic_int *atomic, int value) {
+  _InterlockedExchange((volatile long *)&atomic->value, value);
+}
+
+static INLINE int aom_atomic_add(aom_atomic_int *atomic, int value) {
+  return _InterlockedExchangeAdd((volatile long *)&atomic->value, value) +
+         value;
+}
+#else
+#error "aom_atomics.h: no atomic operations for this compiler."
+#endif  // !CONFIG_MULTITHREAD
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_UTIL_AOM_ATOMICS_H_
@@ -20,6 +20,7 @@
 #include "aom_mem/aom_mem.h"
 
 #if CONFIG_MULTITHREAD
+#include "aom_ports/aom_once.h"
 
 struct AVxWorkerImpl {
   pthread_mutex_t mutex_;
@@ -27,6 +28,26 @@ struct AVxWorkerImpl {
   pthread_t thread_;
 };
 
+#define MAX_POOL_THREADS 64
+
+struct AVxThreadPool {
+  pthread_mutex_t mutex_;
+  pthread_cond_t work_condition_;  // signaled when a worker is queued
+  pthread_cond_t done_condition_;  // broadcast when a hook returns
+  pthread_t threads_[MAX_POOL_THREADS];
+  int num_threads;
+  int num_refs;
+  int ending;
+  // The launched workers whose hook has not started, by decreasing priority
+  // and then in launch order.
+  AVxWorker *queue_;
+};
+
+// The pool shared by the process, and the mutex guarding its creation and
+// destruction.
+static AVxThreadPool *g_thread_pool = NULL;
+static pthread_mutex_t g_thread_pool_mutex;
+
 //------------------------------------------------------------------------------
 
 static void execute(AVxWorker *const worker);  // Forward declaration.
@@ -52,6 +73,72 @@ static THREADFN thread_loop(void *ptr) {
   return THREAD_RETURN(NULL);  // Thread is finished
 }
 
+static THREADFN pool_thread_loop(void *ptr) {
+  AVxThreadPool *const pool = (AVxThreadPool *)ptr;
+  pthread_mutex_lock(&pool->mutex_);
+  while (1) {
+    AVxWorker *worker;
+    while (pool->queue_ == NULL && !pool->ending) {
+      pthread_cond_wait(&pool->work_condition_, &pool->mutex_);
+    }
+    // The pool only ends once no worker is attached to it.
+    if (pool->queue_ == NULL) break;
+    worker = pool->queue_;
+    pool->queue_ = worker->next_;
+    pthread_mutex_unlock(&pool->mutex_);
+    execute(worker);
+    pthread_mutex_lock(&pool->mutex_);
+    worker->status_ = OK;
+    pthread_cond_broadcast(&pool->done_condition_);
+  }
+  pthread_mutex_unlock(&pool->mutex_);
+  return THREAD_RETURN(NULL);
+}
+
+// Removes worker from the queue of its pool. Returns false if its hook has
+// already started. The pool mutex must be held.
+static int pool_unqueue(AVxWorker *const worker) {
+  AVxWorker **link = &worker->pool_->queue_;
+  while (*link != NULL && *link != worker) link = &(*link)->next_;
+  if (*link == NULL) return 0;
+  *link = worker->next_;
+  return 1;
+}
+
+static void pool_launch(AVxWorker *const worker) {
+  AVxThreadPool *const pool = worker->pool_;
+  AVxWorker **link = &pool->queue_;
+  pthread_mutex_lock(&pool->mutex_);
+  // Wait for the previous job, like change_state().
+  while (worker->status_ == WORK) {
+    pthread_cond_wait(&pool->done_condition_, &pool->mutex_);
+  }
+  while (*link != NULL && (*link)->priority_ >= worker->priority_) {
+    link = &(*link)->next_;
+  }
+  worker->next_ = *link;
+  *link = worker;
+  worker->status_ = WORK;
+  pthread_cond_signal(&pool->work_condition_);
+  pthread_mutex_unlock(&pool->mutex_);
+}
+
+static void pool_sync(AVxWorker *const worker) {
+  AVxThreadPool *const pool = worker->pool_;
+  pthread_mutex_lock(&pool->mutex_);
+  if (worker->status_ == WORK && pool_unqueue(worker)) {
+    // Run the hook here rather than wait for a thread of the pool.
+    pthread_mutex_unlock(&pool->mutex_);
+    execute(worker);
+    pthread_mutex_lock(&pool->mutex_);
+    worker->status_ = OK;
+  }
+  while (worker->status_ == WORK) {
+    pthread_cond_wait(&pool->done_condition_, &pool->mutex_);
+  }
+  pthread_mutex_unlock(&pool->mutex_);
+}
+
 // main thread state control
 static void change_state(AVxWorker *const worker, AVxWorkerStatus new_status) {
   // No-op when attempting to change state on a thread that didn't come up.
@@ -85,7 +172,11 @@ static void init(AVxWorker *const worker) {
 
 static int sync(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
-  change_state(worker, OK);
+  if (worker->pool_ != NULL && worker->status_ >= OK) {
+    pool_sync(worker);
+  } else {
+    change_state(worker, OK);
+  }
 #endif
   assert(worker->status_ <= OK);
   return !worker->had_error;
@@ -96,6 +187,10 @@ static int reset(AVxWorker *const worker) {
   worker->had_error = 0;
   if (worker->status_ < OK) {
 #if CONFIG_MULTITHREAD
+    if (worker->pool_ != NULL) {
+      worker->status_ = OK;
+      return 1;
+    }
     worker->impl_ = (AVxWorkerImpl *)aom_calloc(1, sizeof(*worker->impl_));
     if (worker->impl_ == NULL) {
       return 0;
@@ -137,7 +232,11 @@ static void execute(AVxWorker *const worker) {
 
 static void launch(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
-  change_state(worker, WORK);
+  if (worker->pool_ != NULL && worker->status_ >= OK) {
+    pool_launch(worker);
+  } else {
+    change_state(worker, WORK);
+  }
 #else
   execute(worker);
 #endif
@@ -145,7 +244,10 @@ static void launch(AVxWorker *const worker) {
 
 static void end(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
-  if (worker->impl_ != NULL) {
+  if (worker->pool_ != NULL) {
+    if (worker->status_ >= OK) pool_sync(worker);
+    worker->status_ = NOT_OK;
+  } else if (worker->impl_ != NULL) {
     change_state(worker, NOT_OK);
     pthread_join(worker->impl_->thread_, NULL);
     pthread_mutex_destroy(&worker->impl_->mutex_);
@@ -181,3 +283,101 @@ const AVxWorkerInterface *aom_get_worker_interface(void) {
 }
 
 //------------------------------------------------------------------------------
+
+#if CONFIG_MULTITHREAD
+static void init_thread_pool_mutex(void) {
+  pthread_mutex_init(&g_thread_pool_mutex, NULL);
+}
+
+// Ends the threads of pool and frees it. No worker may be attached to it.
+static void free_thread_pool(AVxThreadPool *const pool) {
+  int i;
+  pthread_mutex_lock(&pool->mutex_);
+  assert(pool->queue_ == NULL);
+  pool->ending = 1;
+  pthread_cond_broadcast(&pool->work_condition_);
+  pthread_mutex_unlock(&pool->mutex_);
+  for (i = 0; i < pool->num_threads; ++i) {
+    pthread_join(pool->threads_[i], NULL);
+  }
+  pthread_mutex_destroy(&pool->mutex_);
+  pthread_cond_destroy(&pool->work_condition_);
+  pthread_cond_destroy(&pool->done_condition_);
+  aom_free(pool);
+}
+
+static AVxThreadPool *create_thread_pool(void) {
+  AVxThreadPool *const pool = (AVxThreadPool *)aom_calloc(1, sizeof(*pool));
+  if (pool == NULL) return NULL;
+  if (pthread_mutex_init(&pool->mutex_, NULL)) goto Error;
+  if (pthread_cond_init(&pool->work_condition_, NULL)) {
+    pthread_mutex_destroy(&pool->mutex_);
+    goto Error;
+  }
+  if (pthread_cond_init(&pool->done_condition_, NULL)) {
+    pthread_cond_destroy(&pool->work_condition_);
+    pthread_mutex_destroy(&pool->mutex_);
+    goto Error;
+  }
+  return pool;
+Error:
+  aom_free(pool);
+  return NULL;
+}
+#endif  // CONFIG_MULTITHREAD
+
+AVxThreadPool *aom_thread_pool_acquire(int num_threads) {
+#if CONFIG_MULTITHREAD
+  AVxThreadPool *pool;
+  once(init_thread_pool_mutex);
+  pthread_mutex_lock(&g_thread_pool_mutex);
+  pool = g_thread_pool;
+  if (pool == NULL) pool = create_thread_pool();
+  if (pool != NULL) {
+    if (num_threads > MAX_POOL_THREADS) num_threads = MAX_POOL_THREADS;
+    pthread_mutex_lock(&pool->mutex_);
+    while (pool->num_threads < num_threads &&
+           !pthread_create(&pool->threads_[pool->num_threads], NULL,
+                           pool_thread_loop, pool)) {
+      ++pool->num_threads;
+    }
+    pthread_mutex_unlock(&pool->mutex_);
+    if (pool->num_threads > 0) {
+      ++pool->num_refs;
+      g_thread_pool = pool;
+    } else {
+      free_thread_pool(pool);
+      pool = NULL;
+    }
+  }
+  pthread_mutex_unlock(&g_thread_pool_mutex);
+  return pool;
+#else
+  (void)num_threads;
+  return NULL;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void aom_thread_pool_release(AVxThreadPool *pool) {
+#if CONFIG_MULTITHREAD
+  if (pool == NULL) return;
+  pthread_mutex_lock(&g_thread_pool_mutex);
+  assert(pool == g_thread_pool && pool->num_refs > 0);
+  if (--pool->num_refs == 0) {
+    free_thread_pool(pool);
+    g_thread_pool = NULL;
+  }
+  pthread_mutex_unlock(&g_thread_pool_mutex);
+#else
+  (void)pool;
+#endif  // CONFIG_MULTITHREAD
+}
+
+int aom_worker_set_pool(AVxWorker *const worker, AVxThreadPool *const pool,
+                        int priority) {
+  const int was_reset = worker->status_ >= OK;
+  if (was_reset) end(worker);
+  worker->pool_ = pool;
+  worker->priority_ = priority;
+  return was_reset ? reset(worker) : 1;
+}
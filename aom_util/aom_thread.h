@@ -173,6 +173,22 @@ static INLINE int pthread_cond_signal(pthread_cond_t *const condition) {
   return !ok;
 }
 
+static INLINE int pthread_cond_broadcast(pthread_cond_t *const condition) {
+  int ok = 1;
+#ifdef USE_WINDOWS_CONDITION_VARIABLE
+  WakeAllConditionVariable(condition);
+#else
+  // The woken threads block on the mutex held by the caller, so they cannot
+  // start waiting again before the loop ends.
+  while (WaitForSingleObject(condition->waiting_sem_, 0) == WAIT_OBJECT_0) {
+    ok &= SetEvent(condition->signal_event_);
+    ok &= (WaitForSingleObject(condition->received_sem_, INFINITE) ==
+           WAIT_OBJECT_0);
+  }
+#endif
+  return !ok;
+}
+
 static INLINE int pthread_cond_wait(pthread_cond_t *const condition,
                                     pthread_mutex_t *const mutex) {
   int ok;
@@ -358,14 +374,23 @@ typedef int (*AVxWorkerHook)(void *, void *);
 // Platform-dependent implementation details for the worker.
 typedef struct AVxWorkerImpl AVxWorkerImpl;
 
+// Pool of threads shared by the workers of all the codec instances of the
+// process.
+typedef struct AVxThreadPool AVxThreadPool;
+
 // Synchronization object used to launch job in the worker thread
-typedef struct {
+typedef struct AVxWorker {
   AVxWorkerImpl *impl_;
   AVxWorkerStatus status_;
   AVxWorkerHook hook;  // hook to call
   void *data1;         // first argument passed to 'hook'
   void *data2;         // second argument passed to 'hook'
   int had_error;       // return value of the last call to 'hook'
+  // When set, the hook runs on a thread of this pool instead of a thread of
+  // the worker. See aom_worker_set_pool().
+  AVxThreadPool *pool_;
+  int priority_;
+  struct AVxWorker *next_;  // next launched worker waiting in the pool
 } AVxWorker;
 
 // The interface for all thread-worker related functions. All these functions
@@ -403,6 +428,28 @@ int aom_set_worker_interface(const AVxWorkerInterface *const winterface);
 // Retrieve the currently set thread worker interface.
 const AVxWorkerInterface *aom_get_worker_interface(void);
 
+// Takes a reference to the pool shared by the whole process, creating it or
+// adding threads to it so that it has at least num_threads threads, up to
+// 64. The pool only ever grows, which bounds its threads by the largest
+// request. Returns NULL in case of error. Always fails without
+// CONFIG_MULTITHREAD.
+AVxThreadPool *aom_thread_pool_acquire(int num_threads);
+
+// Drops a reference taken with aom_thread_pool_acquire(). The threads of the
+// pool end with its last reference. Does nothing if pool is NULL.
+void aom_thread_pool_release(AVxThreadPool *pool);
+
+// Moves worker to pool, or back to a thread of its own if pool is NULL. The
+// hook of a launched worker then runs on the first free thread of the pool,
+// after the hooks of the waiting workers with a higher priority, and runs on
+// the thread calling sync() if it has not started by then. This only applies
+// to the default interface. A worker that was reset is synced, ended and
+// reset again, and false is returned in case of error; a worker that was not
+// is left for reset(). Only workers whose hooks never wait for hooks that have
+// not started yet can be moved to a pool.
+int aom_worker_set_pool(AVxWorker *const worker, AVxThreadPool *const pool,
+                        int priority);
+
 //------------------------------------------------------------------------------
 
 #ifdef __cplusplus
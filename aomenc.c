@@ -145,6 +145,8 @@ static const arg_def_t pass_arg =
     ARG_DEF(NULL, "pass", 1, "Pass to execute (1/2)");
 static const arg_def_t fpf_name =
     ARG_DEF(NULL, "fpf", 1, "First pass statistics file name");
+static const arg_def_t fpmvf_name =
+    ARG_DEF(NULL, "fpmvf", 1, "First pass motion vector file name");
 #if CONFIG_FP_MB_STATS
 static const arg_def_t fpmbf_name =
     ARG_DEF(NULL, "fpmbf", 1, "First pass block statistics file name");
@@ -217,6 +219,7 @@ static const arg_def_t *main_args[] = { &debugmode,
                                         &passes,
                                         &pass_arg,
                                         &fpf_name,
+                                        &fpmvf_name,
                                         &limit,
                                         &skip,
                                         &deadline,
@@ -371,11 +374,18 @@ static const arg_def_t max_intra_rate_pct =
 
 #if CONFIG_AV1_ENCODER
 static const arg_def_t cpu_used_av1 =
-    ARG_DEF(NULL, "cpu-used", 1, "CPU Used (-8..8)");
+    ARG_DEF(NULL, "cpu-used", 1, "CPU Used (-9..9)");
 static const arg_def_t tile_cols =
     ARG_DEF(NULL, "tile-columns", 1, "Number of tile columns to use, log2");
 static const arg_def_t tile_rows =
     ARG_DEF(NULL, "tile-rows", 1, "Number of tile rows to use, log2");
+static const arg_def_t row_mt =
+    ARG_DEF(NULL, "row-mt", 1,
+            "Enable row based multi-threading (0: off (default), 1: on)");
+static const arg_def_t fp_mvs =
+    ARG_DEF(NULL, "fp-mvs", 1,
+            "Reuse first pass motion vectors in the last pass "
+            "(0: off (default), 1: on)");
 static const arg_def_t lossless =
     ARG_DEF(NULL, "lossless", 1, "Lossless mode (0: false (default), 1: true)");
 #if CONFIG_AOM_QM
@@ -447,6 +457,7 @@ static const arg_def_t tune_content = ARG_DEF_ENUM(
 static const arg_def_t *av1_args[] = {
   &cpu_used_av1,            &auto_altref,      &sharpness,
   &static_thresh,           &tile_cols,        &tile_rows,
+  &row_mt,                  &fp_mvs,
   &arnr_maxframes,          &arnr_strength,    &arnr_type,
   &tune_ssim,               &cq_level,         &max_intra_rate_pct,
   &max_inter_rate_pct,      &gf_cbr_boost_pct, &lossless,
@@ -461,6 +472,7 @@ static const int av1_arg_ctrl_map[] = {
   AOME_SET_CPUUSED,                 AOME_SET_ENABLEAUTOALTREF,
   AOME_SET_SHARPNESS,               AOME_SET_STATIC_THRESHOLD,
   AV1E_SET_TILE_COLUMNS,            AV1E_SET_TILE_ROWS,
+  AV1E_SET_ROW_MT,                  AV1E_SET_FIRSTPASS_MVS,
   AOME_SET_ARNR_MAXFRAMES,          AOME_SET_ARNR_STRENGTH,
   AOME_SET_ARNR_TYPE,               AOME_SET_TUNING,
   AOME_SET_CQ_LEVEL,                AOME_SET_MAX_INTRA_BITRATE_PCT,
@@ -761,6 +773,7 @@ struct stream_config {
   struct aom_codec_enc_cfg cfg;
   const char *out_fn;
   const char *stats_fn;
+  const char *fpmv_stats_fn;
 #if CONFIG_FP_MB_STATS
   const char *fpmb_stats_fn;
 #endif
@@ -792,6 +805,7 @@ struct stream_state {
   uint64_t cx_time;
   size_t nbytes;
   stats_io_t stats;
+  stats_io_t fpmv_stats;
 #if CONFIG_FP_MB_STATS
   stats_io_t fpmb_stats;
 #endif
@@ -1073,6 +1087,8 @@ static int parse_stream_params(struct AvxEncoderConfig *global,
       config->out_fn = arg.val;
     } else if (arg_match(&arg, &fpf_name, argi)) {
       config->stats_fn = arg.val;
+    } else if (arg_match(&arg, &fpmvf_name, argi)) {
+      config->fpmv_stats_fn = arg.val;
 #if CONFIG_FP_MB_STATS
     } else if (arg_match(&arg, &fpmbf_name, argi)) {
       config->fpmb_stats_fn = arg.val;
@@ -1261,6 +1277,15 @@ static void validate_stream_config(const struct stream_state *stream,
               streami->index, stream->index);
     }
 
+    /* Check for two streams sharing a motion vector file. */
+    if (streami != stream) {
+      const char *a = stream->config.fpmv_stats_fn;
+      const char *b = streami->config.fpmv_stats_fn;
+      if (a && b && !strcmp(a, b))
+        fatal("Stream %d: duplicate mv file (from stream %d)",
+              streami->index, stream->index);
+    }
+
 #if CONFIG_FP_MB_STATS
     /* Check for two streams sharing a mb stats file. */
     if (streami != stream) {
@@ -1438,6 +1463,17 @@ static void setup_pass(struct stream_state *stream,
       fatal("Failed to open statistics store");
   }
 
+  /* Without a file the motion vectors only survive between the passes of a
+   * single run. */
+  if (stream->config.fpmv_stats_fn) {
+    if (!stats_open_file(&stream->fpmv_stats, stream->config.fpmv_stats_fn,
+                         pass))
+      fatal("Failed to open mv statistics store");
+  } else if (!global->pass) {
+    if (!stats_open_mem(&stream->fpmv_stats, pass))
+      fatal("Failed to open mv statistics store");
+  }
+
 #if CONFIG_FP_MB_STATS
   if (stream->config.fpmb_stats_fn) {
     if (!stats_open_file(&stream->fpmb_stats, stream->config.fpmb_stats_fn,
@@ -1454,6 +1490,7 @@ static void setup_pass(struct stream_state *stream,
                                   : AOM_RC_ONE_PASS;
   if (pass) {
     stream->config.cfg.rc_twopass_stats_in = stats_get(&stream->stats);
+    stream->config.cfg.rc_firstpass_mvs_in = stats_get(&stream->fpmv_stats);
 #if CONFIG_FP_MB_STATS
     stream->config.cfg.rc_firstpass_mb_stats_in =
         stats_get(&stream->fpmb_stats);
@@ -1669,6 +1706,12 @@ static void get_cx_data(struct stream_state *stream,
                     pkt->data.twopass_stats.sz);
         stream->nbytes += pkt->data.raw.sz;
         break;
+      case AOM_CODEC_FPMV_STATS_PKT:
+        if (stream->config.fpmv_stats_fn || !global->pass)
+          stats_write(&stream->fpmv_stats, pkt->data.firstpass_mvs.buf,
+                      pkt->data.firstpass_mvs.sz);
+        stream->nbytes += pkt->data.raw.sz;
+        break;
 #if CONFIG_FP_MB_STATS
       case AOM_CODEC_FPMB_STATS_PKT:
         stats_write(&stream->fpmb_stats, pkt->data.firstpass_mb_stats.buf,
@@ -2222,6 +2265,7 @@ int main(int argc, const char **argv_) {
     FOREACH_STREAM(close_output_file(stream, global.codec->fourcc));
 
     FOREACH_STREAM(stats_close(&stream->stats, global.passes - 1));
+    FOREACH_STREAM(stats_close(&stream->fpmv_stats, global.passes - 1));
 
 #if CONFIG_FP_MB_STATS
     FOREACH_STREAM(stats_close(&stream->fpmb_stats, global.passes - 1));
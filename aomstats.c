@@ -86,7 +86,10 @@ void stats_write(stats_io_t *stats, const void *pkt, size_t len) {
   } else {
     if (stats->buf.sz + len > stats->buf_alloc_sz) {
       size_t new_sz = stats->buf_alloc_sz + 64 * 1024;
-      char *new_ptr = realloc(stats->buf.buf, new_sz);
+      char *new_ptr;
+
+      while (stats->buf.sz + len > new_sz) new_sz += 64 * 1024;
+      new_ptr = realloc(stats->buf.buf, new_sz);
 
       if (new_ptr) {
         stats->buf_ptr = new_ptr + (stats->buf_ptr - (char *)stats->buf.buf);
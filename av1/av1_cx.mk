@@ -41,6 +41,8 @@ AV1_CX_SRCS-yes += encoder/encodemb.h
 AV1_CX_SRCS-yes += encoder/encodemv.h
 AV1_CX_SRCS-yes += encoder/extend.h
 AV1_CX_SRCS-yes += encoder/firstpass.h
+AV1_CX_SRCS-yes += encoder/hash.c
+AV1_CX_SRCS-yes += encoder/hash.h
 AV1_CX_SRCS-yes += encoder/lookahead.c
 AV1_CX_SRCS-yes += encoder/lookahead.h
 AV1_CX_SRCS-yes += encoder/mcomp.h
@@ -93,6 +95,7 @@ AV1_CX_SRCS-yes += encoder/clpf_rdo_simd.h
 AV1_CX_SRCS-$(HAVE_SSE2) += encoder/clpf_rdo_sse2.c
 AV1_CX_SRCS-$(HAVE_SSSE3) += encoder/clpf_rdo_ssse3.c
 AV1_CX_SRCS-$(HAVE_SSE4_1) += encoder/clpf_rdo_sse4_1.c
+AV1_CX_SRCS-$(HAVE_AVX2) += encoder/clpf_rdo_avx2.c
 AV1_CX_SRCS-$(HAVE_NEON) += encoder/clpf_rdo_neon.c
 endif
 
@@ -104,6 +107,8 @@ AV1_CX_SRCS-yes += encoder/pvq_encoder.h
 AV1_CX_SRCS-yes += encoder/encint.h
 AV1_CX_SRCS-yes += encoder/generic_encoder.c
 AV1_CX_SRCS-yes += encoder/laplace_encoder.c
+AV1_CX_SRCS-$(HAVE_SSE4_1) += encoder/x86/pvq_sse4.c
+AV1_CX_SRCS-$(HAVE_AVX2) += encoder/x86/pvq_avx2.c
 endif
 
 AV1_CX_SRCS-$(HAVE_SSE2) += encoder/x86/temporal_filter_apply_sse2.asm
@@ -19,6 +19,7 @@
 #include "./aom_version.h"
 #include "av1/encoder/encoder.h"
 #include "aom/aomcx.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/firstpass.h"
 #include "av1/av1_iface_common.h"
 
@@ -30,6 +31,10 @@ struct av1_extracfg {
   unsigned int static_thresh;
   unsigned int tile_columns;
   unsigned int tile_rows;
+  unsigned int row_mt;
+  unsigned int firstpass_mvs;
+  unsigned int tx_rd_cache;
+  unsigned int upsampled_refs_on_the_fly;
   unsigned int arnr_max_frames;
   unsigned int arnr_strength;
   unsigned int min_gf_interval;
@@ -64,6 +69,10 @@ static struct av1_extracfg default_extra_cfg = {
   0,              // static_thresh
   6,              // tile_columns
   0,              // tile_rows
+  0,              // row_mt
+  0,              // firstpass_mvs
+  1,              // tx_rd_cache
+  0,              // upsampled_refs_on_the_fly
   7,              // arnr_max_frames
   5,              // arnr_strength
   0,              // min_gf_interval; 0 -> default decision
@@ -110,6 +119,8 @@ struct aom_codec_alg_priv {
   aom_codec_priv_output_cx_pkt_cb_pair_t output_cx_pkt_cb;
   // BufferPool that holds all reference frames.
   BufferPool *buffer_pool;
+  // Reference to the shared thread pool, see AV1_SET_THREAD_POOL.
+  AVxThreadPool *thread_pool;
 };
 
 static AOM_REFFRAME ref_frame_to_av1_reframe(aom_ref_frame_type_t frame) {
@@ -210,9 +221,13 @@ static aom_codec_err_t validate_config(aom_codec_alg_priv_t *ctx,
         "or kf_max_dist instead.");
 
   RANGE_CHECK(extra_cfg, enable_auto_alt_ref, 0, 2);
-  RANGE_CHECK(extra_cfg, cpu_used, -8, 8);
+  RANGE_CHECK(extra_cfg, cpu_used, -9, 9);
   RANGE_CHECK_HI(extra_cfg, noise_sensitivity, 6);
   RANGE_CHECK(extra_cfg, tile_columns, 0, 6);
+  RANGE_CHECK_BOOL(extra_cfg, row_mt);
+  RANGE_CHECK_BOOL(extra_cfg, firstpass_mvs);
+  RANGE_CHECK_BOOL(extra_cfg, tx_rd_cache);
+  RANGE_CHECK_BOOL(extra_cfg, upsampled_refs_on_the_fly);
   RANGE_CHECK(extra_cfg, tile_rows, 0, 2);
   RANGE_CHECK_HI(extra_cfg, sharpness, 7);
   RANGE_CHECK(extra_cfg, arnr_max_frames, 0, 15);
@@ -245,6 +260,10 @@ static aom_codec_err_t validate_config(aom_codec_alg_priv_t *ctx,
 
     if ((int)(stats->count + 0.5) != n_packets - 1)
       ERROR("rc_twopass_stats_in missing EOS stats packet");
+
+    if (extra_cfg->firstpass_mvs &&
+        cfg->rc_firstpass_mvs_in.sz % sizeof(FIRSTPASS_MB_MV))
+      ERROR("rc_firstpass_mvs_in.sz indicates truncated packet.");
   }
 
 #if !CONFIG_AOM_HIGHBITDEPTH
@@ -407,6 +426,11 @@ static aom_codec_err_t set_encoder_config(
   oxcf->firstpass_mb_stats_in = cfg->rc_firstpass_mb_stats_in;
 #endif
 
+  oxcf->use_firstpass_mvs = extra_cfg->firstpass_mvs;
+  oxcf->firstpass_mvs_in = cfg->rc_firstpass_mvs_in;
+  oxcf->use_tx_rd_cache = extra_cfg->tx_rd_cache;
+  oxcf->upsampled_refs_on_the_fly = extra_cfg->upsampled_refs_on_the_fly;
+
   oxcf->color_space = extra_cfg->color_space;
   oxcf->color_range = extra_cfg->color_range;
   oxcf->render_width = extra_cfg->render_width;
@@ -421,6 +445,7 @@ static aom_codec_err_t set_encoder_config(
 
   oxcf->tile_columns = extra_cfg->tile_columns;
   oxcf->tile_rows = extra_cfg->tile_rows;
+  oxcf->row_mt = extra_cfg->row_mt;
 
   oxcf->error_resilient_mode = cfg->g_error_resilient;
   oxcf->frame_parallel_decoding_mode = extra_cfg->frame_parallel_decoding_mode;
@@ -575,6 +600,35 @@ static aom_codec_err_t ctrl_set_tile_rows(aom_codec_alg_priv_t *ctx,
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
+                                       va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.row_mt = CAST(AV1E_SET_ROW_MT, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_firstpass_mvs(aom_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.firstpass_mvs = CAST(AV1E_SET_FIRSTPASS_MVS, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_tx_rd_cache(aom_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.tx_rd_cache = CAST(AV1E_SET_TX_RD_CACHE, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
+static aom_codec_err_t ctrl_set_upsampled_refs_on_the_fly(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.upsampled_refs_on_the_fly =
+      CAST(AV1E_SET_UPSAMPLED_REFS_ON_THE_FLY, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 static aom_codec_err_t ctrl_set_arnr_max_frames(aom_codec_alg_priv_t *ctx,
                                                 va_list args) {
   struct av1_extracfg extra_cfg = ctx->extra_cfg;
@@ -751,6 +805,7 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx,
 static aom_codec_err_t encoder_destroy(aom_codec_alg_priv_t *ctx) {
   free(ctx->cx_data);
   av1_remove_compressor(ctx->cpi);
+  aom_thread_pool_release(ctx->thread_pool);
 #if CONFIG_MULTITHREAD
   pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
 #endif
@@ -1100,6 +1155,30 @@ static aom_codec_err_t ctrl_get_reference(aom_codec_alg_priv_t *ctx,
   }
 }
 
+static aom_codec_err_t ctrl_set_thread_pool(aom_codec_alg_priv_t *ctx,
+                                           va_list args) {
+#if CONFIG_MULTITHREAD
+  const aom_thread_pool_cfg_t *const cfg =
+      va_arg(args, aom_thread_pool_cfg_t *);
+  AVxThreadPool *pool = NULL;
+  int ok;
+
+  if (cfg == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (cfg->num_threads > 0) {
+    pool = aom_thread_pool_acquire(cfg->num_threads);
+    if (pool == NULL) return AOM_CODEC_MEM_ERROR;
+  }
+  ok = av1_set_enc_thread_pool(ctx->cpi, pool, cfg->priority);
+  aom_thread_pool_release(ctx->thread_pool);
+  ctx->thread_pool = pool;
+  return ok ? AOM_CODEC_OK : AOM_CODEC_ERROR;
+#else
+  (void)ctx;
+  (void)args;
+  return AOM_CODEC_INCAPABLE;
+#endif  // CONFIG_MULTITHREAD
+}
+
 static aom_codec_err_t ctrl_set_previewpp(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   (void)ctx;
@@ -1217,6 +1296,7 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   // Setters
   { AOM_SET_REFERENCE, ctrl_set_reference },
   { AOM_SET_POSTPROC, ctrl_set_previewpp },
+  { AV1_SET_THREAD_POOL, ctrl_set_thread_pool },
   { AOME_SET_ROI_MAP, ctrl_set_roi_map },
   { AOME_SET_ACTIVEMAP, ctrl_set_active_map },
   { AOME_SET_SCALEMODE, ctrl_set_scale_mode },
@@ -1226,6 +1306,10 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AOME_SET_STATIC_THRESHOLD, ctrl_set_static_thresh },
   { AV1E_SET_TILE_COLUMNS, ctrl_set_tile_columns },
   { AV1E_SET_TILE_ROWS, ctrl_set_tile_rows },
+  { AV1E_SET_ROW_MT, ctrl_set_row_mt },
+  { AV1E_SET_FIRSTPASS_MVS, ctrl_set_firstpass_mvs },
+  { AV1E_SET_TX_RD_CACHE, ctrl_set_tx_rd_cache },
+  { AV1E_SET_UPSAMPLED_REFS_ON_THE_FLY, ctrl_set_upsampled_refs_on_the_fly },
   { AOME_SET_ARNR_MAXFRAMES, ctrl_set_arnr_max_frames },
   { AOME_SET_ARNR_STRENGTH, ctrl_set_arnr_strength },
   { AOME_SET_ARNR_TYPE, ctrl_set_arnr_type },
@@ -1292,6 +1376,7 @@ static aom_codec_enc_cfg_map_t encoder_usage_cfg_map[] = {
         AOM_VBR,      // rc_end_usage
         { NULL, 0 },  // rc_twopass_stats_in
         { NULL, 0 },  // rc_firstpass_mb_stats_in
+        { NULL, 0 },  // rc_firstpass_mvs_in
         256,          // rc_target_bandwidth
         0,            // rc_min_quantizer
         63,           // rc_max_quantizer
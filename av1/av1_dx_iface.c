@@ -56,6 +56,9 @@ struct aom_codec_alg_priv {
   int last_show_frame;  // Index of last output frame.
   int byte_alignment;
   int skip_loop_filter;
+  // Reference to the shared thread pool, see AV1_SET_THREAD_POOL.
+  AVxThreadPool *thread_pool;
+  int thread_pool_priority;
 
   // Frame parallel related.
   int frame_parallel_decode;  // frame-based threading.
@@ -139,6 +142,7 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
 
   aom_free(ctx->frame_workers);
   aom_free(ctx->buffer_pool);
+  aom_thread_pool_release(ctx->thread_pool);
   aom_free(ctx);
   return AOM_CODEC_OK;
 }
@@ -391,6 +395,7 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
     frame_worker_data->scratch_buffer_size = 0;
     frame_worker_data->frame_context_ready = 0;
     frame_worker_data->received_frame = 0;
+    aom_atomic_init(&frame_worker_data->progress_waiters, 0);
 #if CONFIG_MULTITHREAD
     if (pthread_mutex_init(&frame_worker_data->stats_mutex, NULL)) {
       set_error_detail(ctx, "Failed to allocate frame_worker_data mutex");
@@ -407,6 +412,10 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
     frame_worker_data->pbi->max_threads =
         (ctx->frame_parallel_decode == 0) ? ctx->cfg.threads : 0;
 
+    if (!ctx->frame_parallel_decode) {
+      frame_worker_data->pbi->thread_pool = ctx->thread_pool;
+      frame_worker_data->pbi->thread_pool_priority = ctx->thread_pool_priority;
+    }
     frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
     frame_worker_data->pbi->common.frame_parallel_decode =
         ctx->frame_parallel_decode;
@@ -1013,6 +1022,38 @@ static aom_codec_err_t ctrl_set_skip_loop_filter(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_thread_pool(aom_codec_alg_priv_t *ctx,
+                                           va_list args) {
+#if CONFIG_MULTITHREAD
+  const aom_thread_pool_cfg_t *const cfg =
+      va_arg(args, aom_thread_pool_cfg_t *);
+  AVxThreadPool *pool = NULL;
+  int ok = 1;
+
+  if (cfg == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (cfg->num_threads > 0) {
+    pool = aom_thread_pool_acquire(cfg->num_threads);
+    if (pool == NULL) return AOM_CODEC_MEM_ERROR;
+  }
+  // Only serial decode has tile and loop filter workers, and its frame worker
+  // is idle between calls.
+  if (ctx->frame_workers != NULL && !ctx->frame_parallel_decode) {
+    FrameWorkerData *const frame_worker_data =
+        (FrameWorkerData *)ctx->frame_workers->data1;
+    ok = av1_decoder_set_thread_pool(frame_worker_data->pbi, pool,
+                                     cfg->priority);
+  }
+  aom_thread_pool_release(ctx->thread_pool);
+  ctx->thread_pool = pool;
+  ctx->thread_pool_priority = cfg->priority;
+  return ok ? AOM_CODEC_OK : AOM_CODEC_ERROR;
+#else
+  (void)ctx;
+  (void)args;
+  return AOM_CODEC_INCAPABLE;
+#endif  // CONFIG_MULTITHREAD
+}
+
 static aom_codec_err_t ctrl_get_accounting(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
 #if !CONFIG_ACCOUNTING
@@ -1046,6 +1087,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AOMD_SET_DECRYPTOR, ctrl_set_decryptor },
   { AV1_SET_BYTE_ALIGNMENT, ctrl_set_byte_alignment },
   { AV1_SET_SKIP_LOOP_FILTER, ctrl_set_skip_loop_filter },
+  { AV1_SET_THREAD_POOL, ctrl_set_thread_pool },
 
   // Getters
   { AOMD_GET_LAST_REF_UPDATES, ctrl_get_last_ref_updates },
@@ -14,6 +14,12 @@
 
 #include "av1/common/alloccommon.h"
 #include "av1/common/blockd.h"
+#if CONFIG_CLPF
+#include "av1/common/clpf.h"
+#endif
+#if CONFIG_DERING
+#include "av1/common/dering.h"
+#endif
 #include "av1/common/entropymode.h"
 #include "av1/common/entropymv.h"
 #include "av1/common/onyxc_int.h"
@@ -129,6 +135,12 @@ fail:
 
 void av1_remove_common(AV1_COMMON *cm) {
   av1_free_context_buffers(cm);
+#if CONFIG_CLPF
+  av1_clpf_free_scratch(cm);
+#endif
+#if CONFIG_DERING
+  av1_dering_free_lines(cm);
+#endif
 
   aom_free(cm->fc);
   cm->fc = NULL;
@@ -34,16 +34,16 @@ if ($opts{arch} eq "x86_64") {
 }
 
 add_proto qw/void av1_convolve_horiz/, "const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int w, int h, const struct InterpFilterParams fp, const int subpel_x_q4, int x_step_q4, int avg";
-specialize qw/av1_convolve_horiz ssse3/;
+specialize qw/av1_convolve_horiz ssse3 avx2/;
 
 add_proto qw/void av1_convolve_vert/, "const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int w, int h, const struct InterpFilterParams fp, const int subpel_x_q4, int x_step_q4, int avg";
-specialize qw/av1_convolve_vert ssse3/;
+specialize qw/av1_convolve_vert ssse3 avx2/;
 
 if (aom_config("CONFIG_AOM_HIGHBITDEPTH") eq "yes") {
   add_proto qw/void av1_highbd_convolve_horiz/, "const uint16_t *src, int src_stride, uint16_t *dst, int dst_stride, int w, int h, const struct InterpFilterParams fp, const int subpel_x_q4, int x_step_q4, int avg, int bd";
-  specialize qw/av1_highbd_convolve_horiz sse4_1/;
+  specialize qw/av1_highbd_convolve_horiz sse4_1 avx2/;
   add_proto qw/void av1_highbd_convolve_vert/, "const uint16_t *src, int src_stride, uint16_t *dst, int dst_stride, int w, int h, const struct InterpFilterParams fp, const int subpel_x_q4, int x_step_q4, int avg, int bd";
-  specialize qw/av1_highbd_convolve_vert sse4_1/;
+  specialize qw/av1_highbd_convolve_vert sse4_1 avx2/;
 }
 
 #
@@ -126,16 +126,26 @@ if (aom_config("CONFIG_AOM_HIGHBITDEPTH") eq "yes") {
   #
   # dct
   #
-  # Note as optimized versions of these functions are added we need to add a check to ensure
-  # that when CONFIG_EMULATE_HARDWARE is on, it defaults to the C versions only.
-  add_proto qw/void av1_highbd_iht4x4_16_add/, "const tran_low_t *input, uint8_t *dest, int dest_stride, int tx_type, int bd";
-  specialize qw/av1_highbd_iht4x4_16_add/;
+  # Force C versions if CONFIG_EMULATE_HARDWARE is 1
+  if (aom_config("CONFIG_EMULATE_HARDWARE") eq "yes") {
+    add_proto qw/void av1_highbd_iht4x4_16_add/, "const tran_low_t *input, uint8_t *dest, int dest_stride, int tx_type, int bd";
+    specialize qw/av1_highbd_iht4x4_16_add/;
+
+    add_proto qw/void av1_highbd_iht8x8_64_add/, "const tran_low_t *input, uint8_t *dest, int dest_stride, int tx_type, int bd";
+    specialize qw/av1_highbd_iht8x8_64_add/;
+
+    add_proto qw/void av1_highbd_iht16x16_256_add/, "const tran_low_t *input, uint8_t *output, int pitch, int tx_type, int bd";
+    specialize qw/av1_highbd_iht16x16_256_add/;
+  } else {
+    add_proto qw/void av1_highbd_iht4x4_16_add/, "const tran_low_t *input, uint8_t *dest, int dest_stride, int tx_type, int bd";
+    specialize qw/av1_highbd_iht4x4_16_add sse4_1/;
 
-  add_proto qw/void av1_highbd_iht8x8_64_add/, "const tran_low_t *input, uint8_t *dest, int dest_stride, int tx_type, int bd";
-  specialize qw/av1_highbd_iht8x8_64_add/;
+    add_proto qw/void av1_highbd_iht8x8_64_add/, "const tran_low_t *input, uint8_t *dest, int dest_stride, int tx_type, int bd";
+    specialize qw/av1_highbd_iht8x8_64_add sse4_1 avx2/;
 
-  add_proto qw/void av1_highbd_iht16x16_256_add/, "const tran_low_t *input, uint8_t *output, int pitch, int tx_type, int bd";
-  specialize qw/av1_highbd_iht16x16_256_add/;
+    add_proto qw/void av1_highbd_iht16x16_256_add/, "const tran_low_t *input, uint8_t *output, int pitch, int tx_type, int bd";
+    specialize qw/av1_highbd_iht16x16_256_add sse4_1 avx2/;
+  }
 }
 
 #
@@ -630,6 +640,12 @@ if (aom_config("CONFIG_AOM_HIGHBITDEPTH") eq "yes") {
 }
 # End av1_high encoder functions
 
+# PVQ pulse search
+if (aom_config("CONFIG_PVQ") eq "yes") {
+  add_proto qw/int od_pvq_search_argmax/, "const int16_t *x, const int32_t *y, int n, int32_t xy, int32_t yy, int xshift, int yshift";
+  specialize qw/od_pvq_search_argmax sse4_1 avx2/;
+}
+
 }
 # end encoder functions
 
@@ -827,19 +843,22 @@ if (aom_config("CONFIG_AOM_HIGHBITDEPTH") eq "yes") {
 
 if (aom_config("CONFIG_DERING") eq "yes") {
   add_proto qw/int od_dir_find8/, "const od_dering_in *img, int stride, int32_t *var, int coeff_shift";
-  specialize qw/od_dir_find8 sse4_1/;
+  specialize qw/od_dir_find8 sse4_1 avx2/;
 
   add_proto qw/int od_filter_dering_direction_4x4/, "int16_t *y, int ystride, const int16_t *in, int threshold, int dir";
-  specialize qw/od_filter_dering_direction_4x4 sse4_1/;
+  specialize qw/od_filter_dering_direction_4x4 sse4_1 avx2/;
 
   add_proto qw/int od_filter_dering_direction_8x8/, "int16_t *y, int ystride, const int16_t *in, int threshold, int dir";
-  specialize qw/od_filter_dering_direction_8x8 sse4_1/;
+  specialize qw/od_filter_dering_direction_8x8 sse4_1 avx2/;
 
   add_proto qw/void od_filter_dering_orthogonal_4x4/, "int16_t *y, int ystride, const int16_t *in, int threshold, int dir";
-  specialize qw/od_filter_dering_orthogonal_4x4 sse4_1/;
+  specialize qw/od_filter_dering_orthogonal_4x4 sse4_1 avx2/;
 
   add_proto qw/void od_filter_dering_orthogonal_8x8/, "int16_t *y, int ystride, const int16_t *in, int threshold, int dir";
-  specialize qw/od_filter_dering_orthogonal_8x8 sse4_1/;
+  specialize qw/od_filter_dering_orthogonal_8x8 sse4_1 avx2/;
+
+  add_proto qw/uint64_t od_compute_dist_8x8/, "const int16_t *x, int xstride, const int16_t *y, int ystride";
+  specialize qw/od_compute_dist_8x8 sse4_1 avx2/;
 }
 
 1;
@@ -13,6 +13,7 @@
 #include "./aom_dsp_rtcd.h"
 #include "aom/aom_image.h"
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 
 int av1_clpf_sample(int X, int A, int B, int C, int D, int E, int F, int b) {
   int delta = 4 * clamp(A - X, -b, b) + clamp(B - X, -b, b) +
@@ -64,221 +65,486 @@ void aom_clpf_block_hbd_c(const uint16_t *src, uint16_t *dst, int sstride,
 }
 #endif
 
-// Return number of filtered blocks
-void av1_clpf_frame(const YV12_BUFFER_CONFIG *frame,
-                    const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
-                    int enable_fb_flag, unsigned int strength,
-                    unsigned int fb_size_log2, int plane,
-                    int (*decision)(int, int, const YV12_BUFFER_CONFIG *,
-                                    const YV12_BUFFER_CONFIG *,
-                                    const AV1_COMMON *cm, int, int, int,
-                                    unsigned int, unsigned int, int8_t *)) {
-  /* Constrained low-pass filter (CLPF) */
-  int c, k, l, m, n;
-  const int subx = plane != AOM_PLANE_Y && frame->subsampling_x;
-  const int suby = plane != AOM_PLANE_Y && frame->subsampling_y;
-  const int bs = (subx || suby) ? 4 : 8;
-  const int bslog = get_msb(bs);
-  int width = plane != AOM_PLANE_Y ? frame->uv_crop_width : frame->y_crop_width;
-  int height =
-      plane != AOM_PLANE_Y ? frame->uv_crop_height : frame->y_crop_height;
-  int xpos, ypos;
-  const int sstride = plane != AOM_PLANE_Y ? frame->uv_stride : frame->y_stride;
-  int dstride = bs;
-  const int num_fb_hor = (width + (1 << fb_size_log2) - 1) >> fb_size_log2;
-  const int num_fb_ver = (height + (1 << fb_size_log2) - 1) >> fb_size_log2;
-  uint8_t *cache = NULL;
-  uint8_t **cache_ptr = NULL;
-  uint8_t **cache_dst = NULL;
-  int cache_idx = 0;
-  const int cache_size = num_fb_hor << (2 * fb_size_log2);
-  const int cache_blocks = cache_size / (bs * bs);
-  uint8_t *src_buffer =
-      plane != AOM_PLANE_Y
-          ? (plane == AOM_PLANE_U ? frame->u_buffer : frame->v_buffer)
-          : frame->y_buffer;
-  uint8_t *dst_buffer;
+// Source buffer of one filter block with borders: one line above and below
+// and up to 8 columns on either side, which keeps the block aligned.
+#define CLPF_BUF_STRIDE (MAX_FB_SIZE + 16)
+#define CLPF_BUF_ROWS (MAX_FB_SIZE + 4)
+#define CLPF_BUF_SIZE (CLPF_BUF_STRIDE * CLPF_BUF_ROWS * 2)
 
-// Make buffer space for in-place filtering
-#if CONFIG_AOM_HIGHBITDEPTH
-  strength <<= (cm->bit_depth - 8);
-  CHECK_MEM_ERROR(cm, cache, aom_malloc(cache_size << !!cm->use_highbitdepth));
-  dst_buffer = cm->use_highbitdepth ? CONVERT_TO_BYTEPTR(cache) : cache;
-#else
-  CHECK_MEM_ERROR(cm, cache, aom_malloc(cache_size));
-  dst_buffer = cache;
-#endif
-  CHECK_MEM_ERROR(cm, cache_ptr, aom_malloc(cache_blocks * sizeof(*cache_ptr)));
-  CHECK_MEM_ERROR(cm, cache_dst, aom_malloc(cache_blocks * sizeof(*cache_dst)));
-  memset(cache_ptr, 0, cache_blocks * sizeof(*cache_dst));
+static void copy_rect(uint8_t *dst, int dstride, const uint8_t *src,
+                      int sstride, int width, int height, int bps) {
+  int r;
+  for (r = 0; r < height; r++)
+    memcpy(dst + r * dstride * bps, src + r * sstride * bps, width * bps);
+}
+
+// Whether the block at (xpos, ypos) of a filter block chosen for filtering is
+// filtered.
+static int clpf_block_filtered(const ClpfFrameParams *p, int xpos, int ypos) {
+  const AV1_COMMON *const cm = p->cm;
+  return !cm->mi_grid_visible[(ypos << p->suby) / MI_SIZE * cm->mi_stride +
+                              (xpos << p->subx) / MI_SIZE]
+              ->mbmi.skip ||
+         (p->enable_fb_flag && p->fb_size_log2 == MAX_FB_SIZE_LOG2);
+}
+
+void av1_clpf_prepare_row(const ClpfFrameParams *p, int k) {
+  AV1_COMMON *const cm = p->cm;
+  const int bs = p->bs;
+  const int fb_size_log2 = p->fb_size_log2;
+  const int yoff = k << fb_size_log2;
+  int l, m, n;
+  for (l = 0; l < p->num_fb_hor; l++) {
+    int h, w;
+    int allskip = !(p->enable_fb_flag && fb_size_log2 == MAX_FB_SIZE_LOG2);
+    const int xoff = l << fb_size_log2;
+    for (m = 0; allskip && m < (1 << fb_size_log2) / bs; m++) {
+      for (n = 0; allskip && n < (1 << fb_size_log2) / bs; n++) {
+        const int xpos = xoff + n * bs;
+        const int ypos = yoff + m * bs;
+        if (xpos < p->width && ypos < p->height) {
+          allskip &=
+              cm->mi_grid_visible[(ypos << p->suby) / MI_SIZE * cm->mi_stride +
+                                  (xpos << p->subx) / MI_SIZE]
+                  ->mbmi.skip;
+        }
+      }
+    }
+
+    // Calculate the actual filter block size near frame edges
+    h = AOMMIN(p->height, (k + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+    w = AOMMIN(p->width, (l + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+    h += !h << fb_size_log2;
+    w += !w << fb_size_log2;
+    p->fb_flags[k * p->num_fb_hor + l] =
+        !allskip &&  // Do not filter the block if all is skip encoded
+        (!p->enable_fb_flag ||
+         // Only called if fb_flag enabled (luma only)
+         p->decision(k, l, p->frame, p->org, cm, bs, w / bs, h / bs,
+                     p->strength, fb_size_log2,
+                     cm->clpf_blocks + yoff / MIN_FB_SIZE * cm->clpf_stride +
+                         xoff / MIN_FB_SIZE));
+  }
 
-  // Iterate over all filter blocks
-  for (k = 0; k < num_fb_ver; k++) {
-    for (l = 0; l < num_fb_hor; l++) {
-      int h, w;
-      int allskip = !(enable_fb_flag && fb_size_log2 == MAX_FB_SIZE_LOG2);
+  if (k > 0) {
+    copy_rect(p->lines + 2 * k * p->width * p->bps, p->width,
+              p->buffer + (yoff - 1) * p->stride * p->bps, p->stride, p->width,
+              1, p->bps);
+  }
+  if (k < p->num_fb_ver - 1) {
+    copy_rect(p->lines + (2 * k + 1) * p->width * p->bps, p->width,
+              p->buffer + (yoff + (1 << fb_size_log2)) * p->stride * p->bps,
+              p->stride, p->width, 1, p->bps);
+  }
+}
+
+void av1_clpf_find_limits(const ClpfFrameParams *p) {
+  const int bs = p->bs;
+  const int bslog = get_msb(bs);
+  const int fb_size_log2 = p->fb_size_log2;
+  // Number of buffers in the ring of the reference CLPF
+  const int cache_blocks = (p->num_fb_hor << 2 * fb_size_log2) >> 2 * bslog;
+  int index = 0;
+  int num_limits = 0;
+  int i, k, l, m, n;
+  if (!p->partial) return;
+  for (k = 0; k < p->num_fb_ver; k++) {
+    const int yoff = k << fb_size_log2;
+    int h =
+        AOMMIN(p->height, (k + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+    h += !h << fb_size_log2;
+    p->row_index[k] = index;
+    for (l = 0; l < p->num_fb_hor; l++) {
       const int xoff = l << fb_size_log2;
-      const int yoff = k << fb_size_log2;
-      for (m = 0; allskip && m < (1 << fb_size_log2) / bs; m++) {
-        for (n = 0; allskip && n < (1 << fb_size_log2) / bs; n++) {
-          xpos = xoff + n * bs;
-          ypos = yoff + m * bs;
-          if (xpos < width && ypos < height) {
-            allskip &=
-                cm->mi_grid_visible[(ypos << suby) / MI_SIZE * cm->mi_stride +
-                                    (xpos << subx) / MI_SIZE]
-                    ->mbmi.skip;
+      int w =
+          AOMMIN(p->width, (l + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+      w += !w << fb_size_log2;
+      if (!p->fb_flags[k * p->num_fb_hor + l]) continue;
+      for (m = 0; m < ((h + bs - 1) >> bslog); m++) {
+        for (n = 0; n < ((w + bs - 1) >> bslog); n++) {
+          const int xpos = xoff + n * bs;
+          const int ypos = yoff + m * bs;
+          const int sizex = AOMMIN(p->width - xpos, bs);
+          const int sizey = AOMMIN(p->height - ypos, bs);
+          if (!clpf_block_filtered(p, xpos, ypos)) continue;
+          // The block took the buffer of the block filtered cache_blocks
+          // blocks before it.
+          if ((sizex < bs || sizey < bs) && index >= cache_blocks) {
+            ClpfLimit *const limit = &p->limits[num_limits++];
+            limit->index = index - cache_blocks;
+            limit->sizex = sizex;
+            limit->sizey = sizey;
           }
+          index++;
         }
       }
+    }
+  }
 
-      // Calculate the actual filter block size near frame edges
-      h = AOMMIN(height, (k + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
-      w = AOMMIN(width, (l + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
-      h += !h << fb_size_log2;
-      w += !w << fb_size_log2;
-      if (!allskip &&  // Do not filter the block if all is skip encoded
-          (!enable_fb_flag ||
-           // Only called if fb_flag enabled (luma only)
-           decision(k, l, frame, org, cm, bs, w / bs, h / bs, strength,
-                    fb_size_log2,
-                    cm->clpf_blocks + yoff / MIN_FB_SIZE * cm->clpf_stride +
-                        xoff / MIN_FB_SIZE))) {
-        // Iterate over all smaller blocks inside the filter block
-        for (m = 0; m < ((h + bs - 1) >> bslog); m++) {
-          for (n = 0; n < ((w + bs - 1) >> bslog); n++) {
-            int sizex, sizey;
-            xpos = xoff + n * bs;
-            ypos = yoff + m * bs;
-            sizex = AOMMIN(width - xpos, bs);
-            sizey = AOMMIN(height - ypos, bs);
-            if (!cm->mi_grid_visible[(ypos << suby) / MI_SIZE * cm->mi_stride +
-                                     (xpos << subx) / MI_SIZE]
-                     ->mbmi.skip ||
-                (enable_fb_flag && fb_size_log2 == MAX_FB_SIZE_LOG2)) {
-              // Temporary buffering needed for in-place filtering
-              if (cache_ptr[cache_idx]) {
-// Copy filtered block back into the frame
-#if CONFIG_AOM_HIGHBITDEPTH
-                if (cm->use_highbitdepth) {
-                  uint16_t *const d = CONVERT_TO_SHORTPTR(cache_dst[cache_idx]);
-                  if (sizex == 8) {
-                    for (c = 0; c < sizey; c++) {
-                      *(uint64_t *)(d + c * sstride) =
-                          *(uint64_t *)(cache_ptr[cache_idx] + c * bs * 2);
-                      *(uint64_t *)(d + c * sstride + 4) =
-                          *(uint64_t *)(cache_ptr[cache_idx] + c * bs * 2 + 8);
-                    }
-                  } else if (sizex == 4) {
-                    for (c = 0; c < sizey; c++)
-                      *(uint64_t *)(d + c * sstride) =
-                          *(uint64_t *)(cache_ptr[cache_idx] + c * bs * 2);
-                  } else {
-                    for (c = 0; c < sizey; c++)
-                      memcpy(d + c * sstride, cache_ptr[cache_idx] + c * bs * 2,
-                             sizex);
-                  }
-                } else {
-                  if (sizex == 8)
-                    for (c = 0; c < sizey; c++)
-                      *(uint64_t *)(cache_dst[cache_idx] + c * sstride) =
-                          *(uint64_t *)(cache_ptr[cache_idx] + c * bs);
-                  else if (sizex == 4)
-                    for (c = 0; c < sizey; c++)
-                      *(uint32_t *)(cache_dst[cache_idx] + c * sstride) =
-                          *(uint32_t *)(cache_ptr[cache_idx] + c * bs);
-                  else
-                    for (c = 0; c < sizey; c++)
-                      memcpy(cache_dst[cache_idx] + c * sstride,
-                             cache_ptr[cache_idx] + c * bs, sizex);
-                }
-#else
-                if (sizex == 8)
-                  for (c = 0; c < sizey; c++)
-                    *(uint64_t *)(cache_dst[cache_idx] + c * sstride) =
-                        *(uint64_t *)(cache_ptr[cache_idx] + c * bs);
-                else if (sizex == 4)
-                  for (c = 0; c < sizey; c++)
-                    *(uint32_t *)(cache_dst[cache_idx] + c * sstride) =
-                        *(uint32_t *)(cache_ptr[cache_idx] + c * bs);
-                else
-                  for (c = 0; c < sizey; c++)
-                    memcpy(cache_dst[cache_idx] + c * sstride,
-                           cache_ptr[cache_idx] + c * bs, sizex);
-#endif
-              }
+  for (k = 0, i = 0; k < p->num_fb_ver; k++) {
+    while (i < num_limits && p->limits[i].index < p->row_index[k]) i++;
+    p->row_limit[k] = i;
+  }
+  p->row_limit[p->num_fb_ver] = num_limits;
+}
+
+// Restores the unfiltered pixels of a filtered block outside the extent of
+// its limit. The reference CLPF copied high bitdepth blocks of widths other
+// than 4 and 8 back by sizex bytes rather than samples.
+static void clpf_limit_block(const ClpfFrameParams *p, const uint8_t *src,
+                             int xpos, int ypos, int sizex, int sizey,
+                             const ClpfLimit *limit) {
+  const int bps = p->bps;
+  const int bytes = bps > 1 && (limit->sizex == 4 || limit->sizex == 8)
+                        ? limit->sizex * bps
+                        : limit->sizex;
+  int y;
+  for (y = 0; y < sizey; y++) {
+    const int x = y < limit->sizey ? AOMMIN(bytes, sizex * bps) : 0;
+    memcpy(p->buffer + ((ypos + y) * p->stride + xpos) * bps + x,
+           src + ((ypos + y) * CLPF_BUF_STRIDE + xpos) * bps + x,
+           sizex * bps - x);
+  }
+}
+
+// Each filter block is filtered from a copy of its unfiltered pixels straight
+// into the frame. The copy of the previous block provides the unfiltered
+// pixels on the left, and the lines saved by av1_clpf_prepare_row() the ones
+// above and below.
+void av1_clpf_filter_row(const ClpfFrameParams *p, uint8_t *const buf[2],
+                         int k) {
 #if CONFIG_AOM_HIGHBITDEPTH
-              if (cm->use_highbitdepth) {
-                cache_ptr[cache_idx] = cache + cache_idx * bs * bs * 2;
-                dst_buffer =
-                    CONVERT_TO_BYTEPTR(cache_ptr[cache_idx]) - ypos * bs - xpos;
-              } else {
-                cache_ptr[cache_idx] = cache + cache_idx * bs * bs;
-                dst_buffer = cache_ptr[cache_idx] - ypos * bs - xpos;
-              }
-#else
-              cache_ptr[cache_idx] = cache + cache_idx * bs * bs;
-              dst_buffer = cache_ptr[cache_idx] - ypos * bs - xpos;
+  const AV1_COMMON *const cm = p->cm;
 #endif
-              cache_dst[cache_idx] = src_buffer + ypos * sstride + xpos;
-              if (++cache_idx >= cache_blocks) cache_idx = 0;
+  const int bs = p->bs;
+  const int bslog = get_msb(bs);
+  const int bps = p->bps;
+  const int fb_size_log2 = p->fb_size_log2;
+  const int yoff = k << fb_size_log2;
+  int h =
+      AOMMIN(p->height, (k + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+  // The filtered block index and the next limit of partial planes
+  int index = p->partial ? p->row_index[k] : 0;
+  int limit = p->partial ? p->row_limit[k] : 0;
+  const int end = p->partial ? p->row_limit[k + 1] : 0;
+  int prev_filtered = 0;
+  int cur = 0;
+  int l, m, n;
+  h += !h << fb_size_log2;
+  for (l = 0; l < p->num_fb_hor; l++) {
+    const int xoff = l << fb_size_log2;
+    const int x0 = AOMMAX(0, xoff - 2);
+    int w =
+        AOMMIN(p->width, (l + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+    int x1;
+    uint8_t *const b = buf[cur];
+    // Position (0, 0) of the frame in the source buffer
+    const uint8_t *const src =
+        b + ((1 - yoff) * CLPF_BUF_STRIDE + 8 - xoff) * bps;
+    w += !w << fb_size_log2;
+    x1 = AOMMIN(p->width, xoff + w + 2);
+    if (!p->fb_flags[k * p->num_fb_hor + l]) {
+      prev_filtered = 0;
+      continue;
+    }
 
-// Apply the filter
+    if (prev_filtered) {
+      copy_rect(b + (CLPF_BUF_STRIDE + 6) * bps, CLPF_BUF_STRIDE,
+                buf[!cur] + (CLPF_BUF_STRIDE + 6 + (1 << fb_size_log2)) * bps,
+                CLPF_BUF_STRIDE, 2, h, bps);
+      copy_rect(b + (CLPF_BUF_STRIDE + 8) * bps, CLPF_BUF_STRIDE,
+                p->buffer + (yoff * p->stride + xoff) * bps, p->stride,
+                x1 - xoff, h, bps);
+    } else {
+      copy_rect(b + (CLPF_BUF_STRIDE + 8 + x0 - xoff) * bps, CLPF_BUF_STRIDE,
+                p->buffer + (yoff * p->stride + x0) * bps, p->stride, x1 - x0,
+                h, bps);
+    }
+    if (k > 0) {
+      copy_rect(b + (8 + x0 - xoff) * bps, CLPF_BUF_STRIDE,
+                p->lines + (2 * k * p->width + x0) * bps, p->width, x1 - x0, 1,
+                bps);
+    }
+    if (k < p->num_fb_ver - 1) {
+      copy_rect(b + ((h + 1) * CLPF_BUF_STRIDE + 8 + x0 - xoff) * bps,
+                CLPF_BUF_STRIDE,
+                p->lines + ((2 * k + 1) * p->width + x0) * bps, p->width,
+                x1 - x0, 1, bps);
+    }
+
+    // Iterate over all smaller blocks inside the filter block
+    for (m = 0; m < ((h + bs - 1) >> bslog); m++) {
+      for (n = 0; n < ((w + bs - 1) >> bslog); n++) {
+        const int xpos = xoff + n * bs;
+        const int ypos = yoff + m * bs;
+        const int sizex = AOMMIN(p->width - xpos, bs);
+        const int sizey = AOMMIN(p->height - ypos, bs);
+        if (clpf_block_filtered(p, xpos, ypos)) {
+// Apply the filter. The optimised versions filter two lines at a time, which
+// would read and write outside the frame for odd heights.
 #if CONFIG_AOM_HIGHBITDEPTH
-              if (cm->use_highbitdepth) {
-                aom_clpf_block_hbd(CONVERT_TO_SHORTPTR(src_buffer),
-                                   CONVERT_TO_SHORTPTR(dst_buffer), sstride,
-                                   dstride, xpos, ypos, sizex, sizey, width,
-                                   height, strength);
-              } else {
-                aom_clpf_block(src_buffer, dst_buffer, sstride, dstride, xpos,
-                               ypos, sizex, sizey, width, height, strength);
-              }
+          if (cm->use_highbitdepth) {
+            (sizey & 1 ? aom_clpf_block_hbd_c : aom_clpf_block_hbd)(
+                (const uint16_t *)src, CONVERT_TO_SHORTPTR(p->frame_buffer),
+                CLPF_BUF_STRIDE, p->stride, xpos, ypos, sizex, sizey,
+                p->width, p->height, p->strength);
+          } else {
+            (sizey & 1 ? aom_clpf_block_c : aom_clpf_block)(
+                src, p->frame_buffer, CLPF_BUF_STRIDE, p->stride, xpos, ypos,
+                sizex, sizey, p->width, p->height, p->strength);
+          }
 #else
-              aom_clpf_block(src_buffer, dst_buffer, sstride, dstride, xpos,
-                             ypos, sizex, sizey, width, height, strength);
+          (sizey & 1 ? aom_clpf_block_c : aom_clpf_block)(
+              src, p->frame_buffer, CLPF_BUF_STRIDE, p->stride, xpos, ypos,
+              sizex, sizey, p->width, p->height, p->strength);
 #endif
-            }
-          }
+          if (limit < end && p->limits[limit].index == index)
+            clpf_limit_block(p, src, xpos, ypos, sizex, sizey,
+                             &p->limits[limit++]);
+          index++;
         }
       }
     }
+    prev_filtered = 1;
+    cur = !cur;
   }
+}
 
-  // Copy remaining blocks into the frame
-  for (cache_idx = 0; cache_idx < cache_blocks && cache_ptr[cache_idx];
-       cache_idx++) {
-#if CONFIG_AOM_HIGHBITDEPTH
-    if (cm->use_highbitdepth) {
-      uint16_t *const d = CONVERT_TO_SHORTPTR(cache_dst[cache_idx]);
-      for (c = 0; c < bs; c++) {
-        *(uint64_t *)(d + c * sstride) =
-            *(uint64_t *)(cache_ptr[cache_idx] + c * bs * 2);
-        if (bs == 8)
-          *(uint64_t *)(d + c * sstride + 4) =
-              *(uint64_t *)(cache_ptr[cache_idx] + c * bs * 2 + 8);
-      }
-    } else {
-      for (c = 0; c < bs; c++)
-        if (bs == 4)
-          *(uint32_t *)(cache_dst[cache_idx] + c * sstride) =
-              *(uint32_t *)(cache_ptr[cache_idx] + c * bs);
-        else
-          *(uint64_t *)(cache_dst[cache_idx] + c * sstride) =
-              *(uint64_t *)(cache_ptr[cache_idx] + c * bs);
+static int clpf_prepare_worker(ClpfWorkerData *const data, void *unused) {
+  int k;
+  (void)unused;
+  for (k = data->start; k < data->params->num_fb_ver; k += data->step)
+    av1_clpf_prepare_row(data->params, k);
+  return 1;
+}
+
+static int clpf_filter_worker(ClpfWorkerData *const data, void *unused) {
+  int k;
+  (void)unused;
+  for (k = data->start; k < data->params->num_fb_ver; k += data->step)
+    av1_clpf_filter_row(data->params, data->buf, k);
+  return 1;
+}
+
+// Make sure the scratch memory kept in cm is large enough.
+static void clpf_alloc_scratch(AV1_COMMON *cm, int num_workers,
+                               int lines_size, int fb_flags_size,
+                               int rows_size, int limits_size) {
+  if (cm->clpf_lines_size < lines_size) {
+    aom_free(cm->clpf_lines);
+    CHECK_MEM_ERROR(cm, cm->clpf_lines, aom_malloc(lines_size));
+    cm->clpf_lines_size = lines_size;
+  }
+  if (cm->clpf_fb_flags_size < fb_flags_size) {
+    aom_free(cm->clpf_fb_flags);
+    CHECK_MEM_ERROR(cm, cm->clpf_fb_flags, aom_malloc(fb_flags_size));
+    cm->clpf_fb_flags_size = fb_flags_size;
+  }
+  if (cm->clpf_rows_size < rows_size) {
+    aom_free(cm->clpf_rows);
+    CHECK_MEM_ERROR(cm, cm->clpf_rows,
+                    aom_malloc(rows_size * sizeof(*cm->clpf_rows)));
+    cm->clpf_rows_size = rows_size;
+  }
+  if (cm->clpf_limits_size < limits_size) {
+    aom_free(cm->clpf_limits);
+    CHECK_MEM_ERROR(cm, cm->clpf_limits,
+                    aom_malloc(limits_size * sizeof(*cm->clpf_limits)));
+    cm->clpf_limits_size = limits_size;
+  }
+  if (cm->clpf_num_workers < num_workers) {
+    int i;
+    av1_clpf_free_worker_data(cm);
+    CHECK_MEM_ERROR(cm, cm->clpf_worker_data,
+                    aom_calloc(num_workers, sizeof(*cm->clpf_worker_data)));
+    cm->clpf_num_workers = num_workers;
+    for (i = 0; i < num_workers; i++) {
+      ClpfWorkerData *const data = &cm->clpf_worker_data[i];
+      CHECK_MEM_ERROR(cm, data->buf[0], aom_memalign(16, 2 * CLPF_BUF_SIZE));
+      data->buf[1] = data->buf[0] + CLPF_BUF_SIZE;
     }
+  }
+}
+
+void av1_clpf_free_worker_data(AV1_COMMON *cm) {
+  int i;
+  for (i = 0; i < cm->clpf_num_workers; i++)
+    aom_free(cm->clpf_worker_data[i].buf[0]);
+  aom_free(cm->clpf_worker_data);
+  cm->clpf_worker_data = NULL;
+  cm->clpf_num_workers = 0;
+}
+
+void av1_clpf_free_scratch(AV1_COMMON *cm) {
+  av1_clpf_free_worker_data(cm);
+  aom_free(cm->clpf_lines);
+  cm->clpf_lines = NULL;
+  cm->clpf_lines_size = 0;
+  aom_free(cm->clpf_fb_flags);
+  cm->clpf_fb_flags = NULL;
+  cm->clpf_fb_flags_size = 0;
+  aom_free(cm->clpf_rows);
+  cm->clpf_rows = NULL;
+  cm->clpf_rows_size = 0;
+  aom_free(cm->clpf_limits);
+  cm->clpf_limits = NULL;
+  cm->clpf_limits_size = 0;
+}
+
+void av1_clpf_init_params(ClpfFrameParams *p, const YV12_BUFFER_CONFIG *frame,
+                          const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                          int enable_fb_flag, unsigned int strength,
+                          unsigned int fb_size_log2, int plane,
+                          av1_clpf_decision_fn decision) {
+  p->cm = cm;
+  p->frame = frame;
+  p->org = org;
+  p->enable_fb_flag = enable_fb_flag;
+  p->fb_size_log2 = fb_size_log2;
+  p->decision = decision;
+  p->subx = plane != AOM_PLANE_Y && frame->subsampling_x;
+  p->suby = plane != AOM_PLANE_Y && frame->subsampling_y;
+  p->bs = (p->subx || p->suby) ? 4 : 8;
+  p->width = plane != AOM_PLANE_Y ? frame->uv_crop_width : frame->y_crop_width;
+  p->height =
+      plane != AOM_PLANE_Y ? frame->uv_crop_height : frame->y_crop_height;
+  p->stride = plane != AOM_PLANE_Y ? frame->uv_stride : frame->y_stride;
+  p->num_fb_hor = (p->width + (1 << fb_size_log2) - 1) >> fb_size_log2;
+  p->num_fb_ver = (p->height + (1 << fb_size_log2) - 1) >> fb_size_log2;
+  p->partial = (p->width % p->bs) || (p->height % p->bs);
+  p->frame_buffer =
+      plane != AOM_PLANE_Y
+          ? (plane == AOM_PLANE_U ? frame->u_buffer : frame->v_buffer)
+          : frame->y_buffer;
+#if CONFIG_AOM_HIGHBITDEPTH
+  strength <<= (cm->bit_depth - 8);
+  p->bps = cm->use_highbitdepth ? 2 : 1;
+  p->buffer = cm->use_highbitdepth
+                  ? (uint8_t *)CONVERT_TO_SHORTPTR(p->frame_buffer)
+                  : p->frame_buffer;
 #else
-    for (c = 0; c < bs; c++)
-      if (bs == 4)
-        *(uint32_t *)(cache_dst[cache_idx] + c * sstride) =
-            *(uint32_t *)(cache_ptr[cache_idx] + c * bs);
-      else
-        *(uint64_t *)(cache_dst[cache_idx] + c * sstride) =
-            *(uint64_t *)(cache_ptr[cache_idx] + c * bs);
+  p->bps = 1;
+  p->buffer = p->frame_buffer;
 #endif
+  p->strength = strength;
+  p->lines = NULL;
+  p->fb_flags = NULL;
+  p->row_index = NULL;
+  p->row_limit = NULL;
+  p->limits = NULL;
+}
+
+// Number of row entries and the largest number of limits of a plane. Only
+// the blocks of the last block column and row can be smaller than bs.
+static int clpf_rows_size(const ClpfFrameParams *p) {
+  return p->partial ? 2 * p->num_fb_ver + 1 : 0;
+}
+
+static int clpf_limits_size(const ClpfFrameParams *p) {
+  return p->partial ? (p->width + p->bs - 1) / p->bs +
+                          (p->height + p->bs - 1) / p->bs
+                    : 0;
+}
+
+void av1_clpf_alloc_rows(AV1_COMMON *cm, ClpfFrameParams *params, int nplanes,
+                         int num_workers) {
+  int lines_size = 0;
+  int fb_flags_size = 0;
+  int rows_size = 0;
+  int limits_size = 0;
+  int i;
+  for (i = 0; i < nplanes; i++) {
+    lines_size += 2 * params[i].num_fb_ver * params[i].width * params[i].bps;
+    fb_flags_size += params[i].num_fb_ver * params[i].num_fb_hor;
+    rows_size += clpf_rows_size(&params[i]);
+    limits_size += clpf_limits_size(&params[i]);
+  }
+  clpf_alloc_scratch(cm, num_workers, lines_size, fb_flags_size, rows_size,
+                     limits_size);
+  lines_size = 0;
+  fb_flags_size = 0;
+  rows_size = 0;
+  limits_size = 0;
+  for (i = 0; i < nplanes; i++) {
+    params[i].lines = cm->clpf_lines + lines_size;
+    params[i].fb_flags = cm->clpf_fb_flags + fb_flags_size;
+    if (params[i].partial) {
+      params[i].row_index = cm->clpf_rows + rows_size;
+      params[i].row_limit = params[i].row_index + params[i].num_fb_ver;
+      params[i].limits = cm->clpf_limits + limits_size;
+    }
+    lines_size += 2 * params[i].num_fb_ver * params[i].width * params[i].bps;
+    fb_flags_size += params[i].num_fb_ver * params[i].num_fb_hor;
+    rows_size += clpf_rows_size(&params[i]);
+    limits_size += clpf_limits_size(&params[i]);
+  }
+}
+
+void av1_clpf_frame_mt(const YV12_BUFFER_CONFIG *frame,
+                       const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                       int enable_fb_flag, unsigned int strength,
+                       unsigned int fb_size_log2, int plane,
+                       av1_clpf_decision_fn decision, AVxWorker *workers,
+                       int nworkers) {
+  /* Constrained low-pass filter (CLPF) */
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  ClpfFrameParams params;
+  ClpfFrameParams *const p = &params;
+  int num_workers;
+  int i;
+
+  av1_clpf_init_params(p, frame, org, cm, enable_fb_flag, strength,
+                       fb_size_log2, plane, decision);
+  num_workers = AOMMAX(1, AOMMIN(nworkers, p->num_fb_ver));
+  av1_clpf_alloc_rows(cm, p, 1, num_workers);
+  for (i = 0; i < num_workers; i++) {
+    cm->clpf_worker_data[i].params = p;
+    cm->clpf_worker_data[i].start = i;
+    cm->clpf_worker_data[i].step = num_workers;
+  }
+
+  if (num_workers == 1) {
+    clpf_prepare_worker(&cm->clpf_worker_data[0], NULL);
+    av1_clpf_find_limits(p);
+    clpf_filter_worker(&cm->clpf_worker_data[0], NULL);
+    return;
   }
 
-  aom_free(cache);
-  aom_free(cache_ptr);
-  aom_free(cache_dst);
+  // The decisions and border lines of all rows, and the limits, are collected
+  // before any row is filtered, after which the rows no longer depend on each
+  // other.
+  for (i = 0; i < num_workers; i++) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = (AVxWorkerHook)clpf_prepare_worker;
+    worker->data1 = &cm->clpf_worker_data[i];
+    worker->data2 = NULL;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (i = 0; i < num_workers; i++) winterface->sync(&workers[i]);
+  av1_clpf_find_limits(p);
+
+  for (i = 0; i < num_workers; i++) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = (AVxWorkerHook)clpf_filter_worker;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (i = 0; i < num_workers; i++) winterface->sync(&workers[i]);
+}
+
+void av1_clpf_frame(const YV12_BUFFER_CONFIG *frame,
+                    const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                    int enable_fb_flag, unsigned int strength,
+                    unsigned int fb_size_log2, int plane,
+                    int (*decision)(int, int, const YV12_BUFFER_CONFIG *,
+                                    const YV12_BUFFER_CONFIG *,
+                                    const AV1_COMMON *cm, int, int, int,
+                                    unsigned int, unsigned int, int8_t *)) {
+  av1_clpf_frame_mt(frame, org, cm, enable_fb_flag, strength, fb_size_log2,
+                    plane, decision, NULL, 0);
 }
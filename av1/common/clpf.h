@@ -11,13 +11,78 @@
 #ifndef AV1_COMMON_CLPF_H_
 #define AV1_COMMON_CLPF_H_
 
-#include "av1/common/reconinter.h"
+#include "av1/common/onyxc_int.h"
+#include "aom_util/aom_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #define MAX_FB_SIZE_LOG2 7
 #define MIN_FB_SIZE_LOG2 5
 #define MAX_FB_SIZE (1 << MAX_FB_SIZE_LOG2)
 #define MIN_FB_SIZE (1 << MIN_FB_SIZE_LOG2)
 
+typedef int (*av1_clpf_decision_fn)(int, int, const YV12_BUFFER_CONFIG *,
+                                    const YV12_BUFFER_CONFIG *,
+                                    const AV1_COMMON *cm, int, int, int,
+                                    unsigned int, unsigned int, int8_t *);
+
+// The reference CLPF passed the filtered blocks of a plane through a ring of
+// buffers, one filter block row in size, and copied each block back into the
+// frame with the size of the block that took its buffer. A block that was
+// copied back by a smaller block at the right or bottom edge of the plane
+// only keeps its filtered pixels in the extent of that block.
+typedef struct ClpfLimit {
+  // Index of the block among the filtered blocks of the plane.
+  int index;
+  // Size of the block that took its buffer.
+  int sizex, sizey;
+} ClpfLimit;
+
+// Parameters of filtering one plane, shared by all workers.
+typedef struct ClpfFrameParams {
+  AV1_COMMON *cm;
+  const YV12_BUFFER_CONFIG *frame;
+  const YV12_BUFFER_CONFIG *org;
+  int enable_fb_flag;
+  unsigned int strength;
+  unsigned int fb_size_log2;
+  av1_clpf_decision_fn decision;
+  int subx, suby;
+  int bs;
+  int width, height, stride;
+  int num_fb_hor, num_fb_ver;
+  // Bytes per sample, and the plane buffer as passed to the block filter and
+  // as a plain byte pointer.
+  int bps;
+  uint8_t *frame_buffer;
+  uint8_t *buffer;
+  // Unfiltered lines above and below every filter block row.
+  uint8_t *lines;
+  // Whether to filter each filter block.
+  int8_t *fb_flags;
+  // Whether the plane has blocks smaller than bs at its right or bottom edge.
+  // Only such planes have limits, found by av1_clpf_find_limits(): row_index
+  // holds the index of the first filtered block of every filter block row,
+  // and row_limit the first of its limits, with row_limit[num_fb_ver] being
+  // the number of limits.
+  int partial;
+  int *row_index;
+  int *row_limit;
+  ClpfLimit *limits;
+} ClpfFrameParams;
+
+// Per-worker state of the CLPF. The source buffers are allocated once and
+// kept in AV1_COMMON.
+typedef struct ClpfWorkerData {
+  const ClpfFrameParams *params;
+  uint8_t *buf[2];
+  // The worker filters filter block rows start, start + step, ...
+  int start;
+  int step;
+} ClpfWorkerData;
+
 int av1_clpf_sample(int X, int A, int B, int C, int D, int E, int F, int b);
 void av1_clpf_frame(const YV12_BUFFER_CONFIG *frame,
                     const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
@@ -27,5 +92,38 @@ void av1_clpf_frame(const YV12_BUFFER_CONFIG *frame,
                                     const YV12_BUFFER_CONFIG *,
                                     const AV1_COMMON *cm, int, int, int,
                                     unsigned int, unsigned int, int8_t *));
+// Multi-threaded CLPF that filters rows of filter blocks on the given workers.
+void av1_clpf_frame_mt(const YV12_BUFFER_CONFIG *frame,
+                       const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                       int enable_fb_flag, unsigned int strength,
+                       unsigned int fb_size_log2, int plane,
+                       av1_clpf_decision_fn decision, AVxWorker *workers,
+                       int nworkers);
+
+// Row by row filtering of one plane. av1_clpf_init_params() describes the
+// plane and av1_clpf_alloc_rows() provides the scratch memory of nplanes such
+// descriptions. av1_clpf_prepare_row() decides which filter blocks of filter
+// block row k to filter and saves the unfiltered lines bordering the row; it
+// must run before rows k - 1 and k + 1 are filtered by av1_clpf_filter_row().
+// For partial planes all rows must be prepared, and av1_clpf_find_limits()
+// run, before any row is filtered.
+void av1_clpf_init_params(ClpfFrameParams *p, const YV12_BUFFER_CONFIG *frame,
+                          const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                          int enable_fb_flag, unsigned int strength,
+                          unsigned int fb_size_log2, int plane,
+                          av1_clpf_decision_fn decision);
+void av1_clpf_alloc_rows(AV1_COMMON *cm, ClpfFrameParams *params, int nplanes,
+                         int num_workers);
+void av1_clpf_prepare_row(const ClpfFrameParams *p, int k);
+void av1_clpf_find_limits(const ClpfFrameParams *p);
+void av1_clpf_filter_row(const ClpfFrameParams *p, uint8_t *const buf[2],
+                         int k);
+
+void av1_clpf_free_worker_data(AV1_COMMON *cm);
+void av1_clpf_free_scratch(AV1_COMMON *cm);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
 
 #endif
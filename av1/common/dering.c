@@ -14,6 +14,7 @@
 
 #include "./aom_scale_rtcd.h"
 #include "aom/aom_integer.h"
+#include "aom_mem/aom_mem.h"
 #include "av1/common/dering.h"
 #include "av1/common/onyxc_int.h"
 #include "av1/common/reconinter.h"
@@ -133,243 +134,315 @@ static void copy_sb8_16(AV1_COMMON *cm, int16_t *dst, int dstride,
   }
 }
 
-void av1_dering_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
-                      MACROBLOCKD *xd, int global_level) {
+void av1_dering_save_boundary(DeringWorkerData *const data, int sbr) {
+  AV1_COMMON *const cm = data->cm;
+  const int stride = data->linebuf_stride;
+  int pli, r, c;
+  for (pli = 0; pli < data->nplanes; pli++) {
+    const struct macroblockd_plane *const pd = &data->planes[pli];
+    const int bsize = OD_DERING_SIZE_LOG2 - pd->subsampling_x;
+    const int sb_lines = MAX_MIB_SIZE << bsize;
+    const int width = cm->mi_cols << bsize;
+    int16_t *const above =
+        data->linebuf[pli] + 2 * OD_FILT_VBORDER * stride * sbr;
+    for (r = 0; r < OD_FILT_VBORDER; r++) {
+      for (c = 0; c < OD_FILT_HBORDER; c++) {
+        above[r * stride + c] = OD_DERING_VERY_LARGE;
+        above[r * stride + width + OD_FILT_HBORDER + c] = OD_DERING_VERY_LARGE;
+      }
+    }
+    if (sbr > 0) {
+      int16_t *const below = above - OD_FILT_VBORDER * stride;
+      copy_sb8_16(cm, &above[OD_FILT_HBORDER], stride, pd->dst.buf,
+                  sb_lines * sbr - OD_FILT_VBORDER, 0, pd->dst.stride,
+                  OD_FILT_VBORDER, width);
+      copy_sb8_16(cm, &below[OD_FILT_HBORDER], stride, pd->dst.buf,
+                  sb_lines * sbr, 0, pd->dst.stride, OD_FILT_VBORDER, width);
+    } else {
+      for (r = 0; r < OD_FILT_VBORDER; r++) {
+        for (c = 0; c < width; c++) {
+          above[r * stride + c + OD_FILT_HBORDER] = OD_DERING_VERY_LARGE;
+        }
+      }
+    }
+  }
+}
+
+void av1_dering_sb_row(DeringWorkerData *const data, int sbr) {
+  AV1_COMMON *const cm = data->cm;
+  const struct macroblockd_plane *const planes = data->planes;
+  const int nplanes = data->nplanes;
+  const int stride = data->linebuf_stride;
+  const int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int nvb = AOMMIN(MAX_MIB_SIZE, cm->mi_rows - MAX_MIB_SIZE * sbr);
   int r, c;
-  int sbr, sbc;
-  int nhsb, nvsb;
+  int sbc;
   int16_t src[OD_DERING_INBUF_SIZE];
-  int16_t *linebuf[3];
-  int16_t colbuf[3][OD_BSIZE_MAX + 2 * OD_FILT_VBORDER][OD_FILT_HBORDER];
+  int16_t colbuf[3][OD_DERING_BSIZE_MAX + 2 * OD_FILT_VBORDER][OD_FILT_HBORDER];
   dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
-  unsigned char *row_dering, *prev_row_dering, *curr_row_dering;
   int dering_count;
   int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS] = { { 0 } };
-  int stride;
+  int32_t var[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS];
   int bsize[3];
   int dec[3];
   int pli;
   int dering_left;
-  int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
-  int nplanes;
-  if (xd->plane[1].subsampling_x == xd->plane[1].subsampling_y &&
-      xd->plane[2].subsampling_x == xd->plane[2].subsampling_y)
-    nplanes = 3;
-  else
-    nplanes = 1;
-  nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
-  nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
-  av1_setup_dst_planes(xd->plane, frame, 0, 0);
-  row_dering = aom_malloc(sizeof(*row_dering) * nhsb * 2);
-  memset(row_dering, 1, sizeof(*row_dering) * (nhsb + 2) * 2);
-  prev_row_dering = row_dering + 1;
-  curr_row_dering = prev_row_dering + nhsb + 2;
   for (pli = 0; pli < nplanes; pli++) {
-    dec[pli] = xd->plane[pli].subsampling_x;
+    dec[pli] = planes[pli].subsampling_x;
     bsize[pli] = OD_DERING_SIZE_LOG2 - dec[pli];
   }
-  stride = (cm->mi_cols << bsize[0]) + 2 * OD_FILT_HBORDER;
   for (pli = 0; pli < nplanes; pli++) {
-    linebuf[pli] = aom_malloc(sizeof(*linebuf) * OD_FILT_VBORDER * stride);
-  }
-  for (sbr = 0; sbr < nvsb; sbr++) {
-    for (pli = 0; pli < nplanes; pli++) {
-      for (r = 0; r < (MAX_MIB_SIZE << bsize[pli]) + 2 * OD_FILT_VBORDER; r++) {
-        for (c = 0; c < OD_FILT_HBORDER; c++) {
-          colbuf[pli][r][c] = OD_DERING_VERY_LARGE;
-        }
+    for (r = 0; r < (MAX_MIB_SIZE << bsize[pli]) + 2 * OD_FILT_VBORDER; r++) {
+      for (c = 0; c < OD_FILT_HBORDER; c++) {
+        colbuf[pli][r][c] = OD_DERING_VERY_LARGE;
       }
     }
-    dering_left = 1;
-    for (sbc = 0; sbc < nhsb; sbc++) {
-      int level;
-      int nhb, nvb;
-      int cstart = 0;
-      if (!dering_left) cstart = -OD_FILT_HBORDER;
-      nhb = AOMMIN(MAX_MIB_SIZE, cm->mi_cols - MAX_MIB_SIZE * sbc);
-      nvb = AOMMIN(MAX_MIB_SIZE, cm->mi_rows - MAX_MIB_SIZE * sbr);
-      level = compute_level_from_index(
-          global_level, cm->mi_grid_visible[MAX_MIB_SIZE * sbr * cm->mi_stride +
-                                            MAX_MIB_SIZE * sbc]
-                            ->mbmi.dering_gain);
-      curr_row_dering[sbc] = 0;
-      if (level == 0 ||
-          (dering_count = sb_compute_dering_list(
-               cm, sbr * MAX_MIB_SIZE, sbc * MAX_MIB_SIZE, dlist)) == 0) {
-        dering_left = 0;
-        continue;
-      }
-      curr_row_dering[sbc] = 1;
-      for (pli = 0; pli < nplanes; pli++) {
-        int16_t dst[OD_BSIZE_MAX * OD_BSIZE_MAX];
-        int threshold;
-        int coffset;
-        int rend, cend;
-        if (sbc == nhsb - 1)
-          cend = (nhb << bsize[pli]);
-        else
-          cend = (nhb << bsize[pli]) + OD_FILT_HBORDER;
-        if (sbr == nvsb - 1)
-          rend = (nvb << bsize[pli]);
-        else
-          rend = (nvb << bsize[pli]) + OD_FILT_VBORDER;
-        coffset = sbc * MAX_MIB_SIZE << bsize[pli];
-        if (sbc == nhsb - 1) {
-          /* On the last superblock column, fill in the right border with
-             OD_DERING_VERY_LARGE to avoid filtering with the outside. */
-          for (r = 0; r < rend + OD_FILT_VBORDER; r++) {
-            for (c = cend; c < (nhb << bsize[pli]) + OD_FILT_HBORDER; ++c) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  OD_DERING_VERY_LARGE;
-            }
-          }
-        }
-        if (sbr == nvsb - 1) {
-          /* On the last superblock row, fill in the bottom border with
-             OD_DERING_VERY_LARGE to avoid filtering with the outside. */
-          for (r = rend; r < rend + OD_FILT_VBORDER; r++) {
-            for (c = 0; c < (nhb << bsize[pli]) + 2 * OD_FILT_HBORDER; c++) {
-              src[(r + OD_FILT_VBORDER) * OD_FILT_BSTRIDE + c] =
-                  OD_DERING_VERY_LARGE;
-            }
-          }
-        }
-        /* Copy in the pixels we need from the current superblock for
-           deringing.*/
-        copy_sb8_16(
-            cm,
-            &src[OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER + cstart],
-            OD_FILT_BSTRIDE, xd->plane[pli].dst.buf,
-            (MAX_MIB_SIZE << bsize[pli]) * sbr, coffset + cstart,
-            xd->plane[pli].dst.stride, rend, cend - cstart);
-        if (!prev_row_dering[sbc]) {
-          copy_sb8_16(cm, &src[OD_FILT_HBORDER], OD_FILT_BSTRIDE,
-                      xd->plane[pli].dst.buf,
-                      (MAX_MIB_SIZE << bsize[pli]) * sbr - OD_FILT_VBORDER,
-                      coffset, xd->plane[pli].dst.stride, OD_FILT_VBORDER,
-                      nhb << bsize[pli]);
-        } else if (sbr > 0) {
-          for (r = 0; r < OD_FILT_VBORDER; r++) {
-            for (c = 0; c < nhb << bsize[pli]; c++) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  linebuf[pli][r * stride + coffset + c];
-            }
-          }
-        } else {
-          for (r = 0; r < OD_FILT_VBORDER; r++) {
-            for (c = 0; c < nhb << bsize[pli]; c++) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  OD_DERING_VERY_LARGE;
-            }
+  }
+  dering_left = 1;
+  for (sbc = 0; sbc < nhsb; sbc++) {
+    int level;
+    int nhb;
+    int cstart = 0;
+    int dirinit = 0;
+    if (!dering_left) cstart = -OD_FILT_HBORDER;
+    nhb = AOMMIN(MAX_MIB_SIZE, cm->mi_cols - MAX_MIB_SIZE * sbc);
+    level = compute_level_from_index(
+        data->global_level,
+        cm->mi_grid_visible[MAX_MIB_SIZE * sbr * cm->mi_stride +
+                            MAX_MIB_SIZE * sbc]
+            ->mbmi.dering_gain);
+    if (level == 0 ||
+        (dering_count = sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE,
+                                               sbc * MAX_MIB_SIZE, dlist)) ==
+            0) {
+      dering_left = 0;
+      continue;
+    }
+    for (pli = 0; pli < nplanes; pli++) {
+      int16_t dst[OD_DERING_BSIZE_MAX * OD_DERING_BSIZE_MAX];
+      const int16_t *const above =
+          data->linebuf[pli] + 2 * OD_FILT_VBORDER * stride * sbr;
+      const int16_t *const below = above + OD_FILT_VBORDER * stride;
+      int threshold;
+      int coffset;
+      int rend, cend;
+      if (sbc == nhsb - 1)
+        cend = (nhb << bsize[pli]);
+      else
+        cend = (nhb << bsize[pli]) + OD_FILT_HBORDER;
+      if (sbr == nvsb - 1)
+        rend = (nvb << bsize[pli]);
+      else
+        rend = (nvb << bsize[pli]) + OD_FILT_VBORDER;
+      coffset = sbc * MAX_MIB_SIZE << bsize[pli];
+      if (sbc == nhsb - 1) {
+        /* On the last superblock column, fill in the right border with
+           OD_DERING_VERY_LARGE to avoid filtering with the outside. */
+        for (r = 0; r < rend + OD_FILT_VBORDER; r++) {
+          for (c = cend; c < (nhb << bsize[pli]) + OD_FILT_HBORDER; ++c) {
+            src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
+                OD_DERING_VERY_LARGE;
           }
         }
-        if (!prev_row_dering[sbc - 1]) {
-          copy_sb8_16(cm, src, OD_FILT_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MAX_MIB_SIZE << bsize[pli]) * sbr - OD_FILT_VBORDER,
-                      coffset - OD_FILT_HBORDER, xd->plane[pli].dst.stride,
-                      OD_FILT_VBORDER, OD_FILT_HBORDER);
-        } else if (sbr > 0 && sbc > 0) {
-          for (r = 0; r < OD_FILT_VBORDER; r++) {
-            for (c = -OD_FILT_HBORDER; c < 0; c++) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  linebuf[pli][r * stride + coffset + c];
-            }
-          }
-        } else {
-          for (r = 0; r < OD_FILT_VBORDER; r++) {
-            for (c = -OD_FILT_HBORDER; c < 0; c++) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  OD_DERING_VERY_LARGE;
-            }
+      }
+      if (sbr == nvsb - 1) {
+        /* On the last superblock row, fill in the bottom border with
+           OD_DERING_VERY_LARGE to avoid filtering with the outside. */
+        for (r = rend; r < rend + OD_FILT_VBORDER; r++) {
+          for (c = 0; c < (nhb << bsize[pli]) + 2 * OD_FILT_HBORDER; c++) {
+            src[(r + OD_FILT_VBORDER) * OD_FILT_BSTRIDE + c] =
+                OD_DERING_VERY_LARGE;
           }
         }
-        if (!prev_row_dering[sbc + 1]) {
-          copy_sb8_16(cm, &src[OD_FILT_HBORDER + (nhb << bsize[pli])],
-                      OD_FILT_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MAX_MIB_SIZE << bsize[pli]) * sbr - OD_FILT_VBORDER,
-                      coffset + (nhb << bsize[pli]), xd->plane[pli].dst.stride,
-                      OD_FILT_VBORDER, OD_FILT_HBORDER);
-        } else if (sbr > 0 && sbc < nhsb - 1) {
-          for (r = 0; r < OD_FILT_VBORDER; r++) {
-            for (c = nhb << bsize[pli];
-                 c < (nhb << bsize[pli]) + OD_FILT_HBORDER; c++) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  linebuf[pli][r * stride + coffset + c];
-            }
-          }
-        } else {
-          for (r = 0; r < OD_FILT_VBORDER; r++) {
-            for (c = nhb << bsize[pli];
-                 c < (nhb << bsize[pli]) + OD_FILT_HBORDER; c++) {
-              src[r * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
-                  OD_DERING_VERY_LARGE;
-            }
-          }
+      }
+      /* Copy in the pixels we need from the current superblock for
+         deringing.*/
+      copy_sb8_16(
+          cm,
+          &src[OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER + cstart],
+          OD_FILT_BSTRIDE, planes[pli].dst.buf,
+          (MAX_MIB_SIZE << bsize[pli]) * sbr, coffset + cstart,
+          planes[pli].dst.stride, nvb << bsize[pli], cend - cstart);
+      /* The lines above and below the superblock row, including the
+         corners, come from the saved unfiltered lines. */
+      for (r = 0; r < OD_FILT_VBORDER; r++) {
+        for (c = 0; c < (nhb << bsize[pli]) + 2 * OD_FILT_HBORDER; c++) {
+          src[r * OD_FILT_BSTRIDE + c] = above[r * stride + coffset + c];
         }
-        if (dering_left) {
-          /* If we deringed the superblock on the left then we need to copy in
-             saved pixels. */
-          for (r = 0; r < rend + OD_FILT_VBORDER; r++) {
-            for (c = 0; c < OD_FILT_HBORDER; c++) {
-              src[r * OD_FILT_BSTRIDE + c] = colbuf[pli][r][c];
-            }
-          }
+      }
+      for (r = nvb << bsize[pli]; r < rend; r++) {
+        for (c = cstart; c < cend; c++) {
+          src[(r + OD_FILT_VBORDER) * OD_FILT_BSTRIDE + c + OD_FILT_HBORDER] =
+              below[(r - (nvb << bsize[pli])) * stride + coffset + c +
+                    OD_FILT_HBORDER];
         }
+      }
+      if (dering_left) {
+        /* If we deringed the superblock on the left then we need to copy in
+           saved pixels. */
         for (r = 0; r < rend + OD_FILT_VBORDER; r++) {
           for (c = 0; c < OD_FILT_HBORDER; c++) {
-            /* Saving pixels in case we need to dering the superblock on the
-               right. */
-            colbuf[pli][r][c] =
-                src[r * OD_FILT_BSTRIDE + c + (nhb << bsize[pli])];
+            src[r * OD_FILT_BSTRIDE + c] = colbuf[pli][r][c];
           }
         }
-        copy_sb8_16(cm, &linebuf[pli][coffset], stride, xd->plane[pli].dst.buf,
-                    (MAX_MIB_SIZE << bsize[pli]) * (sbr + 1) - OD_FILT_VBORDER,
-                    coffset, xd->plane[pli].dst.stride, OD_FILT_VBORDER,
-                    (nhb << bsize[pli]));
+      }
+      for (r = 0; r < rend + OD_FILT_VBORDER; r++) {
+        for (c = 0; c < OD_FILT_HBORDER; c++) {
+          /* Saving pixels in case we need to dering the superblock on the
+             right. */
+          colbuf[pli][r][c] =
+              src[r * OD_FILT_BSTRIDE + c + (nhb << bsize[pli])];
+        }
+      }
 
-        /* FIXME: This is a temporary hack that uses more conservative
-           deringing for chroma. */
-        if (pli)
-          threshold = (level * 5 + 4) >> 3 << coeff_shift;
-        else
-          threshold = level << coeff_shift;
-        if (threshold == 0) continue;
-        od_dering(
-            dst, &src[OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER],
-            dec[pli], dir, pli, dlist, dering_count, threshold, coeff_shift);
+      /* FIXME: This is a temporary hack that uses more conservative
+         deringing for chroma. */
+      if (pli)
+        threshold = (level * 5 + 4) >> 3 << coeff_shift;
+      else
+        threshold = level << coeff_shift;
+      if (threshold == 0) continue;
+      od_dering(dst,
+                &src[OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER],
+                dec[pli], dir, var, &dirinit, pli, dlist, dering_count,
+                threshold, coeff_shift);
 #if CONFIG_AOM_HIGHBITDEPTH
-        if (cm->use_highbitdepth) {
-          copy_dering_16bit_to_16bit(
-              (int16_t *)&CONVERT_TO_SHORTPTR(
-                  xd->plane[pli]
-                      .dst.buf)[xd->plane[pli].dst.stride *
-                                    (MAX_MIB_SIZE * sbr << bsize[pli]) +
-                                (sbc * MAX_MIB_SIZE << bsize[pli])],
-              xd->plane[pli].dst.stride, dst, dlist, dering_count,
-              3 - dec[pli]);
-        } else {
+      if (cm->use_highbitdepth) {
+        copy_dering_16bit_to_16bit(
+            (int16_t *)&CONVERT_TO_SHORTPTR(
+                planes[pli].dst.buf)[planes[pli].dst.stride *
+                                         (MAX_MIB_SIZE * sbr << bsize[pli]) +
+                                     (sbc * MAX_MIB_SIZE << bsize[pli])],
+            planes[pli].dst.stride, dst, dlist, dering_count, 3 - dec[pli]);
+      } else {
 #endif
-          copy_dering_16bit_to_8bit(
-              &xd->plane[pli].dst.buf[xd->plane[pli].dst.stride *
-                                          (MAX_MIB_SIZE * sbr << bsize[pli]) +
-                                      (sbc * MAX_MIB_SIZE << bsize[pli])],
-              xd->plane[pli].dst.stride, dst, dlist, dering_count, bsize[pli]);
+        copy_dering_16bit_to_8bit(
+            &planes[pli].dst.buf[planes[pli].dst.stride *
+                                     (MAX_MIB_SIZE * sbr << bsize[pli]) +
+                                 (sbc * MAX_MIB_SIZE << bsize[pli])],
+            planes[pli].dst.stride, dst, dlist, dering_count, bsize[pli]);
 #if CONFIG_AOM_HIGHBITDEPTH
-        }
-#endif
       }
-      dering_left = 1;
-    }
-    {
-      unsigned char *tmp;
-      tmp = prev_row_dering;
-      prev_row_dering = curr_row_dering;
-      curr_row_dering = tmp;
+#endif
     }
+    dering_left = 1;
   }
-  aom_free(row_dering);
-  for (pli = 0; pli < nplanes; pli++) {
-    aom_free(linebuf[pli]);
+}
+
+static int dering_save_lines_worker(DeringWorkerData *const data,
+                                    void *unused) {
+  const AV1_COMMON *const cm = data->cm;
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  int sbr;
+  (void)unused;
+  for (sbr = data->start; sbr < nvsb; sbr += data->step)
+    av1_dering_save_boundary(data, sbr);
+  return 1;
+}
+
+static int dering_rows_worker(DeringWorkerData *const data, void *unused) {
+  const AV1_COMMON *const cm = data->cm;
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  int sbr;
+  (void)unused;
+  for (sbr = data->start; sbr < nvsb; sbr += data->step)
+    av1_dering_sb_row(data, sbr);
+  return 1;
+}
+
+void av1_dering_rows_init(DeringWorkerData *data, AV1_COMMON *cm,
+                          const struct macroblockd_plane *planes,
+                          int global_level) {
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int bsize = OD_DERING_SIZE_LOG2 - planes[0].subsampling_x;
+  const int stride = (cm->mi_cols << bsize) + 2 * OD_FILT_HBORDER;
+  const int plane_size = 2 * OD_FILT_VBORDER * stride * nvsb;
+  int pli;
+  data->cm = cm;
+  data->planes = planes;
+  if (planes[1].subsampling_x == planes[1].subsampling_y &&
+      planes[2].subsampling_x == planes[2].subsampling_y)
+    data->nplanes = 3;
+  else
+    data->nplanes = 1;
+  data->global_level = global_level;
+  data->linebuf_stride = stride;
+  data->start = 0;
+  data->step = 1;
+  if (cm->dering_lines_size < plane_size * data->nplanes) {
+    aom_free(cm->dering_lines);
+    CHECK_MEM_ERROR(
+        cm, cm->dering_lines,
+        aom_malloc(sizeof(*cm->dering_lines) * plane_size * data->nplanes));
+    cm->dering_lines_size = plane_size * data->nplanes;
+  }
+  for (pli = 0; pli < data->nplanes; pli++)
+    data->linebuf[pli] = cm->dering_lines + plane_size * pli;
+}
+
+void av1_dering_free_lines(AV1_COMMON *cm) {
+  aom_free(cm->dering_lines);
+  cm->dering_lines = NULL;
+  cm->dering_lines_size = 0;
+}
+
+void av1_dering_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                      MACROBLOCKD *xd, int global_level) {
+  DeringWorkerData data;
+  av1_setup_dst_planes(xd->plane, frame, 0, 0);
+  av1_dering_rows_init(&data, cm, xd->plane, global_level);
+  dering_save_lines_worker(&data, NULL);
+  dering_rows_worker(&data, NULL);
+}
+
+void av1_dering_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                         MACROBLOCKD *xd, int global_level,
+                         AVxWorker *workers, int nworkers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int num_workers = AOMMIN(nworkers, nvsb);
+  DeringWorkerData *data;
+  int i;
+
+  if (num_workers <= 1) {
+    av1_dering_frame(frame, cm, xd, global_level);
+    return;
   }
+
+  av1_setup_dst_planes(xd->plane, frame, 0, 0);
+  CHECK_MEM_ERROR(cm, data, aom_malloc(num_workers * sizeof(*data)));
+  av1_dering_rows_init(&data[0], cm, xd->plane, global_level);
+  for (i = 0; i < num_workers; ++i) {
+    data[i] = data[0];
+    data[i].start = i;
+    data[i].step = num_workers;
+  }
+
+  // All border lines are saved before any row is filtered, after which the
+  // superblock rows no longer depend on each other.
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = (AVxWorkerHook)dering_save_lines_worker;
+    worker->data1 = &data[i];
+    worker->data2 = NULL;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = (AVxWorkerHook)dering_rows_worker;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+
+  aom_free(data);
 }
@@ -16,6 +16,7 @@
 #include "aom/aom_integer.h"
 #include "./aom_config.h"
 #include "aom_ports/mem.h"
+#include "aom_util/aom_thread.h"
 #include "od_dering.h"
 
 #ifdef __cplusplus
@@ -28,15 +29,50 @@ extern "C" {
 #define DERING_REFINEMENT_BITS 2
 #define DERING_REFINEMENT_LEVELS 4
 
+// Per-worker state of the row-parallel deringing.
+typedef struct DeringWorkerData {
+  AV1_COMMON *cm;
+  const struct macroblockd_plane *planes;
+  int nplanes;
+  int global_level;
+  // Unfiltered lines above and below every superblock row, per plane.
+  int16_t *linebuf[3];
+  int linebuf_stride;
+  // The worker filters superblock rows start, start + step, ...
+  int start;
+  int step;
+} DeringWorkerData;
+
 int compute_level_from_index(int global_level, int gi);
 int sb_all_skip(const AV1_COMMON *const cm, int mi_row, int mi_col);
 int sb_compute_dering_list(const AV1_COMMON *const cm, int mi_row, int mi_col,
                            dering_list *dlist);
+
+// Row by row deringing. av1_dering_rows_init() sets up data for the frame
+// whose planes are given. The unfiltered lines around the top edge of a
+// superblock row must be saved with av1_dering_save_boundary() after the
+// pixels around that edge are final and before either adjacent row is
+// deringed; av1_dering_sb_row() then filters a row whose top and bottom
+// edges have been saved.
+void av1_dering_rows_init(DeringWorkerData *data, AV1_COMMON *cm,
+                          const struct macroblockd_plane *planes,
+                          int global_level);
+void av1_dering_save_boundary(DeringWorkerData *data, int sb_row);
+void av1_dering_sb_row(DeringWorkerData *data, int sb_row);
+void av1_dering_free_lines(AV1_COMMON *cm);
+
 void av1_dering_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
                       MACROBLOCKD *xd, int global_level);
+// Multi-threaded deringing that filters superblock rows on the given workers.
+void av1_dering_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                         MACROBLOCKD *xd, int global_level, AVxWorker *workers,
+                         int nworkers);
 
+// Picks the dering level of the frame and the gain of each superblock,
+// searching the superblock rows on the given workers.
 int av1_dering_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
-                      AV1_COMMON *cm, MACROBLOCKD *xd);
+                      AV1_COMMON *cm, MACROBLOCKD *xd, AVxWorker *workers,
+                      int nworkers);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -235,6 +235,19 @@ void od_filter_dering_orthogonal_4x4_c(int16_t *y, int ystride,
   }
 }
 
+uint64_t od_compute_dist_8x8_c(const int16_t *x, int xstride,
+                               const int16_t *y, int ystride) {
+  uint64_t sum = 0;
+  int i, j;
+  for (i = 0; i < 8; i++) {
+    for (j = 0; j < 8; j++) {
+      const int d = x[i * xstride + j] - y[i * ystride + j];
+      sum += d * d;
+    }
+  }
+  return sum;
+}
+
 /* This table approximates x^0.16 with the index being log2(x). It is clamped
    to [-.5, 3]. The table is computed as:
    round(256*min(3, max(.5, 1.08*(sqrt(2)*2.^([0:17]+8)/256/256).^.16))) */
@@ -293,8 +306,9 @@ void copy_dering_16bit_to_16bit(int16_t *dst, int dstride, int16_t *src,
 }
 
 void od_dering(int16_t *y, int16_t *in, int xdec,
-               int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS], int pli,
-               dering_list *dlist, int dering_count, int threshold,
+               int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS],
+               int32_t var[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS], int *dirinit,
+               int pli, dering_list *dlist, int dering_count, int threshold,
                int coeff_shift) {
   int bi;
   int bx;
@@ -309,12 +323,18 @@ void od_dering(int16_t *y, int16_t *in, int xdec,
   };
   bsize = OD_DERING_SIZE_LOG2 - xdec;
   if (pli == 0) {
+    if (!*dirinit) {
+      for (bi = 0; bi < dering_count; bi++) {
+        by = dlist[bi].by;
+        bx = dlist[bi].bx;
+        dir[by][bx] = od_dir_find8(&in[8 * by * OD_FILT_BSTRIDE + 8 * bx],
+                                   OD_FILT_BSTRIDE, &var[by][bx], coeff_shift);
+      }
+      *dirinit = 1;
+    }
     for (bi = 0; bi < dering_count; bi++) {
-      int32_t var;
       by = dlist[bi].by;
       bx = dlist[bi].bx;
-      dir[by][bx] = od_dir_find8(&in[8 * by * OD_FILT_BSTRIDE + 8 * bx],
-                                 OD_FILT_BSTRIDE, &var, coeff_shift);
       /* Deringing orthogonal to the direction uses a tighter threshold
          because we want to be conservative. We've presumably already
          achieved some deringing, so the amount of change is expected
@@ -326,7 +346,7 @@ void od_dering(int16_t *y, int16_t *in, int xdec,
       filter2_thresh[by][bx] = (filter_dering_direction[bsize - OD_LOG_BSIZE0])(
           &y[bi << 2 * bsize], 1 << bsize,
           &in[(by * OD_FILT_BSTRIDE << bsize) + (bx << bsize)],
-          od_adjust_thresh(threshold, var), dir[by][bx]);
+          od_adjust_thresh(threshold, var[by][bx]), dir[by][bx]);
     }
   } else {
     for (bi = 0; bi < dering_count; bi++) {
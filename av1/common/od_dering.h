@@ -12,24 +12,29 @@
 #if !defined(_dering_H)
 #define _dering_H (1)
 
+#include "av1/common/enums.h"
 #include "odintrin.h"
 
 #define OD_DERINGSIZES (2)
 
 #define OD_DERING_SIZE_LOG2 (3)
 
-#define OD_DERING_NBLOCKS (OD_BSIZE_MAX / 8)
+/* Deringing operates on whole superblocks, which are larger than the largest
+   transform (OD_BSIZE_MAX). */
+#define OD_DERING_BSIZE_MAX (MAX_SB_SIZE)
+
+#define OD_DERING_NBLOCKS (OD_DERING_BSIZE_MAX / 8)
 
 /* We need to buffer three vertical lines. */
 #define OD_FILT_VBORDER (3)
 /* We only need to buffer three horizontal lines too, but let's make it four
    to make vectorization easier. */
 #define OD_FILT_HBORDER (4)
-#define OD_FILT_BSTRIDE (OD_BSIZE_MAX + 2 * OD_FILT_HBORDER)
+#define OD_FILT_BSTRIDE (OD_DERING_BSIZE_MAX + 2 * OD_FILT_HBORDER)
 
 #define OD_DERING_VERY_LARGE (30000)
 #define OD_DERING_INBUF_SIZE \
-  (OD_FILT_BSTRIDE * (OD_BSIZE_MAX + 2 * OD_FILT_VBORDER))
+  (OD_FILT_BSTRIDE * (OD_DERING_BSIZE_MAX + 2 * OD_FILT_VBORDER))
 
 extern const int OD_DIRECTION_OFFSETS_TABLE[8][3];
 
@@ -48,9 +53,13 @@ void copy_dering_16bit_to_16bit(int16_t *dst, int dstride, int16_t *src,
                                 dering_list *dlist, int dering_count,
                                 int bsize);
 
+/* The luma directions and variances of the blocks are found and stored in dir
+   and var unless *dirinit is set, in which case the ones already there are
+   used. *dirinit is set once they have been found. */
 void od_dering(int16_t *y, int16_t *in, int xdec,
-               int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS], int pli,
-               dering_list *dlist, int skip_stride, int threshold,
+               int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS],
+               int32_t var[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS], int *dirinit,
+               int pli, dering_list *dlist, int skip_stride, int threshold,
                int coeff_shift);
 int od_filter_dering_direction_4x4_c(int16_t *y, int ystride, const int16_t *in,
                                      int threshold, int dir);
@@ -62,4 +71,6 @@ void od_filter_dering_orthogonal_4x4_c(int16_t *y, int ystride,
 void od_filter_dering_orthogonal_8x8_c(int16_t *y, int ystride,
                                        const int16_t *in, int threshold,
                                        int dir);
+uint64_t od_compute_dist_8x8_c(const int16_t *x, int xstride,
+                               const int16_t *y, int ystride);
 #endif
@@ -15,6 +15,7 @@
 #include "./aom_config.h"
 #include "./av1_rtcd.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_atomics.h"
 #include "aom_util/aom_thread.h"
 #include "av1/common/alloccommon.h"
 #include "av1/common/entropy.h"
@@ -109,8 +110,9 @@ typedef struct {
 
   // row and col indicate which position frame has been decoded to in real
   // pixel unit. They are reset to -1 when decoding begins and set to INT_MAX
-  // when the frame is fully decoded.
-  int row;
+  // when the frame is fully decoded, including its borders. row counts the
+  // luma rows that will no longer change, and is read without locking.
+  aom_atomic_int row;
   int col;
 } RefCntBuffer;
 
@@ -177,6 +179,18 @@ typedef struct AV1Common {
   // Buffer for storing whether to filter individual blocks.
   int8_t *clpf_blocks;
   int clpf_stride;
+
+  // Scratch memory of the CLPF, kept across frames.
+  struct ClpfWorkerData *clpf_worker_data;
+  int clpf_num_workers;
+  uint8_t *clpf_lines;
+  int clpf_lines_size;
+  int8_t *clpf_fb_flags;
+  int clpf_fb_flags_size;
+  int *clpf_rows;
+  int clpf_rows_size;
+  struct ClpfLimit *clpf_limits;
+  int clpf_limits_size;
 #endif
 
   YV12_BUFFER_CONFIG *frame_to_show;
@@ -360,6 +374,9 @@ typedef struct AV1Common {
 #endif
 #if CONFIG_DERING
   int dering_level;
+  // Unfiltered lines around the superblock rows, kept across frames.
+  int16_t *dering_lines;
+  int dering_lines_size;
 #endif
 
 #if CONFIG_DELTA_Q
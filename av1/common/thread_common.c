@@ -141,6 +141,13 @@ static INLINE void loop_filter_block_plane_hor(
   }
 }
 
+// Returns the first mi row of the next superblock row to filter.
+static INLINE int get_next_mi_row(AV1LfSync *const lf_sync,
+                                  const LFWorkerData *const lf_data) {
+  return lf_data->start +
+         aom_atomic_add(&lf_sync->next_row, MAX_MIB_SIZE) - MAX_MIB_SIZE;
+}
+
 // Row-based multi-threaded loopfilter hook
 #if CONFIG_PARALLEL_DEBLOCKING
 static int loop_filter_ver_row_worker(AV1LfSync *const lf_sync,
@@ -149,8 +156,8 @@ static int loop_filter_ver_row_worker(AV1LfSync *const lf_sync,
   int mi_row, mi_col;
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * MAX_MIB_SIZE) {
+  for (mi_row = get_next_mi_row(lf_sync, lf_data); mi_row < lf_data->stop;
+       mi_row = get_next_mi_row(lf_sync, lf_data)) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -179,8 +186,8 @@ static int loop_filter_hor_row_worker(AV1LfSync *const lf_sync,
   int mi_row, mi_col;
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * MAX_MIB_SIZE) {
+  for (mi_row = get_next_mi_row(lf_sync, lf_data); mi_row < lf_data->stop;
+       mi_row = get_next_mi_row(lf_sync, lf_data)) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -216,8 +223,8 @@ static int loop_filter_row_worker(AV1LfSync *const lf_sync,
   int mi_row, mi_col;
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * MAX_MIB_SIZE) {
+  for (mi_row = get_next_mi_row(lf_sync, lf_data); mi_row < lf_data->stop;
+       mi_row = get_next_mi_row(lf_sync, lf_data)) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -280,6 +287,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 #if CONFIG_PARALLEL_DEBLOCKING
   // Initialize cur_sb_col to -1 for all SB rows.
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
+  aom_atomic_init(&lf_sync->next_row, 0);
 
   // Filter all the vertical edges in the whole frame
   for (i = 0; i < num_workers; ++i) {
@@ -292,7 +300,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
     // Loopfilter data
     av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * MAX_MIB_SIZE;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -310,6 +318,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   }
 
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
+  aom_atomic_init(&lf_sync->next_row, 0);
   // Filter all the horizontal edges in the whole frame
   for (i = 0; i < num_workers; ++i) {
     AVxWorker *const worker = &workers[i];
@@ -321,7 +330,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
     // Loopfilter data
     av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * MAX_MIB_SIZE;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -340,6 +349,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 #else   // CONFIG_PARALLEL_DEBLOCKING
   // Initialize cur_sb_col to -1 for all SB rows.
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
+  aom_atomic_init(&lf_sync->next_row, 0);
 
   for (i = 0; i < num_workers; ++i) {
     AVxWorker *const worker = &workers[i];
@@ -351,7 +361,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
     // Loopfilter data
     av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * MAX_MIB_SIZE;
+    lf_data->start = start;
     lf_data->stop = stop;
     lf_data->y_only = y_only;
 
@@ -394,7 +404,7 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 }
 
 // Set up nsync by width.
-static INLINE int get_sync_range(int width) {
+int av1_get_sync_range(int width) {
   // nsync numbers are picked by testing. For example, for 4k
   // video, using 4 gives best performance.
   if (width < 640)
@@ -441,7 +451,7 @@ void av1_loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
                   aom_malloc(sizeof(*lf_sync->cur_sb_col) * rows));
 
   // Set up nsync.
-  lf_sync->sync_range = get_sync_range(width);
+  lf_sync->sync_range = av1_get_sync_range(width);
 }
 
 // Deallocate lf synchronization related mutex and data
@@ -476,6 +486,11 @@ void av1_accumulate_frame_counts(AV1_COMMON *cm, FRAME_COUNTS *counts,
                                  int is_dec) {
   int i, j, k, l, m;
 
+  for (i = 0; i < INTRA_MODES; i++)
+    for (j = 0; j < INTRA_MODES; j++)
+      for (k = 0; k < INTRA_MODES; k++)
+        cm->counts.kf_y_mode[i][j][k] += counts->kf_y_mode[i][j][k];
+
   for (i = 0; i < BLOCK_SIZE_GROUPS; i++)
     for (j = 0; j < INTRA_MODES; j++)
       cm->counts.y_mode[i][j] += counts->y_mode[i][j];
@@ -13,6 +13,7 @@
 #define AV1_COMMON_LOOPFILTER_THREAD_H_
 #include "./aom_config.h"
 #include "av1/common/loopfilter.h"
+#include "aom_util/aom_atomics.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -34,12 +35,20 @@ typedef struct AV1LfSyncData {
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
   int sync_range;
   int rows;
+  // Number of mi rows handed out to the workers, which take the superblock
+  // rows in order so that a row only ever waits for rows already being
+  // filtered.
+  aom_atomic_int next_row;
 
   // Row-based parallel loopfilter data
   LFWorkerData *lfdata;
   int num_workers;
 } AV1LfSync;
 
+// Number of superblocks a row of a frame of the given width runs ahead of the
+// row below it between synchronizations.
+int av1_get_sync_range(int width);
+
 // Allocate memory for loopfilter row synchronization.
 void av1_loop_filter_alloc(AV1LfSync *lf_sync, struct AV1Common *cm, int rows,
                            int width, int num_workers);
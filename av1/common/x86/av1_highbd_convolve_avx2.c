@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/filter.h"
+
+#define MAX_FILTER_TAP (12)
+
+// Packs the filter taps in (f[k], f[k + 1]) pairs for _mm256_madd_epi16().
+static INLINE void load_filter_pairs(const int16_t *filter, int taps,
+                                     __m256i *f) {
+  int k;
+  for (k = 0; k < taps; k += 2) {
+    f[k >> 1] = _mm256_set1_epi32((int)((uint32_t)(uint16_t)filter[k] |
+                                        ((uint32_t)(uint16_t)filter[k + 1]
+                                         << 16)));
+  }
+}
+
+// Filters 16 pixels, s[k] holding the source pixels of tap k, and clips the
+// result to bd bits. Pixels of up to 12 bits fit the signed 16-bit inputs of
+// _mm256_madd_epi16(), and the sums are computed in 32 bits.
+static INLINE __m256i highbd_convolve_16(const __m256i *s, const __m256i *f,
+                                         int taps, int bd) {
+  const __m256i round = _mm256_set1_epi32(1 << (FILTER_BITS - 1));
+  const __m256i max = _mm256_set1_epi16((1 << bd) - 1);
+  __m256i lo = round;
+  __m256i hi = round;
+  int k;
+  for (k = 0; k < taps; k += 2) {
+    lo = _mm256_add_epi32(
+        lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(s[k], s[k + 1]),
+                              f[k >> 1]));
+    hi = _mm256_add_epi32(
+        hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(s[k], s[k + 1]),
+                              f[k >> 1]));
+  }
+  lo = _mm256_srai_epi32(lo, FILTER_BITS);
+  hi = _mm256_srai_epi32(hi, FILTER_BITS);
+  return _mm256_min_epu16(_mm256_packus_epi32(lo, hi), max);
+}
+
+static INLINE __m256i load_8x2(const uint16_t *p0, const uint16_t *p1) {
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)p0)),
+      _mm_loadu_si128((const __m128i *)p1), 1);
+}
+
+static INLINE void store_16(__m256i res, uint16_t *dst, int avg) {
+  if (avg)
+    res = _mm256_avg_epu16(res, _mm256_loadu_si256((const __m256i *)dst));
+  _mm256_storeu_si256((__m256i *)dst, res);
+}
+
+// Stores the first w (2, 4 or 8) pixels of the low and, if rows is 2, high
+// lanes of res to two consecutive rows.
+static INLINE void store_narrow(__m256i res, uint16_t *dst, int dst_stride,
+                                int w, int rows, int avg) {
+  int r;
+  for (r = 0; r < rows; ++r) {
+    uint16_t *const d = dst + r * dst_stride;
+    __m128i u = r ? _mm256_extracti128_si256(res, 1)
+                  : _mm256_castsi256_si128(res);
+    if (8 == w) {
+      if (avg) u = _mm_avg_epu16(u, _mm_loadu_si128((const __m128i *)d));
+      _mm_storeu_si128((__m128i *)d, u);
+    } else if (4 == w) {
+      if (avg) u = _mm_avg_epu16(u, _mm_loadl_epi64((const __m128i *)d));
+      _mm_storel_epi64((__m128i *)d, u);
+    } else {
+      if (avg) u = _mm_avg_epu16(u, _mm_cvtsi32_si128(*(const int *)d));
+      *(int *)d = _mm_cvtsi128_si32(u);
+    }
+  }
+}
+
+void av1_highbd_convolve_horiz_avx2(const uint16_t *src, int src_stride,
+                                    uint16_t *dst, int dst_stride, int w,
+                                    int h,
+                                    const InterpFilterParams filter_params,
+                                    const int subpel_x_q4, int x_step_q4,
+                                    int avg, int bd) {
+  __m256i f[MAX_FILTER_TAP / 2];
+  __m256i s[MAX_FILTER_TAP];
+  const int taps = filter_params.taps;
+  int x, y, k;
+
+  if (0 == subpel_x_q4 || 16 != x_step_q4) {
+    av1_highbd_convolve_horiz_c(src, src_stride, dst, dst_stride, w, h,
+                                filter_params, subpel_x_q4, x_step_q4, avg, bd);
+    return;
+  }
+
+  load_filter_pairs(
+      get_interp_filter_subpel_kernel(filter_params, subpel_x_q4), taps, f);
+
+  for (x = 0; w - x >= 16; x += 16) {
+    const uint16_t *src_x = src + x - (taps / 2 - 1);
+    for (y = 0; y < h; ++y) {
+      for (k = 0; k < taps; ++k)
+        s[k] = _mm256_loadu_si256(
+            (const __m256i *)(src_x + y * src_stride + k));
+      store_16(highbd_convolve_16(s, f, taps, bd), dst + y * dst_stride + x,
+               avg);
+    }
+  }
+
+  if (x < w) {
+    const int rem = w - x;
+    if (8 != rem && 4 != rem && 2 != rem) {
+      av1_highbd_convolve_horiz_c(src + x, src_stride, dst + x, dst_stride,
+                                  rem, h, filter_params, subpel_x_q4,
+                                  x_step_q4, avg, bd);
+      return;
+    }
+    // Two rows per iteration, one in each 128-bit lane.
+    for (y = 0; y < h; y += 2) {
+      const int rows = h - y > 1 ? 2 : 1;
+      const uint16_t *src_y = src + y * src_stride + x - (taps / 2 - 1);
+      for (k = 0; k < taps; ++k)
+        s[k] = load_8x2(src_y + k, src_y + (rows - 1) * src_stride + k);
+      store_narrow(highbd_convolve_16(s, f, taps, bd),
+                   dst + y * dst_stride + x, dst_stride, rem, rows, avg);
+    }
+  }
+}
+
+void av1_highbd_convolve_vert_avx2(const uint16_t *src, int src_stride,
+                                   uint16_t *dst, int dst_stride, int w, int h,
+                                   const InterpFilterParams filter_params,
+                                   const int subpel_y_q4, int y_step_q4,
+                                   int avg, int bd) {
+  __m256i f[MAX_FILTER_TAP / 2];
+  __m256i s[MAX_FILTER_TAP];
+  const int taps = filter_params.taps;
+  int x, y, k;
+
+  if (0 == subpel_y_q4 || 16 != y_step_q4) {
+    av1_highbd_convolve_vert_c(src, src_stride, dst, dst_stride, w, h,
+                               filter_params, subpel_y_q4, y_step_q4, avg, bd);
+    return;
+  }
+
+  load_filter_pairs(
+      get_interp_filter_subpel_kernel(filter_params, subpel_y_q4), taps, f);
+  src -= src_stride * (taps / 2 - 1);
+
+  for (x = 0; w - x >= 16; x += 16) {
+    // Slide a window of taps rows down the column.
+    for (k = 0; k < taps - 1; ++k)
+      s[k] = _mm256_loadu_si256((const __m256i *)(src + k * src_stride + x));
+    for (y = 0; y < h; ++y) {
+      s[taps - 1] = _mm256_loadu_si256(
+          (const __m256i *)(src + (y + taps - 1) * src_stride + x));
+      store_16(highbd_convolve_16(s, f, taps, bd), dst + y * dst_stride + x,
+               avg);
+      for (k = 0; k < taps - 1; ++k) s[k] = s[k + 1];
+    }
+  }
+
+  if (x < w) {
+    const int rem = w - x;
+    if (8 != rem && 4 != rem && 2 != rem) {
+      av1_highbd_convolve_vert_c(src + src_stride * (taps / 2 - 1) + x,
+                                 src_stride, dst + x, dst_stride, rem, h,
+                                 filter_params, subpel_y_q4, y_step_q4, avg,
+                                 bd);
+      return;
+    }
+    // Two rows per iteration, one in each 128-bit lane.
+    for (y = 0; y < h; y += 2) {
+      const int rows = h - y > 1 ? 2 : 1;
+      const uint16_t *src_y = src + y * src_stride + x;
+      for (k = 0; k < taps; ++k)
+        s[k] = load_8x2(src_y + k * src_stride,
+                        src_y + (k + rows - 1) * src_stride);
+      store_narrow(highbd_convolve_16(s, f, taps, bd),
+                   dst + y * dst_stride + x, dst_stride, rem, rows, avg);
+    }
+  }
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>  // AVX2
+
+#include "./av1_rtcd.h"
+#include "aom_dsp/txfm_common.h"
+#include "aom_ports/mem.h"
+
+typedef __m256i hbd_vec;
+
+typedef struct {
+  __m256i even, odd;
+} hbd_wide;
+
+static INLINE hbd_vec hbd_add(hbd_vec a, hbd_vec b) {
+  return _mm256_add_epi32(a, b);
+}
+
+static INLINE hbd_vec hbd_sub(hbd_vec a, hbd_vec b) {
+  return _mm256_sub_epi32(a, b);
+}
+
+static INLINE hbd_wide hbd_mul(hbd_vec a, tran_high_t c) {
+  const __m256i k = _mm256_set1_epi32((int)c);
+  hbd_wide r;
+  r.even = _mm256_mul_epi32(a, k);
+  r.odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), k);
+  return r;
+}
+
+static INLINE hbd_wide hbd_wide_add(hbd_wide a, hbd_wide b) {
+  hbd_wide r;
+  r.even = _mm256_add_epi64(a.even, b.even);
+  r.odd = _mm256_add_epi64(a.odd, b.odd);
+  return r;
+}
+
+static INLINE hbd_wide hbd_wide_sub(hbd_wide a, hbd_wide b) {
+  hbd_wide r;
+  r.even = _mm256_sub_epi64(a.even, b.even);
+  r.odd = _mm256_sub_epi64(a.odd, b.odd);
+  return r;
+}
+
+static INLINE hbd_vec hbd_round_shift(hbd_wide a) {
+  // Only the low 32 bits of each shifted product are kept, so a logical
+  // shift gives the same result as an arithmetic one.
+  const __m256i rounding = _mm256_set1_epi64x(DCT_CONST_ROUNDING);
+  const __m256i even =
+      _mm256_srli_epi64(_mm256_add_epi64(a.even, rounding), DCT_CONST_BITS);
+  const __m256i odd =
+      _mm256_slli_epi64(_mm256_add_epi64(a.odd, rounding), 32 - DCT_CONST_BITS);
+  return _mm256_blend_epi32(even, odd, 0xaa);
+}
+
+#include "av1/common/x86/av1_highbd_inv_txfm_impl.h"
+
+typedef void (*hbd_itx1d)(hbd_vec *in);
+
+typedef struct {
+  hbd_itx1d cols, rows;  // vertical and horizontal
+} hbd_itx2d;
+
+static INLINE void transpose_8x8(__m256i *r) {
+  const __m256i a0 = _mm256_unpacklo_epi32(r[0], r[1]);
+  const __m256i a1 = _mm256_unpackhi_epi32(r[0], r[1]);
+  const __m256i a2 = _mm256_unpacklo_epi32(r[2], r[3]);
+  const __m256i a3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  const __m256i a4 = _mm256_unpacklo_epi32(r[4], r[5]);
+  const __m256i a5 = _mm256_unpackhi_epi32(r[4], r[5]);
+  const __m256i a6 = _mm256_unpacklo_epi32(r[6], r[7]);
+  const __m256i a7 = _mm256_unpackhi_epi32(r[6], r[7]);
+  const __m256i b0 = _mm256_unpacklo_epi64(a0, a2);
+  const __m256i b1 = _mm256_unpackhi_epi64(a0, a2);
+  const __m256i b2 = _mm256_unpacklo_epi64(a1, a3);
+  const __m256i b3 = _mm256_unpackhi_epi64(a1, a3);
+  const __m256i b4 = _mm256_unpacklo_epi64(a4, a6);
+  const __m256i b5 = _mm256_unpackhi_epi64(a4, a6);
+  const __m256i b6 = _mm256_unpacklo_epi64(a5, a7);
+  const __m256i b7 = _mm256_unpackhi_epi64(a5, a7);
+  r[0] = _mm256_permute2x128_si256(b0, b4, 0x20);
+  r[1] = _mm256_permute2x128_si256(b1, b5, 0x20);
+  r[2] = _mm256_permute2x128_si256(b2, b6, 0x20);
+  r[3] = _mm256_permute2x128_si256(b3, b7, 0x20);
+  r[4] = _mm256_permute2x128_si256(b0, b4, 0x31);
+  r[5] = _mm256_permute2x128_si256(b1, b5, 0x31);
+  r[6] = _mm256_permute2x128_si256(b2, b6, 0x31);
+  r[7] = _mm256_permute2x128_si256(b3, b7, 0x31);
+}
+
+// Adds the rounded residual in v to eight pixels of dest and clamps to bd.
+static INLINE void add_clamp_8(__m256i v, uint16_t *dest, int shift, int bd) {
+  const __m256i rounding = _mm256_set1_epi32((1 << shift) >> 1);
+  const __m256i max = _mm256_set1_epi32((1 << bd) - 1);
+  const __m256i d =
+      _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)dest));
+  __m256i res =
+      _mm256_sra_epi32(_mm256_add_epi32(v, rounding), _mm_cvtsi32_si128(shift));
+  res = _mm256_add_epi32(d, res);
+  res = _mm256_min_epi32(_mm256_max_epi32(res, _mm256_setzero_si256()), max);
+  res = _mm256_permute4x64_epi64(_mm256_packus_epi32(res, res), 0x08);
+  _mm_storeu_si128((__m128i *)dest, _mm256_castsi256_si128(res));
+}
+
+// Eight rows (then eight columns) are transformed at a time, one per lane.
+static void highbd_iht_avx2(const tran_low_t *input, uint16_t *dest,
+                            int stride, int n, hbd_itx2d tx, int shift,
+                            int bd) {
+  DECLARE_ALIGNED(32, tran_low_t, out[16 * 16]);
+  __m256i v[16];
+  int r, c, i;
+
+  for (r = 0; r < n; r += 8) {
+    for (c = 0; c < n; c += 8) {
+      for (i = 0; i < 8; ++i) {
+        v[c + i] =
+            _mm256_loadu_si256((const __m256i *)(input + (r + i) * n + c));
+      }
+      transpose_8x8(v + c);
+    }
+    tx.rows(v);
+    for (c = 0; c < n; c += 8) {
+      transpose_8x8(v + c);
+      for (i = 0; i < 8; ++i)
+        _mm256_store_si256((__m256i *)(out + (r + i) * n + c), v[c + i]);
+    }
+  }
+
+  for (c = 0; c < n; c += 8) {
+    for (r = 0; r < n; ++r)
+      v[r] = _mm256_load_si256((const __m256i *)(out + r * n + c));
+    tx.cols(v);
+    for (r = 0; r < n; ++r) add_clamp_8(v[r], dest + r * stride + c, shift, bd);
+  }
+}
+
+void av1_highbd_iht8x8_64_add_avx2(const tran_low_t *input, uint8_t *dest8,
+                                   int stride, int tx_type, int bd) {
+  static const hbd_itx2d IHT_8[] = {
+    { hbd_idct8, hbd_idct8 },    // DCT_DCT  = 0
+    { hbd_iadst8, hbd_idct8 },   // ADST_DCT = 1
+    { hbd_idct8, hbd_iadst8 },   // DCT_ADST = 2
+    { hbd_iadst8, hbd_iadst8 },  // ADST_ADST = 3
+  };
+  highbd_iht_avx2(input, CONVERT_TO_SHORTPTR(dest8), stride, 8, IHT_8[tx_type],
+                  5, bd);
+}
+
+void av1_highbd_iht16x16_256_add_avx2(const tran_low_t *input, uint8_t *dest8,
+                                      int stride, int tx_type, int bd) {
+  static const hbd_itx2d IHT_16[] = {
+    { hbd_idct16, hbd_idct16 },    // DCT_DCT  = 0
+    { hbd_iadst16, hbd_idct16 },   // ADST_DCT = 1
+    { hbd_idct16, hbd_iadst16 },   // DCT_ADST = 2
+    { hbd_iadst16, hbd_iadst16 },  // ADST_ADST = 3
+  };
+  highbd_iht_avx2(input, CONVERT_TO_SHORTPTR(dest8), stride, 16,
+                  IHT_16[tx_type], 6, bd);
+}
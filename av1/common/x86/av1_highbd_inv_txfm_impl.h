@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// 1-D high bit-depth inverse DCT and ADST kernels shared by the SSE4.1 and
+// AVX2 hybrid transforms. Each vector holds one coefficient of several
+// independent 1-D transforms, one per 32-bit lane.
+//
+// The including file provides:
+//   hbd_vec               - a vector of signed 32-bit lanes.
+//   hbd_wide              - the 64-bit products of an hbd_vec.
+//   hbd_add(), hbd_sub()  - wrapping 32-bit lane arithmetic.
+//   hbd_mul(a, c)         - exact 64-bit product of each lane with c.
+//   hbd_wide_add(), hbd_wide_sub()
+//   hbd_round_shift(w)    - ROUND_POWER_OF_TWO(w, DCT_CONST_BITS) truncated
+//                           to 32 bits.
+// Products are kept in 64 bits so that the results match the C functions in
+// aom_dsp/inv_txfm.c bit for bit at every bit depth.
+
+static INLINE hbd_vec hbd_btf(hbd_vec a, tran_high_t ca, hbd_vec b,
+                              tran_high_t cb) {
+  return hbd_round_shift(hbd_wide_add(hbd_mul(a, ca), hbd_mul(b, cb)));
+}
+
+static INLINE hbd_vec hbd_mul_round(hbd_vec a, tran_high_t c) {
+  return hbd_round_shift(hbd_mul(a, c));
+}
+
+static void hbd_idct4(hbd_vec *in) {
+  const hbd_vec s0 = hbd_mul_round(hbd_add(in[0], in[2]), cospi_16_64);
+  const hbd_vec s1 = hbd_mul_round(hbd_sub(in[0], in[2]), cospi_16_64);
+  const hbd_vec s2 = hbd_btf(in[1], cospi_24_64, in[3], -cospi_8_64);
+  const hbd_vec s3 = hbd_btf(in[1], cospi_8_64, in[3], cospi_24_64);
+
+  in[0] = hbd_add(s0, s3);
+  in[1] = hbd_add(s1, s2);
+  in[2] = hbd_sub(s1, s2);
+  in[3] = hbd_sub(s0, s3);
+}
+
+static void hbd_idct8(hbd_vec *in) {
+  hbd_vec even[4];
+  hbd_vec s4, s5, s6, s7, t4, t5, t6, t7;
+
+  // stage 1
+  even[0] = in[0];
+  even[1] = in[2];
+  even[2] = in[4];
+  even[3] = in[6];
+  s4 = hbd_btf(in[1], cospi_28_64, in[7], -cospi_4_64);
+  s7 = hbd_btf(in[1], cospi_4_64, in[7], cospi_28_64);
+  s5 = hbd_btf(in[5], cospi_12_64, in[3], -cospi_20_64);
+  s6 = hbd_btf(in[5], cospi_20_64, in[3], cospi_12_64);
+
+  // stage 2 & stage 3 - even half
+  hbd_idct4(even);
+
+  // stage 2 - odd half
+  t4 = hbd_add(s4, s5);
+  t5 = hbd_sub(s4, s5);
+  t6 = hbd_sub(s7, s6);
+  t7 = hbd_add(s6, s7);
+
+  // stage 3 - odd half
+  s5 = hbd_mul_round(hbd_sub(t6, t5), cospi_16_64);
+  s6 = hbd_mul_round(hbd_add(t5, t6), cospi_16_64);
+
+  // stage 4
+  in[0] = hbd_add(even[0], t7);
+  in[1] = hbd_add(even[1], s6);
+  in[2] = hbd_add(even[2], s5);
+  in[3] = hbd_add(even[3], t4);
+  in[4] = hbd_sub(even[3], t4);
+  in[5] = hbd_sub(even[2], s5);
+  in[6] = hbd_sub(even[1], s6);
+  in[7] = hbd_sub(even[0], t7);
+}
+
+static void hbd_idct16(hbd_vec *in) {
+  hbd_vec step1[16], step2[16];
+
+  // stage 1
+  step1[0] = in[0];
+  step1[1] = in[8];
+  step1[2] = in[4];
+  step1[3] = in[12];
+  step1[4] = in[2];
+  step1[5] = in[10];
+  step1[6] = in[6];
+  step1[7] = in[14];
+  step1[8] = in[1];
+  step1[9] = in[9];
+  step1[10] = in[5];
+  step1[11] = in[13];
+  step1[12] = in[3];
+  step1[13] = in[11];
+  step1[14] = in[7];
+  step1[15] = in[15];
+
+  // stage 2
+  step2[0] = step1[0];
+  step2[1] = step1[1];
+  step2[2] = step1[2];
+  step2[3] = step1[3];
+  step2[4] = step1[4];
+  step2[5] = step1[5];
+  step2[6] = step1[6];
+  step2[7] = step1[7];
+  step2[8] = hbd_btf(step1[8], cospi_30_64, step1[15], -cospi_2_64);
+  step2[15] = hbd_btf(step1[8], cospi_2_64, step1[15], cospi_30_64);
+  step2[9] = hbd_btf(step1[9], cospi_14_64, step1[14], -cospi_18_64);
+  step2[14] = hbd_btf(step1[9], cospi_18_64, step1[14], cospi_14_64);
+  step2[10] = hbd_btf(step1[10], cospi_22_64, step1[13], -cospi_10_64);
+  step2[13] = hbd_btf(step1[10], cospi_10_64, step1[13], cospi_22_64);
+  step2[11] = hbd_btf(step1[11], cospi_6_64, step1[12], -cospi_26_64);
+  step2[12] = hbd_btf(step1[11], cospi_26_64, step1[12], cospi_6_64);
+
+  // stage 3
+  step1[0] = step2[0];
+  step1[1] = step2[1];
+  step1[2] = step2[2];
+  step1[3] = step2[3];
+  step1[4] = hbd_btf(step2[4], cospi_28_64, step2[7], -cospi_4_64);
+  step1[7] = hbd_btf(step2[4], cospi_4_64, step2[7], cospi_28_64);
+  step1[5] = hbd_btf(step2[5], cospi_12_64, step2[6], -cospi_20_64);
+  step1[6] = hbd_btf(step2[5], cospi_20_64, step2[6], cospi_12_64);
+
+  step1[8] = hbd_add(step2[8], step2[9]);
+  step1[9] = hbd_sub(step2[8], step2[9]);
+  step1[10] = hbd_sub(step2[11], step2[10]);
+  step1[11] = hbd_add(step2[10], step2[11]);
+  step1[12] = hbd_add(step2[12], step2[13]);
+  step1[13] = hbd_sub(step2[12], step2[13]);
+  step1[14] = hbd_sub(step2[15], step2[14]);
+  step1[15] = hbd_add(step2[14], step2[15]);
+
+  // stage 4
+  step2[0] = hbd_mul_round(hbd_add(step1[0], step1[1]), cospi_16_64);
+  step2[1] = hbd_mul_round(hbd_sub(step1[0], step1[1]), cospi_16_64);
+  step2[2] = hbd_btf(step1[2], cospi_24_64, step1[3], -cospi_8_64);
+  step2[3] = hbd_btf(step1[2], cospi_8_64, step1[3], cospi_24_64);
+  step2[4] = hbd_add(step1[4], step1[5]);
+  step2[5] = hbd_sub(step1[4], step1[5]);
+  step2[6] = hbd_sub(step1[7], step1[6]);
+  step2[7] = hbd_add(step1[6], step1[7]);
+
+  step2[8] = step1[8];
+  step2[15] = step1[15];
+  step2[9] = hbd_btf(step1[9], -cospi_8_64, step1[14], cospi_24_64);
+  step2[14] = hbd_btf(step1[9], cospi_24_64, step1[14], cospi_8_64);
+  step2[10] = hbd_btf(step1[10], -cospi_24_64, step1[13], -cospi_8_64);
+  step2[13] = hbd_btf(step1[10], -cospi_8_64, step1[13], cospi_24_64);
+  step2[11] = step1[11];
+  step2[12] = step1[12];
+
+  // stage 5
+  step1[0] = hbd_add(step2[0], step2[3]);
+  step1[1] = hbd_add(step2[1], step2[2]);
+  step1[2] = hbd_sub(step2[1], step2[2]);
+  step1[3] = hbd_sub(step2[0], step2[3]);
+  step1[4] = step2[4];
+  step1[5] = hbd_mul_round(hbd_sub(step2[6], step2[5]), cospi_16_64);
+  step1[6] = hbd_mul_round(hbd_add(step2[5], step2[6]), cospi_16_64);
+  step1[7] = step2[7];
+
+  step1[8] = hbd_add(step2[8], step2[11]);
+  step1[9] = hbd_add(step2[9], step2[10]);
+  step1[10] = hbd_sub(step2[9], step2[10]);
+  step1[11] = hbd_sub(step2[8], step2[11]);
+  step1[12] = hbd_sub(step2[15], step2[12]);
+  step1[13] = hbd_sub(step2[14], step2[13]);
+  step1[14] = hbd_add(step2[13], step2[14]);
+  step1[15] = hbd_add(step2[12], step2[15]);
+
+  // stage 6
+  step2[0] = hbd_add(step1[0], step1[7]);
+  step2[1] = hbd_add(step1[1], step1[6]);
+  step2[2] = hbd_add(step1[2], step1[5]);
+  step2[3] = hbd_add(step1[3], step1[4]);
+  step2[4] = hbd_sub(step1[3], step1[4]);
+  step2[5] = hbd_sub(step1[2], step1[5]);
+  step2[6] = hbd_sub(step1[1], step1[6]);
+  step2[7] = hbd_sub(step1[0], step1[7]);
+  step2[8] = step1[8];
+  step2[9] = step1[9];
+  step2[10] = hbd_mul_round(hbd_sub(step1[13], step1[10]), cospi_16_64);
+  step2[13] = hbd_mul_round(hbd_add(step1[10], step1[13]), cospi_16_64);
+  step2[11] = hbd_mul_round(hbd_sub(step1[12], step1[11]), cospi_16_64);
+  step2[12] = hbd_mul_round(hbd_add(step1[11], step1[12]), cospi_16_64);
+  step2[14] = step1[14];
+  step2[15] = step1[15];
+
+  // stage 7
+  in[0] = hbd_add(step2[0], step2[15]);
+  in[1] = hbd_add(step2[1], step2[14]);
+  in[2] = hbd_add(step2[2], step2[13]);
+  in[3] = hbd_add(step2[3], step2[12]);
+  in[4] = hbd_add(step2[4], step2[11]);
+  in[5] = hbd_add(step2[5], step2[10]);
+  in[6] = hbd_add(step2[6], step2[9]);
+  in[7] = hbd_add(step2[7], step2[8]);
+  in[8] = hbd_sub(step2[7], step2[8]);
+  in[9] = hbd_sub(step2[6], step2[9]);
+  in[10] = hbd_sub(step2[5], step2[10]);
+  in[11] = hbd_sub(step2[4], step2[11]);
+  in[12] = hbd_sub(step2[3], step2[12]);
+  in[13] = hbd_sub(step2[2], step2[13]);
+  in[14] = hbd_sub(step2[1], step2[14]);
+  in[15] = hbd_sub(step2[0], step2[15]);
+}
+
+// The C functions skip all-zero inputs, which produce all-zero outputs here
+// without the test.
+static void hbd_iadst8(hbd_vec *in) {
+  const hbd_vec zero = hbd_sub(in[0], in[0]);
+  hbd_vec x0 = in[7];
+  hbd_vec x1 = in[0];
+  hbd_vec x2 = in[5];
+  hbd_vec x3 = in[2];
+  hbd_vec x4 = in[3];
+  hbd_vec x5 = in[4];
+  hbd_vec x6 = in[1];
+  hbd_vec x7 = in[6];
+  hbd_wide s0, s1, s2, s3, s4, s5, s6, s7;
+
+  // stage 1
+  s0 = hbd_wide_add(hbd_mul(x0, cospi_2_64), hbd_mul(x1, cospi_30_64));
+  s1 = hbd_wide_sub(hbd_mul(x0, cospi_30_64), hbd_mul(x1, cospi_2_64));
+  s2 = hbd_wide_add(hbd_mul(x2, cospi_10_64), hbd_mul(x3, cospi_22_64));
+  s3 = hbd_wide_sub(hbd_mul(x2, cospi_22_64), hbd_mul(x3, cospi_10_64));
+  s4 = hbd_wide_add(hbd_mul(x4, cospi_18_64), hbd_mul(x5, cospi_14_64));
+  s5 = hbd_wide_sub(hbd_mul(x4, cospi_14_64), hbd_mul(x5, cospi_18_64));
+  s6 = hbd_wide_add(hbd_mul(x6, cospi_26_64), hbd_mul(x7, cospi_6_64));
+  s7 = hbd_wide_sub(hbd_mul(x6, cospi_6_64), hbd_mul(x7, cospi_26_64));
+
+  x0 = hbd_round_shift(hbd_wide_add(s0, s4));
+  x1 = hbd_round_shift(hbd_wide_add(s1, s5));
+  x2 = hbd_round_shift(hbd_wide_add(s2, s6));
+  x3 = hbd_round_shift(hbd_wide_add(s3, s7));
+  x4 = hbd_round_shift(hbd_wide_sub(s0, s4));
+  x5 = hbd_round_shift(hbd_wide_sub(s1, s5));
+  x6 = hbd_round_shift(hbd_wide_sub(s2, s6));
+  x7 = hbd_round_shift(hbd_wide_sub(s3, s7));
+
+  // stage 2
+  s4 = hbd_wide_add(hbd_mul(x4, cospi_8_64), hbd_mul(x5, cospi_24_64));
+  s5 = hbd_wide_sub(hbd_mul(x4, cospi_24_64), hbd_mul(x5, cospi_8_64));
+  s6 = hbd_wide_add(hbd_mul(x6, -cospi_24_64), hbd_mul(x7, cospi_8_64));
+  s7 = hbd_wide_add(hbd_mul(x6, cospi_8_64), hbd_mul(x7, cospi_24_64));
+
+  {
+    const hbd_vec t0 = hbd_add(x0, x2);
+    const hbd_vec t1 = hbd_add(x1, x3);
+    x2 = hbd_sub(x0, x2);
+    x3 = hbd_sub(x1, x3);
+    x0 = t0;
+    x1 = t1;
+  }
+  x4 = hbd_round_shift(hbd_wide_add(s4, s6));
+  x5 = hbd_round_shift(hbd_wide_add(s5, s7));
+  x6 = hbd_round_shift(hbd_wide_sub(s4, s6));
+  x7 = hbd_round_shift(hbd_wide_sub(s5, s7));
+
+  // stage 3
+  in[0] = x0;
+  in[1] = hbd_sub(zero, x4);
+  in[2] = hbd_mul_round(hbd_add(x6, x7), cospi_16_64);
+  in[3] = hbd_sub(zero, hbd_mul_round(hbd_add(x2, x3), cospi_16_64));
+  in[4] = hbd_mul_round(hbd_sub(x2, x3), cospi_16_64);
+  in[5] = hbd_sub(zero, hbd_mul_round(hbd_sub(x6, x7), cospi_16_64));
+  in[6] = x5;
+  in[7] = hbd_sub(zero, x1);
+}
+
+static void hbd_iadst16(hbd_vec *in) {
+  const hbd_vec zero = hbd_sub(in[0], in[0]);
+  hbd_vec x[16];
+  hbd_wide s[16];
+  int i;
+
+  x[0] = in[15];
+  x[1] = in[0];
+  x[2] = in[13];
+  x[3] = in[2];
+  x[4] = in[11];
+  x[5] = in[4];
+  x[6] = in[9];
+  x[7] = in[6];
+  x[8] = in[7];
+  x[9] = in[8];
+  x[10] = in[5];
+  x[11] = in[10];
+  x[12] = in[3];
+  x[13] = in[12];
+  x[14] = in[1];
+  x[15] = in[14];
+
+  // stage 1
+  s[0] = hbd_wide_add(hbd_mul(x[0], cospi_1_64), hbd_mul(x[1], cospi_31_64));
+  s[1] = hbd_wide_sub(hbd_mul(x[0], cospi_31_64), hbd_mul(x[1], cospi_1_64));
+  s[2] = hbd_wide_add(hbd_mul(x[2], cospi_5_64), hbd_mul(x[3], cospi_27_64));
+  s[3] = hbd_wide_sub(hbd_mul(x[2], cospi_27_64), hbd_mul(x[3], cospi_5_64));
+  s[4] = hbd_wide_add(hbd_mul(x[4], cospi_9_64), hbd_mul(x[5], cospi_23_64));
+  s[5] = hbd_wide_sub(hbd_mul(x[4], cospi_23_64), hbd_mul(x[5], cospi_9_64));
+  s[6] = hbd_wide_add(hbd_mul(x[6], cospi_13_64), hbd_mul(x[7], cospi_19_64));
+  s[7] = hbd_wide_sub(hbd_mul(x[6], cospi_19_64), hbd_mul(x[7], cospi_13_64));
+  s[8] = hbd_wide_add(hbd_mul(x[8], cospi_17_64), hbd_mul(x[9], cospi_15_64));
+  s[9] = hbd_wide_sub(hbd_mul(x[8], cospi_15_64), hbd_mul(x[9], cospi_17_64));
+  s[10] = hbd_wide_add(hbd_mul(x[10], cospi_21_64),
+                       hbd_mul(x[11], cospi_11_64));
+  s[11] = hbd_wide_sub(hbd_mul(x[10], cospi_11_64),
+                       hbd_mul(x[11], cospi_21_64));
+  s[12] = hbd_wide_add(hbd_mul(x[12], cospi_25_64), hbd_mul(x[13], cospi_7_64));
+  s[13] = hbd_wide_sub(hbd_mul(x[12], cospi_7_64), hbd_mul(x[13], cospi_25_64));
+  s[14] = hbd_wide_add(hbd_mul(x[14], cospi_29_64), hbd_mul(x[15], cospi_3_64));
+  s[15] = hbd_wide_sub(hbd_mul(x[14], cospi_3_64), hbd_mul(x[15], cospi_29_64));
+
+  for (i = 0; i < 8; ++i) {
+    x[i] = hbd_round_shift(hbd_wide_add(s[i], s[i + 8]));
+    x[i + 8] = hbd_round_shift(hbd_wide_sub(s[i], s[i + 8]));
+  }
+
+  // stage 2
+  s[8] = hbd_wide_add(hbd_mul(x[8], cospi_4_64), hbd_mul(x[9], cospi_28_64));
+  s[9] = hbd_wide_sub(hbd_mul(x[8], cospi_28_64), hbd_mul(x[9], cospi_4_64));
+  s[10] = hbd_wide_add(hbd_mul(x[10], cospi_20_64),
+                       hbd_mul(x[11], cospi_12_64));
+  s[11] = hbd_wide_sub(hbd_mul(x[10], cospi_12_64),
+                       hbd_mul(x[11], cospi_20_64));
+  s[12] = hbd_wide_add(hbd_mul(x[12], -cospi_28_64),
+                       hbd_mul(x[13], cospi_4_64));
+  s[13] = hbd_wide_add(hbd_mul(x[12], cospi_4_64), hbd_mul(x[13], cospi_28_64));
+  s[14] = hbd_wide_add(hbd_mul(x[14], -cospi_12_64),
+                       hbd_mul(x[15], cospi_20_64));
+  s[15] = hbd_wide_add(hbd_mul(x[14], cospi_20_64),
+                       hbd_mul(x[15], cospi_12_64));
+
+  for (i = 0; i < 4; ++i) {
+    const hbd_vec t = hbd_add(x[i], x[i + 4]);
+    x[i + 4] = hbd_sub(x[i], x[i + 4]);
+    x[i] = t;
+    x[i + 8] = hbd_round_shift(hbd_wide_add(s[i + 8], s[i + 12]));
+    x[i + 12] = hbd_round_shift(hbd_wide_sub(s[i + 8], s[i + 12]));
+  }
+
+  // stage 3
+  s[4] = hbd_wide_add(hbd_mul(x[4], cospi_8_64), hbd_mul(x[5], cospi_24_64));
+  s[5] = hbd_wide_sub(hbd_mul(x[4], cospi_24_64), hbd_mul(x[5], cospi_8_64));
+  s[6] = hbd_wide_add(hbd_mul(x[6], -cospi_24_64), hbd_mul(x[7], cospi_8_64));
+  s[7] = hbd_wide_add(hbd_mul(x[6], cospi_8_64), hbd_mul(x[7], cospi_24_64));
+  s[12] = hbd_wide_add(hbd_mul(x[12], cospi_8_64), hbd_mul(x[13], cospi_24_64));
+  s[13] = hbd_wide_sub(hbd_mul(x[12], cospi_24_64), hbd_mul(x[13], cospi_8_64));
+  s[14] = hbd_wide_add(hbd_mul(x[14], -cospi_24_64),
+                       hbd_mul(x[15], cospi_8_64));
+  s[15] = hbd_wide_add(hbd_mul(x[14], cospi_8_64), hbd_mul(x[15], cospi_24_64));
+
+  for (i = 0; i < 16; i += 8) {
+    hbd_vec t = hbd_add(x[i], x[i + 2]);
+    x[i + 2] = hbd_sub(x[i], x[i + 2]);
+    x[i] = t;
+    t = hbd_add(x[i + 1], x[i + 3]);
+    x[i + 3] = hbd_sub(x[i + 1], x[i + 3]);
+    x[i + 1] = t;
+    x[i + 4] = hbd_round_shift(hbd_wide_add(s[i + 4], s[i + 6]));
+    x[i + 5] = hbd_round_shift(hbd_wide_add(s[i + 5], s[i + 7]));
+    x[i + 6] = hbd_round_shift(hbd_wide_sub(s[i + 4], s[i + 6]));
+    x[i + 7] = hbd_round_shift(hbd_wide_sub(s[i + 5], s[i + 7]));
+  }
+
+  // stage 4
+  in[0] = x[0];
+  in[1] = hbd_sub(zero, x[8]);
+  in[2] = x[12];
+  in[3] = hbd_sub(zero, x[4]);
+  in[4] = hbd_mul_round(hbd_add(x[6], x[7]), cospi_16_64);
+  in[5] = hbd_mul_round(hbd_add(x[14], x[15]), -cospi_16_64);
+  in[6] = hbd_mul_round(hbd_add(x[10], x[11]), cospi_16_64);
+  in[7] = hbd_mul_round(hbd_add(x[2], x[3]), -cospi_16_64);
+  in[8] = hbd_mul_round(hbd_sub(x[2], x[3]), cospi_16_64);
+  in[9] = hbd_mul_round(hbd_sub(x[11], x[10]), cospi_16_64);
+  in[10] = hbd_mul_round(hbd_sub(x[14], x[15]), cospi_16_64);
+  in[11] = hbd_mul_round(hbd_sub(x[7], x[6]), cospi_16_64);
+  in[12] = x[5];
+  in[13] = hbd_sub(zero, x[13]);
+  in[14] = x[9];
+  in[15] = hbd_sub(zero, x[1]);
+}
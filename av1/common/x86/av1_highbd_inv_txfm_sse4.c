@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>  // SSE4.1
+
+#include "./av1_rtcd.h"
+#include "aom_dsp/txfm_common.h"
+#include "aom_ports/mem.h"
+
+typedef __m128i hbd_vec;
+
+typedef struct {
+  __m128i even, odd;
+} hbd_wide;
+
+static INLINE hbd_vec hbd_add(hbd_vec a, hbd_vec b) {
+  return _mm_add_epi32(a, b);
+}
+
+static INLINE hbd_vec hbd_sub(hbd_vec a, hbd_vec b) {
+  return _mm_sub_epi32(a, b);
+}
+
+static INLINE hbd_wide hbd_mul(hbd_vec a, tran_high_t c) {
+  const __m128i k = _mm_set1_epi32((int)c);
+  hbd_wide r;
+  r.even = _mm_mul_epi32(a, k);
+  r.odd = _mm_mul_epi32(_mm_srli_epi64(a, 32), k);
+  return r;
+}
+
+static INLINE hbd_wide hbd_wide_add(hbd_wide a, hbd_wide b) {
+  hbd_wide r;
+  r.even = _mm_add_epi64(a.even, b.even);
+  r.odd = _mm_add_epi64(a.odd, b.odd);
+  return r;
+}
+
+static INLINE hbd_wide hbd_wide_sub(hbd_wide a, hbd_wide b) {
+  hbd_wide r;
+  r.even = _mm_sub_epi64(a.even, b.even);
+  r.odd = _mm_sub_epi64(a.odd, b.odd);
+  return r;
+}
+
+static INLINE hbd_vec hbd_round_shift(hbd_wide a) {
+  // Only the low 32 bits of each shifted product are kept, so a logical
+  // shift gives the same result as an arithmetic one.
+  const __m128i rounding = _mm_set1_epi64x(DCT_CONST_ROUNDING);
+  const __m128i even =
+      _mm_srli_epi64(_mm_add_epi64(a.even, rounding), DCT_CONST_BITS);
+  const __m128i odd =
+      _mm_slli_epi64(_mm_add_epi64(a.odd, rounding), 32 - DCT_CONST_BITS);
+  return _mm_blend_epi16(even, odd, 0xcc);
+}
+
+#include "av1/common/x86/av1_highbd_inv_txfm_impl.h"
+
+// Only the 4x4 transform, which has no AVX2 version, uses the 4-point ADST.
+static void hbd_iadst4(hbd_vec *in) {
+  const hbd_vec x0 = in[0];
+  const hbd_vec x1 = in[1];
+  const hbd_vec x2 = in[2];
+  const hbd_vec x3 = in[3];
+  const hbd_wide s3 = hbd_mul(x1, sinpi_3_9);
+  const hbd_wide s7 = hbd_mul(hbd_add(hbd_sub(x0, x2), x3), sinpi_3_9);
+  hbd_wide s0 = hbd_mul(x0, sinpi_1_9);
+  hbd_wide s1 = hbd_mul(x0, sinpi_2_9);
+
+  s0 = hbd_wide_add(s0, hbd_mul(x2, sinpi_4_9));
+  s0 = hbd_wide_add(s0, hbd_mul(x3, sinpi_2_9));
+  s1 = hbd_wide_sub(s1, hbd_mul(x2, sinpi_1_9));
+  s1 = hbd_wide_sub(s1, hbd_mul(x3, sinpi_4_9));
+
+  in[0] = hbd_round_shift(hbd_wide_add(s0, s3));
+  in[1] = hbd_round_shift(hbd_wide_add(s1, s3));
+  in[2] = hbd_round_shift(s7);
+  in[3] = hbd_round_shift(hbd_wide_sub(hbd_wide_add(s0, s1), s3));
+}
+
+typedef void (*hbd_itx1d)(hbd_vec *in);
+
+typedef struct {
+  hbd_itx1d cols, rows;  // vertical and horizontal
+} hbd_itx2d;
+
+static INLINE void transpose_4x4(__m128i *r) {
+  const __m128i a0 = _mm_unpacklo_epi32(r[0], r[1]);
+  const __m128i a1 = _mm_unpackhi_epi32(r[0], r[1]);
+  const __m128i a2 = _mm_unpacklo_epi32(r[2], r[3]);
+  const __m128i a3 = _mm_unpackhi_epi32(r[2], r[3]);
+  r[0] = _mm_unpacklo_epi64(a0, a2);
+  r[1] = _mm_unpackhi_epi64(a0, a2);
+  r[2] = _mm_unpacklo_epi64(a1, a3);
+  r[3] = _mm_unpackhi_epi64(a1, a3);
+}
+
+// Adds the rounded residual in v to four pixels of dest and clamps to bd.
+static INLINE void add_clamp_4(__m128i v, uint16_t *dest, int shift, int bd) {
+  const __m128i rounding = _mm_set1_epi32((1 << shift) >> 1);
+  const __m128i max = _mm_set1_epi32((1 << bd) - 1);
+  const __m128i d = _mm_cvtepu16_epi32(_mm_loadl_epi64((__m128i *)dest));
+  __m128i res =
+      _mm_sra_epi32(_mm_add_epi32(v, rounding), _mm_cvtsi32_si128(shift));
+  res = _mm_add_epi32(d, res);
+  res = _mm_min_epi32(_mm_max_epi32(res, _mm_setzero_si128()), max);
+  _mm_storel_epi64((__m128i *)dest, _mm_packus_epi32(res, res));
+}
+
+// Four rows (then four columns) are transformed at a time, one per lane.
+static void highbd_iht_sse4_1(const tran_low_t *input, uint16_t *dest,
+                              int stride, int n, hbd_itx2d tx, int shift,
+                              int bd) {
+  DECLARE_ALIGNED(16, tran_low_t, out[16 * 16]);
+  __m128i v[16];
+  int r, c, i;
+
+  for (r = 0; r < n; r += 4) {
+    for (c = 0; c < n; c += 4) {
+      for (i = 0; i < 4; ++i)
+        v[c + i] = _mm_loadu_si128((const __m128i *)(input + (r + i) * n + c));
+      transpose_4x4(v + c);
+    }
+    tx.rows(v);
+    for (c = 0; c < n; c += 4) {
+      transpose_4x4(v + c);
+      for (i = 0; i < 4; ++i)
+        _mm_store_si128((__m128i *)(out + (r + i) * n + c), v[c + i]);
+    }
+  }
+
+  for (c = 0; c < n; c += 4) {
+    for (r = 0; r < n; ++r)
+      v[r] = _mm_load_si128((const __m128i *)(out + r * n + c));
+    tx.cols(v);
+    for (r = 0; r < n; ++r) add_clamp_4(v[r], dest + r * stride + c, shift, bd);
+  }
+}
+
+void av1_highbd_iht4x4_16_add_sse4_1(const tran_low_t *input, uint8_t *dest8,
+                                     int stride, int tx_type, int bd) {
+  static const hbd_itx2d IHT_4[] = {
+    { hbd_idct4, hbd_idct4 },    // DCT_DCT  = 0
+    { hbd_iadst4, hbd_idct4 },   // ADST_DCT = 1
+    { hbd_idct4, hbd_iadst4 },   // DCT_ADST = 2
+    { hbd_iadst4, hbd_iadst4 },  // ADST_ADST = 3
+  };
+  highbd_iht_sse4_1(input, CONVERT_TO_SHORTPTR(dest8), stride, 4,
+                    IHT_4[tx_type], 4, bd);
+}
+
+void av1_highbd_iht8x8_64_add_sse4_1(const tran_low_t *input, uint8_t *dest8,
+                                     int stride, int tx_type, int bd) {
+  static const hbd_itx2d IHT_8[] = {
+    { hbd_idct8, hbd_idct8 },    // DCT_DCT  = 0
+    { hbd_iadst8, hbd_idct8 },   // ADST_DCT = 1
+    { hbd_idct8, hbd_iadst8 },   // DCT_ADST = 2
+    { hbd_iadst8, hbd_iadst8 },  // ADST_ADST = 3
+  };
+  highbd_iht_sse4_1(input, CONVERT_TO_SHORTPTR(dest8), stride, 8,
+                    IHT_8[tx_type], 5, bd);
+}
+
+void av1_highbd_iht16x16_256_add_sse4_1(const tran_low_t *input,
+                                        uint8_t *dest8, int stride,
+                                        int tx_type, int bd) {
+  static const hbd_itx2d IHT_16[] = {
+    { hbd_idct16, hbd_idct16 },    // DCT_DCT  = 0
+    { hbd_iadst16, hbd_idct16 },   // ADST_DCT = 1
+    { hbd_idct16, hbd_iadst16 },   // DCT_ADST = 2
+    { hbd_iadst16, hbd_iadst16 },  // ADST_ADST = 3
+  };
+  highbd_iht_sse4_1(input, CONVERT_TO_SHORTPTR(dest8), stride, 16,
+                    IHT_16[tx_type], 6, bd);
+}
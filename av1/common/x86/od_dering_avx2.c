@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/od_dering.h"
+
+/* Same as the SSE4.1 version, applied independently to each 128-bit lane. */
+static INLINE __m256i fold_mul_and_sum(__m256i partiala, __m256i partialb,
+                                       __m128i const1, __m128i const2) {
+  __m256i tmp;
+  /* Reverse partial B. */
+  partialb = _mm256_shuffle_epi8(
+      partialb, _mm256_broadcastsi128_si256(_mm_set_epi8(
+                    15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12)));
+  /* Interleave the x and y values of identical indices and pair x8 with 0. */
+  tmp = partiala;
+  partiala = _mm256_unpacklo_epi16(partiala, partialb);
+  partialb = _mm256_unpackhi_epi16(tmp, partialb);
+  /* Square and add the corresponding x and y values. */
+  partiala = _mm256_madd_epi16(partiala, partiala);
+  partialb = _mm256_madd_epi16(partialb, partialb);
+  /* Multiply by constant. */
+  partiala =
+      _mm256_mullo_epi32(partiala, _mm256_broadcastsi128_si256(const1));
+  partialb =
+      _mm256_mullo_epi32(partialb, _mm256_broadcastsi128_si256(const2));
+  /* Sum all results. */
+  return _mm256_add_epi32(partiala, partialb);
+}
+
+static INLINE __m256i hsum4(__m256i x0, __m256i x1, __m256i x2, __m256i x3) {
+  __m256i t0, t1, t2, t3;
+  t0 = _mm256_unpacklo_epi32(x0, x1);
+  t1 = _mm256_unpacklo_epi32(x2, x3);
+  t2 = _mm256_unpackhi_epi32(x0, x1);
+  t3 = _mm256_unpackhi_epi32(x2, x3);
+  x0 = _mm256_unpacklo_epi64(t0, t1);
+  x1 = _mm256_unpackhi_epi64(t0, t1);
+  x2 = _mm256_unpacklo_epi64(t2, t3);
+  x3 = _mm256_unpackhi_epi64(t2, t3);
+  return _mm256_add_epi32(_mm256_add_epi32(x0, x1), _mm256_add_epi32(x2, x3));
+}
+
+/* Horizontal sum of 16x16-bit unsigned values. */
+static INLINE int32_t hsum_epi16(__m256i a) {
+  __m128i b;
+  b = _mm_add_epi16(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+  b = _mm_madd_epi16(b, _mm_set1_epi16(1));
+  b = _mm_hadd_epi32(b, b);
+  b = _mm_hadd_epi32(b, b);
+  return _mm_cvtsi128_si32(b);
+}
+
+/* Computes cost for directions 4, 5, 6 and 7 of the block in each 128-bit
+   lane. The "mostly horizontal" directions 0 to 3 are obtained by passing
+   the rotated block in one of the lanes, so that a single call covers all
+   eight directions. */
+static INLINE __m256i compute_directions(__m256i lines[8]) {
+  __m256i partial4a, partial4b, partial5a, partial5b, partial7a, partial7b;
+  __m256i partial6;
+  __m256i tmp;
+  /* Partial sums for lines 0 and 1. */
+  partial4a = _mm256_slli_si256(lines[0], 14);
+  partial4b = _mm256_srli_si256(lines[0], 2);
+  partial4a = _mm256_add_epi16(partial4a, _mm256_slli_si256(lines[1], 12));
+  partial4b = _mm256_add_epi16(partial4b, _mm256_srli_si256(lines[1], 4));
+  tmp = _mm256_add_epi16(lines[0], lines[1]);
+  partial5a = _mm256_slli_si256(tmp, 10);
+  partial5b = _mm256_srli_si256(tmp, 6);
+  partial7a = _mm256_slli_si256(tmp, 4);
+  partial7b = _mm256_srli_si256(tmp, 12);
+  partial6 = tmp;
+
+  /* Partial sums for lines 2 and 3. */
+  partial4a = _mm256_add_epi16(partial4a, _mm256_slli_si256(lines[2], 10));
+  partial4b = _mm256_add_epi16(partial4b, _mm256_srli_si256(lines[2], 6));
+  partial4a = _mm256_add_epi16(partial4a, _mm256_slli_si256(lines[3], 8));
+  partial4b = _mm256_add_epi16(partial4b, _mm256_srli_si256(lines[3], 8));
+  tmp = _mm256_add_epi16(lines[2], lines[3]);
+  partial5a = _mm256_add_epi16(partial5a, _mm256_slli_si256(tmp, 8));
+  partial5b = _mm256_add_epi16(partial5b, _mm256_srli_si256(tmp, 8));
+  partial7a = _mm256_add_epi16(partial7a, _mm256_slli_si256(tmp, 6));
+  partial7b = _mm256_add_epi16(partial7b, _mm256_srli_si256(tmp, 10));
+  partial6 = _mm256_add_epi16(partial6, tmp);
+
+  /* Partial sums for lines 4 and 5. */
+  partial4a = _mm256_add_epi16(partial4a, _mm256_slli_si256(lines[4], 6));
+  partial4b = _mm256_add_epi16(partial4b, _mm256_srli_si256(lines[4], 10));
+  partial4a = _mm256_add_epi16(partial4a, _mm256_slli_si256(lines[5], 4));
+  partial4b = _mm256_add_epi16(partial4b, _mm256_srli_si256(lines[5], 12));
+  tmp = _mm256_add_epi16(lines[4], lines[5]);
+  partial5a = _mm256_add_epi16(partial5a, _mm256_slli_si256(tmp, 6));
+  partial5b = _mm256_add_epi16(partial5b, _mm256_srli_si256(tmp, 10));
+  partial7a = _mm256_add_epi16(partial7a, _mm256_slli_si256(tmp, 8));
+  partial7b = _mm256_add_epi16(partial7b, _mm256_srli_si256(tmp, 8));
+  partial6 = _mm256_add_epi16(partial6, tmp);
+
+  /* Partial sums for lines 6 and 7. */
+  partial4a = _mm256_add_epi16(partial4a, _mm256_slli_si256(lines[6], 2));
+  partial4b = _mm256_add_epi16(partial4b, _mm256_srli_si256(lines[6], 14));
+  partial4a = _mm256_add_epi16(partial4a, lines[7]);
+  tmp = _mm256_add_epi16(lines[6], lines[7]);
+  partial5a = _mm256_add_epi16(partial5a, _mm256_slli_si256(tmp, 4));
+  partial5b = _mm256_add_epi16(partial5b, _mm256_srli_si256(tmp, 12));
+  partial7a = _mm256_add_epi16(partial7a, _mm256_slli_si256(tmp, 10));
+  partial7b = _mm256_add_epi16(partial7b, _mm256_srli_si256(tmp, 6));
+  partial6 = _mm256_add_epi16(partial6, tmp);
+
+  /* Compute costs in terms of partial sums. */
+  partial4a =
+      fold_mul_and_sum(partial4a, partial4b, _mm_set_epi32(210, 280, 420, 840),
+                       _mm_set_epi32(105, 120, 140, 168));
+  partial7a =
+      fold_mul_and_sum(partial7a, partial7b, _mm_set_epi32(210, 420, 0, 0),
+                       _mm_set_epi32(105, 105, 105, 140));
+  partial5a =
+      fold_mul_and_sum(partial5a, partial5b, _mm_set_epi32(210, 420, 0, 0),
+                       _mm_set_epi32(105, 105, 105, 140));
+  partial6 = _mm256_madd_epi16(partial6, partial6);
+  partial6 = _mm256_mullo_epi32(partial6, _mm256_set1_epi32(105));
+
+  return hsum4(partial4a, partial5a, partial6, partial7a);
+}
+
+/* transpose and reverse the order of the lines -- equivalent to a 90-degree
+   counter-clockwise rotation of the pixels. */
+static INLINE void array_reverse_transpose_8x8(__m128i *in, __m128i *res) {
+  const __m128i tr0_0 = _mm_unpacklo_epi16(in[0], in[1]);
+  const __m128i tr0_1 = _mm_unpacklo_epi16(in[2], in[3]);
+  const __m128i tr0_2 = _mm_unpackhi_epi16(in[0], in[1]);
+  const __m128i tr0_3 = _mm_unpackhi_epi16(in[2], in[3]);
+  const __m128i tr0_4 = _mm_unpacklo_epi16(in[4], in[5]);
+  const __m128i tr0_5 = _mm_unpacklo_epi16(in[6], in[7]);
+  const __m128i tr0_6 = _mm_unpackhi_epi16(in[4], in[5]);
+  const __m128i tr0_7 = _mm_unpackhi_epi16(in[6], in[7]);
+
+  const __m128i tr1_0 = _mm_unpacklo_epi32(tr0_0, tr0_1);
+  const __m128i tr1_1 = _mm_unpacklo_epi32(tr0_4, tr0_5);
+  const __m128i tr1_2 = _mm_unpackhi_epi32(tr0_0, tr0_1);
+  const __m128i tr1_3 = _mm_unpackhi_epi32(tr0_4, tr0_5);
+  const __m128i tr1_4 = _mm_unpacklo_epi32(tr0_2, tr0_3);
+  const __m128i tr1_5 = _mm_unpacklo_epi32(tr0_6, tr0_7);
+  const __m128i tr1_6 = _mm_unpackhi_epi32(tr0_2, tr0_3);
+  const __m128i tr1_7 = _mm_unpackhi_epi32(tr0_6, tr0_7);
+
+  res[7] = _mm_unpacklo_epi64(tr1_0, tr1_1);
+  res[6] = _mm_unpackhi_epi64(tr1_0, tr1_1);
+  res[5] = _mm_unpacklo_epi64(tr1_2, tr1_3);
+  res[4] = _mm_unpackhi_epi64(tr1_2, tr1_3);
+  res[3] = _mm_unpacklo_epi64(tr1_4, tr1_5);
+  res[2] = _mm_unpackhi_epi64(tr1_4, tr1_5);
+  res[1] = _mm_unpacklo_epi64(tr1_6, tr1_7);
+  res[0] = _mm_unpackhi_epi64(tr1_6, tr1_7);
+}
+
+int od_dir_find8_avx2(const od_dering_in *img, int stride, int32_t *var,
+                      int coeff_shift) {
+  int i;
+  int32_t cost[8];
+  int32_t best_cost = 0;
+  int best_dir = 0;
+  __m128i lines[8];
+  __m128i rotated[8];
+  __m256i both[8];
+  __m256i costs;
+  __m128i dir03, dir47;
+  __m128i max;
+  for (i = 0; i < 8; i++) {
+    lines[i] = _mm_loadu_si128((const __m128i *)&img[i * stride]);
+    lines[i] = _mm_sub_epi16(_mm_srai_epi16(lines[i], coeff_shift),
+                             _mm_set1_epi16(128));
+  }
+  array_reverse_transpose_8x8(lines, rotated);
+
+  /* Compute the "mostly horizontal" directions in the low lane and the
+     "mostly vertical" directions in the high lane. */
+  for (i = 0; i < 8; i++) {
+    both[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(rotated[i]),
+                                      lines[i], 1);
+  }
+  costs = compute_directions(both);
+  _mm256_storeu_si256((__m256i *)cost, costs);
+  dir03 = _mm256_castsi256_si128(costs);
+  dir47 = _mm256_extracti128_si256(costs, 1);
+
+  max = _mm_max_epi32(dir03, dir47);
+  max = _mm_max_epi32(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+  max = _mm_max_epi32(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+  dir03 = _mm_and_si128(_mm_cmpeq_epi32(max, dir03),
+                        _mm_setr_epi32(-1, -2, -3, -4));
+  dir47 = _mm_and_si128(_mm_cmpeq_epi32(max, dir47),
+                        _mm_setr_epi32(-5, -6, -7, -8));
+  dir03 = _mm_max_epu32(dir03, dir47);
+  dir03 = _mm_max_epu32(dir03, _mm_unpackhi_epi64(dir03, dir03));
+  dir03 =
+      _mm_max_epu32(dir03, _mm_shufflelo_epi16(dir03, _MM_SHUFFLE(1, 0, 3, 2)));
+  dir03 = _mm_xor_si128(dir03, _mm_set1_epi32(0xFFFFFFFF));
+
+  best_dir = _mm_cvtsi128_si32(dir03);
+  best_cost = _mm_cvtsi128_si32(max);
+  /* Difference between the optimal variance and the variance along the
+     orthogonal direction. Again, the sum(x^2) terms cancel out. */
+  *var = best_cost - cost[(best_dir + 4) & 7];
+  /* We'd normally divide by 840, but dividing by 1024 is close enough
+     for what we're going to do with this. */
+  *var >>= 10;
+  return best_dir;
+}
+
+static INLINE __m256i od_cmplt_abs_epi16(__m256i in, __m256i threshold) {
+  return _mm256_cmpgt_epi16(threshold, _mm256_abs_epi16(in));
+}
+
+/* Loads two consecutive 8-pixel rows of the filter input. */
+static INLINE __m256i load_rows_8x2(const int16_t *in) {
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)in)),
+      _mm_loadu_si128((const __m128i *)(in + OD_FILT_BSTRIDE)), 1);
+}
+
+/* Loads a whole 4x4 block of the filter input. */
+static INLINE __m256i load_rows_4x4(const int16_t *in) {
+  const __m128i r01 = _mm_unpacklo_epi64(
+      _mm_loadl_epi64((const __m128i *)in),
+      _mm_loadl_epi64((const __m128i *)(in + OD_FILT_BSTRIDE)));
+  const __m128i r23 = _mm_unpacklo_epi64(
+      _mm_loadl_epi64((const __m128i *)(in + 2 * OD_FILT_BSTRIDE)),
+      _mm_loadl_epi64((const __m128i *)(in + 3 * OD_FILT_BSTRIDE)));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(r01), r23, 1);
+}
+
+static INLINE void store_rows_8x2(int16_t *y, int ystride, __m256i res) {
+  _mm_storeu_si128((__m128i *)y, _mm256_castsi256_si128(res));
+  _mm_storeu_si128((__m128i *)(y + ystride), _mm256_extracti128_si256(res, 1));
+}
+
+static INLINE void store_rows_4x4(int16_t *y, int ystride, __m256i res) {
+  const __m128i r01 = _mm256_castsi256_si128(res);
+  const __m128i r23 = _mm256_extracti128_si256(res, 1);
+  _mm_storel_epi64((__m128i *)y, r01);
+  _mm_storel_epi64((__m128i *)(y + ystride), _mm_unpackhi_epi64(r01, r01));
+  _mm_storel_epi64((__m128i *)(y + 2 * ystride), r23);
+  _mm_storel_epi64((__m128i *)(y + 3 * ystride), _mm_unpackhi_epi64(r23, r23));
+}
+
+int od_filter_dering_direction_4x4_avx2(int16_t *y, int ystride,
+                                        const int16_t *in, int threshold,
+                                        int dir) {
+  __m256i sum;
+  __m256i p;
+  __m256i cmp;
+  __m256i row;
+  __m256i res;
+  __m256i thresh;
+  int off1, off2;
+  off1 = OD_DIRECTION_OFFSETS_TABLE[dir][0];
+  off2 = OD_DIRECTION_OFFSETS_TABLE[dir][1];
+  thresh = _mm256_set1_epi16(threshold);
+  sum = _mm256_setzero_si256();
+  row = load_rows_4x4(in);
+
+  /*p = in[i*OD_FILT_BSTRIDE + offset] - row*/
+  p = _mm256_sub_epi16(load_rows_4x4(in + off1), row);
+  /*if (abs(p) < thresh) sum += taps[k]*p*/
+  cmp = od_cmplt_abs_epi16(p, thresh);
+  p = _mm256_slli_epi16(p, 2);
+  p = _mm256_and_si256(p, cmp);
+  sum = _mm256_add_epi16(sum, p);
+  /*p = in[i*OD_FILT_BSTRIDE - offset] - row*/
+  p = _mm256_sub_epi16(load_rows_4x4(in - off1), row);
+  /*if (abs(p) < thresh) sum += taps[k]*p1*/
+  cmp = od_cmplt_abs_epi16(p, thresh);
+  p = _mm256_slli_epi16(p, 2);
+  p = _mm256_and_si256(p, cmp);
+  sum = _mm256_add_epi16(sum, p);
+
+  /*p = in[i*OD_FILT_BSTRIDE + offset] - row*/
+  p = _mm256_sub_epi16(load_rows_4x4(in + off2), row);
+  /*if (abs(p) < thresh) sum += taps[k]*p*/
+  cmp = od_cmplt_abs_epi16(p, thresh);
+  p = _mm256_and_si256(p, cmp);
+  sum = _mm256_add_epi16(sum, p);
+  /*p = in[i*OD_FILT_BSTRIDE - offset] - row*/
+  p = _mm256_sub_epi16(load_rows_4x4(in - off2), row);
+  /*if (abs(p) < thresh) sum += taps[k]*p1*/
+  cmp = od_cmplt_abs_epi16(p, thresh);
+  p = _mm256_and_si256(p, cmp);
+  sum = _mm256_add_epi16(sum, p);
+
+  /*res = row + ((sum + 8) >> 4)*/
+  res = _mm256_add_epi16(sum, _mm256_set1_epi16(8));
+  res = _mm256_srai_epi16(res, 4);
+  store_rows_4x4(y, ystride, _mm256_add_epi16(row, res));
+  return (hsum_epi16(_mm256_abs_epi16(res)) + 2) >> 2;
+}
+
+int od_filter_dering_direction_8x8_avx2(int16_t *y, int ystride,
+                                        const int16_t *in, int threshold,
+                                        int dir) {
+  int i;
+  __m256i sum;
+  __m256i p;
+  __m256i cmp;
+  __m256i row;
+  __m256i res;
+  __m256i thresh;
+  __m256i total_abs;
+  int off1, off2, off3;
+  off1 = OD_DIRECTION_OFFSETS_TABLE[dir][0];
+  off2 = OD_DIRECTION_OFFSETS_TABLE[dir][1];
+  off3 = OD_DIRECTION_OFFSETS_TABLE[dir][2];
+  total_abs = _mm256_setzero_si256();
+  thresh = _mm256_set1_epi16(threshold);
+  for (i = 0; i < 8; i += 2) {
+    const int16_t *rin = &in[i * OD_FILT_BSTRIDE];
+    sum = _mm256_setzero_si256();
+    row = load_rows_8x2(rin);
+
+    /*p = in[i*OD_FILT_BSTRIDE + offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin + off1), row);
+    /*if (abs(p) < thresh) sum += taps[k]*p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_add_epi16(p, _mm256_slli_epi16(p, 1));
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*p = in[i*OD_FILT_BSTRIDE - offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin - off1), row);
+    /*if (abs(p) < thresh) sum += taps[k]*p1*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_add_epi16(p, _mm256_slli_epi16(p, 1));
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*p = in[i*OD_FILT_BSTRIDE + offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin + off2), row);
+    /*if (abs(p) < thresh) sum += taps[k]*p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_slli_epi16(p, 1);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*p = in[i*OD_FILT_BSTRIDE - offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin - off2), row);
+    /*if (abs(p) < thresh) sum += taps[k]*p1*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_slli_epi16(p, 1);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*p = in[i*OD_FILT_BSTRIDE + offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin + off3), row);
+    /*if (abs(p) < thresh) sum += taps[k]*p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*p = in[i*OD_FILT_BSTRIDE - offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin - off3), row);
+    /*if (abs(p) < thresh) sum += taps[k]*p1*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*res = row + ((sum + 8) >> 4)*/
+    res = _mm256_add_epi16(sum, _mm256_set1_epi16(8));
+    res = _mm256_srai_epi16(res, 4);
+    total_abs = _mm256_add_epi16(total_abs, _mm256_abs_epi16(res));
+    store_rows_8x2(&y[i * ystride], ystride, _mm256_add_epi16(row, res));
+  }
+  return (hsum_epi16(total_abs) + 8) >> 4;
+}
+
+void od_filter_dering_orthogonal_4x4_avx2(int16_t *y, int ystride,
+                                          const int16_t *in, int threshold,
+                                          int dir) {
+  int offset;
+  __m256i res;
+  __m256i p;
+  __m256i cmp;
+  __m256i row;
+  __m256i sum;
+  __m256i thresh;
+  thresh = _mm256_set1_epi16(threshold);
+  if (dir > 0 && dir < 4)
+    offset = OD_FILT_BSTRIDE;
+  else
+    offset = 1;
+  sum = _mm256_setzero_si256();
+  row = load_rows_4x4(in);
+
+  /*p = in[i*OD_FILT_BSTRIDE + k*offset] - row*/
+  p = _mm256_sub_epi16(load_rows_4x4(in + offset), row);
+  /*if (abs(p) < threshold) sum += p*/
+  cmp = od_cmplt_abs_epi16(p, thresh);
+  p = _mm256_and_si256(p, cmp);
+  sum = _mm256_add_epi16(sum, p);
+  /*p = in[i*OD_FILT_BSTRIDE - k*offset] - row*/
+  p = _mm256_sub_epi16(load_rows_4x4(in - offset), row);
+  /*if (abs(p) < threshold) sum += p*/
+  cmp = od_cmplt_abs_epi16(p, thresh);
+  p = _mm256_and_si256(p, cmp);
+  sum = _mm256_add_epi16(sum, p);
+
+  /*row + ((5*sum + 8) >> 4)*/
+  res = _mm256_mullo_epi16(sum, _mm256_set1_epi16(5));
+  res = _mm256_add_epi16(res, _mm256_set1_epi16(8));
+  res = _mm256_srai_epi16(res, 4);
+  store_rows_4x4(y, ystride, _mm256_add_epi16(res, row));
+}
+
+void od_filter_dering_orthogonal_8x8_avx2(int16_t *y, int ystride,
+                                          const int16_t *in, int threshold,
+                                          int dir) {
+  int i;
+  int offset;
+  __m256i res;
+  __m256i p;
+  __m256i cmp;
+  __m256i row;
+  __m256i sum;
+  __m256i thresh;
+  thresh = _mm256_set1_epi16(threshold);
+  if (dir > 0 && dir < 4)
+    offset = OD_FILT_BSTRIDE;
+  else
+    offset = 1;
+  for (i = 0; i < 8; i += 2) {
+    const int16_t *rin = &in[i * OD_FILT_BSTRIDE];
+    sum = _mm256_setzero_si256();
+    row = load_rows_8x2(rin);
+
+    /*p = in[i*OD_FILT_BSTRIDE + k*offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin + offset), row);
+    /*if (abs(p) < thresh) sum += p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+    /*p = in[i*OD_FILT_BSTRIDE - k*offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin - offset), row);
+    /*if (abs(p) < threshold) sum += p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*p = in[i*OD_FILT_BSTRIDE + k*offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin + 2 * offset), row);
+    /*if (abs(p) < threshold) sum += p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+    /*p = in[i*OD_FILT_BSTRIDE - k*offset] - row*/
+    p = _mm256_sub_epi16(load_rows_8x2(rin - 2 * offset), row);
+    /*if (abs(p) < threshold) sum += p*/
+    cmp = od_cmplt_abs_epi16(p, thresh);
+    p = _mm256_and_si256(p, cmp);
+    sum = _mm256_add_epi16(sum, p);
+
+    /*row + ((3*sum + 8) >> 4)*/
+    res = _mm256_mullo_epi16(sum, _mm256_set1_epi16(3));
+    res = _mm256_add_epi16(res, _mm256_set1_epi16(8));
+    res = _mm256_srai_epi16(res, 4);
+    store_rows_8x2(&y[i * ystride], ystride, _mm256_add_epi16(res, row));
+  }
+}
+
+/* The pixels are at most 12-bit, so the sums fit in 32 bits. */
+uint64_t od_compute_dist_8x8_avx2(const int16_t *x, int xstride,
+                                  const int16_t *y, int ystride) {
+  __m256i sum = _mm256_setzero_si256();
+  __m128i sum128;
+  int i;
+  for (i = 0; i < 8; i += 2) {
+    const __m256i xx = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i *)&x[i * xstride])),
+        _mm_loadu_si128((const __m128i *)&x[(i + 1) * xstride]), 1);
+    const __m256i yy = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i *)&y[i * ystride])),
+        _mm_loadu_si128((const __m128i *)&y[(i + 1) * ystride]), 1);
+    const __m256i d = _mm256_sub_epi16(xx, yy);
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(d, d));
+  }
+  sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                         _mm256_extracti128_si256(sum, 1));
+  sum128 = _mm_add_epi32(sum128, _mm_srli_si128(sum128, 8));
+  sum128 = _mm_add_epi32(sum128, _mm_srli_si128(sum128, 4));
+  return (uint32_t)_mm_cvtsi128_si32(sum128);
+}
@@ -497,3 +497,19 @@ void od_filter_dering_orthogonal_8x8_sse4_1(int16_t *y, int ystride,
     _mm_storeu_si128((__m128i *)&y[i * ystride], res);
   }
 }
+
+/* The pixels are at most 12-bit, so the sums fit in 32 bits. */
+uint64_t od_compute_dist_8x8_sse4_1(const int16_t *x, int xstride,
+                                    const int16_t *y, int ystride) {
+  __m128i sum = _mm_setzero_si128();
+  int i;
+  for (i = 0; i < 8; i++) {
+    const __m128i d =
+        _mm_sub_epi16(_mm_loadu_si128((const __m128i *)&x[i * xstride]),
+                      _mm_loadu_si128((const __m128i *)&y[i * ystride]));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(d, d));
+  }
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+  return (uint32_t)_mm_cvtsi128_si32(sum);
+}
@@ -472,11 +472,24 @@ static int av1_pvq_decode_helper2(
 }
 #endif
 
+static void predict_intra_block(MACROBLOCKD *const xd,
+                                const MB_MODE_INFO *const mbmi, int plane,
+                                int row, int col, TX_SIZE tx_size) {
+  struct macroblockd_plane *const pd = &xd->plane[plane];
+  PREDICTION_MODE mode = (plane == 0) ? mbmi->mode : mbmi->uv_mode;
+  uint8_t *const dst = &pd->dst.buf[4 * row * pd->dst.stride + 4 * col];
+
+  if (mbmi->sb_type < BLOCK_8X8)
+    if (plane == 0) mode = xd->mi[0]->bmi[(row << 1) + col].as_mode;
+
+  av1_predict_intra_block(xd, pd->n4_wl, pd->n4_hl, tx_size, mode, dst,
+                          pd->dst.stride, dst, pd->dst.stride, col, row, plane);
+}
+
 static void predict_and_reconstruct_intra_block(
     AV1_COMMON *cm, MACROBLOCKD *const xd, aom_reader *r,
     MB_MODE_INFO *const mbmi, int plane, int row, int col, TX_SIZE tx_size) {
   struct macroblockd_plane *const pd = &xd->plane[plane];
-  PREDICTION_MODE mode = (plane == 0) ? mbmi->mode : mbmi->uv_mode;
   PLANE_TYPE plane_type = (plane == 0) ? PLANE_TYPE_Y : PLANE_TYPE_UV;
   uint8_t *dst;
   int block_idx = (row << 1) + col;
@@ -486,11 +499,7 @@ static void predict_and_reconstruct_intra_block(
 #endif
   dst = &pd->dst.buf[4 * row * pd->dst.stride + 4 * col];
 
-  if (mbmi->sb_type < BLOCK_8X8)
-    if (plane == 0) mode = xd->mi[0]->bmi[(row << 1) + col].as_mode;
-
-  av1_predict_intra_block(xd, pd->n4_wl, pd->n4_hl, tx_size, mode, dst,
-                          pd->dst.stride, dst, pd->dst.stride, col, row, plane);
+  predict_intra_block(xd, mbmi, plane, row, col, tx_size);
 
   if (!mbmi->skip) {
     TX_TYPE tx_type = get_tx_type(plane_type, xd, block_idx);
@@ -575,9 +584,140 @@ static MB_MODE_INFO *set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
   return &xd->mi[0]->mbmi;
 }
 
+// Returns in *wide and *high the number of 4x4 columns and rows of the block
+// in the plane that lie inside the frame.
+static void get_max_blocks(const MACROBLOCKD *const xd,
+                           const struct macroblockd_plane *const pd,
+                           int *wide, int *high) {
+  *wide = pd->n4_w + (xd->mb_to_right_edge >= 0
+                          ? 0
+                          : xd->mb_to_right_edge >> (5 + pd->subsampling_x));
+  *high = pd->n4_h + (xd->mb_to_bottom_edge >= 0
+                          ? 0
+                          : xd->mb_to_bottom_edge >> (5 + pd->subsampling_y));
+}
+
+// Reads the tokens of a transform block and appends its end of block
+// position, and its dequantized coefficients if it has any, to sb.
+static int parse_tx_block(AV1_COMMON *cm, MACROBLOCKD *const xd, aom_reader *r,
+                          const MB_MODE_INFO *const mbmi, int plane, int row,
+                          int col, TX_SIZE tx_size, ParsedSuperblock *sb) {
+  struct macroblockd_plane *const pd = &xd->plane[plane];
+  const PLANE_TYPE plane_type = (plane == 0) ? PLANE_TYPE_Y : PLANE_TYPE_UV;
+  const TX_TYPE tx_type = get_tx_type(plane_type, xd, (row << 1) + col);
+  const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type);
+  int eob;
+
+  // The buffer is zero except where the reconstruction has not yet consumed
+  // coefficients, as inverse_transform_block() clears what it has read.
+  pd->dqcoeff = sb->coeffs + sb->num_coeffs;
+  eob = av1_decode_block_tokens(xd, plane, scan_order, col, row, tx_size, r,
+                                mbmi->segment_id);
+#if CONFIG_ADAPT_SCAN
+  av1_update_scan_count_facade(cm, tx_size, tx_type, pd->dqcoeff, eob);
+#endif
+  sb->eobs[sb->num_eobs++] = eob;
+  if (eob > 0) sb->num_coeffs += tx_size_2d[tx_size];
+  return eob;
+}
+
+// Reads the coefficients of a block into sb, leaving its prediction and
+// reconstruction to reconstruct_parsed_block().
+static void parse_block(AV1_COMMON *cm, MACROBLOCKD *const xd, aom_reader *r,
+                        MB_MODE_INFO *const mbmi, int mi_row, int mi_col,
+                        BLOCK_SIZE bsize, int bwl, int bhl,
+                        ParsedSuperblock *sb) {
+  ParsedBlock *const block = &sb->blocks[sb->num_blocks++];
+  assert(sb->num_blocks <= MAX_MIB_SIZE * MAX_MIB_SIZE);
+  block->mi_row = mi_row;
+  block->mi_col = mi_col;
+  block->bsize = bsize;
+  block->bwl = bwl;
+  block->bhl = bhl;
+  block->bmode_blocks_wl = xd->bmode_blocks_wl;
+  block->bmode_blocks_hl = xd->bmode_blocks_hl;
+
+  if (!mbmi->skip) {
+    int eobtotal = 0;
+    int plane;
+
+    for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+      const struct macroblockd_plane *const pd = &xd->plane[plane];
+      const TX_SIZE tx_size = plane ? get_uv_tx_size(mbmi, pd) : mbmi->tx_size;
+      const int step = tx_size_1d_in_unit[tx_size];
+      int row, col, max_blocks_wide, max_blocks_high;
+      get_max_blocks(xd, pd, &max_blocks_wide, &max_blocks_high);
+
+      for (row = 0; row < max_blocks_high; row += step)
+        for (col = 0; col < max_blocks_wide; col += step)
+          eobtotal +=
+              parse_tx_block(cm, xd, r, mbmi, plane, row, col, tx_size, sb);
+    }
+
+    if (is_inter_block(mbmi) && bsize >= BLOCK_8X8 && eobtotal == 0)
+      mbmi->has_no_coeffs = 1;  // skip loopfilter
+  }
+}
+
+// In frame parallel mode, waits until the references of an inter block are
+// final over the area that its prediction reads. Predictions that read the
+// border of a reference, which is extended once the whole reference has been
+// decoded, or that read scaled references wait for the whole reference.
+static void dec_wait_for_refs(AV1Decoder *const pbi, const MACROBLOCKD *xd,
+                              int mi_row, int mi_col, int bw, int bh) {
+  AV1_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+  const MODE_INFO *const mi = xd->mi[0];
+  const MB_MODE_INFO *const mbmi = &mi->mbmi;
+  const int num_mvs = mbmi->sb_type < BLOCK_8X8 ? 4 : 1;
+  // The chroma filter taps cover twice as many luma pixels.
+  const int extend = 2 * AOM_INTERP_EXTEND;
+  int ref, i;
+
+#if CONFIG_MOTION_VAR
+  // The overlapped predictions use the references of the neighbors.
+  if (mbmi->motion_mode == OBMC_CAUSAL) {
+    for (ref = 0; ref < REFS_PER_FRAME; ++ref)
+      av1_frameworker_wait(pbi->frame_worker_owner,
+                           &frame_bufs[cm->frame_refs[ref].idx], INT_MAX);
+    return;
+  }
+#endif  // CONFIG_MOTION_VAR
+
+  for (ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+    const RefBuffer *const ref_buf =
+        &cm->frame_refs[mbmi->ref_frame[ref] - LAST_FRAME];
+    int min_row = INT_MAX, max_row = INT_MIN;
+    int min_col = INT_MAX, max_col = INT_MIN;
+    int top, left, bottom, right;
+
+    for (i = 0; i < num_mvs; ++i) {
+      const MV mv = num_mvs > 1 ? mi->bmi[i].as_mv[ref].as_mv
+                                : mbmi->mv[ref].as_mv;
+      min_row = AOMMIN(min_row, mv.row);
+      max_row = AOMMAX(max_row, mv.row);
+      min_col = AOMMIN(min_col, mv.col);
+      max_col = AOMMAX(max_col, mv.col);
+    }
+    // The motion vectors are in 1/8 pel units.
+    top = mi_row * MI_SIZE + (min_row >> 3) - extend;
+    left = mi_col * MI_SIZE + (min_col >> 3) - extend;
+    bottom = (mi_row + bh) * MI_SIZE + ((max_row + 7) >> 3) + extend;
+    right = (mi_col + bw) * MI_SIZE + ((max_col + 7) >> 3) + extend;
+
+    if (av1_is_scaled(&ref_buf->sf) || top < 0 || left < 0 ||
+        bottom > ref_buf->buf->y_crop_height ||
+        right > ref_buf->buf->y_crop_width)
+      bottom = INT_MAX;
+    av1_frameworker_wait(pbi->frame_worker_owner, &frame_bufs[ref_buf->idx],
+                         bottom);
+  }
+}
+
 static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
                          int mi_row, int mi_col, aom_reader *r,
-                         BLOCK_SIZE bsize, int bwl, int bhl) {
+                         BLOCK_SIZE bsize, int bwl, int bhl,
+                         ParsedSuperblock *sb) {
   AV1_COMMON *const cm = &pbi->common;
   const int less8x8 = bsize < BLOCK_8X8;
   const int bw = 1 << (bwl - 1);
@@ -626,7 +766,9 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
     dec_reset_skip_context(xd);
   }
 
-  if (!is_inter_block(mbmi)) {
+  if (sb) {
+    parse_block(cm, xd, r, mbmi, mi_row, mi_col, bsize, bwl, bhl, sb);
+  } else if (!is_inter_block(mbmi)) {
     int plane;
 #if CONFIG_PALETTE
     for (plane = 0; plane <= 1; ++plane) {
@@ -637,18 +779,9 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
     for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
       const struct macroblockd_plane *const pd = &xd->plane[plane];
       const TX_SIZE tx_size = plane ? get_uv_tx_size(mbmi, pd) : mbmi->tx_size;
-      const int num_4x4_w = pd->n4_w;
-      const int num_4x4_h = pd->n4_h;
       const int step = tx_size_1d_in_unit[tx_size];
-      int row, col;
-      const int max_blocks_wide =
-          num_4x4_w + (xd->mb_to_right_edge >= 0
-                           ? 0
-                           : xd->mb_to_right_edge >> (5 + pd->subsampling_x));
-      const int max_blocks_high =
-          num_4x4_h + (xd->mb_to_bottom_edge >= 0
-                           ? 0
-                           : xd->mb_to_bottom_edge >> (5 + pd->subsampling_y));
+      int row, col, max_blocks_wide, max_blocks_high;
+      get_max_blocks(xd, pd, &max_blocks_wide, &max_blocks_high);
 
       for (row = 0; row < max_blocks_high; row += step)
         for (col = 0; col < max_blocks_wide; col += step)
@@ -657,6 +790,8 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
     }
   } else {
     // Prediction
+    if (cm->frame_parallel_decode)
+      dec_wait_for_refs(pbi, xd, mi_row, mi_col, bw, bh);
     av1_build_inter_predictors_sb(xd, mi_row, mi_col, AOMMAX(bsize, BLOCK_8X8));
 #if CONFIG_MOTION_VAR
     if (mbmi->motion_mode == OBMC_CAUSAL)
@@ -671,18 +806,9 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
         const struct macroblockd_plane *const pd = &xd->plane[plane];
         const TX_SIZE tx_size =
             plane ? get_uv_tx_size(mbmi, pd) : mbmi->tx_size;
-        const int num_4x4_w = pd->n4_w;
-        const int num_4x4_h = pd->n4_h;
         const int step = tx_size_1d_in_unit[tx_size];
-        int row, col;
-        const int max_blocks_wide =
-            num_4x4_w + (xd->mb_to_right_edge >= 0
-                             ? 0
-                             : xd->mb_to_right_edge >> (5 + pd->subsampling_x));
-        const int max_blocks_high =
-            num_4x4_h +
-            (xd->mb_to_bottom_edge >= 0 ? 0 : xd->mb_to_bottom_edge >>
-                                                  (5 + pd->subsampling_y));
+        int row, col, max_blocks_wide, max_blocks_high;
+        get_max_blocks(xd, pd, &max_blocks_wide, &max_blocks_high);
 
         for (row = 0; row < max_blocks_high; row += step)
           for (col = 0; col < max_blocks_wide; col += step)
@@ -769,9 +895,12 @@ static int clpf_all_skip(const AV1_COMMON *cm, int mi_col, int mi_row,
 #endif
 
 // TODO(slavarnway): eliminate bsize and subsize in future commits
+// When sb is not NULL the blocks are only parsed into it, to be reconstructed
+// later.
 static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
                              int mi_row, int mi_col, aom_reader *r,
-                             BLOCK_SIZE bsize, int n4x4_l2) {
+                             BLOCK_SIZE bsize, int n4x4_l2,
+                             ParsedSuperblock *sb) {
   AV1_COMMON *const cm = &pbi->common;
   const int n8x8_l2 = n4x4_l2 - 1;
   const int num_8x8_wh = 1 << n8x8_l2;
@@ -795,30 +924,35 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
     // calculate bmode block dimensions (log 2)
     xd->bmode_blocks_wl = 1 >> !!(partition & PARTITION_VERT);
     xd->bmode_blocks_hl = 1 >> !!(partition & PARTITION_HORZ);
-    decode_block(pbi, xd, mi_row, mi_col, r, subsize, 1, 1);
+    decode_block(pbi, xd, mi_row, mi_col, r, subsize, 1, 1, sb);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        decode_block(pbi, xd, mi_row, mi_col, r, subsize, n4x4_l2, n4x4_l2);
+        decode_block(pbi, xd, mi_row, mi_col, r, subsize, n4x4_l2, n4x4_l2,
+                     sb);
         break;
       case PARTITION_HORZ:
-        decode_block(pbi, xd, mi_row, mi_col, r, subsize, n4x4_l2, n8x8_l2);
+        decode_block(pbi, xd, mi_row, mi_col, r, subsize, n4x4_l2, n8x8_l2,
+                     sb);
         if (has_rows)
           decode_block(pbi, xd, mi_row + hbs, mi_col, r, subsize, n4x4_l2,
-                       n8x8_l2);
+                       n8x8_l2, sb);
         break;
       case PARTITION_VERT:
-        decode_block(pbi, xd, mi_row, mi_col, r, subsize, n8x8_l2, n4x4_l2);
+        decode_block(pbi, xd, mi_row, mi_col, r, subsize, n8x8_l2, n4x4_l2,
+                     sb);
         if (has_cols)
           decode_block(pbi, xd, mi_row, mi_col + hbs, r, subsize, n8x8_l2,
-                       n4x4_l2);
+                       n4x4_l2, sb);
         break;
       case PARTITION_SPLIT:
-        decode_partition(pbi, xd, mi_row, mi_col, r, subsize, n8x8_l2);
-        decode_partition(pbi, xd, mi_row, mi_col + hbs, r, subsize, n8x8_l2);
-        decode_partition(pbi, xd, mi_row + hbs, mi_col, r, subsize, n8x8_l2);
+        decode_partition(pbi, xd, mi_row, mi_col, r, subsize, n8x8_l2, sb);
+        decode_partition(pbi, xd, mi_row, mi_col + hbs, r, subsize, n8x8_l2,
+                         sb);
+        decode_partition(pbi, xd, mi_row + hbs, mi_col, r, subsize, n8x8_l2,
+                         sb);
         decode_partition(pbi, xd, mi_row + hbs, mi_col + hbs, r, subsize,
-                         n8x8_l2);
+                         n8x8_l2, sb);
         break;
       default: assert(0 && "Invalid partition type");
     }
@@ -1325,12 +1459,6 @@ static void setup_tile_info(AV1Decoder *pbi, struct aom_read_bit_buffer *rb) {
 #endif
 }
 
-typedef struct TileBuffer {
-  const uint8_t *data;
-  size_t size;
-  int col;  // only used with multi-threaded decoding
-} TileBuffer;
-
 static int mem_get_varsize(const uint8_t *data, const int mag) {
   switch (mag) {
     case 0: return data[0];
@@ -1444,6 +1572,503 @@ static void daala_dec_init(daala_dec_ctx *daala_dec, od_ec_dec *ec) {
 }
 #endif
 
+// State of the post-filters run by pbi->lf_worker. Every time the worker runs
+// it deblocks the rows given by lf and then deringes and CLPF filters all
+// superblock rows whose pixels no longer change, so that each row is
+// post-filtered while it is still in cache and while the rows below it are
+// being decoded.
+typedef struct PostFilterData {
+  LFWorkerData lf;
+  int filter_level;
+#if CONFIG_DERING
+  int dering_level;
+  struct macroblockd_plane dering_planes[MAX_MB_PLANE];
+  DeringWorkerData dering;
+  // Number of superblock row boundaries saved and rows deringed.
+  int dering_saved;
+  int dering_rows;
+#endif
+#if CONFIG_CLPF
+  ClpfFrameParams clpf[MAX_MB_PLANE];
+  int clpf_planes;
+  // Number of filter block rows prepared and filtered per plane.
+  int clpf_prepared[MAX_MB_PLANE];
+  int clpf_filtered[MAX_MB_PLANE];
+#endif
+  // The frame whose progress is broadcast in frame parallel mode, or NULL.
+  RefCntBuffer *progress_buf;
+} PostFilterData;
+
+static void post_filter_data_reset(PostFilterData *pf, AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
+  av1_loop_filter_data_reset(&pf->lf, new_fb, cm, pbi->mb.plane);
+  pf->filter_level = cm->lf.filter_level;
+  pf->progress_buf = cm->frame_parallel_decode ? pbi->cur_buf : NULL;
+#if CONFIG_DERING
+  pf->dering_level = cm->dering_level;
+  pf->dering_saved = 0;
+  pf->dering_rows = 0;
+  if (pf->dering_level) {
+    memcpy(pf->dering_planes, pbi->mb.plane, sizeof(pf->dering_planes));
+    av1_setup_dst_planes(pf->dering_planes, new_fb, 0, 0);
+    av1_dering_rows_init(&pf->dering, cm, pf->dering_planes,
+                         pf->dering_level);
+  }
+#endif
+#if CONFIG_CLPF
+  pf->clpf_planes = 0;
+  if (cm->clpf_strength_y) {
+    av1_clpf_init_params(&pf->clpf[pf->clpf_planes++], new_fb, NULL, cm,
+                         cm->clpf_size != CLPF_NOSIZE,
+                         cm->clpf_strength_y + (cm->clpf_strength_y == 3),
+                         4 + cm->clpf_size, AOM_PLANE_Y, clpf_bit);
+  }
+  if (cm->clpf_strength_u) {
+    av1_clpf_init_params(&pf->clpf[pf->clpf_planes++], new_fb, NULL, cm, 0,
+                         cm->clpf_strength_u + (cm->clpf_strength_u == 3), 4,
+                         AOM_PLANE_U, NULL);
+  }
+  if (cm->clpf_strength_v) {
+    av1_clpf_init_params(&pf->clpf[pf->clpf_planes++], new_fb, NULL, cm, 0,
+                         cm->clpf_strength_v + (cm->clpf_strength_v == 3), 4,
+                         AOM_PLANE_V, NULL);
+  }
+  if (pf->clpf_planes) av1_clpf_alloc_rows(cm, pf->clpf, pf->clpf_planes, 1);
+  av1_zero(pf->clpf_prepared);
+  av1_zero(pf->clpf_filtered);
+#endif
+}
+
+static int post_filter_active(const AV1_COMMON *cm) {
+  if (cm->skip_loop_filter) return 0;
+#if CONFIG_DERING
+  if (cm->dering_level) return 1;
+#endif
+#if CONFIG_CLPF
+  if (cm->clpf_strength_y || cm->clpf_strength_u || cm->clpf_strength_v)
+    return 1;
+#endif
+  return cm->lf.filter_level != 0;
+}
+
+// Returns the number of luma rows that the post filter will no longer change.
+static int post_filter_final_rows(const PostFilterData *pf) {
+  const AV1_COMMON *const cm = pf->lf.cm;
+  int rows = pf->lf.stop * MI_SIZE;
+#if CONFIG_CLPF
+  int i;
+#endif
+  // Deblocking the edge below the last deblocked row changes its bottom
+  // lines.
+  if (pf->filter_level && pf->lf.stop < cm->mi_rows) rows -= MI_SIZE;
+#if CONFIG_DERING
+  if (pf->dering_level)
+    rows = AOMMIN(rows, pf->dering_rows << MAX_SB_SIZE_LOG2);
+#endif
+#if CONFIG_CLPF
+  for (i = 0; i < pf->clpf_planes; i++) {
+    const ClpfFrameParams *const p = &pf->clpf[i];
+    rows = AOMMIN(rows, (pf->clpf_filtered[i] << p->fb_size_log2) << p->suby);
+  }
+#endif
+  return rows;
+}
+
+// Deblocks the rows [pf->lf.start, pf->lf.stop), which must all have been
+// decoded, and post-filters everything that this makes final.
+static int post_filter_worker(PostFilterData *const pf, void *unused) {
+#if CONFIG_DERING || CONFIG_CLPF
+  AV1_COMMON *const cm = pf->lf.cm;
+  const int sb_rows = (cm->mi_rows + MAX_MIB_SIZE - 1) >> MAX_MIB_SIZE_LOG2;
+  int final_rows;
+#endif
+#if CONFIG_CLPF
+  int i;
+#endif
+  if (pf->filter_level) av1_loop_filter_worker(&pf->lf, unused);
+
+#if CONFIG_DERING || CONFIG_CLPF
+  // The intra prediction of the next superblock row reads the unfiltered
+  // bottom line of the last decoded row, and the deblocking of the edge below
+  // the last deblocked row still changes its bottom lines.
+  if (pf->lf.stop >= cm->mi_rows)
+    final_rows = sb_rows;
+  else
+    final_rows = (pf->lf.stop >> MAX_MIB_SIZE_LOG2) - (pf->filter_level != 0);
+#endif
+
+#if CONFIG_DERING
+  if (pf->dering_level) {
+    // The lines around the top edge of a row are saved once its first lines
+    // are final, before the row above it is deringed.
+    while (pf->dering_saved < AOMMIN(final_rows + 1, sb_rows))
+      av1_dering_save_boundary(&pf->dering, pf->dering_saved++);
+    while (pf->dering_rows < final_rows)
+      av1_dering_sb_row(&pf->dering, pf->dering_rows++);
+  }
+#endif
+
+#if CONFIG_CLPF
+  for (i = 0; i < pf->clpf_planes; i++) {
+    const ClpfFrameParams *const p = &pf->clpf[i];
+    const int lines = final_rows == sb_rows
+                          ? p->height
+                          : (final_rows << MAX_SB_SIZE_LOG2) >> p->suby;
+    // A filter block row is prepared once the line below it is final, and
+    // filtered once the row below it has saved its unfiltered top line.
+    while (pf->clpf_prepared[i] < p->num_fb_ver &&
+           AOMMIN(p->height,
+                  ((pf->clpf_prepared[i] + 1) << p->fb_size_log2) + 1) <=
+               lines)
+      av1_clpf_prepare_row(p, pf->clpf_prepared[i]++);
+    // The limits of a partial plane reach across rows, so such a plane is
+    // only filtered once all its rows are prepared.
+    if (p->partial && pf->clpf_prepared[i] < p->num_fb_ver) continue;
+    if (p->partial && pf->clpf_filtered[i] == 0) av1_clpf_find_limits(p);
+    while (pf->clpf_filtered[i] < pf->clpf_prepared[i] - 1 ||
+           (pf->clpf_prepared[i] == p->num_fb_ver &&
+            pf->clpf_filtered[i] < p->num_fb_ver))
+      av1_clpf_filter_row(p, cm->clpf_worker_data[0].buf,
+                          pf->clpf_filtered[i]++);
+  }
+#endif
+  if (pf->progress_buf)
+    av1_frameworker_broadcast(pf->progress_buf, post_filter_final_rows(pf));
+  return 1;
+}
+
+// Deblocks and post-filters the mi rows [start, stop) in pbi->lf_worker, after
+// waiting for the rows before them.
+static void post_filter_rows(AV1Decoder *pbi, int start, int stop) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  LFWorkerData *const lf_data = &((PostFilterData *)pbi->lf_worker.data1)->lf;
+
+  winterface->sync(&pbi->lf_worker);
+  lf_data->start = start;
+  lf_data->stop = stop;
+  if (pbi->max_threads > 1) {
+    winterface->launch(&pbi->lf_worker);
+  } else {
+    winterface->execute(&pbi->lf_worker);
+  }
+}
+
+static void create_tile_workers(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  // TODO(jzern): See if we can remove the restriction of passing in max
+  // threads to the decoder.
+  if (pbi->num_tile_workers == 0) {
+    const int num_threads = pbi->max_threads;
+    int i;
+    CHECK_MEM_ERROR(cm, pbi->tile_workers,
+                    aom_malloc(num_threads * sizeof(*pbi->tile_workers)));
+    // Ensure tile data offsets will be properly aligned. This may fail on
+    // platforms without DECLARE_ALIGNED().
+    assert((sizeof(*pbi->tile_worker_data) % 16) == 0);
+    CHECK_MEM_ERROR(
+        cm, pbi->tile_worker_data,
+        aom_memalign(32, num_threads * sizeof(*pbi->tile_worker_data)));
+    CHECK_MEM_ERROR(cm, pbi->tile_worker_info,
+                    aom_malloc(num_threads * sizeof(*pbi->tile_worker_info)));
+    for (i = 0; i < num_threads; ++i) {
+      AVxWorker *const worker = &pbi->tile_workers[i];
+      ++pbi->num_tile_workers;
+
+      winterface->init(worker);
+      aom_worker_set_pool(worker, pbi->thread_pool, pbi->thread_pool_priority);
+      if (i < num_threads - 1 && !winterface->reset(worker)) {
+        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                           "Tile decoder thread creation failed");
+      }
+    }
+  }
+}
+
+static void reconstruct_parsed_tx_block(MACROBLOCKD *const xd, int plane,
+                                        int row, int col, TX_SIZE tx_size,
+                                        tran_low_t **coeffs,
+                                        const uint16_t **eobs) {
+  struct macroblockd_plane *const pd = &xd->plane[plane];
+  const int eob = *(*eobs)++;
+
+  if (eob > 0) {
+    const PLANE_TYPE plane_type = (plane == 0) ? PLANE_TYPE_Y : PLANE_TYPE_UV;
+    const TX_TYPE tx_type = get_tx_type(plane_type, xd, (row << 1) + col);
+    pd->dqcoeff = *coeffs;
+    inverse_transform_block(xd, plane, tx_type, tx_size,
+                            &pd->dst.buf[4 * row * pd->dst.stride + 4 * col],
+                            pd->dst.stride, eob);
+    *coeffs += tx_size_2d[tx_size];
+  }
+}
+
+// Predicts and reconstructs a block parsed by parse_block(), taking its
+// coefficients from *coeffs and *eobs. Unlike decode_block() this does not
+// write to the mode info, which the main thread may still be filling in for
+// the rows below.
+static void reconstruct_parsed_block(AV1_COMMON *cm, MACROBLOCKD *const xd,
+                                     const ParsedBlock *block,
+                                     tran_low_t **coeffs,
+                                     const uint16_t **eobs) {
+  const int mi_row = block->mi_row;
+  const int mi_col = block->mi_col;
+  const int bw = 1 << (block->bwl - 1);
+  const int bh = 1 << (block->bhl - 1);
+  const MB_MODE_INFO *mbmi;
+  int plane, row, col, max_blocks_wide, max_blocks_high;
+
+  xd->mi = cm->mi_grid_visible + mi_row * cm->mi_stride + mi_col;
+  set_plane_n4(xd, bw, bh, block->bwl, block->bhl);
+  set_mi_row_col(xd, &xd->tile, mi_row, bh, mi_col, bw, cm->mi_rows,
+                 cm->mi_cols);
+  av1_setup_dst_planes(xd->plane, get_frame_new_buffer(cm), mi_row, mi_col);
+  xd->bmode_blocks_wl = block->bmode_blocks_wl;
+  xd->bmode_blocks_hl = block->bmode_blocks_hl;
+  mbmi = &xd->mi[0]->mbmi;
+
+  if (!is_inter_block(mbmi)) {
+    for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+      const struct macroblockd_plane *const pd = &xd->plane[plane];
+      const TX_SIZE tx_size = plane ? get_uv_tx_size(mbmi, pd) : mbmi->tx_size;
+      const int step = tx_size_1d_in_unit[tx_size];
+      get_max_blocks(xd, pd, &max_blocks_wide, &max_blocks_high);
+
+      for (row = 0; row < max_blocks_high; row += step)
+        for (col = 0; col < max_blocks_wide; col += step) {
+          predict_intra_block(xd, mbmi, plane, row, col, tx_size);
+          if (!mbmi->skip)
+            reconstruct_parsed_tx_block(xd, plane, row, col, tx_size, coeffs,
+                                        eobs);
+        }
+    }
+  } else {
+    int ref;
+    for (ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+      const RefBuffer *const ref_buf =
+          &cm->frame_refs[mbmi->ref_frame[ref] - LAST_FRAME];
+      xd->block_refs[ref] = ref_buf;
+      av1_setup_pre_planes(xd, ref, ref_buf->buf, mi_row, mi_col,
+                           &ref_buf->sf);
+    }
+
+    av1_build_inter_predictors_sb(xd, mi_row, mi_col,
+                                  AOMMAX(block->bsize, BLOCK_8X8));
+#if CONFIG_MOTION_VAR
+    if (mbmi->motion_mode == OBMC_CAUSAL)
+      av1_build_obmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
+#endif  // CONFIG_MOTION_VAR
+
+    if (!mbmi->skip) {
+      for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+        const struct macroblockd_plane *const pd = &xd->plane[plane];
+        const TX_SIZE tx_size =
+            plane ? get_uv_tx_size(mbmi, pd) : mbmi->tx_size;
+        const int step = tx_size_1d_in_unit[tx_size];
+        get_max_blocks(xd, pd, &max_blocks_wide, &max_blocks_high);
+
+        for (row = 0; row < max_blocks_high; row += step)
+          for (col = 0; col < max_blocks_wide; col += step)
+            reconstruct_parsed_tx_block(xd, plane, row, col, tx_size, coeffs,
+                                        eobs);
+      }
+    }
+  }
+}
+
+// Reconstructs superblock row sb_row of the frame, which has a single tile
+// column. Returns 0 if the frame has failed to decode.
+static int reconstruct_sb_row(TileWorkerData *const tile_data, int sb_row) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  AV1DecRowMTSync *const sync = &pbi->row_mt_sync;
+  MACROBLOCKD *const xd = &tile_data->xd;
+  const int mi_row = sb_row << MAX_MIB_SIZE_LOG2;
+  int tile_row = 0, mi_col;
+
+  assert(cm->log2_tile_cols == 0);
+  av1_tile_set_row(&xd->tile, cm, tile_row);
+  while (mi_row >= xd->tile.mi_row_end)
+    av1_tile_set_row(&xd->tile, cm, ++tile_row);
+  av1_tile_set_col(&xd->tile, cm, 0);
+
+  for (mi_col = xd->tile.mi_col_start; mi_col < xd->tile.mi_col_end;
+       mi_col += MAX_MIB_SIZE) {
+    const int sb_col = mi_col >> MAX_MIB_SIZE_LOG2;
+    ParsedSuperblock *const sb =
+        &pbi->parsed_sbs[sb_row * sync->sb_cols + sb_col];
+    tran_low_t *coeffs;
+    const uint16_t *eobs;
+    int i;
+
+    if (!av1_dec_row_mt_sync_read(sync, sb_row, sb_col)) return 0;
+    coeffs = sb->coeffs;
+    eobs = sb->eobs;
+    for (i = 0; i < sb->num_blocks; ++i)
+      reconstruct_parsed_block(cm, xd, &sb->blocks[i], &coeffs, &eobs);
+    av1_dec_row_mt_sync_write(sync, sb_row, sb_col + 1);
+  }
+  return 1;
+}
+
+static int row_mt_worker_hook(TileWorkerData *const tile_data, void *unused) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  int sb_row;
+  (void)unused;
+
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    av1_dec_row_mt_abort(&pbi->row_mt_sync);
+    return 0;
+  }
+
+  tile_data->error_info.setjmp = 1;
+  tile_data->xd = pbi->mb;
+  av1_init_macroblockd(&pbi->common, &tile_data->xd,
+#if CONFIG_PVQ
+                       tile_data->pvq_ref_coeff,
+#endif
+                       tile_data->dqcoeff);
+  tile_data->xd.error_info = &tile_data->error_info;
+
+  while ((sb_row = av1_dec_row_mt_next_row(&pbi->row_mt_sync)) >= 0) {
+    if (!reconstruct_sb_row(tile_data, sb_row)) break;
+  }
+  tile_data->error_info.setjmp = 0;
+  return !pbi->row_mt_sync.aborted;
+}
+
+// Whether decode_tiles() should parse the frame in the main thread and leave
+// its reconstruction to the tile workers. Frames with more than one tile
+// column are decoded by decode_tiles_mt() instead. The parse cannot run ahead
+// of the reconstruction with PVQ, which codes coefficients relative to the
+// prediction, nor with palette, whose color maps are kept per tile. Frame
+// parallel decoding already keeps the threads busy.
+static int use_row_mt(const AV1Decoder *pbi) {
+#if CONFIG_MULTITHREAD && !CONFIG_PVQ
+  const AV1_COMMON *const cm = &pbi->common;
+  if (pbi->max_threads < 2 || cm->log2_tile_cols > 0 ||
+      cm->frame_parallel_decode)
+    return 0;
+#if CONFIG_PALETTE
+  if (cm->allow_screen_content_tools) return 0;
+#endif  // CONFIG_PALETTE
+  return 1;
+#else
+  (void)pbi;
+  return 0;
+#endif  // CONFIG_MULTITHREAD && !CONFIG_PVQ
+}
+
+// Allocates the parse buffers and launches max_threads - 1 tile workers to
+// reconstruct the superblock rows as the main thread parses them.
+static void row_mt_start(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int sb_rows = (cm->mi_rows + MAX_MIB_SIZE - 1) >> MAX_MIB_SIZE_LOG2;
+  const int sb_cols = mi_cols_aligned_to_sb(cm->mi_cols) >> MAX_MIB_SIZE_LOG2;
+  // The coefficients of the whole frame are kept so that the parse, which is
+  // the serial part of the decode, never waits for the reconstruction to
+  // free space. Only transform blocks with coefficients take space, and the
+  // inverse transforms zero what they read, so the arena is allocated once
+  // and does not need clearing between frames. Transform blocks do not
+  // overlap and stay within their superblock, which bounds the size.
+  const size_t luma_size =
+      (size_t)(sb_rows * sb_cols) << (2 * (MAX_MIB_SIZE_LOG2 + MI_SIZE_LOG2));
+  const size_t coeffs_size =
+      luma_size + (MAX_MB_PLANE - 1) *
+                      (luma_size >> (cm->subsampling_x + cm->subsampling_y));
+  int n;
+
+  if (sb_rows * sb_cols > pbi->parsed_sbs_size) {
+    aom_free(pbi->parsed_sbs);
+    pbi->parsed_sbs_size = 0;
+    CHECK_MEM_ERROR(
+        cm, pbi->parsed_sbs,
+        aom_malloc(sb_rows * sb_cols * sizeof(*pbi->parsed_sbs)));
+    pbi->parsed_sbs_size = sb_rows * sb_cols;
+  }
+  if (coeffs_size > pbi->parsed_coeffs_size) {
+    aom_free(pbi->parsed_coeffs);
+    aom_free(pbi->parsed_eobs);
+    pbi->parsed_eobs = NULL;
+    pbi->parsed_coeffs_size = 0;
+    CHECK_MEM_ERROR(cm, pbi->parsed_coeffs,
+                    aom_calloc(coeffs_size, sizeof(*pbi->parsed_coeffs)));
+    CHECK_MEM_ERROR(cm, pbi->parsed_eobs,
+                    aom_malloc(coeffs_size / tx_size_2d[0] *
+                               sizeof(*pbi->parsed_eobs)));
+    pbi->parsed_coeffs_size = coeffs_size;
+  } else if (pbi->row_mt_sync.aborted) {
+    // The last frame left coefficients that were never reconstructed.
+    memset(pbi->parsed_coeffs, 0,
+           pbi->parsed_coeffs_size * sizeof(*pbi->parsed_coeffs));
+  }
+
+  av1_dec_row_mt_sync_reset(&pbi->row_mt_sync, cm, sb_rows, sb_cols);
+  create_tile_workers(pbi);
+
+  for (n = 0; n < pbi->max_threads - 1; ++n) {
+    AVxWorker *const worker = &pbi->tile_workers[n];
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[n];
+    winterface->sync(worker);
+    worker->hook = (AVxWorkerHook)row_mt_worker_hook;
+    worker->data1 = tile_data;
+    worker->data2 = NULL;
+    worker->had_error = 0;
+    tile_data->pbi = pbi;
+    winterface->launch(worker);
+  }
+}
+
+// Sets up the parsed superblock at (mi_row, mi_col) to take its coefficients
+// from coeffs and eobs onwards.
+static ParsedSuperblock *row_mt_init_sb(AV1Decoder *pbi, int mi_row,
+                                        int mi_col, tran_low_t *coeffs,
+                                        uint16_t *eobs) {
+  ParsedSuperblock *const sb =
+      &pbi->parsed_sbs[(mi_row >> MAX_MIB_SIZE_LOG2) *
+                           pbi->row_mt_sync.sb_cols +
+                       (mi_col >> MAX_MIB_SIZE_LOG2)];
+  sb->num_blocks = 0;
+  sb->coeffs = coeffs;
+  sb->num_coeffs = 0;
+  sb->eobs = eobs;
+  sb->num_eobs = 0;
+  return sb;
+}
+
+// Post-filters the rows as the tile workers reconstruct them, keeping the
+// same lag of one superblock row as decode_tiles(), and waits for the workers
+// to finish.
+static void row_mt_finish(AV1Decoder *pbi, int post_filter) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int n;
+
+#if !CONFIG_PARALLEL_DEBLOCKING
+  if (post_filter) {
+    int mi_row;
+    for (mi_row = MAX_MIB_SIZE; mi_row + MAX_MIB_SIZE < cm->mi_rows;
+         mi_row += MAX_MIB_SIZE) {
+      if (!av1_dec_row_mt_wait_row(&pbi->row_mt_sync,
+                                   mi_row >> MAX_MIB_SIZE_LOG2))
+        break;
+      post_filter_rows(pbi, mi_row - MAX_MIB_SIZE, mi_row);
+    }
+  }
+#else
+  (void)post_filter;
+#endif  // !CONFIG_PARALLEL_DEBLOCKING
+
+  for (n = 0; n < pbi->max_threads - 1; ++n)
+    pbi->mb.corrupted |= !winterface->sync(&pbi->tile_workers[n]);
+  if (pbi->mb.corrupted)
+    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
+                       "Failed to decode tile data");
+}
+
 static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end) {
   AV1_COMMON *const cm = &pbi->common;
@@ -1455,24 +2080,28 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
   int tile_row, tile_col;
   int mi_row, mi_col;
   TileData *tile_data = NULL;
+  tran_low_t *parsed_coeffs = NULL;
+  uint16_t *parsed_eobs = NULL;
+
+  const int post_filter = post_filter_active(cm);
+  const int row_mt = use_row_mt(pbi);
 
-  if (cm->lf.filter_level && !cm->skip_loop_filter &&
-      pbi->lf_worker.data1 == NULL) {
+  if (post_filter && pbi->lf_worker.data1 == NULL) {
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
-                    aom_memalign(32, sizeof(LFWorkerData)));
-    pbi->lf_worker.hook = (AVxWorkerHook)av1_loop_filter_worker;
+                    aom_memalign(32, sizeof(PostFilterData)));
+    pbi->lf_worker.hook = (AVxWorkerHook)post_filter_worker;
+    aom_worker_set_pool(&pbi->lf_worker, pbi->thread_pool,
+                        pbi->thread_pool_priority);
     if (pbi->max_threads > 1 && !winterface->reset(&pbi->lf_worker)) {
       aom_internal_error(&cm->error, AOM_CODEC_ERROR,
                          "Loop filter thread creation failed");
     }
   }
 
-  if (cm->lf.filter_level && !cm->skip_loop_filter) {
-    LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+  if (post_filter) {
     // Be sure to sync as we might be resuming after a failed frame decode.
     winterface->sync(&pbi->lf_worker);
-    av1_loop_filter_data_reset(lf_data, get_frame_new_buffer(cm), cm,
-                               pbi->mb.plane);
+    post_filter_data_reset((PostFilterData *)pbi->lf_worker.data1, pbi);
   }
 
   assert(tile_rows <= 4);
@@ -1542,6 +2171,14 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     }
   }
 
+  // With row_mt the blocks are only parsed here, and the tile workers
+  // predict and reconstruct each superblock row once it has been parsed.
+  if (row_mt) {
+    row_mt_start(pbi);
+    parsed_coeffs = pbi->parsed_coeffs;
+    parsed_eobs = pbi->parsed_eobs;
+  }
+
   for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
     TileInfo tile;
     av1_tile_set_row(&tile, cm, tile_row);
@@ -1562,8 +2199,16 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
         av1_zero(tile_data->xd.left_seg_context);
         for (mi_col = tile.mi_col_start; mi_col < tile.mi_col_end;
              mi_col += MAX_MIB_SIZE) {
+          ParsedSuperblock *const sb =
+              row_mt ? row_mt_init_sb(pbi, mi_row, mi_col, parsed_coeffs,
+                                      parsed_eobs)
+                     : NULL;
           decode_partition(pbi, &tile_data->xd, mi_row, mi_col,
-                           &tile_data->bit_reader, BLOCK_64X64, 4);
+                           &tile_data->bit_reader, BLOCK_64X64, 4, sb);
+          if (sb) {
+            parsed_coeffs += sb->num_coeffs;
+            parsed_eobs += sb->num_eobs;
+          }
         }
         pbi->mb.corrupted |= tile_data->xd.corrupted;
         if (pbi->mb.corrupted)
@@ -1571,14 +2216,19 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
                              "Failed to decode tile data");
       }
 
+      if (row_mt) {
+        av1_dec_row_mt_set_parsed(&pbi->row_mt_sync,
+                                  (mi_row >> MAX_MIB_SIZE_LOG2) + 1);
+        continue;
+      }
+
 // when Parallel deblocking is enabled, deblocking should not
 // be interleaved with decoding. Instead, deblocking should be done
 // after the entire frame is decoded.
 #if !CONFIG_PARALLEL_DEBLOCKING
-      // Loopfilter one row.
-      if (cm->lf.filter_level && !cm->skip_loop_filter) {
+      // Loopfilter and post-filter one row.
+      if (post_filter) {
         const int lf_start = mi_row - MAX_MIB_SIZE;
-        LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
 
         // delay the loopfilter by 1 macroblock row.
         if (lf_start < 0) continue;
@@ -1586,42 +2236,42 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
         // decoding has completed: finish up the loop filter in this thread.
         if (mi_row + MAX_MIB_SIZE >= cm->mi_rows) continue;
 
-        winterface->sync(&pbi->lf_worker);
-        lf_data->start = lf_start;
-        lf_data->stop = mi_row;
-        if (pbi->max_threads > 1) {
-          winterface->launch(&pbi->lf_worker);
-        } else {
-          winterface->execute(&pbi->lf_worker);
-        }
+        post_filter_rows(pbi, lf_start, mi_row);
       }
 // After loopfiltering, the last 7 row pixels in each superblock row may
 // still be changed by the longest loopfilter of the next superblock
 // row.
 #endif  // !CONFIG_PARALLEL_DEBLOCKING
 
-      if (cm->frame_parallel_decode)
-        av1_frameworker_broadcast(pbi->cur_buf, mi_row << MAX_MIB_SIZE_LOG2);
+      // Without post filters the rows are final once reconstructed. Otherwise
+      // post_filter_worker() broadcasts the progress.
+      if (cm->frame_parallel_decode && !post_filter)
+        av1_frameworker_broadcast(pbi->cur_buf,
+                                  (mi_row + MAX_MIB_SIZE) * MI_SIZE);
     }
   }
 
+  if (row_mt) row_mt_finish(pbi, post_filter);
+
 #if CONFIG_ACCOUNTING
 // aom_accounting_dump(&pbi->accounting);
 #endif
 
 #if CONFIG_PARALLEL_DEBLOCKING
-  // Loopfilter all rows in the frame in the frame.
-  if (cm->lf.filter_level && !cm->skip_loop_filter) {
-    LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+  // Loopfilter and post-filter all rows in the frame.
+  if (post_filter) {
+    LFWorkerData *const lf_data =
+        &((PostFilterData *)pbi->lf_worker.data1)->lf;
     winterface->sync(&pbi->lf_worker);
     lf_data->start = 0;
     lf_data->stop = cm->mi_rows;
     winterface->execute(&pbi->lf_worker);
   }
 #else
-  // Loopfilter remaining rows in the frame.
-  if (cm->lf.filter_level && !cm->skip_loop_filter) {
-    LFWorkerData *const lf_data = (LFWorkerData *)pbi->lf_worker.data1;
+  // Loopfilter and post-filter remaining rows in the frame.
+  if (post_filter) {
+    LFWorkerData *const lf_data =
+        &((PostFilterData *)pbi->lf_worker.data1)->lf;
     winterface->sync(&pbi->lf_worker);
     lf_data->start = lf_data->stop;
     lf_data->stop = cm->mi_rows;
@@ -1632,8 +2282,6 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
   // Get last tile data.
   tile_data = pbi->tile_data + tile_cols * tile_rows - 1;
 
-  if (cm->frame_parallel_decode)
-    av1_frameworker_broadcast(pbi->cur_buf, INT_MAX);
 #if CONFIG_ANS
   return data_end;
 #else
@@ -1641,9 +2289,45 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
 #endif
 }
 
+static void tile_worker_init_tile(TileWorkerData *const tile_data,
+                                  const TileBuffer *const buf, int tile_row) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+
+  tile_data->xd = pbi->mb;
+  tile_data->xd.corrupted = 0;
+  tile_data->xd.error_info = &tile_data->error_info;
+  tile_data->xd.counts =
+      cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD
+          ? &tile_data->counts
+          : NULL;
+  av1_zero(tile_data->dqcoeff);
+#if CONFIG_PVQ
+  av1_zero(tile_data->pvq_ref_coeff);
+#endif
+  av1_tile_init(&tile_data->xd.tile, cm, tile_row, buf->col);
+  setup_token_decoder(buf->data, tile_data->data_end, buf->size,
+                      &tile_data->error_info, &tile_data->bit_reader,
+                      pbi->decrypt_cb, pbi->decrypt_state);
+  av1_init_macroblockd(cm, &tile_data->xd,
+#if CONFIG_PVQ
+                       tile_data->pvq_ref_coeff,
+#endif
+                       tile_data->dqcoeff);
+#if CONFIG_PVQ
+  daala_dec_init(&tile_data->xd.daala_dec, &tile_data->bit_reader.ec);
+#endif
+#if CONFIG_PALETTE
+  tile_data->xd.plane[0].color_index_map = tile_data->color_index_map[0];
+  tile_data->xd.plane[1].color_index_map = tile_data->color_index_map[1];
+#endif  // CONFIG_PALETTE
+}
+
 static int tile_worker_hook(TileWorkerData *const tile_data,
-                            const TileInfo *const tile) {
-  int mi_row, mi_col;
+                            TileInfo *const tile) {
+  AV1_COMMON *const cm = &tile_data->pbi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  int i, tile_row, mi_row, mi_col;
 
   if (setjmp(tile_data->error_info.jmp)) {
     tile_data->error_info.setjmp = 0;
@@ -1652,19 +2336,34 @@ static int tile_worker_hook(TileWorkerData *const tile_data,
   }
 
   tile_data->error_info.setjmp = 1;
-  tile_data->xd.error_info = &tile_data->error_info;
 
-  for (mi_row = tile->mi_row_start; mi_row < tile->mi_row_end;
-       mi_row += MAX_MIB_SIZE) {
-    av1_zero(tile_data->xd.left_context);
-    av1_zero(tile_data->xd.left_seg_context);
-    for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
-         mi_col += MAX_MIB_SIZE) {
-      decode_partition(tile_data->pbi, &tile_data->xd, mi_row, mi_col,
-                       &tile_data->bit_reader, BLOCK_64X64, 4);
+  for (i = 0; i < tile_data->num_tile_cols; ++i) {
+    const int tile_col = tile_data->tile_cols[i];
+    for (tile_row = 0; tile_row < tile_data->tile_rows; ++tile_row) {
+      tile_worker_init_tile(tile_data,
+                            &tile_data->tile_buffers[tile_row][tile_col],
+                            tile_row);
+      av1_tile_init(tile, cm, tile_row, tile_col);
+      for (mi_row = tile->mi_row_start; mi_row < tile->mi_row_end;
+           mi_row += MAX_MIB_SIZE) {
+        av1_zero(tile_data->xd.left_context);
+        av1_zero(tile_data->xd.left_seg_context);
+        for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
+             mi_col += MAX_MIB_SIZE) {
+          decode_partition(tile_data->pbi, &tile_data->xd, mi_row, mi_col,
+                           &tile_data->bit_reader, BLOCK_64X64, 4, NULL);
+        }
+      }
+      if (tile_data->xd.corrupted) {
+        tile_data->error_info.setjmp = 0;
+        return 0;
+      }
+      if (tile_row == tile_data->tile_rows - 1 && tile_col == tile_cols - 1)
+        tile_data->bit_reader_end = aom_reader_find_end(&tile_data->bit_reader);
     }
   }
-  return !tile_data->xd.corrupted;
+  tile_data->error_info.setjmp = 0;
+  return 1;
 }
 
 // sorts in descending order
@@ -1682,49 +2381,32 @@ static const uint8_t *decode_tiles_mt(AV1Decoder *pbi, const uint8_t *data,
   const int aligned_mi_cols = mi_cols_aligned_to_sb(cm->mi_cols);
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
-  const int num_workers = AOMMIN(pbi->max_threads & ~1, tile_cols);
-  TileBuffer tile_buffers[1][1 << 6];
-  int n;
-  int final_worker = -1;
+  const int num_workers = AOMMIN(pbi->max_threads, tile_cols);
+  TileBuffer tile_buffers[4][1 << 6];
+  TileBuffer col_buffers[1 << 6];
+  size_t worker_load[1 << 6];
+  int n, tile_row, tile_col;
 
   assert(tile_cols <= (1 << 6));
-  assert(tile_rows == 1);
-  (void)tile_rows;
-
-  // TODO(jzern): See if we can remove the restriction of passing in max
-  // threads to the decoder.
-  if (pbi->num_tile_workers == 0) {
-    const int num_threads = pbi->max_threads & ~1;
-    int i;
-    CHECK_MEM_ERROR(cm, pbi->tile_workers,
-                    aom_malloc(num_threads * sizeof(*pbi->tile_workers)));
-    // Ensure tile data offsets will be properly aligned. This may fail on
-    // platforms without DECLARE_ALIGNED().
-    assert((sizeof(*pbi->tile_worker_data) % 16) == 0);
-    CHECK_MEM_ERROR(
-        cm, pbi->tile_worker_data,
-        aom_memalign(32, num_threads * sizeof(*pbi->tile_worker_data)));
-    CHECK_MEM_ERROR(cm, pbi->tile_worker_info,
-                    aom_malloc(num_threads * sizeof(*pbi->tile_worker_info)));
-    for (i = 0; i < num_threads; ++i) {
-      AVxWorker *const worker = &pbi->tile_workers[i];
-      ++pbi->num_tile_workers;
+  assert(tile_rows <= 4);
 
-      winterface->init(worker);
-      if (i < num_threads - 1 && !winterface->reset(worker)) {
-        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                           "Tile decoder thread creation failed");
-      }
-    }
-  }
+  create_tile_workers(pbi);
 
   // Reset tile decoding hook
   for (n = 0; n < num_workers; ++n) {
     AVxWorker *const worker = &pbi->tile_workers[n];
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[n];
     winterface->sync(worker);
     worker->hook = (AVxWorkerHook)tile_worker_hook;
-    worker->data1 = &pbi->tile_worker_data[n];
+    worker->data1 = tile_data;
     worker->data2 = &pbi->tile_worker_info[n];
+    tile_data->pbi = pbi;
+    tile_data->num_tile_cols = 0;
+    tile_data->tile_rows = tile_rows;
+    tile_data->tile_buffers = tile_buffers;
+    tile_data->data_end = data_end;
+    tile_data->bit_reader_end = NULL;
+    worker_load[n] = 0;
   }
 
   // Note: this memset assumes above_context[0], [1] and [2]
@@ -1737,110 +2419,59 @@ static const uint8_t *decode_tiles_mt(AV1Decoder *pbi, const uint8_t *data,
   // Load tile data into tile_buffers
   get_tile_buffers(pbi, data, data_end, tile_cols, tile_rows, tile_buffers);
 
-  // Sort the buffers based on size in descending order.
-  qsort(tile_buffers[0], tile_cols, sizeof(tile_buffers[0][0]),
-        compare_tile_buffers);
-
-  // Rearrange the tile buffers such that per-tile group the largest, and
-  // presumably the most difficult, tile will be decoded in the main thread.
-  // This should help minimize the number of instances where the main thread is
-  // waiting for a worker to complete.
-  {
-    int group_start = 0;
-    while (group_start < tile_cols) {
-      const TileBuffer largest = tile_buffers[0][group_start];
-      const int group_end = AOMMIN(group_start + num_workers, tile_cols) - 1;
-      memmove(tile_buffers[0] + group_start, tile_buffers[0] + group_start + 1,
-              (group_end - group_start) * sizeof(tile_buffers[0][0]));
-      tile_buffers[0][group_end] = largest;
-      group_start = group_end + 1;
-    }
+  // Tile columns are independent of each other, but every tile continues the
+  // above context left by the tile above it, so a worker decodes whole tile
+  // columns. Hand out the columns largest first, each to the worker with the
+  // least data so far, to balance the load. The largest column goes to the
+  // last worker, which runs in the main thread.
+  for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+    col_buffers[tile_col].col = tile_col;
+    col_buffers[tile_col].size = 0;
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+      col_buffers[tile_col].size += tile_buffers[tile_row][tile_col].size;
+  }
+  qsort(col_buffers, tile_cols, sizeof(col_buffers[0]), compare_tile_buffers);
+  for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+    TileWorkerData *tile_data;
+    int i, best = num_workers - 1;
+    for (i = num_workers - 2; i >= 0; --i)
+      if (worker_load[i] < worker_load[best]) best = i;
+    tile_data = &pbi->tile_worker_data[best];
+    tile_data->tile_cols[tile_data->num_tile_cols++] =
+        col_buffers[tile_col].col;
+    worker_load[best] += col_buffers[tile_col].size;
   }
 
   // Initialize thread frame counts.
   if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
-    int i;
-
-    for (i = 0; i < num_workers; ++i) {
-      TileWorkerData *const tile_data =
-          (TileWorkerData *)pbi->tile_workers[i].data1;
-      av1_zero(tile_data->counts);
-    }
+    for (n = 0; n < num_workers; ++n)
+      av1_zero(pbi->tile_worker_data[n].counts);
   }
 
-  n = 0;
-  while (n < tile_cols) {
-    int i;
-    for (i = 0; i < num_workers && n < tile_cols; ++i) {
-      AVxWorker *const worker = &pbi->tile_workers[i];
-      TileWorkerData *const tile_data = (TileWorkerData *)worker->data1;
-      TileInfo *const tile = (TileInfo *)worker->data2;
-      TileBuffer *const buf = &tile_buffers[0][n];
-
-      tile_data->pbi = pbi;
-      tile_data->xd = pbi->mb;
-      tile_data->xd.corrupted = 0;
-      tile_data->xd.counts =
-          cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD
-              ? &tile_data->counts
-              : NULL;
-      av1_zero(tile_data->dqcoeff);
-      av1_tile_init(tile, cm, 0, buf->col);
-      av1_tile_init(&tile_data->xd.tile, cm, 0, buf->col);
-      setup_token_decoder(buf->data, data_end, buf->size, &cm->error,
-                          &tile_data->bit_reader, pbi->decrypt_cb,
-                          pbi->decrypt_state);
-      av1_init_macroblockd(cm, &tile_data->xd,
-#if CONFIG_PVQ
-                           tile_data->pvq_ref_coeff,
-#endif
-                           tile_data->dqcoeff);
-#if CONFIG_PVQ
-      daala_dec_init(&tile_data->xd.daala_dec, &tile_data->bit_reader.ec);
-#endif
-#if CONFIG_PALETTE
-      tile_data->xd.plane[0].color_index_map = tile_data->color_index_map[0];
-      tile_data->xd.plane[1].color_index_map = tile_data->color_index_map[1];
-#endif  // CONFIG_PALETTE
-
-      worker->had_error = 0;
-      if (i == num_workers - 1 || n == tile_cols - 1) {
-        winterface->execute(worker);
-      } else {
-        winterface->launch(worker);
-      }
-
-      if (buf->col == tile_cols - 1) {
-        final_worker = i;
-      }
-
-      ++n;
-    }
+  for (n = 0; n < num_workers; ++n) {
+    AVxWorker *const worker = &pbi->tile_workers[n];
+    worker->had_error = 0;
+    if (n == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
 
-    for (; i > 0; --i) {
-      AVxWorker *const worker = &pbi->tile_workers[i - 1];
-      // TODO(jzern): The tile may have specific error data associated with
-      // its aom_internal_error_info which could be propagated to the main info
-      // in cm. Additionally once the threads have been synced and an error is
-      // detected, there's no point in continuing to decode tiles.
-      pbi->mb.corrupted |= !winterface->sync(worker);
-    }
-    if (final_worker > -1) {
-      TileWorkerData *const tile_data =
-          (TileWorkerData *)pbi->tile_workers[final_worker].data1;
-      bit_reader_end = aom_reader_find_end(&tile_data->bit_reader);
-      final_worker = -1;
-    }
+  for (n = 0; n < num_workers; ++n) {
+    AVxWorker *const worker = &pbi->tile_workers[n];
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[n];
+    // TODO(jzern): The tile may have specific error data associated with
+    // its aom_internal_error_info which could be propagated to the main info
+    // in cm. Additionally once the threads have been synced and an error is
+    // detected, there's no point in continuing to decode tiles.
+    pbi->mb.corrupted |= !winterface->sync(worker);
+    if (tile_data->bit_reader_end) bit_reader_end = tile_data->bit_reader_end;
+  }
 
-    // Accumulate thread frame counts.
-    if (n >= tile_cols &&
-        cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
-      for (i = 0; i < num_workers; ++i) {
-        TileWorkerData *const tile_data =
-            (TileWorkerData *)pbi->tile_workers[i].data1;
-        av1_accumulate_frame_counts(cm, &tile_data->counts, 1);
-      }
-    }
+  // Accumulate thread frame counts.
+  if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
+    for (n = 0; n < num_workers; ++n)
+      av1_accumulate_frame_counts(cm, &pbi->tile_worker_data[n].counts, 1);
   }
 
   return bit_reader_end;
@@ -2490,8 +3121,6 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
   struct aom_read_bit_buffer rb;
   int context_updated = 0;
   uint8_t clear_data[MAX_AV1_HEADER_SIZE];
-  const int tile_rows = 1 << cm->log2_tile_rows;
-  const int tile_cols = 1 << cm->log2_tile_cols;
   int early_terminate;
   YV12_BUFFER_CONFIG *const new_fb = get_frame_new_buffer(cm);
   xd->cur_buf = new_fb;
@@ -2549,7 +3178,7 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
       cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
     }
     av1_frameworker_lock_stats(worker);
-    pbi->cur_buf->row = -1;
+    aom_atomic_store(&pbi->cur_buf->row, -1);
     pbi->cur_buf->col = -1;
     frame_worker_data->frame_context_ready = 1;
     // Signal the main thread that context is ready.
@@ -2557,7 +3186,7 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
     av1_frameworker_unlock_stats(worker);
   }
 
-  if (pbi->max_threads > 1 && tile_rows == 1 && tile_cols > 1) {
+  if (pbi->max_threads > 1 && cm->log2_tile_cols > 0) {
     // Multi-threaded tile decoder
     *p_data_end = decode_tiles_mt(pbi, data, data_end);
     if (!xd->corrupted) {
@@ -2572,35 +3201,43 @@ void av1_decode_frame(AV1Decoder *pbi, const uint8_t *data,
       aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
                          "Decode failed. Frame data is corrupted.");
     }
-  } else {
-    *p_data_end = decode_tiles(pbi, data, data_end);
-  }
-
 #if CONFIG_DERING
-  if (cm->dering_level && !cm->skip_loop_filter) {
-    av1_dering_frame(&pbi->cur_buf->buf, cm, &pbi->mb, cm->dering_level);
-  }
+    if (cm->dering_level && !cm->skip_loop_filter) {
+      // Dering superblock rows in parallel on the tile workers.
+      av1_dering_frame_mt(&pbi->cur_buf->buf, cm, &pbi->mb, cm->dering_level,
+                          pbi->tile_workers, pbi->num_tile_workers);
+    }
 #endif  // CONFIG_DERING
-
 #if CONFIG_CLPF
-  if (!cm->skip_loop_filter) {
-    const YV12_BUFFER_CONFIG *const frame = &pbi->cur_buf->buf;
-    if (cm->clpf_strength_y) {
-      av1_clpf_frame(frame, NULL, cm, cm->clpf_size != CLPF_NOSIZE,
-                     cm->clpf_strength_y + (cm->clpf_strength_y == 3),
-                     4 + cm->clpf_size, AOM_PLANE_Y, clpf_bit);
-    }
-    if (cm->clpf_strength_u) {
-      av1_clpf_frame(frame, NULL, cm, 0,  // No block signals for chroma
-                     cm->clpf_strength_u + (cm->clpf_strength_u == 3), 4,
-                     AOM_PLANE_U, NULL);
-    }
-    if (cm->clpf_strength_v) {
-      av1_clpf_frame(frame, NULL, cm, 0,  // No block signals for chroma
-                     cm->clpf_strength_v + (cm->clpf_strength_v == 3), 4,
-                     AOM_PLANE_V, NULL);
+    if (!cm->skip_loop_filter) {
+      const YV12_BUFFER_CONFIG *const frame = &pbi->cur_buf->buf;
+      // Filter rows of filter blocks in parallel on the tile workers.
+      if (cm->clpf_strength_y) {
+        av1_clpf_frame_mt(frame, NULL, cm, cm->clpf_size != CLPF_NOSIZE,
+                          cm->clpf_strength_y + (cm->clpf_strength_y == 3),
+                          4 + cm->clpf_size, AOM_PLANE_Y, clpf_bit,
+                          pbi->tile_workers, pbi->num_tile_workers);
+      }
+      if (cm->clpf_strength_u) {
+        av1_clpf_frame_mt(frame, NULL, cm, 0,  // No block signals for chroma
+                          cm->clpf_strength_u + (cm->clpf_strength_u == 3), 4,
+                          AOM_PLANE_U, NULL, pbi->tile_workers,
+                          pbi->num_tile_workers);
+      }
+      if (cm->clpf_strength_v) {
+        av1_clpf_frame_mt(frame, NULL, cm, 0,  // No block signals for chroma
+                          cm->clpf_strength_v + (cm->clpf_strength_v == 3), 4,
+                          AOM_PLANE_V, NULL, pbi->tile_workers,
+                          pbi->num_tile_workers);
+      }
     }
+#endif  // CONFIG_CLPF
+  } else {
+    // Deblocking, deringing and CLPF run row by row along with the decoding.
+    *p_data_end = decode_tiles(pbi, data, data_end);
   }
+
+#if CONFIG_CLPF
   if (cm->clpf_blocks) aom_free(cm->clpf_blocks);
 #endif
 
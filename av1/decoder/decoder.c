@@ -136,6 +136,7 @@ AV1Decoder *av1_decoder_create(BufferPool *const pool) {
   cm->error.setjmp = 0;
 
   aom_get_worker_interface()->init(&pbi->lf_worker);
+  av1_dec_row_mt_sync_init(&pbi->row_mt_sync);
 
   return pbi;
 }
@@ -159,6 +160,10 @@ void av1_decoder_remove(AV1Decoder *pbi) {
   if (pbi->num_tile_workers > 0) {
     av1_loop_filter_dealloc(&pbi->lf_row_sync);
   }
+  av1_dec_row_mt_sync_dealloc(&pbi->row_mt_sync);
+  aom_free(pbi->parsed_sbs);
+  aom_free(pbi->parsed_coeffs);
+  aom_free(pbi->parsed_eobs);
 
 #if CONFIG_ACCOUNTING
   aom_accounting_clear(&pbi->accounting);
@@ -167,6 +172,21 @@ void av1_decoder_remove(AV1Decoder *pbi) {
   aom_free(pbi);
 }
 
+int av1_decoder_set_thread_pool(AV1Decoder *pbi, AVxThreadPool *pool,
+                                int priority) {
+  int i;
+  int ok = aom_worker_set_pool(&pbi->lf_worker, pool, priority);
+
+  pbi->thread_pool = pool;
+  pbi->thread_pool_priority = priority;
+
+  // The last tile worker is the main thread.
+  for (i = 0; i < pbi->num_tile_workers - 1; ++i)
+    ok &= aom_worker_set_pool(&pbi->tile_workers[i], pool, priority);
+
+  return ok;
+}
+
 static int equal_dimensions(const YV12_BUFFER_CONFIG *a,
                             const YV12_BUFFER_CONFIG *b) {
   return a->y_height == b->y_height && a->y_width == b->y_width &&
@@ -363,7 +383,7 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     frame_bufs[cm->new_fb_idx].frame_worker_owner = worker;
     // Reset decoding progress.
     pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
-    pbi->cur_buf->row = -1;
+    aom_atomic_store(&pbi->cur_buf->row, -1);
     pbi->cur_buf->col = -1;
     av1_frameworker_unlock_stats(worker);
   } else {
@@ -378,7 +398,9 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     pbi->ready_for_new_data = 1;
 
     // Synchronize all threads immediately as a subsequent decode call may
-    // cause a resize invalidating some allocations.
+    // cause a resize invalidating some allocations. Superblock row workers
+    // may be waiting for rows that will never be parsed.
+    av1_dec_row_mt_abort(&pbi->row_mt_sync);
     winterface->sync(&pbi->lf_worker);
     for (i = 0; i < pbi->num_tile_workers; ++i) {
       winterface->sync(&pbi->tile_workers[i]);
@@ -429,6 +451,11 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 
   aom_extend_frame_inner_borders(cm->frame_to_show);
 
+  // The other workers may now read the frame as a reference, borders
+  // included.
+  if (cm->frame_parallel_decode && !cm->show_existing_frame)
+    av1_frameworker_broadcast(pbi->cur_buf, INT_MAX);
+
   aom_clear_system_state();
 
   if (!cm->show_existing_frame) {
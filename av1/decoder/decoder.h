@@ -52,8 +52,47 @@ typedef struct TileData {
 #endif  // CONFIG_PALETTE
 } TileData;
 
+typedef struct TileBuffer {
+  const uint8_t *data;
+  size_t size;
+  int col;  // only used with multi-threaded decoding
+} TileBuffer;
+
+// A block parsed by the first pass of the superblock row multithreaded
+// decoder, to be reconstructed by the second.
+typedef struct ParsedBlock {
+  int mi_row;
+  int mi_col;
+  BLOCK_SIZE bsize;
+  uint8_t bwl;
+  uint8_t bhl;
+  uint8_t bmode_blocks_wl;
+  uint8_t bmode_blocks_hl;
+} ParsedBlock;
+
+// The parsed blocks of a superblock in decoding order. The end of block
+// positions of their transform blocks, and the dequantized coefficients of
+// those with any, are stored in the same order starting at eobs and coeffs.
+typedef struct ParsedSuperblock {
+  ParsedBlock blocks[MAX_MIB_SIZE * MAX_MIB_SIZE];
+  int num_blocks;
+  tran_low_t *coeffs;
+  int num_coeffs;
+  uint16_t *eobs;
+  int num_eobs;
+} ParsedSuperblock;
+
 typedef struct TileWorkerData {
   struct AV1Decoder *pbi;
+  // Tile columns assigned to this worker by decode_tiles_mt(), in decoding
+  // order. Each column is decoded from its top tile row to its bottom one.
+  int num_tile_cols;
+  int tile_cols[1 << 6];
+  int tile_rows;
+  TileBuffer (*tile_buffers)[1 << 6];
+  const uint8_t *data_end;
+  // Set to the end of the last tile of the frame if this worker decoded it.
+  const uint8_t *bit_reader_end;
   aom_reader bit_reader;
   FRAME_COUNTS counts;
   DECLARE_ALIGNED(16, MACROBLOCKD, xd);
@@ -88,12 +127,23 @@ typedef struct AV1Decoder {
   TileWorkerData *tile_worker_data;
   TileInfo *tile_worker_info;
   int num_tile_workers;
+  // Pool the tile and loop filter workers run on, or NULL.
+  AVxThreadPool *thread_pool;
+  int thread_pool_priority;
 
   TileData *tile_data;
   int total_tiles;
 
   AV1LfSync lf_row_sync;
 
+  // Superblock row multithreaded decoding, see decode_tiles().
+  AV1DecRowMTSync row_mt_sync;
+  ParsedSuperblock *parsed_sbs;
+  int parsed_sbs_size;
+  tran_low_t *parsed_coeffs;
+  uint16_t *parsed_eobs;
+  size_t parsed_coeffs_size;
+
   aom_decrypt_cb decrypt_cb;
   void *decrypt_state;
 
@@ -148,6 +198,12 @@ struct AV1Decoder *av1_decoder_create(BufferPool *const pool);
 
 void av1_decoder_remove(struct AV1Decoder *pbi);
 
+// Moves the tile and loop filter workers to pool, or back to threads of their
+// own if pool is NULL, along with the workers created later. Returns 0 if a
+// thread could not be created.
+int av1_decoder_set_thread_pool(struct AV1Decoder *pbi, AVxThreadPool *pool,
+                                int priority);
+
 static INLINE void decrease_ref_count(int idx, RefCntBuffer *const frame_bufs,
                                       BufferPool *const pool) {
   if (idx >= 0) {
@@ -39,14 +39,7 @@ void av1_frameworker_unlock_stats(AVxWorker *const worker) {
 void av1_frameworker_signal_stats(AVxWorker *const worker) {
 #if CONFIG_MULTITHREAD
   FrameWorkerData *const worker_data = worker->data1;
-
-// TODO(hkuang): Fix the pthread_cond_broadcast in windows wrapper.
-#if defined(_WIN32) && !HAVE_PTHREAD_H
-  pthread_cond_signal(&worker_data->stats_cond);
-#else
   pthread_cond_broadcast(&worker_data->stats_cond);
-#endif
-
 #else
   (void)worker;
 #endif
@@ -66,9 +59,10 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
   if (!ref_buf) return;
 
 #ifndef BUILDING_WITH_TSAN
-  // The following line of code will get harmless tsan error but it is the key
-  // to get best performance.
-  if (ref_buf->row >= row && ref_buf->buf.corrupted != 1) return;
+  // The following line of code will get harmless tsan error on corrupted but
+  // it is the key to get best performance.
+  if (aom_atomic_load(&ref_buf->row) >= row && ref_buf->buf.corrupted != 1)
+    return;
 #endif
 
   {
@@ -84,16 +78,20 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
       FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
       printf("%d %p worker is waiting for %d %p worker (%d)  ref %d \r\n",
              worker_data->worker_id, worker, ref_worker_data->worker_id,
-             ref_buf->frame_worker_owner, row, ref_buf->row);
+             ref_buf->frame_worker_owner, row, aom_atomic_load(&ref_buf->row));
     }
 #endif
 
+    // The waiter count is raised before the progress is read again, so either
+    // av1_frameworker_broadcast() sees it and signals, or this sees the row.
     av1_frameworker_lock_stats(ref_worker);
-    while (ref_buf->row < row && pbi->cur_buf == ref_buf &&
+    aom_atomic_add(&ref_worker_data->progress_waiters, 1);
+    while (aom_atomic_load(&ref_buf->row) < row && pbi->cur_buf == ref_buf &&
            ref_buf->buf.corrupted != 1) {
       pthread_cond_wait(&ref_worker_data->stats_cond,
                         &ref_worker_data->stats_mutex);
     }
+    aom_atomic_add(&ref_worker_data->progress_waiters, -1);
 
     if (ref_buf->buf.corrupted == 1) {
       FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
@@ -115,19 +113,19 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
 void av1_frameworker_broadcast(RefCntBuffer *const buf, int row) {
 #if CONFIG_MULTITHREAD
   AVxWorker *worker = buf->frame_worker_owner;
+  FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
 
 #ifdef DEBUG_THREAD
-  {
-    FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
-    printf("%d %p worker decode to (%d) \r\n", worker_data->worker_id,
-           buf->frame_worker_owner, row);
-  }
+  printf("%d %p worker decode to (%d) \r\n", worker_data->worker_id,
+         buf->frame_worker_owner, row);
 #endif
 
-  av1_frameworker_lock_stats(worker);
-  buf->row = row;
-  av1_frameworker_signal_stats(worker);
-  av1_frameworker_unlock_stats(worker);
+  aom_atomic_store(&buf->row, row);
+  if (aom_atomic_load(&worker_data->progress_waiters)) {
+    av1_frameworker_lock_stats(worker);
+    av1_frameworker_signal_stats(worker);
+    av1_frameworker_unlock_stats(worker);
+  }
 #else
   (void)buf;
   (void)row;
@@ -192,3 +190,175 @@ void av1_frameworker_copy_context(AVxWorker *const dst_worker,
   (void)src_worker;
 #endif  // CONFIG_MULTITHREAD
 }
+
+void av1_dec_row_mt_sync_init(AV1DecRowMTSync *sync) {
+  memset(sync, 0, sizeof(*sync));
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&sync->mutex, NULL);
+  pthread_cond_init(&sync->cond, NULL);
+#endif
+}
+
+static void row_mt_free_rows(AV1DecRowMTSync *sync) {
+#if CONFIG_MULTITHREAD
+  int i;
+  if (sync->row_mutex != NULL) {
+    for (i = 0; i < sync->alloc_rows; ++i)
+      pthread_mutex_destroy(&sync->row_mutex[i]);
+    aom_free(sync->row_mutex);
+    sync->row_mutex = NULL;
+  }
+  if (sync->row_cond != NULL) {
+    for (i = 0; i < sync->alloc_rows; ++i)
+      pthread_cond_destroy(&sync->row_cond[i]);
+    aom_free(sync->row_cond);
+    sync->row_cond = NULL;
+  }
+#endif  // CONFIG_MULTITHREAD
+  aom_free(sync->recon_sb_cols);
+  sync->recon_sb_cols = NULL;
+  sync->alloc_rows = 0;
+}
+
+void av1_dec_row_mt_sync_dealloc(AV1DecRowMTSync *sync) {
+  row_mt_free_rows(sync);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&sync->mutex);
+  pthread_cond_destroy(&sync->cond);
+#endif
+}
+
+void av1_dec_row_mt_sync_reset(AV1DecRowMTSync *sync, AV1_COMMON *cm,
+                               int sb_rows, int sb_cols) {
+  if (sb_rows > sync->alloc_rows) {
+    row_mt_free_rows(sync);
+    // The frame is not decoded by any worker yet, so abort() must not see
+    // rows that are not allocated.
+    sync->sb_rows = 0;
+    CHECK_MEM_ERROR(cm, sync->recon_sb_cols,
+                    aom_malloc(sb_rows * sizeof(*sync->recon_sb_cols)));
+#if CONFIG_MULTITHREAD
+    {
+      int i;
+      CHECK_MEM_ERROR(cm, sync->row_mutex,
+                      aom_malloc(sb_rows * sizeof(*sync->row_mutex)));
+      CHECK_MEM_ERROR(cm, sync->row_cond,
+                      aom_malloc(sb_rows * sizeof(*sync->row_cond)));
+      for (i = 0; i < sb_rows; ++i) {
+        pthread_mutex_init(&sync->row_mutex[i], NULL);
+        pthread_cond_init(&sync->row_cond[i], NULL);
+      }
+    }
+#endif  // CONFIG_MULTITHREAD
+    sync->alloc_rows = sb_rows;
+  }
+  memset(sync->recon_sb_cols, 0, sb_rows * sizeof(*sync->recon_sb_cols));
+  sync->sb_rows = sb_rows;
+  sync->sb_cols = sb_cols;
+  sync->sync_range = av1_get_sync_range(cm->width);
+  sync->parsed_rows = 0;
+  sync->next_row = 0;
+  sync->aborted = 0;
+}
+
+void av1_dec_row_mt_set_parsed(AV1DecRowMTSync *sync, int rows) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&sync->mutex);
+  sync->parsed_rows = rows;
+  pthread_cond_broadcast(&sync->cond);
+  pthread_mutex_unlock(&sync->mutex);
+#else
+  sync->parsed_rows = rows;
+#endif  // CONFIG_MULTITHREAD
+}
+
+int av1_dec_row_mt_next_row(AV1DecRowMTSync *sync) {
+  int r;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&sync->mutex);
+#endif
+  r = sync->aborted || sync->next_row >= sync->sb_rows ? -1 : sync->next_row++;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&sync->mutex);
+#endif
+  return r;
+}
+
+int av1_dec_row_mt_sync_read(AV1DecRowMTSync *sync, int r, int c) {
+  const int nsync = sync->sync_range;
+  // The superblocks up to the next synchronization need the above right
+  // superblock of the last of them.
+  const int above_cols = AOMMIN(c + nsync + 1, sync->sb_cols);
+  int ok = 1;
+#if CONFIG_MULTITHREAD
+  if (c == 0) {
+    pthread_mutex_lock(&sync->mutex);
+    while (!sync->aborted && sync->parsed_rows <= r)
+      pthread_cond_wait(&sync->cond, &sync->mutex);
+    ok = !sync->aborted;
+    pthread_mutex_unlock(&sync->mutex);
+  }
+  if (ok && r > 0 && !(c & (nsync - 1))) {
+    pthread_mutex_t *const mutex = &sync->row_mutex[r - 1];
+    pthread_mutex_lock(mutex);
+    while (!sync->aborted && sync->recon_sb_cols[r - 1] < above_cols)
+      pthread_cond_wait(&sync->row_cond[r - 1], mutex);
+    ok = !sync->aborted;
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  ok = !sync->aborted && sync->parsed_rows > r &&
+       (r == 0 || sync->recon_sb_cols[r - 1] >= above_cols);
+#endif  // CONFIG_MULTITHREAD
+  return ok;
+}
+
+void av1_dec_row_mt_sync_write(AV1DecRowMTSync *sync, int r, int cols) {
+#if CONFIG_MULTITHREAD
+  // Readers wait for c + sync_range + 1 superblocks at the multiples c of
+  // sync_range, or for the whole row.
+  if ((cols - 1) % sync->sync_range == 0 || cols == sync->sb_cols) {
+    pthread_mutex_lock(&sync->row_mutex[r]);
+    sync->recon_sb_cols[r] = cols;
+    // Both the worker of the row below and the post filter of the main
+    // thread may be waiting.
+    pthread_cond_broadcast(&sync->row_cond[r]);
+    pthread_mutex_unlock(&sync->row_mutex[r]);
+  }
+#else
+  sync->recon_sb_cols[r] = cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+int av1_dec_row_mt_wait_row(AV1DecRowMTSync *sync, int r) {
+  int ok;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&sync->row_mutex[r]);
+  while (!sync->aborted && sync->recon_sb_cols[r] < sync->sb_cols)
+    pthread_cond_wait(&sync->row_cond[r], &sync->row_mutex[r]);
+  ok = !sync->aborted;
+  pthread_mutex_unlock(&sync->row_mutex[r]);
+#else
+  ok = !sync->aborted && sync->recon_sb_cols[r] == sync->sb_cols;
+#endif  // CONFIG_MULTITHREAD
+  return ok;
+}
+
+void av1_dec_row_mt_abort(AV1DecRowMTSync *sync) {
+#if CONFIG_MULTITHREAD
+  int i;
+  // Waiters hold at most one of the mutexes, so taking all of them in order
+  // cannot deadlock.
+  pthread_mutex_lock(&sync->mutex);
+  for (i = 0; i < sync->sb_rows; ++i) pthread_mutex_lock(&sync->row_mutex[i]);
+  sync->aborted = 1;
+  pthread_cond_broadcast(&sync->cond);
+  for (i = 0; i < sync->sb_rows; ++i) {
+    pthread_cond_broadcast(&sync->row_cond[i]);
+    pthread_mutex_unlock(&sync->row_mutex[i]);
+  }
+  pthread_mutex_unlock(&sync->mutex);
+#else
+  sync->aborted = 1;
+#endif  // CONFIG_MULTITHREAD
+}
@@ -13,6 +13,7 @@
 #define AV1_DECODER_DTHREAD_H_
 
 #include "./aom_config.h"
+#include "aom_util/aom_atomics.h"
 #include "aom_util/aom_thread.h"
 #include "aom/internal/aom_codec_internal.h"
 
@@ -44,6 +45,9 @@ typedef struct FrameWorkerData {
   pthread_mutex_t stats_mutex;
   pthread_cond_t stats_cond;
 #endif
+  // Number of threads waiting on stats_cond for the decoding progress of this
+  // worker's frame. Progress is only broadcast when it is non-zero.
+  aom_atomic_int progress_waiters;
 
   int frame_context_ready;  // Current frame's context is ready to read.
   int frame_decoded;        // Finished decoding current frame.
@@ -53,7 +57,8 @@ void av1_frameworker_lock_stats(AVxWorker *const worker);
 void av1_frameworker_unlock_stats(AVxWorker *const worker);
 void av1_frameworker_signal_stats(AVxWorker *const worker);
 
-// Wait until ref_buf has been decoded to row in real pixel unit.
+// Wait until the first row luma rows of ref_buf are final. Pass INT_MAX to
+// also wait for its borders to be extended.
 // Note: worker may already finish decoding ref_buf and release it in order to
 // start decoding next frame. So need to check whether worker is still decoding
 // ref_buf.
@@ -61,13 +66,72 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
                           int row);
 
 // FrameWorker broadcasts its decoding progress so other workers that are
-// waiting on it can resume decoding.
+// waiting on it can resume decoding. This only takes the stats lock when a
+// worker is waiting.
 void av1_frameworker_broadcast(RefCntBuffer *const buf, int row);
 
 // Copy necessary decoding context from src worker to dst worker.
 void av1_frameworker_copy_context(AVxWorker *const dst_worker,
                                   AVxWorker *const src_worker);
 
+// Progress of the superblock row multithreaded decoder. The main thread
+// parses the superblock rows of a frame in order, and the tile workers take
+// the parsed rows in order and reconstruct them in a wavefront: superblock
+// (r, c) is reconstructed once row r has been parsed and row r - 1 has been
+// reconstructed up to and including superblock c + 1, which holds the above
+// right pixels used by intra prediction.
+typedef struct AV1DecRowMTSync {
+#if CONFIG_MULTITHREAD
+  // Guards parsed_rows, next_row and aborted.
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  // Guard the progress of each row, so that a worker only contends with the
+  // workers of the rows next to its own.
+  pthread_mutex_t *row_mutex;
+  pthread_cond_t *row_cond;
+#endif
+  int sb_rows;
+  int sb_cols;
+  int parsed_rows;
+  // Next row to be handed out to a worker.
+  int next_row;
+  // Number of superblocks reconstructed in each row. A row publishes its
+  // progress every sync_range superblocks, as the loop filter does.
+  int *recon_sb_cols;
+  int sync_range;
+  int alloc_rows;
+  // Set when the frame fails to decode, to release all waiting threads.
+  int aborted;
+} AV1DecRowMTSync;
+
+void av1_dec_row_mt_sync_init(AV1DecRowMTSync *sync);
+
+void av1_dec_row_mt_sync_dealloc(AV1DecRowMTSync *sync);
+
+// Resets the progress for a frame of sb_rows by sb_cols superblocks.
+void av1_dec_row_mt_sync_reset(AV1DecRowMTSync *sync, struct AV1Common *cm,
+                               int sb_rows, int sb_cols);
+
+// Marks the first rows superblock rows as parsed.
+void av1_dec_row_mt_set_parsed(AV1DecRowMTSync *sync, int rows);
+
+// Returns the next superblock row to reconstruct, or -1 if there are none
+// left or the frame has failed.
+int av1_dec_row_mt_next_row(AV1DecRowMTSync *sync);
+
+// Waits until superblock (r, c) can be reconstructed. Returns 0 if the frame
+// has failed.
+int av1_dec_row_mt_sync_read(AV1DecRowMTSync *sync, int r, int c);
+
+// Marks the first cols superblocks of row r as reconstructed.
+void av1_dec_row_mt_sync_write(AV1DecRowMTSync *sync, int r, int cols);
+
+// Waits until superblock row r has been reconstructed. Returns 0 if the frame
+// has failed.
+int av1_dec_row_mt_wait_row(AV1DecRowMTSync *sync, int r);
+
+void av1_dec_row_mt_abort(AV1DecRowMTSync *sync);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -42,6 +42,7 @@
 #include "av1/encoder/cost.h"
 #include "av1/encoder/bitstream.h"
 #include "av1/encoder/encodemv.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/mcomp.h"
 #include "av1/encoder/segmentation.h"
 #include "av1/encoder/subexp.h"
@@ -750,18 +751,18 @@ static void write_palette_mode_info(const AV1_COMMON *cm, const MACROBLOCKD *xd,
 }
 #endif  // CONFIG_PALETTE
 
-static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
-                                aom_writer *w) {
+static void pack_inter_mode_mvs(AV1_COMP *cpi, ThreadData *td,
+                                const MODE_INFO *mi, aom_writer *w) {
   AV1_COMMON *const cm = &cpi->common;
 #if !CONFIG_REF_MV
   nmv_context *nmvc = &cm->fc->nmvc;
 #endif
 
 #if CONFIG_DELTA_Q
-  MACROBLOCK *const x = &cpi->td.mb;
+  MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
 #else
-  const MACROBLOCK *const x = &cpi->td.mb;
+  const MACROBLOCK *const x = &td->mb;
   const MACROBLOCKD *const xd = &x->e_mbd;
 #endif
   const struct segmentation *const seg = &cm->seg;
@@ -897,7 +898,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
                                         mbmi->ref_mv_idx);
               nmv_context *nmvc = &cm->fc->nmvc[nmv_ctx];
 #endif
-              av1_encode_mv(cpi, w, &mi->bmi[j].as_mv[ref].as_mv,
+              av1_encode_mv(cpi, td, w, &mi->bmi[j].as_mv[ref].as_mv,
                             &mbmi_ext->ref_mvs[mbmi->ref_frame[ref]][0].as_mv,
                             nmvc, allow_hp);
             }
@@ -916,8 +917,8 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const MODE_INFO *mi,
           nmv_context *nmvc = &cm->fc->nmvc[nmv_ctx];
 #endif
           ref_mv = mbmi_ext->ref_mvs[mbmi->ref_frame[ref]][0];
-          av1_encode_mv(cpi, w, &mbmi->mv[ref].as_mv, &ref_mv.as_mv, nmvc,
-                        allow_hp);
+          av1_encode_mv(cpi, td, w, &mbmi->mv[ref].as_mv, &ref_mv.as_mv,
+                        nmvc, allow_hp);
         }
       }
     }
@@ -1073,12 +1074,12 @@ PVQ_INFO *get_pvq_block(PVQ_QUEUE *pvq_q) {
 }
 #endif
 
-static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
-                          aom_writer *w, TOKENEXTRA **tok,
-                          const TOKENEXTRA *const tok_end, int mi_row,
-                          int mi_col) {
+static void write_modes_b(AV1_COMP *cpi, ThreadData *td,
+                          const TileInfo *const tile, aom_writer *w,
+                          TOKENEXTRA **tok, const TOKENEXTRA *const tok_end,
+                          int mi_row, int mi_col) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &td->mb.e_mbd;
   MODE_INFO *m;
   int plane;
 #if CONFIG_PVQ
@@ -1092,7 +1093,7 @@ static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
   xd->mi = cm->mi_grid_visible + (mi_row * cm->mi_stride + mi_col);
   m = xd->mi[0];
 
-  cpi->td.mb.mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
+  td->mb.mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
 
   set_mi_row_col(xd, tile, mi_row, num_8x8_blocks_high_lookup[m->mbmi.sb_type],
                  mi_col, num_8x8_blocks_wide_lookup[m->mbmi.sb_type],
@@ -1100,13 +1101,13 @@ static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
 #if CONFIG_PVQ
   mbmi = &m->mbmi;
   bsize = mbmi->sb_type;
-  adapt = &cpi->td.mb.daala_enc.state.adapt;
+  adapt = &td->mb.daala_enc.state.adapt;
 #endif
 
   if (frame_is_intra_only(cm)) {
     write_mb_modes_kf(cm, xd, xd->mi, w);
   } else {
-    pack_inter_mode_mvs(cpi, m, w);
+    pack_inter_mode_mvs(cpi, td, m, w);
   }
 
 #if CONFIG_PALETTE
@@ -1187,7 +1188,7 @@ static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
           int *ext = adapt->pvq.pvq_ext + tx_size * PVQ_MAX_PARTITIONS;
           generic_encoder *model = adapt->pvq.pvq_param_model;
 
-          pvq = get_pvq_block(cpi->td.mb.pvq_q);
+          pvq = get_pvq_block(td->mb.pvq_q);
 
           // encode block skip info
           od_encode_cdf_adapt(&w->ec, pvq->ac_dc_coded,
@@ -1261,12 +1262,12 @@ static void write_partition(const AV1_COMMON *const cm,
   }
 }
 
-static void write_modes_sb(AV1_COMP *cpi, const TileInfo *const tile,
-                           aom_writer *w, TOKENEXTRA **tok,
-                           const TOKENEXTRA *const tok_end, int mi_row,
-                           int mi_col, BLOCK_SIZE bsize) {
+static void write_modes_sb(AV1_COMP *cpi, ThreadData *td,
+                           const TileInfo *const tile, aom_writer *w,
+                           TOKENEXTRA **tok, const TOKENEXTRA *const tok_end,
+                           int mi_row, int mi_col, BLOCK_SIZE bsize) {
   const AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &td->mb.e_mbd;
 
   const int bsl = b_width_log2_lookup[bsize];
   const int bs = (1 << bsl) / 4;
@@ -1282,29 +1283,29 @@ static void write_modes_sb(AV1_COMP *cpi, const TileInfo *const tile,
   write_partition(cm, xd, bs, mi_row, mi_col, partition, bsize, w);
   subsize = get_subsize(bsize, partition);
   if (subsize < BLOCK_8X8) {
-    write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+    write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
         break;
       case PARTITION_HORZ:
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
         if (mi_row + bs < cm->mi_rows)
-          write_modes_b(cpi, tile, w, tok, tok_end, mi_row + bs, mi_col);
+          write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + bs, mi_col);
         break;
       case PARTITION_VERT:
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
         if (mi_col + bs < cm->mi_cols)
-          write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + bs);
+          write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + bs);
         break;
       case PARTITION_SPLIT:
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, subsize);
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col + bs,
+        write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row, mi_col, subsize);
+        write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + bs,
                        subsize);
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row + bs, mi_col,
+        write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row + bs, mi_col,
                        subsize);
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row + bs, mi_col + bs,
+        write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row + bs, mi_col + bs,
                        subsize);
         break;
       default: assert(0);
@@ -1358,14 +1359,14 @@ static void write_modes_sb(AV1_COMP *cpi, const TileInfo *const tile,
 #endif
 }
 
-static void write_modes(AV1_COMP *cpi, const TileInfo *const tile,
-                        aom_writer *w, TOKENEXTRA **tok,
-                        const TOKENEXTRA *const tok_end) {
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+static void write_modes(AV1_COMP *cpi, ThreadData *td,
+                        const TileInfo *const tile, aom_writer *w,
+                        TOKENEXTRA **tok, const TOKENEXTRA *const tok_end) {
+  MACROBLOCKD *const xd = &td->mb.e_mbd;
   int mi_row, mi_col;
 
 #if CONFIG_PVQ
-  assert(cpi->td.mb.pvq_q->curr_pos == 0);
+  assert(td->mb.pvq_q->curr_pos == 0);
 #endif
 #if CONFIG_DELTA_Q
   if (cpi->common.delta_q_present_flag) {
@@ -1378,14 +1379,15 @@ static void write_modes(AV1_COMP *cpi, const TileInfo *const tile,
     av1_zero(xd->left_seg_context);
     for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
          mi_col += MAX_MIB_SIZE)
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, BLOCK_64X64);
+      write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row, mi_col,
+                     BLOCK_64X64);
   }
 #if CONFIG_PVQ
   // Check that the number of PVQ blocks encoded and written to the bitstream
   // are the same
-  assert(cpi->td.mb.pvq_q->curr_pos == cpi->td.mb.pvq_q->last_pos);
+  assert(td->mb.pvq_q->curr_pos == td->mb.pvq_q->last_pos);
   // Reset curr_pos in case we repack the bitstream
-  cpi->td.mb.pvq_q->curr_pos = 0;
+  td->mb.pvq_q->curr_pos = 0;
 #endif
 }
 
@@ -1872,6 +1874,95 @@ static int get_refresh_mask(AV1_COMP *cpi) {
   }
 }
 
+// Packs tile (tile_row, tile_col) into dst and returns its size minus one.
+static unsigned int write_tile(AV1_COMP *const cpi, ThreadData *const td,
+                               int tile_row, int tile_col, uint8_t *dst) {
+  const int tile_cols = 1 << cpi->common.log2_tile_cols;
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * tile_cols + tile_col];
+  TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+  const TOKENEXTRA *const tok_end = tok + cpi->tok_count[tile_row][tile_col];
+  unsigned int tile_size;
+#if CONFIG_ANS
+  struct AnsCoder ans;
+  struct BufAnsCoder *buf_ans = &cpi->buf_ans;
+
+  buf_ans_write_reset(buf_ans);
+  write_modes(cpi, td, &this_tile->tile_info, buf_ans, &tok, tok_end);
+  assert(tok == tok_end);
+  ans_write_init(&ans, dst);
+  buf_ans_flush(buf_ans, &ans);
+  tile_size = ans_write_end(&ans) - 1;
+#else
+  aom_writer residual_bc;
+
+  aom_start_encode(&residual_bc, dst);
+
+#if CONFIG_PVQ
+  // NOTE: This will not work with CONFIG_ANS turned on.
+  od_adapt_ctx_reset(&td->mb.daala_enc.state.adapt, 0);
+  td->mb.pvq_q = &this_tile->pvq_q;
+#endif
+  write_modes(cpi, td, &this_tile->tile_info, &residual_bc, &tok, tok_end);
+  assert(tok == tok_end);
+  aom_stop_encode(&residual_bc);
+  tile_size = residual_bc.pos - 1;
+#endif
+#if CONFIG_PVQ
+  td->mb.pvq_q = NULL;
+#endif
+  assert(tile_size > 0);
+  return tile_size;
+}
+
+void av1_pack_tile_col(AV1_COMP *cpi, ThreadData *td, int tile_col) {
+  const int tile_rows = 1 << cpi->common.log2_tile_rows;
+  TilePackBuffers *const pack = &cpi->tile_pack;
+  int tile_row;
+
+  for (tile_row = 0; tile_row < tile_rows; tile_row++)
+    pack->size[tile_row][tile_col] =
+        write_tile(cpi, td, tile_row, tile_col,
+                   pack->buf + pack->offset[tile_row][tile_col]);
+}
+
+// Lays out the scratch buffers of the tiles packed on the workers. Each tile
+// gets twice its raw size, like the frame buffer of the encoder interface.
+static void alloc_tile_pack_buffers(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  TilePackBuffers *const pack = &cpi->tile_pack;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+#if CONFIG_AOM_HIGHBITDEPTH
+  const size_t bytes_per_sample = cm->use_highbitdepth ? 2 : 1;
+#else
+  const size_t bytes_per_sample = 1;
+#endif
+  size_t total = 0;
+  int tile_row, tile_col;
+
+  for (tile_row = 0; tile_row < tile_rows; tile_row++) {
+    for (tile_col = 0; tile_col < tile_cols; tile_col++) {
+      const TileInfo *const tile =
+          &cpi->tile_data[tile_row * tile_cols + tile_col].tile_info;
+      const size_t luma = (size_t)(tile->mi_row_end - tile->mi_row_start) *
+                          (tile->mi_col_end - tile->mi_col_start) * MI_SIZE *
+                          MI_SIZE;
+      const size_t samples =
+          luma + 2 * (luma >> (cm->subsampling_x + cm->subsampling_y));
+      pack->offset[tile_row][tile_col] = total;
+      pack->space[tile_row][tile_col] = 2 * samples * bytes_per_sample;
+      total += pack->space[tile_row][tile_col];
+    }
+  }
+
+  if (pack->buf_size < total) {
+    aom_free(pack->buf);
+    CHECK_MEM_ERROR(cm, pack->buf, aom_malloc(total));
+    pack->buf_size = total;
+  }
+}
+
 #if CONFIG_TILE_GROUPS
 static size_t encode_tiles(AV1_COMP *cpi, struct aom_write_bit_buffer *wb,
                            unsigned int *max_tile_sz)
@@ -1881,16 +1972,17 @@ static size_t encode_tiles(AV1_COMP *cpi, uint8_t *data_ptr,
 #endif
 {
   AV1_COMMON *const cm = &cpi->common;
-#if CONFIG_ANS
-  struct AnsCoder ans;
-  struct BufAnsCoder *buf_ans = &cpi->buf_ans;
-#else
-  aom_writer residual_bc;
-#endif  // CONFIG_ANS
   int tile_row, tile_col;
-  TOKENEXTRA *tok_end;
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
+#if CONFIG_ANS || CONFIG_BITSTREAM_DEBUG || CONFIG_EC_ADAPT
+  // All tiles are buffered in the ANS coder of cpi, the debug queue expects
+  // the symbols in bitstream order, and the adapting CDFs of cm->fc are
+  // updated by every symbol written.
+  const int pack_mt = 0;
+#else
+  const int pack_mt = AOMMIN(cpi->oxcf.max_threads, tile_cols) > 1;
+#endif
   unsigned int max_tile = 0;
 #if CONFIG_TILE_GROUPS
   const int n_log2_tiles = cm->log2_tile_rows + cm->log2_tile_cols;
@@ -1935,14 +2027,19 @@ static size_t encode_tiles(AV1_COMP *cpi, uint8_t *data_ptr,
   total_size += uncompressed_hdr_size + comp_hdr_size;
 #endif
 
+  // The tile columns are packed on the workers, each into its own buffer,
+  // and copied into place below.
+  cpi->td.max_mv_magnitude = 0;
+  if (pack_mt) {
+    alloc_tile_pack_buffers(cpi);
+    av1_pack_tile_cols_mt(cpi);
+  }
+
   for (tile_row = 0; tile_row < tile_rows; tile_row++) {
     for (tile_col = 0; tile_col < tile_cols; tile_col++) {
       const int tile_idx = tile_row * tile_cols + tile_col;
       unsigned int tile_size;
-#if CONFIG_PVQ
-      TileDataEnc *this_tile = &cpi->tile_data[tile_idx];
-#endif
-      TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+      uint8_t *dst;
 #if !CONFIG_TILE_GROUPS
       const int is_last_tile = tile_idx == tile_rows * tile_cols - 1;
 #else
@@ -1969,35 +2066,21 @@ static size_t encode_tiles(AV1_COMP *cpi, uint8_t *data_ptr,
       tile_count++;
 #endif
 
-      tok_end = cpi->tile_tok[tile_row][tile_col] +
-                cpi->tok_count[tile_row][tile_col];
-
-#if CONFIG_ANS
-      buf_ans_write_reset(buf_ans);
-      write_modes(cpi, &cpi->tile_data[tile_idx].tile_info, buf_ans, &tok,
-                  tok_end);
-      assert(tok == tok_end);
-      ans_write_init(&ans, data_ptr + total_size + 4 * !is_last_tile);
-      buf_ans_flush(buf_ans, &ans);
-      tile_size = ans_write_end(&ans) - 1;
-#else
-      aom_start_encode(&residual_bc, data_ptr + total_size + 4 * !is_last_tile);
-
-#if CONFIG_PVQ
-      // NOTE: This will not work with CONFIG_ANS turned on.
-      od_adapt_ctx_reset(&cpi->td.mb.daala_enc.state.adapt, 0);
-      cpi->td.mb.pvq_q = &this_tile->pvq_q;
-#endif
-      write_modes(cpi, &cpi->tile_data[tile_idx].tile_info, &residual_bc, &tok,
-                  tok_end);
-      assert(tok == tok_end);
-      aom_stop_encode(&residual_bc);
-      tile_size = residual_bc.pos - 1;
-#endif
-#if CONFIG_PVQ
-      cpi->td.mb.pvq_q = NULL;
-#endif
-      assert(tile_size > 0);
+      dst = data_ptr + total_size + 4 * !is_last_tile;
+      if (pack_mt) {
+        const TilePackBuffers *const pack = &cpi->tile_pack;
+        tile_size = pack->size[tile_row][tile_col];
+        // The writer is not bounded, so an overflow of the scratch space can
+        // only be caught once the tile is written.
+        if (tile_size + 1 > pack->space[tile_row][tile_col])
+          aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                             "Tile of %u bytes overflowed its pack buffer",
+                             tile_size + 1);
+        memcpy(dst, pack->buf + pack->offset[tile_row][tile_col],
+               tile_size + 1);
+      } else {
+        tile_size = write_tile(cpi, &cpi->td, tile_row, tile_col, dst);
+      }
       if (!is_last_tile) {
         // size of this tile
         mem_put_le32(data_ptr + total_size, tile_size);
@@ -2016,6 +2099,8 @@ static size_t encode_tiles(AV1_COMP *cpi, uint8_t *data_ptr,
   }
 #endif
   *max_tile_sz = max_tile;
+  cpi->max_mv_magnitude =
+      AOMMAX(cpi->max_mv_magnitude, cpi->td.max_mv_magnitude);
 
   return total_size;
 }
@@ -21,6 +21,9 @@ extern "C" {
 void av1_encode_token_init();
 void av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dest, size_t *size);
 
+// Packs all tile rows of tile column tile_col into cpi->tile_pack.
+void av1_pack_tile_col(AV1_COMP *cpi, ThreadData *td, int tile_col);
+
 static INLINE int av1_preserve_existing_gf(AV1_COMP *cpi) {
   return !cpi->multi_arf_allowed && cpi->refresh_golden_frame &&
          cpi->rc.is_src_frame_alt_ref;
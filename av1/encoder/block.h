@@ -14,6 +14,7 @@
 
 #include "av1/common/entropymv.h"
 #include "av1/common/entropy.h"
+#include "av1/encoder/hash.h"
 #if CONFIG_PVQ
 #include "av1/encoder/encint.h"
 #endif
@@ -79,6 +80,63 @@ typedef struct {
 } PALETTE_BUFFER;
 #endif  // CONFIG_PALETTE
 
+// Rows of the reference frame interpolated horizontally at one sub-pixel
+// column offset, kept while the sub-pixel motion search of a block
+// interpolates up-sampled positions on the fly.
+#define UPSAMPLED_PRED_CACHE_SLOTS 16
+typedef struct {
+  // Column offset of the rows in 1/8 pel, INT_MAX if the slot is unused.
+  int col;
+  // Rows held, relative to the block.
+  int row0;
+  int rows;
+  DECLARE_ALIGNED(16, uint16_t, buf[MAX_SB_SIZE * (MAX_SB_SIZE + 16)]);
+} UPSAMPLED_PRED_CACHE;
+
+typedef struct {
+  // Set when the up-sampled reference is not stored and pre[] points to the
+  // reference frame itself.
+  int on_the_fly;
+  // Position of the block in the reference frame and size of the frame, in
+  // pixels.
+  int row;
+  int col;
+  int width;
+  int height;
+  UPSAMPLED_PRED_CACHE *cache;
+} UPSAMPLED_PRED_CTX;
+
+// Best motion vector found for one reference in one 8x8 cell of the
+// superblock being coded.
+typedef struct {
+  int valid;
+  // Result of the full pel search, with its error plus mv cost scaled to the
+  // 64 pixels of the cell.
+  MV full_mv;
+  int cost;
+  // Its sub pel refinement.
+  MV sub_mv;
+} MV_FIELD_CELL;
+
+// Rate distortion results of an inter transform block, keyed on the CRC of
+// its residual and on everything else the results depend on within a frame.
+typedef struct {
+  uint32_t hash;
+  // Packed transform size and type, plane type, entropy context, quantizer
+  // and coding options. 0 if the record is unused.
+  uint32_t key;
+  int rate;
+  uint16_t eob;
+  int64_t dist;
+  int64_t sse;
+} TX_RD_RECORD;
+
+#define TX_RD_CACHE_BITS 12
+typedef struct {
+  CRC_CALCULATOR crc;
+  TX_RD_RECORD records[1 << TX_RD_CACHE_BITS];
+} TX_RD_CACHE;
+
 typedef struct macroblock MACROBLOCK;
 struct macroblock {
   struct macroblock_plane plane[MAX_MB_PLANE];
@@ -103,6 +161,12 @@ struct macroblock {
   int *m_search_count_ptr;
   int *ex_search_count_ptr;
 
+  // Transform rate distortion cache of the thread and its counters. Nothing
+  // is cached if it is NULL.
+  TX_RD_CACHE *tx_rd_cache;
+  int *tx_rd_lookup_count_ptr;
+  int *tx_rd_hit_count_ptr;
+
   // These are set to their default values at the beginning, and then adjusted
   // further in the encoding process.
   BLOCK_SIZE min_partition_size;
@@ -141,6 +205,9 @@ struct macroblock {
   PALETTE_BUFFER *palette_buffer;
 #endif  // CONFIG_PALETTE
 
+  // Sub-pixel motion search in the up-sampled reference.
+  UPSAMPLED_PRED_CTX upsampled_pred;
+
   // These define limits to motion vector components to prevent them
   // from extending outside the UMV borders
   int mv_col_min;
@@ -163,6 +230,10 @@ struct macroblock {
 
   // Used to store sub partition's choices.
   MV pred_mv[MAX_REF_FRAMES];
+
+  // Motion field of the superblock, filled by the motion searches of all
+  // block sizes to seed the searches of the other sizes.
+  MV_FIELD_CELL mv_field[MAX_MIB_SIZE * MAX_MIB_SIZE][MAX_REF_FRAMES];
 #if CONFIG_PVQ
   int rate;
   // 1 if neither AC nor DC is coded. Only used during RDO.
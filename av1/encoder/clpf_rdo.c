@@ -13,6 +13,7 @@
 #include "./aom_dsp_rtcd.h"
 #include "aom/aom_image.h"
 #include "aom/aom_integer.h"
+#include "aom_mem/aom_mem.h"
 #include "av1/common/quant_common.h"
 
 // Calculate the error of a filtered and unfiltered block
@@ -199,7 +200,8 @@ static int clpf_rdo(int y, int x, const YV12_BUFFER_CONFIG *rec,
   sum[0] = sum[1] = sum[2] = sum[3] = sum[4] = sum[5] = sum[6] = sum[7] = 0;
   if (plane == AOM_PLANE_Y &&
       fb_size_log2 > (unsigned int)get_msb(MAX_FB_SIZE) - 3) {
-    int w1, h1, w2, h2, i, sum1, sum2, sum3, oldfiltered;
+    int w1, h1, w2, h2, i;
+    int64_t sum1, sum2, sum3, oldfiltered;
 
     filtered = fb_size_log2-- == MAX_FB_SIZE_LOG2;
     w1 = AOMMIN(1 << (fb_size_log2 - bslog), w);
@@ -285,41 +287,58 @@ static int clpf_rdo(int y, int x, const YV12_BUFFER_CONFIG *rec,
   return filtered;
 }
 
-void av1_clpf_test_frame(const YV12_BUFFER_CONFIG *rec,
+// Number of rows of filter blocks, the unit of work of the RDO.
+static int clpf_rdo_num_rows(const YV12_BUFFER_CONFIG *rec, int plane) {
+  const int bslog = get_msb(MI_SIZE);
+  const int fb_size_log2 = get_msb(MAX_FB_SIZE);
+  if (plane != AOM_PLANE_Y) {
+    const int rows = rec->uv_crop_height >> bslog;
+    return (rows + (1 << (fb_size_log2 - bslog)) - 1) >>
+           (fb_size_log2 - bslog);
+  }
+  return (rec->y_crop_height + (1 << fb_size_log2) - MI_SIZE) >> fb_size_log2;
+}
+
+// Adds the square errors of filter block row k of the plane to sums.
+static void clpf_rdo_row(const YV12_BUFFER_CONFIG *rec,
                          const YV12_BUFFER_CONFIG *org, const AV1_COMMON *cm,
-                         int *best_strength, int *best_bs, int plane) {
-  int c, j, k, l;
-  int64_t best, sums[4][8];
+                         int plane, int k, int64_t sums[4][8]) {
+  int l;
   int width = plane != AOM_PLANE_Y ? rec->uv_crop_width : rec->y_crop_width;
   int height = plane != AOM_PLANE_Y ? rec->uv_crop_height : rec->y_crop_height;
   const int bs = MI_SIZE;
   const int bslog = get_msb(bs);
   int fb_size_log2 = get_msb(MAX_FB_SIZE);
-  int num_fb_ver = (height + (1 << fb_size_log2) - bs) >> fb_size_log2;
   int num_fb_hor = (width + (1 << fb_size_log2) - bs) >> fb_size_log2;
 
-  memset(sums, 0, sizeof(sums));
-
-  if (plane != AOM_PLANE_Y)
+  if (plane != AOM_PLANE_Y) {
     // Use a block size of MI_SIZE regardless of the subsampling.  This
     // This is accurate enough to determine the best strength and
     // we don't need to add SIMD optimisations for 4x4 blocks.
-    clpf_rdo(0, 0, rec, org, cm, bs, fb_size_log2, width >> bslog,
-             height >> bslog, sums, plane);
-  else
-    for (k = 0; k < num_fb_ver; k++) {
-      for (l = 0; l < num_fb_hor; l++) {
-        // Calculate the block size after frame border clipping
-        int h =
-            AOMMIN(height, (k + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
-        int w =
-            AOMMIN(width, (l + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
-        h += !h << fb_size_log2;
-        w += !w << fb_size_log2;
-        clpf_rdo(k << fb_size_log2, l << fb_size_log2, rec, org, cm, MI_SIZE,
-                 fb_size_log2, w >> bslog, h >> bslog, sums, plane);
-      }
-    }
+    const int rows = 1 << (fb_size_log2 - bslog);
+    clpf_rdo(k << fb_size_log2, 0, rec, org, cm, bs, fb_size_log2,
+             width >> bslog, AOMMIN((height >> bslog) - k * rows, rows), sums,
+             plane);
+    return;
+  }
+
+  for (l = 0; l < num_fb_hor; l++) {
+    // Calculate the block size after frame border clipping
+    int h = AOMMIN(height, (k + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+    int w = AOMMIN(width, (l + 1) << fb_size_log2) & ((1 << fb_size_log2) - 1);
+    h += !h << fb_size_log2;
+    w += !w << fb_size_log2;
+    clpf_rdo(k << fb_size_log2, l << fb_size_log2, rec, org, cm, MI_SIZE,
+             fb_size_log2, w >> bslog, h >> bslog, sums, plane);
+  }
+}
+
+// Picks the best strength (and filter block size for luma) from the square
+// errors of the whole plane.
+static void clpf_rdo_pick(const AV1_COMMON *cm, int64_t sums[4][8],
+                          int *best_strength, int *best_bs, int plane) {
+  int c, j;
+  int64_t best;
 
   // For fb_size == 128 skip blocks are included in the result.
   if (plane == AOM_PLANE_Y) {
@@ -359,3 +378,116 @@ void av1_clpf_test_frame(const YV12_BUFFER_CONFIG *rec,
   if (best_bs) *best_bs = (best > 3) * (5 + (best < 12) + (best < 8));
   *best_strength = best ? 1 << ((best - 1) & 3) : 0;
 }
+
+void av1_clpf_test_frame(const YV12_BUFFER_CONFIG *rec,
+                         const YV12_BUFFER_CONFIG *org, const AV1_COMMON *cm,
+                         int *best_strength, int *best_bs, int plane) {
+  const int num_rows = clpf_rdo_num_rows(rec, plane);
+  int64_t sums[4][8];
+  int k;
+
+  memset(sums, 0, sizeof(sums));
+  for (k = 0; k < num_rows; k++) clpf_rdo_row(rec, org, cm, plane, k, sums);
+  clpf_rdo_pick(cm, sums, best_strength, best_bs, plane);
+}
+
+// The square errors of one filter block row of a plane.
+typedef struct ClpfRdoJob {
+  int plane;
+  int row;
+  int64_t sums[4][8];
+} ClpfRdoJob;
+
+typedef struct ClpfRdoWorkerData {
+  const YV12_BUFFER_CONFIG *rec;
+  const YV12_BUFFER_CONFIG *org;
+  const AV1_COMMON *cm;
+  ClpfRdoJob *jobs;
+  int num_jobs;
+  // The worker measures jobs start, start + step, ...
+  int start;
+  int step;
+} ClpfRdoWorkerData;
+
+static int clpf_rdo_worker(ClpfRdoWorkerData *const data, void *unused) {
+  int i;
+  (void)unused;
+  for (i = data->start; i < data->num_jobs; i += data->step) {
+    ClpfRdoJob *const job = &data->jobs[i];
+    memset(job->sums, 0, sizeof(job->sums));
+    clpf_rdo_row(data->rec, data->org, data->cm, job->plane, job->row,
+                 job->sums);
+  }
+  return 1;
+}
+
+void av1_clpf_test_frame_mt(const YV12_BUFFER_CONFIG *rec,
+                            const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                            int best_strength[3], int *best_bs,
+                            AVxWorker *workers, int nworkers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  ClpfRdoWorkerData *data;
+  ClpfRdoJob *jobs;
+  int num_jobs = 0;
+  int num_workers;
+  int plane, i, k;
+
+  for (plane = 0; plane < MAX_MB_PLANE; plane++)
+    num_jobs += clpf_rdo_num_rows(rec, plane);
+  num_workers = AOMMAX(1, AOMMIN(nworkers, num_jobs));
+  CHECK_MEM_ERROR(cm, jobs, aom_malloc(num_jobs * sizeof(*jobs)));
+  CHECK_MEM_ERROR(cm, data, aom_malloc(num_workers * sizeof(*data)));
+
+  i = 0;
+  for (plane = 0; plane < MAX_MB_PLANE; plane++) {
+    const int num_rows = clpf_rdo_num_rows(rec, plane);
+    for (k = 0; k < num_rows; k++, i++) {
+      jobs[i].plane = plane;
+      jobs[i].row = k;
+    }
+  }
+  for (i = 0; i < num_workers; i++) {
+    data[i].rec = rec;
+    data[i].org = org;
+    data[i].cm = cm;
+    data[i].jobs = jobs;
+    data[i].num_jobs = num_jobs;
+    data[i].start = i;
+    data[i].step = num_workers;
+  }
+
+  // The rows of all planes are measured in one pass.
+  if (num_workers > 1) {
+    for (i = 0; i < num_workers; i++) {
+      AVxWorker *const worker = &workers[i];
+      worker->hook = (AVxWorkerHook)clpf_rdo_worker;
+      worker->data1 = &data[i];
+      worker->data2 = NULL;
+      if (i == num_workers - 1)
+        winterface->execute(worker);
+      else
+        winterface->launch(worker);
+    }
+    for (i = 0; i < num_workers; i++) winterface->sync(&workers[i]);
+  } else {
+    clpf_rdo_worker(data, NULL);
+  }
+
+  // Sum the rows in order, so the result does not depend on the number of
+  // workers.
+  i = 0;
+  for (plane = 0; plane < MAX_MB_PLANE; plane++) {
+    const int num_rows = clpf_rdo_num_rows(rec, plane);
+    int64_t sums[4][8];
+    int c, j;
+    memset(sums, 0, sizeof(sums));
+    for (k = 0; k < num_rows; k++, i++)
+      for (c = 0; c < 4; c++)
+        for (j = 0; j < 8; j++) sums[c][j] += jobs[i].sums[c][j];
+    clpf_rdo_pick(cm, sums, &best_strength[plane],
+                  plane == AOM_PLANE_Y ? best_bs : NULL, plane);
+  }
+
+  aom_free(data);
+  aom_free(jobs);
+}
@@ -12,6 +12,7 @@
 #ifndef AV1_ENCODER_CLPF_H_
 #define AV1_ENCODER_CLPF_H_
 
+#include "aom_util/aom_thread.h"
 #include "av1/common/reconinter.h"
 
 int av1_clpf_decision(int k, int l, const YV12_BUFFER_CONFIG *rec,
@@ -23,4 +24,12 @@ void av1_clpf_test_frame(const YV12_BUFFER_CONFIG *rec,
                          const YV12_BUFFER_CONFIG *org, const AV1_COMMON *cm,
                          int *best_strength, int *best_bs, int plane);
 
+// Finds the best strength of every plane and the best luma filter block size
+// like av1_clpf_test_frame(), measuring the filter block rows of all planes
+// on the given workers.
+void av1_clpf_test_frame_mt(const YV12_BUFFER_CONFIG *rec,
+                            const YV12_BUFFER_CONFIG *org, AV1_COMMON *cm,
+                            int best_strength[3], int *best_bs,
+                            AVxWorker *workers, int nworkers);
+
 #endif
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/aom_simd.h"
+#include "aom_ports/mem.h"
+
+// The 256 bit versions hold four lines of an 8x8 block, two in each 128 bit
+// lane, so a block takes two iterations and no shuffle crosses a lane.
+
+SIMD_INLINE void calc_diff(v256 o, v256 *a, v256 *b, v256 *c, v256 *d, v256 *e,
+                           v256 *f) {
+  // The difference will be 9 bit, offset by 128 so we can use saturated
+  // sub to avoid going to 16 bit temporarily before "strength" clipping.
+  const v256 c128 = v256_dup_8(128);
+  v256 x = v256_add_8(c128, o);
+  *a = v256_ssub_s8(v256_add_8(c128, *a), x);
+  *b = v256_ssub_s8(v256_add_8(c128, *b), x);
+  *c = v256_ssub_s8(v256_add_8(c128, *c), x);
+  *d = v256_ssub_s8(v256_add_8(c128, *d), x);
+  *e = v256_ssub_s8(v256_add_8(c128, *e), x);
+  *f = v256_ssub_s8(v256_add_8(c128, *f), x);
+}
+
+SIMD_INLINE v256 delta_kernel(v256 o, v256 a, v256 b, v256 c, v256 d, v256 e,
+                              v256 f, v256 sp, v256 sm) {
+  const v256 tmp = v256_add_8(v256_max_s8(v256_min_s8(c, sp), sm),
+                              v256_max_s8(v256_min_s8(d, sp), sm));
+  const v256 delta = v256_add_8(
+      v256_add_8(v256_shl_8(v256_add_8(v256_max_s8(v256_min_s8(a, sp), sm),
+                                       v256_max_s8(v256_min_s8(f, sp), sm)),
+                            2),
+                 v256_add_8(v256_max_s8(v256_min_s8(b, sp), sm),
+                            v256_max_s8(v256_min_s8(e, sp), sm))),
+      v256_add_8(v256_add_8(tmp, tmp), tmp));
+
+  return v256_add_8(
+      o, v256_shr_s8(
+             v256_add_8(v256_dup_8(8),
+                        v256_add_8(delta, v256_cmplt_s8(delta, v256_zero()))),
+             4));
+}
+
+SIMD_INLINE v256 calc_delta(v256 o, v256 a, v256 b, v256 c, v256 d, v256 e,
+                            v256 f, v256 sp, v256 sm) {
+  calc_diff(o, &a, &b, &c, &d, &e, &f);
+  return delta_kernel(o, a, b, c, d, e, f, sp, sm);
+}
+
+SIMD_INLINE void clip_sides(v256 *b, v256 *c, v256 *d, v256 *e, int left,
+                            int right) {
+  DECLARE_ALIGNED(32, static const uint64_t,
+                  b_shuff[]) = { 0x0504030201000000LL, 0x0d0c0b0a09080808LL,
+                                 0x0504030201000000LL, 0x0d0c0b0a09080808LL };
+  DECLARE_ALIGNED(32, static const uint64_t,
+                  c_shuff[]) = { 0x0605040302010000LL, 0x0e0d0c0b0a090808LL,
+                                 0x0605040302010000LL, 0x0e0d0c0b0a090808LL };
+  DECLARE_ALIGNED(32, static const uint64_t,
+                  d_shuff[]) = { 0x0707060504030201LL, 0x0f0f0e0d0c0b0a09LL,
+                                 0x0707060504030201LL, 0x0f0f0e0d0c0b0a09LL };
+  DECLARE_ALIGNED(32, static const uint64_t,
+                  e_shuff[]) = { 0x0707070605040302LL, 0x0f0f0f0e0d0c0b0aLL,
+                                 0x0707070605040302LL, 0x0f0f0f0e0d0c0b0aLL };
+
+  if (!left) {  // Left clipping
+    *b = v256_pshuffle_8(*b, v256_load_aligned(b_shuff));
+    *c = v256_pshuffle_8(*c, v256_load_aligned(c_shuff));
+  }
+  if (!right) {  // Right clipping
+    *d = v256_pshuffle_8(*d, v256_load_aligned(d_shuff));
+    *e = v256_pshuffle_8(*e, v256_load_aligned(e_shuff));
+  }
+}
+
+// Line offsets of the lines above and below the four lines starting at
+// absolute line y, clamped to the frame like the C version.
+SIMD_INLINE void line_offsets(int y, int height, int *above, int below[4]) {
+  int i;
+  *above = -(y > 0);
+  for (i = 0; i < 4; i++) below[i] = AOMMIN(y + i + 1, height - 1) - y;
+}
+
+SIMD_INLINE v256 load_lines(const uint8_t *p, int stride, int l0, int l1,
+                            int l2, int l3) {
+  return v256_from_v64(v64_load_unaligned(p + l0 * stride),
+                       v64_load_unaligned(p + l1 * stride),
+                       v64_load_unaligned(p + l2 * stride),
+                       v64_load_unaligned(p + l3 * stride));
+}
+
+SIMD_INLINE void read_four_lines(const uint8_t *rec, const uint8_t *org,
+                                 int rstride, int ostride, int x0, int right,
+                                 int y, int height, v256 *o, v256 *r, v256 *a,
+                                 v256 *b, v256 *c, v256 *d, v256 *e, v256 *f) {
+  int above, below[4];
+  line_offsets(y, height, &above, below);
+  *o = load_lines(org, ostride, 0, 1, 2, 3);
+  *r = load_lines(rec, rstride, 0, 1, 2, 3);
+  *a = load_lines(rec, rstride, above, 0, 1, 2);
+  *f = load_lines(rec, rstride, below[0], below[1], below[2], below[3]);
+  *b = load_lines(rec - 2 * !!x0, rstride, 0, 1, 2, 3);
+  *c = load_lines(rec - !!x0, rstride, 0, 1, 2, 3);
+  *d = load_lines(rec + !!right, rstride, 0, 1, 2, 3);
+  *e = load_lines(rec + 2 * !!right, rstride, 0, 1, 2, 3);
+  clip_sides(b, c, d, e, x0, right);
+}
+
+void aom_clpf_detect_avx2(const uint8_t *rec, const uint8_t *org, int rstride,
+                          int ostride, int x0, int y0, int width, int height,
+                          int *sum0, int *sum1, unsigned int strength,
+                          int size) {
+  const v256 sp = v256_dup_8(strength);
+  const v256 sm = v256_dup_8(-(int)strength);
+  const int right = width - 8 - x0;
+  ssd256_internal ssd0 = v256_ssd_u8_init();
+  ssd256_internal ssd1 = v256_ssd_u8_init();
+  int y;
+
+  if (size != 8) {  // Fallback to plain C
+    aom_clpf_detect_c(rec, org, rstride, ostride, x0, y0, width, height, sum0,
+                      sum1, strength, size);
+    return;
+  }
+
+  rec += x0 + y0 * rstride;
+  org += x0 + y0 * ostride;
+
+  for (y = 0; y < 8; y += 4) {
+    v256 a, b, c, d, e, f, o, r;
+    read_four_lines(rec, org, rstride, ostride, x0, right, y0 + y, height, &o,
+                    &r, &a, &b, &c, &d, &e, &f);
+    ssd0 = v256_ssd_u8(ssd0, o, r);
+    ssd1 = v256_ssd_u8(ssd1, o, calc_delta(r, a, b, c, d, e, f, sp, sm));
+    rec += 4 * rstride;
+    org += 4 * ostride;
+  }
+  *sum0 += v256_ssd_u8_sum(ssd0);
+  *sum1 += v256_ssd_u8_sum(ssd1);
+}
+
+SIMD_INLINE void calc_delta_multi(v256 r, v256 o, v256 a, v256 b, v256 c,
+                                  v256 d, v256 e, v256 f, ssd256_internal *ssd1,
+                                  ssd256_internal *ssd2,
+                                  ssd256_internal *ssd3) {
+  calc_diff(r, &a, &b, &c, &d, &e, &f);
+  *ssd1 = v256_ssd_u8(*ssd1, o, delta_kernel(r, a, b, c, d, e, f, v256_dup_8(1),
+                                             v256_dup_8(-1)));
+  *ssd2 = v256_ssd_u8(*ssd2, o, delta_kernel(r, a, b, c, d, e, f, v256_dup_8(2),
+                                             v256_dup_8(-2)));
+  *ssd3 = v256_ssd_u8(*ssd3, o, delta_kernel(r, a, b, c, d, e, f, v256_dup_8(4),
+                                             v256_dup_8(-4)));
+}
+
+// Test multiple filter strengths at once.
+void aom_clpf_detect_multi_avx2(const uint8_t *rec, const uint8_t *org,
+                                int rstride, int ostride, int x0, int y0,
+                                int width, int height, int *sum, int size) {
+  const int right = width - 8 - x0;
+  ssd256_internal ssd0 = v256_ssd_u8_init();
+  ssd256_internal ssd1 = v256_ssd_u8_init();
+  ssd256_internal ssd2 = v256_ssd_u8_init();
+  ssd256_internal ssd3 = v256_ssd_u8_init();
+  int y;
+
+  if (size != 8) {  // Fallback to plain C
+    aom_clpf_detect_multi_c(rec, org, rstride, ostride, x0, y0, width, height,
+                            sum, size);
+    return;
+  }
+
+  rec += x0 + y0 * rstride;
+  org += x0 + y0 * ostride;
+
+  for (y = 0; y < 8; y += 4) {
+    v256 a, b, c, d, e, f, o, r;
+    read_four_lines(rec, org, rstride, ostride, x0, right, y0 + y, height, &o,
+                    &r, &a, &b, &c, &d, &e, &f);
+    ssd0 = v256_ssd_u8(ssd0, o, r);
+    calc_delta_multi(r, o, a, b, c, d, e, f, &ssd1, &ssd2, &ssd3);
+    rec += 4 * rstride;
+    org += 4 * ostride;
+  }
+  sum[0] += v256_ssd_u8_sum(ssd0);
+  sum[1] += v256_ssd_u8_sum(ssd1);
+  sum[2] += v256_ssd_u8_sum(ssd2);
+  sum[3] += v256_ssd_u8_sum(ssd3);
+}
+
+#if CONFIG_AOM_HIGHBITDEPTH
+// Reads four lines of eight pixels and keeps the low byte of every pixel
+// after the shift, in the same line order as load_lines().
+SIMD_INLINE v256 load_lines_hbd(const uint16_t *p, int stride, int l0, int l1,
+                                int l2, int l3, int shift) {
+  return v256_unziplo_8(
+      v256_shr_u16(v256_from_v128(v128_load_unaligned(p + l0 * stride),
+                                  v128_load_unaligned(p + l1 * stride)),
+                   shift),
+      v256_shr_u16(v256_from_v128(v128_load_unaligned(p + l2 * stride),
+                                  v128_load_unaligned(p + l3 * stride)),
+                   shift));
+}
+
+SIMD_INLINE void read_four_lines_hbd(const uint16_t *rec, const uint16_t *org,
+                                     int rstride, int ostride, int x0,
+                                     int right, int y, int height, v256 *o,
+                                     v256 *r, v256 *a, v256 *b, v256 *c,
+                                     v256 *d, v256 *e, v256 *f, int shift) {
+  int above, below[4];
+  line_offsets(y, height, &above, below);
+  *o = load_lines_hbd(org, ostride, 0, 1, 2, 3, shift);
+  *r = load_lines_hbd(rec, rstride, 0, 1, 2, 3, shift);
+  *a = load_lines_hbd(rec, rstride, above, 0, 1, 2, shift);
+  *f = load_lines_hbd(rec, rstride, below[0], below[1], below[2], below[3],
+                      shift);
+  *b = load_lines_hbd(rec - 2 * !!x0, rstride, 0, 1, 2, 3, shift);
+  *c = load_lines_hbd(rec - !!x0, rstride, 0, 1, 2, 3, shift);
+  *d = load_lines_hbd(rec + !!right, rstride, 0, 1, 2, 3, shift);
+  *e = load_lines_hbd(rec + 2 * !!right, rstride, 0, 1, 2, 3, shift);
+  clip_sides(b, c, d, e, x0, right);
+}
+
+void aom_clpf_detect_hbd_avx2(const uint16_t *rec, const uint16_t *org,
+                              int rstride, int ostride, int x0, int y0,
+                              int width, int height, int *sum0, int *sum1,
+                              unsigned int strength, int shift, int size) {
+  const v256 sp = v256_dup_8(strength >> shift);
+  const v256 sm = v256_dup_8(-(int)(strength >> shift));
+  const int right = width - 8 - x0;
+  ssd256_internal ssd0 = v256_ssd_u8_init();
+  ssd256_internal ssd1 = v256_ssd_u8_init();
+  int y;
+
+  if (size != 8) {  // Fallback to plain C
+    aom_clpf_detect_hbd_c(rec, org, rstride, ostride, x0, y0, width, height,
+                          sum0, sum1, strength, shift, size);
+    return;
+  }
+
+  rec += x0 + y0 * rstride;
+  org += x0 + y0 * ostride;
+
+  for (y = 0; y < 8; y += 4) {
+    v256 a, b, c, d, e, f, o, r;
+    read_four_lines_hbd(rec, org, rstride, ostride, x0, right, y0 + y, height,
+                        &o, &r, &a, &b, &c, &d, &e, &f, shift);
+    ssd0 = v256_ssd_u8(ssd0, o, r);
+    ssd1 = v256_ssd_u8(ssd1, o, calc_delta(r, a, b, c, d, e, f, sp, sm));
+    rec += 4 * rstride;
+    org += 4 * ostride;
+  }
+  *sum0 += v256_ssd_u8_sum(ssd0);
+  *sum1 += v256_ssd_u8_sum(ssd1);
+}
+
+void aom_clpf_detect_multi_hbd_avx2(const uint16_t *rec, const uint16_t *org,
+                                    int rstride, int ostride, int x0, int y0,
+                                    int width, int height, int *sum, int shift,
+                                    int size) {
+  const int right = width - 8 - x0;
+  ssd256_internal ssd0 = v256_ssd_u8_init();
+  ssd256_internal ssd1 = v256_ssd_u8_init();
+  ssd256_internal ssd2 = v256_ssd_u8_init();
+  ssd256_internal ssd3 = v256_ssd_u8_init();
+  int y;
+
+  if (size != 8) {  // Fallback to plain C
+    aom_clpf_detect_multi_hbd_c(rec, org, rstride, ostride, x0, y0, width,
+                                height, sum, shift, size);
+    return;
+  }
+
+  rec += x0 + y0 * rstride;
+  org += x0 + y0 * ostride;
+
+  for (y = 0; y < 8; y += 4) {
+    v256 a, b, c, d, e, f, o, r;
+    read_four_lines_hbd(rec, org, rstride, ostride, x0, right, y0 + y, height,
+                        &o, &r, &a, &b, &c, &d, &e, &f, shift);
+    ssd0 = v256_ssd_u8(ssd0, o, r);
+    calc_delta_multi(r, o, a, b, c, d, e, f, &ssd1, &ssd2, &ssd3);
+    rec += 4 * rstride;
+    org += 4 * ostride;
+  }
+  sum[0] += v256_ssd_u8_sum(ssd0);
+  sum[1] += v256_ssd_u8_sum(ssd1);
+  sum[2] += v256_ssd_u8_sum(ssd2);
+  sum[3] += v256_ssd_u8_sum(ssd3);
+}
+#endif
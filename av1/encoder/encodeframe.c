@@ -1099,6 +1099,10 @@ static void rd_pick_sb_modes(const AV1_COMP *const cpi, TileDataEnc *tile_data,
       if (segfeature_active(&cm->seg, mbmi->segment_id, SEG_LVL_SKIP))
         av1_rd_pick_inter_mode_sb_seg_skip(cpi, tile_data, x, rd_cost, bsize,
                                            ctx, best_rd);
+      else if (cpi->sf.use_nonrd_pick_mode &&
+               cm->reference_mode != COMPOUND_REFERENCE)
+        av1_nonrd_pick_inter_mode_sb(cpi, tile_data, x, mi_row, mi_col, rd_cost,
+                                     bsize, ctx, best_rd);
       else
         av1_rd_pick_inter_mode_sb(cpi, tile_data, x, mi_row, mi_col, rd_cost,
                                   bsize, ctx, best_rd);
@@ -2623,12 +2627,16 @@ static void rd_pick_partition(const AV1_COMP *const cpi, ThreadData *td,
 
 static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
                              TileDataEnc *tile_data, int mi_row,
-                             TOKENEXTRA **tp) {
+                             TOKENEXTRA **tp, AV1RowMTSync *row_mt_sync) {
   AV1_COMMON *const cm = &cpi->common;
   TileInfo *const tile_info = &tile_data->tile_info;
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   SPEED_FEATURES *const sf = &cpi->sf;
+  const int sync_row = mi_row >> MAX_MIB_SIZE_LOG2;
+  const int sb_cols_in_tile =
+      (tile_info->mi_col_end - tile_info->mi_col_start + MAX_MIB_SIZE - 1) >>
+      MAX_MIB_SIZE_LOG2;
   int mi_col;
 
   // Initialize the left context for the new SB row
@@ -2653,6 +2661,11 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
 
     const int idx_str = cm->mi_stride * mi_row + mi_col;
     MODE_INFO **mi = cm->mi_grid_visible + idx_str;
+    const int sync_col =
+        (mi_col - tile_info->mi_col_start) >> MAX_MIB_SIZE_LOG2;
+
+    // Wait for the above and above-right superblocks to be encoded.
+    if (row_mt_sync) av1_row_mt_sync_read(row_mt_sync, sync_row, sync_col);
 
     if (sf->adaptive_pred_interp_filter) {
       for (i = 0; i < 64; ++i) td->leaf_tree[i].pred_interp_filter = SWITCHABLE;
@@ -2666,6 +2679,7 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
     }
 
     av1_zero(x->pred_mv);
+    if (sf->reuse_mv_field) av1_zero(x->mv_field);
     td->pc_root->index = 0;
 
     if (seg->enabled) {
@@ -2730,6 +2744,9 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
       rd_pick_partition(cpi, td, tile_data, tp, mi_row, mi_col, BLOCK_64X64,
                         &dummy_rdc, INT64_MAX, td->pc_root);
     }
+
+    if (row_mt_sync)
+      av1_row_mt_sync_write(row_mt_sync, sync_row, sync_col, sb_cols_in_tile);
   }
 }
 
@@ -2802,6 +2819,17 @@ static TX_MODE select_tx_mode(const AV1_COMP *cpi, MACROBLOCKD *const xd) {
     return cpi->common.tx_mode;
 }
 
+// Offset of the first token of the superblock row starting at mi_row inside
+// the token buffer of its tile, when every row is given its own token space.
+static INLINE int row_token_offset(const TileInfo *const tile_info,
+                                   int mi_row) {
+  const int tile_mb_rows = (mi_row - tile_info->mi_row_start + 1) >> 1;
+  const int tile_mb_cols =
+      (tile_info->mi_col_end - tile_info->mi_col_start + 1) >> 1;
+
+  return get_token_alloc(tile_mb_rows, tile_mb_cols);
+}
+
 void av1_init_tile_data(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   const int tile_cols = 1 << cm->log2_tile_cols;
@@ -2851,6 +2879,94 @@ void av1_init_tile_data(AV1_COMP *cpi) {
 #endif
     }
   }
+
+  if (cpi->row_mt) {
+    const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MAX_MIB_SIZE_LOG2;
+
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync[tile_col];
+
+      if (row_mt_sync->rows != sb_rows) {
+        av1_row_mt_sync_mem_dealloc(row_mt_sync);
+        av1_row_mt_sync_mem_alloc(row_mt_sync, cm, sb_rows);
+      }
+      // Initialize cur_sb_col to -1 for all SB rows.
+      memset(row_mt_sync->cur_sb_col, -1,
+             sizeof(*row_mt_sync->cur_sb_col) * sb_rows);
+    }
+  }
+}
+
+void av1_setup_thread_mb(const AV1_COMP *cpi, ThreadData *td) {
+  td->mb.m_search_count_ptr = &td->rd_counts.m_search_count;
+  td->mb.ex_search_count_ptr = &td->rd_counts.ex_search_count;
+  td->mb.upsampled_pred.cache = td->upsampled_pred_cache;
+  td->mb.tx_rd_cache = cpi->oxcf.use_tx_rd_cache ? &td->tx_rd_cache : NULL;
+  td->mb.tx_rd_lookup_count_ptr = &td->rd_counts.tx_rd_lookup_count;
+  td->mb.tx_rd_hit_count_ptr = &td->rd_counts.tx_rd_hit_count;
+}
+
+void av1_encode_sb_row(AV1_COMP *cpi, ThreadData *td, int tile_row,
+                       int tile_col, int mi_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * tile_cols + tile_col];
+  const TileInfo *const tile_info = &this_tile->tile_info;
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync[tile_col];
+  TileDataEnc *const row_tile = &td->row_tile_data;
+  const int sb_row = mi_row >> MAX_MIB_SIZE_LOG2;
+  TOKENEXTRA *const tok_start =
+      cpi->tile_tok[tile_row][tile_col] + row_token_offset(tile_info, mi_row);
+  TOKENEXTRA *tok = tok_start;
+
+  assert(cpi->row_mt);
+
+  av1_setup_thread_mb(cpi, td);
+
+  // Every row starts from the thresholds the tile had at the start of the
+  // frame. The tile itself is only updated once its last row is done, at
+  // which point all other rows have already taken their copy.
+  memcpy(row_tile, this_tile, sizeof(*row_tile));
+
+  encode_rd_sb_row(cpi, td, row_tile, mi_row, &tok, row_mt_sync);
+
+  row_mt_sync->num_tok[sb_row] = (unsigned int)(tok - tok_start);
+  assert(tok - cpi->tile_tok[tile_row][tile_col] <=
+         row_token_offset(tile_info, AOMMIN(mi_row + MAX_MIB_SIZE,
+                                            tile_info->mi_row_end)));
+
+  if (mi_row + MAX_MIB_SIZE >= tile_info->mi_row_end) {
+    memcpy(this_tile->thresh_freq_fact, row_tile->thresh_freq_fact,
+           sizeof(this_tile->thresh_freq_fact));
+    memcpy(this_tile->mode_map, row_tile->mode_map,
+           sizeof(this_tile->mode_map));
+  }
+}
+
+void av1_merge_sb_row_tokens(AV1_COMP *cpi, int tile_row, int tile_col) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * tile_cols + tile_col];
+  const TileInfo *const tile_info = &this_tile->tile_info;
+  const AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync[tile_col];
+  TOKENEXTRA *const tile_tok = cpi->tile_tok[tile_row][tile_col];
+  TOKENEXTRA *tok = tile_tok;
+  int mi_row;
+
+  for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
+       mi_row += MAX_MIB_SIZE) {
+    const TOKENEXTRA *const row_tok =
+        tile_tok + row_token_offset(tile_info, mi_row);
+    const unsigned int num_tok =
+        row_mt_sync->num_tok[mi_row >> MAX_MIB_SIZE_LOG2];
+
+    if (tok != row_tok) memmove(tok, row_tok, num_tok * sizeof(*tok));
+    tok += num_tok;
+  }
+
+  cpi->tok_count[tile_row][tile_col] = (unsigned int)(tok - tile_tok);
 }
 
 void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
@@ -2865,9 +2981,7 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
   od_adapt_ctx *adapt;
 #endif
 
-  // Set up pointers to per thread motion search counters.
-  td->mb.m_search_count_ptr = &td->rd_counts.m_search_count;
-  td->mb.ex_search_count_ptr = &td->rd_counts.ex_search_count;
+  av1_setup_thread_mb(cpi, td);
 
 #if CONFIG_PVQ
   td->mb.pvq_q = &this_tile->pvq_q;
@@ -2900,7 +3014,7 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
 
   for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
        mi_row += MAX_MIB_SIZE) {
-    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok);
+    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok, NULL);
   }
   cpi->tok_count[tile_row][tile_col] =
       (unsigned int)(tok - cpi->tile_tok[tile_row][tile_col]);
@@ -2926,9 +3040,22 @@ static void encode_tiles(AV1_COMP *cpi) {
 
   av1_init_tile_data(cpi);
 
-  for (tile_row = 0; tile_row < tile_rows; ++tile_row)
-    for (tile_col = 0; tile_col < tile_cols; ++tile_col)
-      av1_encode_tile(cpi, &cpi->td, tile_row, tile_col);
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      if (cpi->row_mt) {
+        const TileInfo *const tile_info =
+            &cpi->tile_data[tile_row * tile_cols + tile_col].tile_info;
+        int mi_row;
+
+        for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
+             mi_row += MAX_MIB_SIZE)
+          av1_encode_sb_row(cpi, &cpi->td, tile_row, tile_col, mi_row);
+        av1_merge_sb_row_tokens(cpi, tile_row, tile_col);
+      } else {
+        av1_encode_tile(cpi, &cpi->td, tile_row, tile_col);
+      }
+    }
+  }
 }
 
 #if CONFIG_FP_MB_STATS
@@ -2965,6 +3092,9 @@ static void encode_frame_internal(AV1_COMP *cpi) {
   av1_zero(rdc->comp_pred_diff);
   rdc->m_search_count = 0;   // Count of motion search hits.
   rdc->ex_search_count = 0;  // Exhaustive mesh search hits.
+  rdc->tx_rd_lookup_count = 0;
+  rdc->tx_rd_hit_count = 0;
+  av1_reset_tx_rd_cache(&td->tx_rd_cache);
 
   for (i = 0; i < MAX_SEGMENTS; ++i) {
     const int qindex = cm->seg.enabled
@@ -2982,6 +3112,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
 
   av1_initialize_rd_consts(cpi);
   av1_initialize_me_consts(cpi, x, cm->base_qindex);
+  av1_setup_me_pyramids(cpi);
   init_encode_frame_mb_context(cpi);
   cm->use_prev_frame_mvs =
       !cm->error_resilient_mode && cm->width == cm->last_width &&
@@ -3029,8 +3160,20 @@ static void encode_frame_internal(AV1_COMP *cpi) {
     }
 #endif
 
-    // If allowed, encoding tiles in parallel with one thread handling one tile.
-    if (AOMMIN(cpi->oxcf.max_threads, 1 << cm->log2_tile_cols) > 1)
+    // Superblock rows of a tile depend on the state left by the previous row
+    // when PVQ or delta q is used, so those are always encoded per tile.
+    cpi->row_mt = cpi->oxcf.row_mt;
+#if CONFIG_PVQ
+    cpi->row_mt = 0;
+#endif
+#if CONFIG_DELTA_Q
+    if (cpi->oxcf.aq_mode == DELTA_AQ) cpi->row_mt = 0;
+#endif
+
+    // If allowed, encoding tiles in parallel with one thread handling one tile
+    // or, in row-mt mode, one superblock row at a time.
+    if ((cpi->row_mt && cpi->oxcf.max_threads > 1) ||
+        AOMMIN(cpi->oxcf.max_threads, 1 << cm->log2_tile_cols) > 1)
       av1_encode_tiles_mt(cpi);
     else
       encode_tiles(cpi);
@@ -37,9 +37,21 @@ void av1_setup_src_planes(struct macroblock *x,
 void av1_encode_frame(struct AV1_COMP *cpi);
 
 void av1_init_tile_data(struct AV1_COMP *cpi);
+
+// Sets up the pointers of the macroblock of td to the per thread motion
+// search counters and buffers.
+void av1_setup_thread_mb(const struct AV1_COMP *cpi, struct ThreadData *td);
+
 void av1_encode_tile(struct AV1_COMP *cpi, struct ThreadData *td, int tile_row,
                      int tile_col);
 
+// Encode one superblock row of a tile in row-mt mode. The tokens of each row
+// are stored in their own part of the tile token buffer and must be merged
+// with av1_merge_sb_row_tokens() once all rows of the tile are done.
+void av1_encode_sb_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                       int tile_row, int tile_col, int mi_row);
+void av1_merge_sb_row_tokens(struct AV1_COMP *cpi, int tile_row, int tile_col);
+
 void av1_set_variance_partition_thresholds(struct AV1_COMP *cpi, int q);
 
 #ifdef __cplusplus
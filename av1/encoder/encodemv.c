@@ -252,8 +252,8 @@ void av1_write_nmv_probs(AV1_COMMON *cm, int usehp, aom_writer *w,
 #endif
 }
 
-void av1_encode_mv(AV1_COMP *cpi, aom_writer *w, const MV *mv, const MV *ref,
-                   nmv_context *mvctx, int usehp) {
+void av1_encode_mv(AV1_COMP *cpi, ThreadData *td, aom_writer *w,
+                   const MV *mv, const MV *ref, nmv_context *mvctx, int usehp) {
   const MV diff = { mv->row - ref->row, mv->col - ref->col };
   const MV_JOINT_TYPE j = av1_get_mv_joint(&diff);
 
@@ -269,10 +269,11 @@ void av1_encode_mv(AV1_COMP *cpi, aom_writer *w, const MV *mv, const MV *ref,
     encode_mv_component(w, diff.col, &mvctx->comps[1], usehp);
 
   // If auto_mv_step_size is enabled then keep track of the largest
-  // motion vector component used.
+  // motion vector component used. The tiles may be packed on several
+  // threads, so each one keeps its own maximum.
   if (cpi->sf.mv.auto_mv_step_size) {
     unsigned int maxv = AOMMAX(abs(mv->row), abs(mv->col)) >> 3;
-    cpi->max_mv_magnitude = AOMMAX(maxv, cpi->max_mv_magnitude);
+    td->max_mv_magnitude = AOMMAX(maxv, td->max_mv_magnitude);
   }
 }
 
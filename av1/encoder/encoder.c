@@ -390,6 +390,9 @@ static void dealloc_compressor_data(AV1_COMP *cpi) {
   aom_free(cpi->tile_data);
   cpi->tile_data = NULL;
 
+  for (i = 0; i < (1 << 6); ++i)
+    av1_row_mt_sync_mem_dealloc(&cpi->row_mt_sync[i]);
+
   // Delete sementation map
   aom_free(cpi->segmentation_map);
   cpi->segmentation_map = NULL;
@@ -404,6 +407,8 @@ static void dealloc_compressor_data(AV1_COMP *cpi) {
   for (i = 0; i < MAX_UPSAMPLED_BUFS; i++)
     aom_free_frame_buffer(&cpi->upsampled_ref_bufs[i].buf);
 
+  av1_free_me_pyramids(cpi);
+
   av1_free_ref_frame_buffers(cm->buffer_pool);
   av1_free_context_buffers(cm);
 
@@ -1964,6 +1969,12 @@ void av1_remove_compressor(AV1_COMP *cpi) {
           SNPRINT2(results, "\t%7.3f", cpi->worst_consistency);
         }
 
+        SNPRINT(headings, "\tTxCache");
+        SNPRINT2(results, "\t%7.3f",
+                 cpi->tx_rd_lookup_count
+                     ? 100.0 * cpi->tx_rd_hit_count / cpi->tx_rd_lookup_count
+                     : 0.0);
+
         fprintf(f, "%s\t    Time\tRcErr\tAbsErr\n", headings);
         fprintf(f, "%s\t%8.0f\t%7.2f\t%7.2f\n", results, total_encode_time,
                 rate_err, fabs(rate_err));
@@ -1996,8 +2007,7 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     // Deallocate allocated thread data.
     if (t < cpi->num_workers - 1) {
 #if CONFIG_PALETTE
-      if (cpi->common.allow_screen_content_tools)
-        aom_free(thread_data->td->mb.palette_buffer);
+      aom_free(thread_data->td->mb.palette_buffer);
 #endif  // CONFIG_PALETTE
       aom_free(thread_data->td->counts);
       av1_free_pc_tree(thread_data->td);
@@ -2006,6 +2016,9 @@ void av1_remove_compressor(AV1_COMP *cpi) {
   }
   aom_free(cpi->tile_thr_data);
   aom_free(cpi->workers);
+#if CONFIG_MULTITHREAD
+  if (cpi->num_workers > 0) pthread_mutex_destroy(&cpi->job_queue.mutex_);
+#endif
 
   if (cpi->num_workers > 1) av1_loop_filter_dealloc(&cpi->lf_row_sync);
 
@@ -2022,6 +2035,11 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     cpi->twopass.frame_mb_stats_buf = NULL;
   }
 #endif
+  aom_free(cpi->twopass.row_stats);
+  aom_free(cpi->twopass.mb_factors);
+  aom_free(cpi->twopass.frame_mb_mvs);
+  aom_free(cpi->lpf_search_data.row_err);
+  aom_free(cpi->tile_pack.buf);
 
   av1_remove_common(cm);
   av1_free_ref_frame_buffers(cm->buffer_pool);
@@ -2401,7 +2419,7 @@ static INLINE int upsample_ref_frame(AV1_COMP *cpi,
 void av1_update_reference_frames(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   BufferPool *const pool = cm->buffer_pool;
-  const int use_upsampled_ref = cpi->sf.use_upsampled_references;
+  const int use_upsampled_ref = use_upsampled_ref_bufs(cpi);
   int new_uidx = 0;
 
   if (use_upsampled_ref) {
@@ -2642,8 +2660,13 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     cm->dering_level = 0;
   } else {
     cm->dering_level =
-        av1_dering_search(cm->frame_to_show, cpi->Source, cm, xd);
-    av1_dering_frame(cm->frame_to_show, cm, xd, cm->dering_level);
+        av1_dering_search(cm->frame_to_show, cpi->Source, cm, xd, cpi->workers,
+                          cpi->num_workers);
+    if (cpi->num_workers > 1)
+      av1_dering_frame_mt(cm->frame_to_show, cm, xd, cm->dering_level,
+                          cpi->workers, cpi->num_workers);
+    else
+      av1_dering_frame(cm->frame_to_show, cm, xd, cm->dering_level);
   }
 #endif  // CONFIG_DERING
 
@@ -2670,28 +2693,32 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     const YV12_BUFFER_CONFIG *const frame = cm->frame_to_show;
 
     // Find the best strength and block size for the entire frame
-    int fb_size_log2, strength_y, strength_u, strength_v;
-    av1_clpf_test_frame(frame, cpi->Source, cm, &strength_y, &fb_size_log2,
-                        AOM_PLANE_Y);
-    av1_clpf_test_frame(frame, cpi->Source, cm, &strength_u, 0, AOM_PLANE_U);
-    av1_clpf_test_frame(frame, cpi->Source, cm, &strength_v, 0, AOM_PLANE_V);
+    int fb_size_log2, strength[MAX_MB_PLANE];
+    int strength_y, strength_u, strength_v;
+    av1_clpf_test_frame_mt(frame, cpi->Source, cm, strength, &fb_size_log2,
+                           cpi->workers, cpi->num_workers);
+    strength_y = strength[AOM_PLANE_Y];
+    strength_u = strength[AOM_PLANE_U];
+    strength_v = strength[AOM_PLANE_V];
 
     if (strength_y) {
       // Apply the filter using the chosen strength
       cm->clpf_strength_y = strength_y - (strength_y == 4);
       cm->clpf_size =
           fb_size_log2 ? fb_size_log2 - MAX_FB_SIZE_LOG2 + 3 : CLPF_NOSIZE;
-      av1_clpf_frame(frame, cpi->Source, cm, cm->clpf_size != CLPF_NOSIZE,
-                     strength_y, 4 + cm->clpf_size, AOM_PLANE_Y,
-                     av1_clpf_decision);
+      av1_clpf_frame_mt(frame, cpi->Source, cm, cm->clpf_size != CLPF_NOSIZE,
+                        strength_y, 4 + cm->clpf_size, AOM_PLANE_Y,
+                        av1_clpf_decision, cpi->workers, cpi->num_workers);
     }
     if (strength_u) {
       cm->clpf_strength_u = strength_u - (strength_u == 4);
-      av1_clpf_frame(frame, NULL, cm, 0, strength_u, 4, AOM_PLANE_U, NULL);
+      av1_clpf_frame_mt(frame, NULL, cm, 0, strength_u, 4, AOM_PLANE_U, NULL,
+                        cpi->workers, cpi->num_workers);
     }
     if (strength_v) {
       cm->clpf_strength_v = strength_v - (strength_v == 4);
-      av1_clpf_frame(frame, NULL, cm, 0, strength_v, 4, AOM_PLANE_V, NULL);
+      av1_clpf_frame_mt(frame, NULL, cm, 0, strength_v, 4, AOM_PLANE_V, NULL,
+                        cpi->workers, cpi->num_workers);
     }
   }
 #endif
@@ -2784,7 +2811,7 @@ void av1_scale_references(AV1_COMP *cpi) {
         }
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
-        if (cpi->sf.use_upsampled_references &&
+        if (use_upsampled_ref_bufs(cpi) &&
             (force_scaling || new_fb_ptr->buf.y_crop_width != cm->width ||
              new_fb_ptr->buf.y_crop_height != cm->height)) {
           const int map_idx = get_ref_frame_map_idx(cpi, ref_frame);
@@ -3122,10 +3149,20 @@ static void reset_use_upsampled_references(AV1_COMP *cpi) {
   }
 }
 
+// Releases the up-sampled reference frames once the sub-pixel motion search
+// interpolates them on the fly.
+static void free_upsampled_ref_bufs(AV1_COMP *cpi) {
+  int i;
+
+  init_upsampled_ref_frame_bufs(cpi);
+  for (i = 0; i < MAX_UPSAMPLED_BUFS; ++i)
+    aom_free_frame_buffer(&cpi->upsampled_ref_bufs[i].buf);
+}
+
 static void encode_without_recode_loop(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   int q = 0, bottom_index = 0, top_index = 0;  // Dummy variables.
-  const int use_upsampled_ref = cpi->sf.use_upsampled_references;
+  const int use_upsampled_ref = use_upsampled_ref_bufs(cpi);
 
   aom_clear_system_state();
 
@@ -3160,8 +3197,10 @@ static void encode_without_recode_loop(AV1_COMP *cpi) {
   // cpi->sf.use_upsampled_references can be different from frame to frame.
   // Every time when cpi->sf.use_upsampled_references is changed from 0 to 1.
   // The reference frames for this frame have to be up-sampled before encoding.
-  if (!use_upsampled_ref && cpi->sf.use_upsampled_references)
+  if (!use_upsampled_ref && use_upsampled_ref_bufs(cpi))
     reset_use_upsampled_references(cpi);
+  else if (use_upsampled_ref && !use_upsampled_ref_bufs(cpi))
+    free_upsampled_ref_bufs(cpi);
 
   av1_set_quantizer(cm, q);
   av1_set_variance_partition_thresholds(cpi, q);
@@ -3208,7 +3247,7 @@ static void encode_with_recode_loop(AV1_COMP *cpi, size_t *size,
   int frame_over_shoot_limit;
   int frame_under_shoot_limit;
   int q = 0, q_low = 0, q_high = 0;
-  const int use_upsampled_ref = cpi->sf.use_upsampled_references;
+  const int use_upsampled_ref = use_upsampled_ref_bufs(cpi);
 
   set_size_independent_vars(cpi);
 
@@ -3225,8 +3264,10 @@ static void encode_with_recode_loop(AV1_COMP *cpi, size_t *size,
       // 1.
       // The reference frames for this frame have to be up-sampled before
       // encoding.
-      if (!use_upsampled_ref && cpi->sf.use_upsampled_references)
+      if (!use_upsampled_ref && use_upsampled_ref_bufs(cpi))
         reset_use_upsampled_references(cpi);
+      else if (use_upsampled_ref && !use_upsampled_ref_bufs(cpi))
+        free_upsampled_ref_bufs(cpi);
 
       // TODO(agrange) Scale cpi->max_mv_magnitude if frame-size has changed.
       set_mv_search_params(cpi);
@@ -4272,6 +4313,8 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
 #if CONFIG_EXT_REFS
   int brf_src_index;
 #endif  // CONFIG_EXT_REFS
+  // Offset of the source frame from the next frame to be shown.
+  int source_offset = 0;
   int i;
 
 #if CONFIG_BITSTREAM_DEBUG
@@ -4362,6 +4405,7 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
 
     if ((source = av1_lookahead_peek(cpi->lookahead, arf_src_index)) != NULL) {
       cpi->alt_ref_source = source;
+      source_offset = arf_src_index;
 
       if (oxcf->arnr_max_frames > 0) {
         // Produce the filtered ARF frame.
@@ -4388,6 +4432,7 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
   if (brf_src_index) {
     assert(brf_src_index <= rc->frames_to_key);
     if ((source = av1_lookahead_peek(cpi->lookahead, brf_src_index)) != NULL) {
+      source_offset = brf_src_index;
       cm->show_frame = 0;
       cm->intra_only = 0;
 
@@ -4430,6 +4475,11 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
     *time_end = source->ts_end;
     *frame_flags = (source->flags & AOM_EFLAG_FORCE_KF) ? FRAMEFLAGS_KEY : 0;
 
+    // cm->current_video_frame counts the source frames shown so far, and the
+    // last of those is the LAST reference.
+    cpi->twopass.this_frame_mb_mvs =
+        av1_get_firstpass_mvs(cpi, cm->current_video_frame + source_offset);
+    cpi->twopass.this_frame_mvs_dist = source_offset + 1;
   } else {
     *size = 0;
     if (flush && oxcf->pass == 1 && !cpi->twopass.first_pass_done) {
@@ -4525,6 +4575,8 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
   if (oxcf->pass != 1) {
     compute_internal_stats(cpi);
     cpi->bytes += (int)(*size);
+    cpi->tx_rd_lookup_count += cpi->td.rd_counts.tx_rd_lookup_count;
+    cpi->tx_rd_hit_count += cpi->td.rd_counts.tx_rd_hit_count;
   }
 #endif
 
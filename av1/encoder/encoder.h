@@ -25,6 +25,7 @@
 #include "av1/encoder/aq_cyclicrefresh.h"
 #include "av1/encoder/context_tree.h"
 #include "av1/encoder/encodemb.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/firstpass.h"
 #include "av1/encoder/lookahead.h"
 #include "av1/encoder/mbgraph.h"
@@ -237,6 +238,15 @@ typedef struct AV1EncoderConfig {
   int tile_rows;
 
   int max_threads;
+  // Encode superblock rows of a tile in parallel.
+  int row_mt;
+  // Pass the macroblock motion vectors of the first pass to the last pass.
+  int use_firstpass_mvs;
+  aom_fixed_buf_t firstpass_mvs_in;
+  // Reuse the transform RD results of inter blocks with known residuals.
+  int use_tx_rd_cache;
+  // Interpolate the up-sampled references on the fly whatever the frame size.
+  int upsampled_refs_on_the_fly;
 
   aom_fixed_buf_t two_pass_stats_in;
   struct aom_codec_pkt_list *output_pkt_list;
@@ -275,6 +285,8 @@ typedef struct RD_COUNTS {
   int64_t comp_pred_diff[REFERENCE_MODES];
   int m_search_count;
   int ex_search_count;
+  int tx_rd_lookup_count;
+  int tx_rd_hit_count;
 } RD_COUNTS;
 
 typedef struct ThreadData {
@@ -285,10 +297,62 @@ typedef struct ThreadData {
   PICK_MODE_CONTEXT *leaf_tree;
   PC_TREE *pc_tree;
   PC_TREE *pc_root;
+
+  // In row-mt mode, each superblock row adapts its own copy of the tile's
+  // mode search thresholds so that the result does not depend on the number
+  // of threads.
+  TileDataEnc row_tile_data;
+
+  UPSAMPLED_PRED_CACHE upsampled_pred_cache[UPSAMPLED_PRED_CACHE_SLOTS];
+
+  TX_RD_CACHE tx_rd_cache;
+
+  // The largest motion vector component packed by this thread, which is
+  // merged into cpi->max_mv_magnitude once all tiles have been packed.
+  unsigned int max_mv_magnitude;
 } ThreadData;
 
 struct EncWorkerData;
 
+// The frames and parameters of the alt-ref frame being filtered, which are
+// shared by the threads filtering its macroblock rows.
+typedef struct ARNRFilterData {
+  YV12_BUFFER_CONFIG *frames[MAX_LAG_BUFFERS];
+  int frame_count;
+  int alt_ref_index;
+  int strength;
+  struct scale_factors sf;
+} ARNRFilterData;
+
+// Output of the tiles packed on the workers. Tile (r, c) is written at
+// offset[r][c] of buf, has space[r][c] bytes there, and is size[r][c] + 1
+// bytes long.
+typedef struct TilePackBuffers {
+  uint8_t *buf;
+  size_t buf_size;
+  size_t offset[4][1 << 6];
+  size_t space[4][1 << 6];
+  unsigned int size[4][1 << 6];
+} TilePackBuffers;
+
+// The loop filter level being tried and the superblock rows it is measured
+// on, which are shared by the threads measuring them. Job i covers
+// superblock row first_row + i * row_step.
+typedef struct LPFSearchData {
+  const YV12_BUFFER_CONFIG *sd;
+  int filter_level;
+  int first_row;
+  int row_step;
+  int num_jobs;
+  // Set when each job filters its own superblock row, which requires the rows
+  // of the jobs not to be adjacent. Otherwise the frame is filtered before the
+  // jobs, which then only measure and restore their rows.
+  int filter_rows;
+  // Luma SSE of the row of each job.
+  int64_t *row_err;
+  int row_err_size;
+} LPFSearchData;
+
 typedef struct ActiveMap {
   int enabled;
   int update;
@@ -329,6 +393,11 @@ typedef struct AV1_COMP {
   EncRefCntBuffer upsampled_ref_bufs[MAX_UPSAMPLED_BUFS];
   int upsampled_ref_idx[MAX_UPSAMPLED_BUFS];
 
+  // Downscaled luma of the source and of each frame buffer, searched ahead of
+  // the full pel motion search.
+  ME_PYRAMID src_pyramid;
+  ME_PYRAMID ref_pyramid[FRAME_BUFFERS];
+
   TileDataEnc *tile_data;
   int allocated_tiles;  // Keep track of memory allocated for tiles.
 
@@ -366,6 +435,10 @@ typedef struct AV1_COMP {
 
   TOKENEXTRA *tile_tok[4][1 << 6];
   unsigned int tok_count[4][1 << 6];
+  // Superblock row synchronization of each tile column in row-mt mode. The
+  // rows span all tile rows, as a tile depends on the contexts left by the
+  // tile above it.
+  AV1RowMTSync row_mt_sync[1 << 6];
 
   // Ambient reconstruction err target for force key frames
   int64_t ambient_err;
@@ -428,6 +501,7 @@ typedef struct AV1_COMP {
   TWO_PASS twopass;
 
   YV12_BUFFER_CONFIG alt_ref_buffer;
+  ARNRFilterData arnr_filter_data;
 
 #if CONFIG_INTERNAL_STATS
   unsigned int mode_chosen_counts[MAX_MODES];
@@ -446,6 +520,9 @@ typedef struct AV1_COMP {
   unsigned int tot_recode_hits;
   double worst_ssim;
 
+  uint64_t tx_rd_lookup_count;
+  uint64_t tx_rd_hit_count;
+
   ImageStat fastssim;
   ImageStat psnrhvs;
 
@@ -536,7 +613,16 @@ typedef struct AV1_COMP {
   int num_workers;
   AVxWorker *workers;
   struct EncWorkerData *tile_thr_data;
+  AV1EncJobQueue job_queue;
+  // Pool the workers run on (see av1_set_enc_thread_pool()), or NULL.
+  AVxThreadPool *thread_pool;
+  int thread_pool_priority;
   AV1LfSync lf_row_sync;
+  LPFSearchData lpf_search_data;
+  TilePackBuffers tile_pack;
+  // Set when superblock rows of the current frame are encoded as separate
+  // jobs (see AV1EncoderConfig::row_mt).
+  int row_mt;
 #if CONFIG_ANS
   struct BufAnsCoder buf_ans;
 #endif  // CONFIG_ANS
@@ -623,6 +709,14 @@ static INLINE YV12_BUFFER_CONFIG *get_ref_frame_buffer(
                                 : NULL;
 }
 
+// Returns 1 if the sub-pixel motion search reads the up-sampled reference
+// frames from cpi->upsampled_ref_bufs rather than interpolating them on the
+// fly.
+static INLINE int use_upsampled_ref_bufs(const AV1_COMP *cpi) {
+  return cpi->sf.use_upsampled_references &&
+         !cpi->sf.upsampled_refs_on_the_fly;
+}
+
 static INLINE const YV12_BUFFER_CONFIG *get_upsampled_ref(
     const AV1_COMP *cpi, const MV_REFERENCE_FRAME ref_frame) {
   // Use up-sampled reference frames.
@@ -9,9 +9,14 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include "av1/encoder/bitstream.h"
 #include "av1/encoder/encodeframe.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/ethread.h"
+#include "av1/encoder/firstpass.h"
+#include "av1/encoder/picklpf.h"
+#include "av1/encoder/rdopt.h"
+#include "av1/encoder/temporal_filter.h"
 #include "aom_dsp/aom_dsp_common.h"
 
 static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
@@ -32,98 +37,337 @@ static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
   // Counts of all motion searches and exhuastive mesh searches.
   td->rd_counts.m_search_count += td_t->rd_counts.m_search_count;
   td->rd_counts.ex_search_count += td_t->rd_counts.ex_search_count;
+
+  // Lookups and hits of the transform rate distortion cache.
+  td->rd_counts.tx_rd_lookup_count += td_t->rd_counts.tx_rd_lookup_count;
+  td->rd_counts.tx_rd_hit_count += td_t->rd_counts.tx_rd_hit_count;
+}
+
+#if CONFIG_MULTITHREAD
+static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
+  const int kMaxTryLocks = 4000;
+  int locked = 0;
+  int i;
+
+  for (i = 0; i < kMaxTryLocks; ++i) {
+    if (!pthread_mutex_trylock(mutex)) {
+      locked = 1;
+      break;
+    }
+  }
+
+  if (!locked) pthread_mutex_lock(mutex);
+}
+#endif  // CONFIG_MULTITHREAD
+
+void av1_row_mt_sync_read(AV1RowMTSync *const row_mt_sync, int r, int c) {
+#if CONFIG_MULTITHREAD
+  const int nsync = row_mt_sync->sync_range;
+
+  if (r && !(c & (nsync - 1))) {
+    pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
+    mutex_lock(mutex);
+
+    while (c > row_mt_sync->cur_sb_col[r - 1] - nsync) {
+      pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_row_mt_sync_write(AV1RowMTSync *const row_mt_sync, int r, int c,
+                           const int sb_cols) {
+#if CONFIG_MULTITHREAD
+  const int nsync = row_mt_sync->sync_range;
+  int cur;
+  // Only signal when there are enough encoded SB for next row to run.
+  int sig = 1;
+
+  if (c < sb_cols - 1) {
+    cur = c;
+    if (c % nsync) sig = 0;
+  } else {
+    cur = sb_cols + nsync;
+  }
+
+  if (sig) {
+    mutex_lock(&row_mt_sync->mutex_[r]);
+
+    row_mt_sync->cur_sb_col[r] = cur;
+
+    pthread_cond_signal(&row_mt_sync->cond_[r]);
+    pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+  }
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Allocate memory for row synchronization
+void av1_row_mt_sync_mem_alloc(AV1RowMTSync *row_mt_sync, AV1_COMMON *cm,
+                               int rows) {
+  row_mt_sync->rows = rows;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                    aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+    if (row_mt_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
+                    aom_malloc(sizeof(*row_mt_sync->cond_) * rows));
+    if (row_mt_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&row_mt_sync->cond_[i], NULL);
+      }
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->cur_sb_col,
+                  aom_malloc(sizeof(*row_mt_sync->cur_sb_col) * rows));
+  CHECK_MEM_ERROR(cm, row_mt_sync->num_tok,
+                  aom_calloc(rows, sizeof(*row_mt_sync->num_tok)));
+
+  // Only the above-right superblock is needed to encode the current one.
+  row_mt_sync->sync_range = 1;
+}
+
+// Deallocate row synchronization related mutex and data
+void av1_row_mt_sync_mem_dealloc(AV1RowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      }
+      aom_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->cond_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i) {
+        pthread_cond_destroy(&row_mt_sync->cond_[i]);
+      }
+      aom_free(row_mt_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(row_mt_sync->cur_sb_col);
+    aom_free(row_mt_sync->num_tok);
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*row_mt_sync);
+  }
+}
+
+// Map a row-mt job index to a superblock row of a tile. Jobs are ordered by
+// superblock row and then by tile column, so that every job only depends on
+// jobs with a smaller index. As jobs are handed out in order, the lowest
+// unfinished job can always make progress.
+static void get_row_mt_job(const AV1_COMP *const cpi, int job, int *tile_row,
+                           int *tile_col, int *mi_row) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  int tr = 0;
+
+  *tile_col = job % tile_cols;
+  *mi_row = (job / tile_cols) * MAX_MIB_SIZE;
+  while (*mi_row >= cpi->tile_data[tr * tile_cols].tile_info.mi_row_end) ++tr;
+  *tile_row = tr;
+}
+
+// In row-mt mode there is one job per superblock row of each tile column.
+// Otherwise a job is a whole tile column, whose tiles are encoded from top to
+// bottom since a tile depends on the contexts left by the tile above it.
+static int get_num_jobs(const AV1_COMP *const cpi) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+
+  if (cpi->row_mt)
+    return (mi_cols_aligned_to_sb(cm->mi_rows) >> MAX_MIB_SIZE_LOG2) *
+           tile_cols;
+  return tile_cols;
+}
+
+// Returns the index of the next job to run, or -1 once all jobs are taken.
+static int get_next_job(AV1EncJobQueue *const job_queue) {
+  int job = -1;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&job_queue->mutex_);
+#endif
+  if (job_queue->next_job < job_queue->num_jobs) job = job_queue->next_job++;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&job_queue->mutex_);
+#endif
+
+  return job;
 }
 
 static int enc_worker_hook(EncWorkerData *const thread_data, void *unused) {
   AV1_COMP *const cpi = thread_data->cpi;
   const AV1_COMMON *const cm = &cpi->common;
-  const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
-  int t;
+  int job;
 
   (void)unused;
 
-  for (t = thread_data->start; t < tile_rows * tile_cols;
-       t += cpi->num_workers) {
-    int tile_row = t / tile_cols;
-    int tile_col = t % tile_cols;
+  while ((job = get_next_job(&cpi->job_queue)) >= 0) {
+    if (cpi->row_mt) {
+      int tile_row, tile_col, mi_row;
 
-    av1_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+      get_row_mt_job(cpi, job, &tile_row, &tile_col, &mi_row);
+      av1_encode_sb_row(cpi, thread_data->td, tile_row, tile_col, mi_row);
+    } else {
+      int tile_row;
+
+      for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+        av1_encode_tile(cpi, thread_data->td, tile_row, job);
+    }
   }
 
   return 0;
 }
 
-void av1_encode_tiles_mt(AV1_COMP *cpi) {
+// Creates the workers and their thread data, one per thread allowed by the
+// configuration, so that no job is limited by the needs of the first one.
+// Workers which find the job queue empty return immediately.
+static void create_enc_workers(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
-  const int tile_cols = 1 << cm->log2_tile_cols;
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-  const int num_workers = AOMMIN(cpi->oxcf.max_threads, tile_cols);
+  const int num_workers = cpi->oxcf.max_threads;
   int i;
 
-  av1_init_tile_data(cpi);
-
-  // Only run once to create threads and allocate thread data.
-  if (cpi->num_workers == 0) {
-    int allocated_workers = num_workers;
+  if (cpi->num_workers != 0) return;
 
-    CHECK_MEM_ERROR(cm, cpi->workers,
-                    aom_malloc(allocated_workers * sizeof(*cpi->workers)));
+  CHECK_MEM_ERROR(cm, cpi->workers,
+                  aom_malloc(num_workers * sizeof(*cpi->workers)));
 
-    CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
-                    aom_calloc(allocated_workers, sizeof(*cpi->tile_thr_data)));
+  CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
+                  aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
 
-    for (i = 0; i < allocated_workers; i++) {
-      AVxWorker *const worker = &cpi->workers[i];
-      EncWorkerData *thread_data = &cpi->tile_thr_data[i];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&cpi->job_queue.mutex_, NULL);
+#endif
 
-      ++cpi->num_workers;
-      winterface->init(worker);
+  for (i = 0; i < num_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[i];
+    EncWorkerData *thread_data = &cpi->tile_thr_data[i];
+
+    ++cpi->num_workers;
+    winterface->init(worker);
+
+    if (i < num_workers - 1) {
+      aom_worker_set_pool(worker, cpi->thread_pool, cpi->thread_pool_priority);
+      thread_data->cpi = cpi;
+
+      // Allocate thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td,
+                      aom_memalign(32, sizeof(*thread_data->td)));
+      av1_zero(*thread_data->td);
+
+      // Set up pc_tree.
+      thread_data->td->leaf_tree = NULL;
+      thread_data->td->pc_tree = NULL;
+      av1_setup_pc_tree(cm, thread_data->td);
+
+      // Allocate frame counters in thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td->counts,
+                      aom_calloc(1, sizeof(*thread_data->td->counts)));
+
+      // Create threads
+      if (!winterface->reset(worker))
+        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                           "Tile encoder thread creation failed");
+    } else {
+      // Main thread acts as a worker and uses the thread data in cpi.
+      thread_data->cpi = cpi;
+      thread_data->td = &cpi->td;
+    }
 
-      if (i < allocated_workers - 1) {
-        thread_data->cpi = cpi;
+    winterface->sync(worker);
+  }
+}
 
-        // Allocate thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td,
-                        aom_memalign(32, sizeof(*thread_data->td)));
-        av1_zero(*thread_data->td);
+// Runs hook on all the workers, the last one being the main thread, and waits
+// for them to finish.
+static void launch_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
 
-        // Set up pc_tree.
-        thread_data->td->leaf_tree = NULL;
-        thread_data->td->pc_tree = NULL;
-        av1_setup_pc_tree(cm, thread_data->td);
+  for (i = 0; i < cpi->num_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[i];
 
-        // Allocate frame counters in thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td->counts,
-                        aom_calloc(1, sizeof(*thread_data->td->counts)));
+    worker->hook = hook;
+    worker->data1 = &cpi->tile_thr_data[i];
+    worker->data2 = NULL;
+  }
 
-        // Create threads
-        if (!winterface->reset(worker))
-          aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                             "Tile encoder thread creation failed");
-      } else {
-        // Main thread acts as a worker and uses the thread data in cpi.
-        thread_data->cpi = cpi;
-        thread_data->td = &cpi->td;
-      }
+  for (i = 0; i < cpi->num_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[i];
 
-      winterface->sync(worker);
-    }
+    if (i == cpi->num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
   }
 
-  for (i = 0; i < num_workers; i++) {
+  for (i = 0; i < cpi->num_workers; i++) {
     AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *thread_data;
+    winterface->sync(worker);
+  }
+}
 
-    worker->hook = (AVxWorkerHook)enc_worker_hook;
-    worker->data1 = &cpi->tile_thr_data[i];
-    worker->data2 = NULL;
-    thread_data = (EncWorkerData *)worker->data1;
+// Copies the macroblock of cpi into the one of the worker thread data td,
+// keeping the buffers and counters owned by td.
+static void copy_thread_mb(AV1_COMP *cpi, ThreadData *td) {
+#if CONFIG_PALETTE
+  PALETTE_BUFFER *const palette_buffer = td->mb.palette_buffer;
+#endif  // CONFIG_PALETTE
+
+  td->mb = cpi->td.mb;
+#if CONFIG_PALETTE
+  td->mb.palette_buffer = palette_buffer;
+#endif  // CONFIG_PALETTE
+  av1_setup_thread_mb(cpi, td);
+}
+
+void av1_encode_tiles_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  int num_workers;
+  int i;
+
+  av1_init_tile_data(cpi);
+
+  create_enc_workers(cpi);
+
+  num_workers = cpi->num_workers;
+  cpi->job_queue.next_job = 0;
+  cpi->job_queue.num_jobs = get_num_jobs(cpi);
+
+  for (i = 0; i < num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
 
     // Before encoding a frame, copy the thread data from cpi.
     if (thread_data->td != &cpi->td) {
-      thread_data->td->mb = cpi->td.mb;
+      copy_thread_mb(cpi, thread_data->td);
       thread_data->td->rd_counts = cpi->td.rd_counts;
+      av1_reset_tx_rd_cache(&thread_data->td->tx_rd_cache);
     }
     if (thread_data->td->counts != &cpi->common.counts) {
       memcpy(thread_data->td->counts, &cpi->common.counts,
@@ -132,7 +376,8 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
 
 #if CONFIG_PALETTE
     // Allocate buffers used by palette coding mode.
-    if (cpi->common.allow_screen_content_tools && i < num_workers - 1) {
+    if (cpi->common.allow_screen_content_tools && i < num_workers - 1 &&
+        thread_data->td->mb.palette_buffer == NULL) {
       MACROBLOCK *x = &thread_data->td->mb;
       CHECK_MEM_ERROR(cm, x->palette_buffer,
                       aom_memalign(16, sizeof(*x->palette_buffer)));
@@ -141,28 +386,17 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
   }
 
   // Encode a frame
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
-
-    // Set the starting tile for each thread.
-    thread_data->start = i;
+  launch_enc_workers(cpi, (AVxWorkerHook)enc_worker_hook);
 
-    if (i == cpi->num_workers - 1)
-      winterface->execute(worker);
-    else
-      winterface->launch(worker);
+  if (cpi->row_mt) {
+    int tile_row, tile_col;
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+      for (tile_col = 0; tile_col < tile_cols; ++tile_col)
+        av1_merge_sb_row_tokens(cpi, tile_row, tile_col);
   }
 
-  // Encoding ends.
   for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    winterface->sync(worker);
-  }
-
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
 
     // Accumulate counters.
     if (i < cpi->num_workers - 1) {
@@ -171,3 +405,162 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
     }
   }
 }
+
+static int fp_worker_hook(EncWorkerData *const thread_data, void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  int mb_row;
+
+  (void)unused;
+
+  while ((mb_row = get_next_job(&cpi->job_queue)) >= 0)
+    av1_first_pass_row(cpi, thread_data->td, mb_row, &cpi->row_mt_sync[0]);
+
+  return 0;
+}
+
+void av1_first_pass_rows_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  // The first pass ignores tiling, so it uses the row synchronization of the
+  // first tile column, with one row per macroblock row.
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync[0];
+  int i;
+
+  create_enc_workers(cpi);
+
+  if (row_mt_sync->rows != cm->mb_rows) {
+    av1_row_mt_sync_mem_dealloc(row_mt_sync);
+    av1_row_mt_sync_mem_alloc(row_mt_sync, cm, cm->mb_rows);
+  }
+  memset(row_mt_sync->cur_sb_col, -1,
+         sizeof(*row_mt_sync->cur_sb_col) * cm->mb_rows);
+
+  // Rows are handed out in order, so the lowest unfinished row can always
+  // make progress.
+  cpi->job_queue.next_job = 0;
+  cpi->job_queue.num_jobs = cm->mb_rows;
+
+  for (i = 0; i < cpi->num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    // Before analysing a frame, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) copy_thread_mb(cpi, thread_data->td);
+  }
+
+  launch_enc_workers(cpi, (AVxWorkerHook)fp_worker_hook);
+}
+
+static int arnr_worker_hook(EncWorkerData *const thread_data, void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  int mb_row;
+
+  (void)unused;
+
+  while ((mb_row = get_next_job(&cpi->job_queue)) >= 0)
+    av1_temporal_filter_row(cpi, thread_data->td, mb_row);
+
+  return 0;
+}
+
+void av1_temporal_filter_rows_mt(AV1_COMP *cpi, int mb_rows) {
+  int i;
+
+  create_enc_workers(cpi);
+
+  cpi->job_queue.next_job = 0;
+  cpi->job_queue.num_jobs = mb_rows;
+
+  for (i = 0; i < cpi->num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    // Before filtering a frame, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) copy_thread_mb(cpi, thread_data->td);
+  }
+
+  launch_enc_workers(cpi, (AVxWorkerHook)arnr_worker_hook);
+}
+
+static int lpf_worker_hook(EncWorkerData *const thread_data, void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  int job;
+
+  (void)unused;
+
+  while ((job = get_next_job(&cpi->job_queue)) >= 0)
+    av1_try_filter_sb_row(cpi, thread_data->td, job);
+
+  return 0;
+}
+
+void av1_try_filter_sb_rows_mt(AV1_COMP *cpi, int num_jobs) {
+  int i;
+
+  create_enc_workers(cpi);
+
+  cpi->job_queue.next_job = 0;
+  cpi->job_queue.num_jobs = num_jobs;
+
+  for (i = 0; i < cpi->num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    // Before filtering a frame, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) copy_thread_mb(cpi, thread_data->td);
+  }
+
+  launch_enc_workers(cpi, (AVxWorkerHook)lpf_worker_hook);
+}
+
+static int pack_worker_hook(EncWorkerData *const thread_data, void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  int tile_col;
+
+  (void)unused;
+
+  while ((tile_col = get_next_job(&cpi->job_queue)) >= 0)
+    av1_pack_tile_col(cpi, thread_data->td, tile_col);
+
+  return 0;
+}
+
+void av1_pack_tile_cols_mt(AV1_COMP *cpi) {
+  int i;
+
+  create_enc_workers(cpi);
+
+  cpi->job_queue.next_job = 0;
+  cpi->job_queue.num_jobs = 1 << cpi->common.log2_tile_cols;
+
+  for (i = 0; i < cpi->num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    // Before packing a frame, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) {
+      copy_thread_mb(cpi, thread_data->td);
+      thread_data->td->max_mv_magnitude = 0;
+    }
+  }
+
+  launch_enc_workers(cpi, (AVxWorkerHook)pack_worker_hook);
+
+  // Accumulate the largest motion vector component into the thread data of
+  // cpi, like the counters of the encoding pass.
+  for (i = 0; i < cpi->num_workers; i++) {
+    const ThreadData *const td = cpi->tile_thr_data[i].td;
+    if (td != &cpi->td)
+      cpi->td.max_mv_magnitude =
+          AOMMAX(cpi->td.max_mv_magnitude, td->max_mv_magnitude);
+  }
+}
+
+int av1_set_enc_thread_pool(AV1_COMP *cpi, AVxThreadPool *pool, int priority) {
+  int i;
+  int ok = 1;
+
+  cpi->thread_pool = pool;
+  cpi->thread_pool_priority = priority;
+
+  // The last worker is the main thread.
+  for (i = 0; i < cpi->num_workers - 1; i++)
+    ok &= aom_worker_set_pool(&cpi->workers[i], pool, priority);
+
+  return ok;
+}
@@ -12,21 +12,87 @@
 #ifndef AV1_ENCODER_ETHREAD_H_
 #define AV1_ENCODER_ETHREAD_H_
 
+#include "./aom_config.h"
+#include "aom_util/aom_thread.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct AV1_COMP;
+struct AV1Common;
 struct ThreadData;
 
 typedef struct EncWorkerData {
   struct AV1_COMP *cpi;
   struct ThreadData *td;
-  int start;
 } EncWorkerData;
 
+// Jobs of a frame (tiles, or superblock rows of tiles in row-mt mode) are
+// handed out in order to whichever worker asks for one next, so that a worker
+// which finishes a cheap job early picks up more work instead of idling.
+typedef struct AV1EncJobQueue {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex_;
+#endif
+  int next_job;
+  int num_jobs;
+} AV1EncJobQueue;
+
+// Superblock row synchronization inside a tile column, used by the row-based
+// multi-threaded encoder.
+typedef struct AV1RowMTSync {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // Allocate memory to store the encoded superblock index in each row.
+  int *cur_sb_col;
+  // Number of tokens produced by each superblock row.
+  unsigned int *num_tok;
+  // The row above must be at least sync_range superblocks ahead before the
+  // current superblock can be encoded. Currently a power-of-2 number.
+  int sync_range;
+  int rows;
+} AV1RowMTSync;
+
+// Allocate memory for superblock row synchronization of one tile column.
+void av1_row_mt_sync_mem_alloc(AV1RowMTSync *row_mt_sync, struct AV1Common *cm,
+                               int rows);
+
+// Deallocate superblock row synchronization related mutex and data.
+void av1_row_mt_sync_mem_dealloc(AV1RowMTSync *row_mt_sync);
+
+// Wait until superblock (r - 1, c + sync_range - 1) has been encoded.
+void av1_row_mt_sync_read(AV1RowMTSync *const row_mt_sync, int r, int c);
+
+// Signal that superblock (r, c) has been encoded.
+void av1_row_mt_sync_write(AV1RowMTSync *const row_mt_sync, int r, int c,
+                           const int sb_cols);
+
 void av1_encode_tiles_mt(struct AV1_COMP *cpi);
 
+// Analyses the macroblock rows of a first pass frame on all the workers, in
+// a wavefront where each macroblock waits for its above right neighbour.
+void av1_first_pass_rows_mt(struct AV1_COMP *cpi);
+
+// Filters the mb_rows macroblock rows of the alt-ref frame on all the workers.
+void av1_temporal_filter_rows_mt(struct AV1_COMP *cpi, int mb_rows);
+
+// Runs the num_jobs superblock rows of a loop filter level search on all the
+// workers.
+void av1_try_filter_sb_rows_mt(struct AV1_COMP *cpi, int num_jobs);
+
+// Packs the tile columns of the frame into cpi->tile_pack, one tile column per
+// job.
+void av1_pack_tile_cols_mt(struct AV1_COMP *cpi);
+
+// Moves the workers to pool, or back to threads of their own if pool is NULL,
+// along with the workers created later. Returns 0 if a thread could not be
+// created.
+int av1_set_enc_thread_pool(struct AV1_COMP *cpi, AVxThreadPool *pool,
+                            int priority);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
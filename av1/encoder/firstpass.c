@@ -138,6 +138,52 @@ static void output_fpmb_stats(uint8_t *this_frame_mb_stats, int stats_size,
 }
 #endif
 
+static void output_fpmv_stats(const FIRSTPASS_MB_MV *mb_mvs, int mbs,
+                              struct aom_codec_pkt_list *pktlist) {
+  struct aom_codec_cx_pkt pkt;
+  pkt.kind = AOM_CODEC_FPMV_STATS_PKT;
+  pkt.data.firstpass_mvs.buf = (void *)mb_mvs;
+  pkt.data.firstpass_mvs.sz = mbs * sizeof(*mb_mvs);
+  aom_codec_pkt_list_add(pktlist, &pkt);
+}
+
+// The macroblock motion vectors are passed between the passes for frames of
+// the initial size only.
+static int firstpass_mvs_match_frame(const AV1_COMP *cpi) {
+  const AV1_COMMON *const cm = &cpi->common;
+  return cm->width == cpi->initial_width && cm->height == cpi->initial_height;
+}
+
+const FIRSTPASS_MB_MV *av1_get_firstpass_mvs(const AV1_COMP *cpi,
+                                             int frame_index) {
+  const AV1EncoderConfig *const oxcf = &cpi->oxcf;
+  const FIRSTPASS_MB_MV *const mb_mvs = oxcf->firstpass_mvs_in.buf;
+  const size_t mbs = cpi->common.MBs;
+
+  if (oxcf->pass != 2 || !oxcf->use_firstpass_mvs || mb_mvs == NULL ||
+      frame_index < 0 || !firstpass_mvs_match_frame(cpi) ||
+      (frame_index + 1) * mbs * sizeof(*mb_mvs) > oxcf->firstpass_mvs_in.sz)
+    return NULL;
+  return mb_mvs + frame_index * mbs;
+}
+
+int av1_firstpass_mv_candidate(const AV1_COMP *cpi, const MACROBLOCK *x,
+                               const FIRSTPASS_MB_MV *mb_mvs, int dist,
+                               int mb_index, MV *mv) {
+  const FIRSTPASS_MB_MV *const first = cpi->oxcf.firstpass_mvs_in.buf;
+  ptrdiff_t index = mb_mvs - first + mb_index;
+  int row = 0, col = 0, i;
+
+  for (i = 0; i < dist; ++i, index -= cpi->common.MBs) {
+    if (index < 0 || first[index].mv.as_int == INVALID_MV) return 0;
+    row += first[index].mv.as_mv.row;
+    col += first[index].mv.as_mv.col;
+  }
+  mv->row = clamp(row >> 3, x->mv_row_min, x->mv_row_max);
+  mv->col = clamp(col >> 3, x->mv_col_min, x->mv_col_max);
+  return 1;
+}
+
 static void zero_stats(FIRSTPASS_STATS *section) {
   section->frame = 0.0;
   section->weight = 0.0;
@@ -350,7 +396,8 @@ static int get_search_range(const AV1_COMP *cpi) {
 }
 
 static void first_pass_motion_search(AV1_COMP *cpi, MACROBLOCK *x,
-                                     const MV *ref_mv, MV *best_mv,
+                                     MV_REFERENCE_FRAME ref, int mb_row,
+                                     int mb_col, const MV *ref_mv, MV *best_mv,
                                      int *best_motion_err) {
   MACROBLOCKD *const xd = &x->e_mbd;
   MV tmp_mv = { 0, 0 };
@@ -374,6 +421,10 @@ static void first_pass_motion_search(AV1_COMP *cpi, MACROBLOCK *x,
   }
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
+  if (cpi->sf.mv.pyramid_levels)
+    av1_pyramid_motion_search(cpi, x, bsize, 2 * mb_row, 2 * mb_col, ref,
+                              ref_mv, &v_fn_ptr, &ref_mv_full);
+
   // Center the initial step/diamond search on best mv.
   tmp_err = cpi->diamond_search_sad(x, &cpi->ss_cfg, &ref_mv_full, &tmp_mv,
                                     step_param, x->sadperbit16, &num00,
@@ -446,70 +497,41 @@ static void set_first_pass_params(AV1_COMP *cpi) {
 
 #define UL_INTRA_THRESH 50
 #define INVALID_ROW -1
-void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
-  int mb_row, mb_col;
-  MACROBLOCK *const x = &cpi->td.mb;
+void av1_first_pass_row(AV1_COMP *cpi, ThreadData *td, int mb_row,
+                        AV1RowMTSync *row_mt_sync) {
+  int mb_col;
+  MACROBLOCK *const x = &td->mb;
   AV1_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
   TileInfo tile;
   struct macroblock_plane *const p = x->plane;
   struct macroblockd_plane *const pd = xd->plane;
-  const PICK_MODE_CONTEXT *ctx = &cpi->td.pc_root->none;
+  const PICK_MODE_CONTEXT *ctx = &td->pc_root->none;
+  FIRSTPASS_ROW_STATS *const stats = &cpi->twopass.row_stats[mb_row];
+  FIRSTPASS_MB_FACTORS *const factors =
+      &cpi->twopass.mb_factors[mb_row * cm->mb_cols];
+  FIRSTPASS_MB_MV *const mb_mvs =
+      cpi->twopass.frame_mb_mvs && firstpass_mvs_match_frame(cpi)
+          ? &cpi->twopass.frame_mb_mvs[mb_row * cm->mb_cols]
+          : NULL;
   int i;
 
   int recon_yoffset, recon_uvoffset;
-  int64_t intra_error = 0;
-  int64_t coded_error = 0;
-  int64_t sr_coded_error = 0;
-
-  int sum_mvr = 0, sum_mvc = 0;
-  int sum_mvr_abs = 0, sum_mvc_abs = 0;
-  int64_t sum_mvrs = 0, sum_mvcs = 0;
-  int mvcount = 0;
-  int intercount = 0;
-  int second_ref_count = 0;
   const int intrapenalty = INTRA_MODE_PENALTY;
-  double neutral_count;
-  int intra_skip_count = 0;
-  int image_data_start_row = INVALID_ROW;
-  int new_mv_count = 0;
-  int sum_in_vectors = 0;
-  MV lastmv = { 0, 0 };
-  TWO_PASS *twopass = &cpi->twopass;
   const MV zero_mv = { 0, 0 };
+  MV best_ref_mv = { 0, 0 };
   int recon_y_stride, recon_uv_stride, uv_mb_height;
 
   YV12_BUFFER_CONFIG *const lst_yv12 = get_ref_frame_buffer(cpi, LAST_FRAME);
   YV12_BUFFER_CONFIG *gld_yv12 = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
   YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
   const YV12_BUFFER_CONFIG *first_ref_buf = lst_yv12;
-  double intra_factor;
-  double brightness_factor;
-  BufferPool *const pool = cm->buffer_pool;
-#if CONFIG_PVQ
-  PVQ_QUEUE pvq_q;
-#endif
-
-  // First pass code requires valid last and new frame buffers.
-  assert(new_yv12 != NULL);
-  assert(frame_is_intra_only(cm) || (lst_yv12 != NULL));
-
-#if CONFIG_FP_MB_STATS
-  if (cpi->use_fp_mb_stats) {
-    av1_zero_array(cpi->twopass.frame_mb_stats_buf, cpi->initial_mbs);
-  }
-#endif
-
-  aom_clear_system_state();
-
-  intra_factor = 0.0;
-  brightness_factor = 0.0;
-  neutral_count = 0.0;
 
-  set_first_pass_params(cpi);
-  av1_set_quantizer(cm, find_fp_qindex(cm->bit_depth));
+  memset(stats, 0, sizeof(*stats));
 
-  av1_setup_block_planes(&x->e_mbd, cm->subsampling_x, cm->subsampling_y);
+  recon_y_stride = new_yv12->y_stride;
+  recon_uv_stride = new_yv12->uv_stride;
+  uv_mb_height = 16 >> (new_yv12->y_height > new_yv12->uv_height);
 
   av1_setup_src_planes(x, cpi->Source, 0, 0);
   av1_setup_dst_planes(xd->plane, new_yv12, 0, 0);
@@ -518,40 +540,11 @@ void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
     av1_setup_pre_planes(xd, 0, first_ref_buf, 0, 0, NULL);
   }
 
-  xd->mi = cm->mi_grid_visible;
-  xd->mi[0] = cm->mi;
-
-  av1_frame_init_quantizer(cpi);
-
-#if CONFIG_PVQ
-  // For pass 1 of 2-pass encoding, init here for PVQ for now.
-  {
-    od_adapt_ctx *adapt;
-
-    pvq_q.buf_len = 5000;
-    CHECK_MEM_ERROR(cm, pvq_q.buf, aom_malloc(pvq_q.buf_len * sizeof(PVQ_INFO)));
-    pvq_q.curr_pos = 0;
-    x->pvq_coded = 0;
-
-    x->pvq_q = &pvq_q;
-
-    // TODO(yushin): Since this init step is also called in 2nd pass,
-    // or 1-pass encoding, consider factoring out it as a function.
-    // TODO(yushin)
-    // If activity masking is enabled, change below to OD_HVS_QM
-    x->daala_enc.qm = OD_FLAT_QM;  // Hard coded. Enc/dec required to sync.
-    x->daala_enc.pvq_norm_lambda = OD_PVQ_LAMBDA;
-    x->daala_enc.pvq_norm_lambda_dc = OD_PVQ_LAMBDA;
-
-    od_init_qm(x->daala_enc.state.qm, x->daala_enc.state.qm_inv,
-               x->daala_enc.qm == OD_HVS_QM ? OD_QM8_Q4_HVS : OD_QM8_Q4_FLAT);
-    od_ec_enc_init(&x->daala_enc.ec, 65025);
-
-    adapt = &x->daala_enc.state.adapt;
-    od_ec_enc_reset(&x->daala_enc.ec);
-    od_adapt_ctx_reset(adapt, 0);
-  }
-#endif
+  // Every row uses the mode info of its own first 8x8 block, so that rows
+  // analysed by different threads do not share it. The entries above and to
+  // the left of it are never set in the first pass.
+  xd->mi = cm->mi_grid_visible + (mb_row << 1) * cm->mi_stride;
+  xd->mi[0] = cm->mi + (mb_row << 1) * cm->mi_stride;
 
   for (i = 0; i < MAX_MB_PLANE; ++i) {
     p[i].coeff = ctx->coeff[i];
@@ -563,246 +556,302 @@ void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
     p[i].eobs = ctx->eobs[i];
   }
 
-  av1_init_mv_probs(cm);
-#if CONFIG_ADAPT_SCAN
-  av1_init_scan_order(cm);
-#endif
-  av1_initialize_rd_consts(cpi);
-
   // Tiling is ignored in the first pass.
   av1_tile_init(&tile, cm, 0, 0);
 
-  recon_y_stride = new_yv12->y_stride;
-  recon_uv_stride = new_yv12->uv_stride;
-  uv_mb_height = 16 >> (new_yv12->y_height > new_yv12->uv_height);
+  // Reset above block coeffs.
+  xd->up_available = (mb_row != 0);
+  recon_yoffset = (mb_row * recon_y_stride * 16);
+  recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
 
-  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
-    MV best_ref_mv = { 0, 0 };
+  x->plane[0].src.buf += mb_row * 16 * x->plane[0].src.stride;
+  x->plane[1].src.buf += mb_row * uv_mb_height * x->plane[1].src.stride;
+  x->plane[2].src.buf += mb_row * uv_mb_height * x->plane[1].src.stride;
 
-    // Reset above block coeffs.
-    xd->up_available = (mb_row != 0);
-    recon_yoffset = (mb_row * recon_y_stride * 16);
-    recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
+  // Set up limit values for motion vectors to prevent them extending
+  // outside the UMV borders.
+  x->mv_row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
+  x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16) + BORDER_MV_PIXELS_B16;
 
-    // Set up limit values for motion vectors to prevent them extending
-    // outside the UMV borders.
-    x->mv_row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
-    x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16) + BORDER_MV_PIXELS_B16;
-
-    for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
-      int this_error;
-      const int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
-      const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
-      double log_intra;
-      int level_sample;
+  for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
+    int this_error;
+    const int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
+    const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
+    FIRSTPASS_MB_FACTORS *const mb_factors = &factors[mb_col];
+    double log_intra;
+    int level_sample;
 
 #if CONFIG_FP_MB_STATS
-      const int mb_index = mb_row * cm->mb_cols + mb_col;
+    const int mb_index = mb_row * cm->mb_cols + mb_col;
 #endif
 
-      aom_clear_system_state();
-
-      xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
-      xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
-      xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
-      xd->left_available = (mb_col != 0);
-      xd->mi[0]->mbmi.sb_type = bsize;
-      xd->mi[0]->mbmi.ref_frame[0] = INTRA_FRAME;
-      set_mi_row_col(xd, &tile, mb_row << 1, num_8x8_blocks_high_lookup[bsize],
-                     mb_col << 1, num_8x8_blocks_wide_lookup[bsize],
-                     cm->mi_rows, cm->mi_cols);
-
-      // Do intra 16x16 prediction.
-      xd->mi[0]->mbmi.segment_id = 0;
-      xd->mi[0]->mbmi.mode = DC_PRED;
-      xd->mi[0]->mbmi.tx_size =
-          use_dc_pred ? (bsize >= BLOCK_16X16 ? TX_16X16 : TX_8X8) : TX_4X4;
-      av1_encode_intra_block_plane(cm, x, bsize, 0);
-      this_error = aom_get_mb_ss(x->plane[0].src_diff);
-
-      // Keep a record of blocks that have almost no intra error residual
-      // (i.e. are in effect completely flat and untextured in the intra
-      // domain). In natural videos this is uncommon, but it is much more
-      // common in animations, graphics and screen content, so may be used
-      // as a signal to detect these types of content.
-      if (this_error < UL_INTRA_THRESH) {
-        ++intra_skip_count;
-      } else if ((mb_col > 0) && (image_data_start_row == INVALID_ROW)) {
-        image_data_start_row = mb_row;
-      }
+    // The above right macroblock must be reconstructed before this one is
+    // intra predicted.
+    if (row_mt_sync) av1_row_mt_sync_read(row_mt_sync, mb_row, mb_col);
+
+    aom_clear_system_state();
+
+    mb_factors->neutral_count = 0.0;
+
+    xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
+    xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
+    xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
+    xd->left_available = (mb_col != 0);
+    xd->mi[0]->mbmi.sb_type = bsize;
+    xd->mi[0]->mbmi.ref_frame[0] = INTRA_FRAME;
+    set_mi_row_col(xd, &tile, mb_row << 1, num_8x8_blocks_high_lookup[bsize],
+                   mb_col << 1, num_8x8_blocks_wide_lookup[bsize],
+                   cm->mi_rows, cm->mi_cols);
+
+    // Do intra 16x16 prediction.
+    xd->mi[0]->mbmi.segment_id = 0;
+    xd->mi[0]->mbmi.mode = DC_PRED;
+    xd->mi[0]->mbmi.tx_size =
+        use_dc_pred ? (bsize >= BLOCK_16X16 ? TX_16X16 : TX_8X8) : TX_4X4;
+    av1_encode_intra_block_plane(cm, x, bsize, 0);
+    this_error = aom_get_mb_ss(x->plane[0].src_diff);
+
+    // Keep a record of blocks that have almost no intra error residual
+    // (i.e. are in effect completely flat and untextured in the intra
+    // domain). In natural videos this is uncommon, but it is much more
+    // common in animations, graphics and screen content, so may be used
+    // as a signal to detect these types of content.
+    if (this_error < UL_INTRA_THRESH) {
+      ++stats->intra_skip_count;
+    } else if (mb_col > 0) {
+      stats->image_data = 1;
+    }
 
 #if CONFIG_AOM_HIGHBITDEPTH
-      if (cm->use_highbitdepth) {
-        switch (cm->bit_depth) {
-          case AOM_BITS_8: break;
-          case AOM_BITS_10: this_error >>= 4; break;
-          case AOM_BITS_12: this_error >>= 8; break;
-          default:
-            assert(0 &&
-                   "cm->bit_depth should be AOM_BITS_8, "
-                   "AOM_BITS_10 or AOM_BITS_12");
-            return;
-        }
+    if (cm->use_highbitdepth) {
+      switch (cm->bit_depth) {
+        case AOM_BITS_8: break;
+        case AOM_BITS_10: this_error >>= 4; break;
+        case AOM_BITS_12: this_error >>= 8; break;
+        default:
+          assert(0 &&
+                 "cm->bit_depth should be AOM_BITS_8, "
+                 "AOM_BITS_10 or AOM_BITS_12");
+          return;
       }
+    }
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
-      aom_clear_system_state();
-      log_intra = log(this_error + 1.0);
-      if (log_intra < 10.0)
-        intra_factor += 1.0 + ((10.0 - log_intra) * 0.05);
-      else
-        intra_factor += 1.0;
+    aom_clear_system_state();
+    log_intra = log(this_error + 1.0);
+    if (log_intra < 10.0)
+      mb_factors->intra_factor = 1.0 + ((10.0 - log_intra) * 0.05);
+    else
+      mb_factors->intra_factor = 1.0;
 
 #if CONFIG_AOM_HIGHBITDEPTH
-      if (cm->use_highbitdepth)
-        level_sample = CONVERT_TO_SHORTPTR(x->plane[0].src.buf)[0];
-      else
-        level_sample = x->plane[0].src.buf[0];
-#else
+    if (cm->use_highbitdepth)
+      level_sample = CONVERT_TO_SHORTPTR(x->plane[0].src.buf)[0];
+    else
       level_sample = x->plane[0].src.buf[0];
+#else
+    level_sample = x->plane[0].src.buf[0];
 #endif
-      if ((level_sample < DARK_THRESH) && (log_intra < 9.0))
-        brightness_factor += 1.0 + (0.01 * (DARK_THRESH - level_sample));
-      else
-        brightness_factor += 1.0;
+    if ((level_sample < DARK_THRESH) && (log_intra < 9.0))
+      mb_factors->brightness_factor =
+          1.0 + (0.01 * (DARK_THRESH - level_sample));
+    else
+      mb_factors->brightness_factor = 1.0;
 
-      // Intrapenalty below deals with situations where the intra and inter
-      // error scores are very low (e.g. a plain black frame).
-      // We do not have special cases in first pass for 0,0 and nearest etc so
-      // all inter modes carry an overhead cost estimate for the mv.
-      // When the error score is very low this causes us to pick all or lots of
-      // INTRA modes and throw lots of key frames.
-      // This penalty adds a cost matching that of a 0,0 mv to the intra case.
-      this_error += intrapenalty;
+    // Intrapenalty below deals with situations where the intra and inter
+    // error scores are very low (e.g. a plain black frame).
+    // We do not have special cases in first pass for 0,0 and nearest etc so
+    // all inter modes carry an overhead cost estimate for the mv.
+    // When the error score is very low this causes us to pick all or lots of
+    // INTRA modes and throw lots of key frames.
+    // This penalty adds a cost matching that of a 0,0 mv to the intra case.
+    this_error += intrapenalty;
 
-      // Accumulate the intra error.
-      intra_error += (int64_t)this_error;
+    // Accumulate the intra error.
+    stats->intra_error += (int64_t)this_error;
 
 #if CONFIG_FP_MB_STATS
-      if (cpi->use_fp_mb_stats) {
-        // initialization
-        cpi->twopass.frame_mb_stats_buf[mb_index] = 0;
-      }
+    if (cpi->use_fp_mb_stats) {
+      // initialization
+      cpi->twopass.frame_mb_stats_buf[mb_index] = 0;
+    }
 #endif
 
-      // Set up limit values for motion vectors to prevent them extending
-      // outside the UMV borders.
-      x->mv_col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
-      x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16) + BORDER_MV_PIXELS_B16;
+    // Set up limit values for motion vectors to prevent them extending
+    // outside the UMV borders.
+    x->mv_col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
+    x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16) + BORDER_MV_PIXELS_B16;
 
-      // Other than for the first frame do a motion search.
-      if (cm->current_video_frame > 0) {
-        int tmp_err, motion_error, raw_motion_error;
-        // Assume 0,0 motion with no mv overhead.
-        MV mv = { 0, 0 }, tmp_mv = { 0, 0 };
-        struct buf_2d unscaled_last_source_buf_2d;
+    // Other than for the first frame do a motion search.
+    if (cm->current_video_frame > 0) {
+      int tmp_err, motion_error, raw_motion_error;
+      // Assume 0,0 motion with no mv overhead.
+      MV mv = { 0, 0 }, tmp_mv = { 0, 0 };
+      struct buf_2d unscaled_last_source_buf_2d;
 
-        xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
+      xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
 #if CONFIG_AOM_HIGHBITDEPTH
-        if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
-          motion_error = highbd_get_prediction_error(
-              bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
-        } else {
-          motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                              &xd->plane[0].pre[0]);
-        }
+      if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+        motion_error = highbd_get_prediction_error(
+            bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
+      } else {
+        motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                            &xd->plane[0].pre[0]);
+      }
 #else
-        motion_error =
-            get_prediction_error(bsize, &x->plane[0].src, &xd->plane[0].pre[0]);
+      motion_error =
+          get_prediction_error(bsize, &x->plane[0].src, &xd->plane[0].pre[0]);
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
-        // Compute the motion error of the 0,0 motion using the last source
-        // frame as the reference. Skip the further motion search on
-        // reconstructed frame if this error is small.
-        unscaled_last_source_buf_2d.buf =
-            cpi->unscaled_last_source->y_buffer + recon_yoffset;
-        unscaled_last_source_buf_2d.stride =
-            cpi->unscaled_last_source->y_stride;
+      // Compute the motion error of the 0,0 motion using the last source
+      // frame as the reference. Skip the further motion search on
+      // reconstructed frame if this error is small.
+      unscaled_last_source_buf_2d.buf =
+          cpi->unscaled_last_source->y_buffer + recon_yoffset;
+      unscaled_last_source_buf_2d.stride = cpi->unscaled_last_source->y_stride;
 #if CONFIG_AOM_HIGHBITDEPTH
-        if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
-          raw_motion_error = highbd_get_prediction_error(
-              bsize, &x->plane[0].src, &unscaled_last_source_buf_2d, xd->bd);
-        } else {
-          raw_motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                                  &unscaled_last_source_buf_2d);
-        }
-#else
+      if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+        raw_motion_error = highbd_get_prediction_error(
+            bsize, &x->plane[0].src, &unscaled_last_source_buf_2d, xd->bd);
+      } else {
         raw_motion_error = get_prediction_error(bsize, &x->plane[0].src,
                                                 &unscaled_last_source_buf_2d);
+      }
+#else
+      raw_motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                              &unscaled_last_source_buf_2d);
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
-        // TODO(pengchong): Replace the hard-coded threshold
-        if (raw_motion_error > 25) {
-          // Test last reference frame using the previous best mv as the
-          // starting point (best reference) for the search.
-          first_pass_motion_search(cpi, x, &best_ref_mv, &mv, &motion_error);
-
-          // If the current best reference mv is not centered on 0,0 then do a
-          // 0,0 based search as well.
-          if (!is_zero_mv(&best_ref_mv)) {
-            tmp_err = INT_MAX;
-            first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv, &tmp_err);
-
-            if (tmp_err < motion_error) {
-              motion_error = tmp_err;
-              mv = tmp_mv;
-            }
+      // TODO(pengchong): Replace the hard-coded threshold
+      if (raw_motion_error > 25) {
+        // Test last reference frame using the previous best mv as the
+        // starting point (best reference) for the search.
+        first_pass_motion_search(cpi, x, LAST_FRAME, mb_row, mb_col,
+                                 &best_ref_mv, &mv, &motion_error);
+
+        // If the current best reference mv is not centered on 0,0 then do a
+        // 0,0 based search as well.
+        if (!is_zero_mv(&best_ref_mv)) {
+          tmp_err = INT_MAX;
+          first_pass_motion_search(cpi, x, LAST_FRAME, mb_row, mb_col,
+                                   &zero_mv, &tmp_mv, &tmp_err);
+
+          if (tmp_err < motion_error) {
+            motion_error = tmp_err;
+            mv = tmp_mv;
           }
+        }
 
-          // Search in an older reference frame.
-          if ((cm->current_video_frame > 1) && gld_yv12 != NULL) {
-            // Assume 0,0 motion with no mv overhead.
-            int gf_motion_error;
+        // Search in an older reference frame.
+        if ((cm->current_video_frame > 1) && gld_yv12 != NULL) {
+          // Assume 0,0 motion with no mv overhead.
+          int gf_motion_error;
 
-            xd->plane[0].pre[0].buf = gld_yv12->y_buffer + recon_yoffset;
+          xd->plane[0].pre[0].buf = gld_yv12->y_buffer + recon_yoffset;
 #if CONFIG_AOM_HIGHBITDEPTH
-            if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
-              gf_motion_error = highbd_get_prediction_error(
-                  bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
-            } else {
-              gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                                     &xd->plane[0].pre[0]);
-            }
-#else
+          if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+            gf_motion_error = highbd_get_prediction_error(
+                bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
+          } else {
             gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
                                                    &xd->plane[0].pre[0]);
+          }
+#else
+          gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                                 &xd->plane[0].pre[0]);
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
-            first_pass_motion_search(cpi, x, &zero_mv, &tmp_mv,
-                                     &gf_motion_error);
-
-            if (gf_motion_error < motion_error && gf_motion_error < this_error)
-              ++second_ref_count;
-
-            // Reset to last frame as reference buffer.
-            xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
-            xd->plane[1].pre[0].buf = first_ref_buf->u_buffer + recon_uvoffset;
-            xd->plane[2].pre[0].buf = first_ref_buf->v_buffer + recon_uvoffset;
-
-            // In accumulating a score for the older reference frame take the
-            // best of the motion predicted score and the intra coded error
-            // (just as will be done for) accumulation of "coded_error" for
-            // the last frame.
-            if (gf_motion_error < this_error)
-              sr_coded_error += gf_motion_error;
-            else
-              sr_coded_error += this_error;
-          } else {
-            sr_coded_error += motion_error;
-          }
+          first_pass_motion_search(cpi, x, GOLDEN_FRAME, mb_row, mb_col,
+                                   &zero_mv, &tmp_mv, &gf_motion_error);
+
+          if (gf_motion_error < motion_error && gf_motion_error < this_error)
+            ++stats->second_ref_count;
+
+          // Reset to last frame as reference buffer.
+          xd->plane[0].pre[0].buf = first_ref_buf->y_buffer + recon_yoffset;
+          xd->plane[1].pre[0].buf = first_ref_buf->u_buffer + recon_uvoffset;
+          xd->plane[2].pre[0].buf = first_ref_buf->v_buffer + recon_uvoffset;
+
+          // In accumulating a score for the older reference frame take the
+          // best of the motion predicted score and the intra coded error
+          // (just as will be done for) accumulation of "coded_error" for
+          // the last frame.
+          if (gf_motion_error < this_error)
+            stats->sr_coded_error += gf_motion_error;
+          else
+            stats->sr_coded_error += this_error;
         } else {
-          sr_coded_error += motion_error;
+          stats->sr_coded_error += motion_error;
         }
+      } else {
+        stats->sr_coded_error += motion_error;
+      }
+
+      if (mb_mvs) {
+        mb_mvs[mb_col].mv.as_mv.row = mv.row * 8;
+        mb_mvs[mb_col].mv.as_mv.col = mv.col * 8;
+      }
 
-        // Start by assuming that intra mode is best.
-        best_ref_mv.row = 0;
-        best_ref_mv.col = 0;
+      // Start by assuming that intra mode is best.
+      best_ref_mv.row = 0;
+      best_ref_mv.col = 0;
+
+#if CONFIG_FP_MB_STATS
+      if (cpi->use_fp_mb_stats) {
+        // intra predication statistics
+        cpi->twopass.frame_mb_stats_buf[mb_index] = 0;
+        cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_DCINTRA_MASK;
+        cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_MOTION_ZERO_MASK;
+        if (this_error > FPMB_ERROR_LARGE_TH) {
+          cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_ERROR_LARGE_MASK;
+        } else if (this_error < FPMB_ERROR_SMALL_TH) {
+          cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_ERROR_SMALL_MASK;
+        }
+      }
+#endif
+
+      if (motion_error <= this_error) {
+        aom_clear_system_state();
+
+        // Keep a count of cases where the inter and intra were very close
+        // and very low. This helps with scene cut detection for example in
+        // cropped clips with black bars at the sides or top and bottom.
+        if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
+            (this_error < (2 * intrapenalty))) {
+          mb_factors->neutral_count = 1.0;
+          // Also track cases where the intra is not much worse than the inter
+          // and use this in limiting the GF/arf group length.
+        } else if ((this_error > NCOUNT_INTRA_THRESH) &&
+                   (this_error < (NCOUNT_INTRA_FACTOR * motion_error))) {
+          mb_factors->neutral_count =
+              (double)motion_error / DOUBLE_DIVIDE_CHECK((double)this_error);
+        }
+
+        mv.row *= 8;
+        mv.col *= 8;
+        this_error = motion_error;
+        xd->mi[0]->mbmi.mode = NEWMV;
+        xd->mi[0]->mbmi.mv[0].as_mv = mv;
+        xd->mi[0]->mbmi.tx_size = TX_4X4;
+        xd->mi[0]->mbmi.ref_frame[0] = LAST_FRAME;
+        xd->mi[0]->mbmi.ref_frame[1] = NONE;
+        av1_build_inter_predictors_sby(xd, mb_row << 1, mb_col << 1, bsize);
+        av1_encode_sby_pass1(cm, x, bsize);
+        stats->sum_mvr += mv.row;
+        stats->sum_mvr_abs += abs(mv.row);
+        stats->sum_mvc += mv.col;
+        stats->sum_mvc_abs += abs(mv.col);
+        stats->sum_mvrs += mv.row * mv.row;
+        stats->sum_mvcs += mv.col * mv.col;
+        ++stats->intercount;
+
+        best_ref_mv = mv;
 
 #if CONFIG_FP_MB_STATS
         if (cpi->use_fp_mb_stats) {
-          // intra predication statistics
+          // inter predication statistics
           cpi->twopass.frame_mb_stats_buf[mb_index] = 0;
-          cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_DCINTRA_MASK;
+          cpi->twopass.frame_mb_stats_buf[mb_index] &= ~FPMB_DCINTRA_MASK;
           cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_MOTION_ZERO_MASK;
           if (this_error > FPMB_ERROR_LARGE_TH) {
             cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_ERROR_LARGE_MASK;
@@ -812,140 +861,222 @@ void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
         }
 #endif
 
-        if (motion_error <= this_error) {
-          aom_clear_system_state();
-
-          // Keep a count of cases where the inter and intra were very close
-          // and very low. This helps with scene cut detection for example in
-          // cropped clips with black bars at the sides or top and bottom.
-          if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
-              (this_error < (2 * intrapenalty))) {
-            neutral_count += 1.0;
-            // Also track cases where the intra is not much worse than the inter
-            // and use this in limiting the GF/arf group length.
-          } else if ((this_error > NCOUNT_INTRA_THRESH) &&
-                     (this_error < (NCOUNT_INTRA_FACTOR * motion_error))) {
-            neutral_count +=
-                (double)motion_error / DOUBLE_DIVIDE_CHECK((double)this_error);
-          }
-
-          mv.row *= 8;
-          mv.col *= 8;
-          this_error = motion_error;
-          xd->mi[0]->mbmi.mode = NEWMV;
-          xd->mi[0]->mbmi.mv[0].as_mv = mv;
-          xd->mi[0]->mbmi.tx_size = TX_4X4;
-          xd->mi[0]->mbmi.ref_frame[0] = LAST_FRAME;
-          xd->mi[0]->mbmi.ref_frame[1] = NONE;
-          av1_build_inter_predictors_sby(xd, mb_row << 1, mb_col << 1, bsize);
-          av1_encode_sby_pass1(cm, x, bsize);
-          sum_mvr += mv.row;
-          sum_mvr_abs += abs(mv.row);
-          sum_mvc += mv.col;
-          sum_mvc_abs += abs(mv.col);
-          sum_mvrs += mv.row * mv.row;
-          sum_mvcs += mv.col * mv.col;
-          ++intercount;
-
-          best_ref_mv = mv;
+        if (!is_zero_mv(&mv)) {
+          ++stats->mvcount;
 
 #if CONFIG_FP_MB_STATS
           if (cpi->use_fp_mb_stats) {
-            // inter predication statistics
-            cpi->twopass.frame_mb_stats_buf[mb_index] = 0;
-            cpi->twopass.frame_mb_stats_buf[mb_index] &= ~FPMB_DCINTRA_MASK;
-            cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_MOTION_ZERO_MASK;
-            if (this_error > FPMB_ERROR_LARGE_TH) {
+            cpi->twopass.frame_mb_stats_buf[mb_index] &=
+                ~FPMB_MOTION_ZERO_MASK;
+            // check estimated motion direction
+            if (mv.col > 0 && mv.col >= abs(mv.row)) {
+              // right direction
+              cpi->twopass.frame_mb_stats_buf[mb_index] |=
+                  FPMB_MOTION_RIGHT_MASK;
+            } else if (mv.row < 0 && abs(mv.row) >= abs(mv.col)) {
+              // up direction
+              cpi->twopass.frame_mb_stats_buf[mb_index] |= FPMB_MOTION_UP_MASK;
+            } else if (mv.col < 0 && abs(mv.col) >= abs(mv.row)) {
+              // left direction
               cpi->twopass.frame_mb_stats_buf[mb_index] |=
-                  FPMB_ERROR_LARGE_MASK;
-            } else if (this_error < FPMB_ERROR_SMALL_TH) {
+                  FPMB_MOTION_LEFT_MASK;
+            } else {
+              // down direction
               cpi->twopass.frame_mb_stats_buf[mb_index] |=
-                  FPMB_ERROR_SMALL_MASK;
+                  FPMB_MOTION_DOWN_MASK;
             }
           }
 #endif
 
-          if (!is_zero_mv(&mv)) {
-            ++mvcount;
+          // Non-zero vector, was it different from the last non zero vector?
+          // The first one of the row is compared when the rows are merged.
+          if (stats->mvcount == 1)
+            stats->first_mv = mv;
+          else if (!is_equal_mv(&mv, &stats->last_mv))
+            ++stats->new_mv_count;
+          stats->last_mv = mv;
+
+          // Does the row vector point inwards or outwards?
+          if (mb_row < cm->mb_rows / 2) {
+            if (mv.row > 0)
+              --stats->sum_in_vectors;
+            else if (mv.row < 0)
+              ++stats->sum_in_vectors;
+          } else if (mb_row > cm->mb_rows / 2) {
+            if (mv.row > 0)
+              ++stats->sum_in_vectors;
+            else if (mv.row < 0)
+              --stats->sum_in_vectors;
+          }
+
+          // Does the col vector point inwards or outwards?
+          if (mb_col < cm->mb_cols / 2) {
+            if (mv.col > 0)
+              --stats->sum_in_vectors;
+            else if (mv.col < 0)
+              ++stats->sum_in_vectors;
+          } else if (mb_col > cm->mb_cols / 2) {
+            if (mv.col > 0)
+              ++stats->sum_in_vectors;
+            else if (mv.col < 0)
+              --stats->sum_in_vectors;
+          }
+        }
+      }
+    } else {
+      stats->sr_coded_error += (int64_t)this_error;
+    }
+    stats->coded_error += (int64_t)this_error;
+
+    if (row_mt_sync)
+      av1_row_mt_sync_write(row_mt_sync, mb_row, mb_col, cm->mb_cols);
+
+    // Adjust to the next column of MBs.
+    x->plane[0].src.buf += 16;
+    x->plane[1].src.buf += uv_mb_height;
+    x->plane[2].src.buf += uv_mb_height;
+
+    recon_yoffset += 16;
+    recon_uvoffset += uv_mb_height;
+  }
+
+  aom_clear_system_state();
+}
+
+static void alloc_row_stats(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  TWO_PASS *const twopass = &cpi->twopass;
+
+  if (twopass->row_stats_rows < cm->mb_rows) {
+    aom_free(twopass->row_stats);
+    CHECK_MEM_ERROR(cm, twopass->row_stats,
+                    aom_malloc(cm->mb_rows * sizeof(*twopass->row_stats)));
+    twopass->row_stats_rows = cm->mb_rows;
+  }
+  if (twopass->mb_factors_size < cm->MBs) {
+    aom_free(twopass->mb_factors);
+    CHECK_MEM_ERROR(cm, twopass->mb_factors,
+                    aom_malloc(cm->MBs * sizeof(*twopass->mb_factors)));
+    twopass->mb_factors_size = cm->MBs;
+  }
+  if (cpi->oxcf.use_firstpass_mvs && twopass->frame_mb_mvs == NULL) {
+    CHECK_MEM_ERROR(
+        cm, twopass->frame_mb_mvs,
+        aom_malloc(cpi->initial_mbs * sizeof(*twopass->frame_mb_mvs)));
+  }
+}
+
+void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
+  int mb_row;
+  MACROBLOCK *const x = &cpi->td.mb;
+  AV1_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  int i;
+
+  int64_t intra_error = 0;
+  int64_t coded_error = 0;
+  int64_t sr_coded_error = 0;
+
+  int sum_mvr = 0, sum_mvc = 0;
+  int sum_mvr_abs = 0, sum_mvc_abs = 0;
+  int64_t sum_mvrs = 0, sum_mvcs = 0;
+  int mvcount = 0;
+  int intercount = 0;
+  int second_ref_count = 0;
+  double neutral_count;
+  int intra_skip_count = 0;
+  int image_data_start_row = INVALID_ROW;
+  int new_mv_count = 0;
+  int sum_in_vectors = 0;
+  MV lastmv = { 0, 0 };
+  TWO_PASS *twopass = &cpi->twopass;
+
+  YV12_BUFFER_CONFIG *const lst_yv12 = get_ref_frame_buffer(cpi, LAST_FRAME);
+  YV12_BUFFER_CONFIG *gld_yv12 = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
+  YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
+  double intra_factor;
+  double brightness_factor;
+  BufferPool *const pool = cm->buffer_pool;
+#if CONFIG_PVQ
+  PVQ_QUEUE pvq_q;
+#endif
+
+  // First pass code requires valid last and new frame buffers.
+  assert(new_yv12 != NULL);
+  assert(frame_is_intra_only(cm) || (lst_yv12 != NULL));
 
 #if CONFIG_FP_MB_STATS
-            if (cpi->use_fp_mb_stats) {
-              cpi->twopass.frame_mb_stats_buf[mb_index] &=
-                  ~FPMB_MOTION_ZERO_MASK;
-              // check estimated motion direction
-              if (mv.col > 0 && mv.col >= abs(mv.row)) {
-                // right direction
-                cpi->twopass.frame_mb_stats_buf[mb_index] |=
-                    FPMB_MOTION_RIGHT_MASK;
-              } else if (mv.row < 0 && abs(mv.row) >= abs(mv.col)) {
-                // up direction
-                cpi->twopass.frame_mb_stats_buf[mb_index] |=
-                    FPMB_MOTION_UP_MASK;
-              } else if (mv.col < 0 && abs(mv.col) >= abs(mv.row)) {
-                // left direction
-                cpi->twopass.frame_mb_stats_buf[mb_index] |=
-                    FPMB_MOTION_LEFT_MASK;
-              } else {
-                // down direction
-                cpi->twopass.frame_mb_stats_buf[mb_index] |=
-                    FPMB_MOTION_DOWN_MASK;
-              }
-            }
+  if (cpi->use_fp_mb_stats) {
+    av1_zero_array(cpi->twopass.frame_mb_stats_buf, cpi->initial_mbs);
+  }
 #endif
 
-            // Non-zero vector, was it different from the last non zero vector?
-            if (!is_equal_mv(&mv, &lastmv)) ++new_mv_count;
-            lastmv = mv;
-
-            // Does the row vector point inwards or outwards?
-            if (mb_row < cm->mb_rows / 2) {
-              if (mv.row > 0)
-                --sum_in_vectors;
-              else if (mv.row < 0)
-                ++sum_in_vectors;
-            } else if (mb_row > cm->mb_rows / 2) {
-              if (mv.row > 0)
-                ++sum_in_vectors;
-              else if (mv.row < 0)
-                --sum_in_vectors;
-            }
+  aom_clear_system_state();
 
-            // Does the col vector point inwards or outwards?
-            if (mb_col < cm->mb_cols / 2) {
-              if (mv.col > 0)
-                --sum_in_vectors;
-              else if (mv.col < 0)
-                ++sum_in_vectors;
-            } else if (mb_col > cm->mb_cols / 2) {
-              if (mv.col > 0)
-                ++sum_in_vectors;
-              else if (mv.col < 0)
-                --sum_in_vectors;
-            }
-          }
-        }
-      } else {
-        sr_coded_error += (int64_t)this_error;
-      }
-      coded_error += (int64_t)this_error;
+  intra_factor = 0.0;
+  brightness_factor = 0.0;
+  neutral_count = 0.0;
 
-      // Adjust to the next column of MBs.
-      x->plane[0].src.buf += 16;
-      x->plane[1].src.buf += uv_mb_height;
-      x->plane[2].src.buf += uv_mb_height;
+  set_first_pass_params(cpi);
+  av1_set_quantizer(cm, find_fp_qindex(cm->bit_depth));
 
-      recon_yoffset += 16;
-      recon_uvoffset += uv_mb_height;
-    }
+  av1_setup_block_planes(&x->e_mbd, cm->subsampling_x, cm->subsampling_y);
 
-    // Adjust to the next row of MBs.
-    x->plane[0].src.buf += 16 * x->plane[0].src.stride - 16 * cm->mb_cols;
-    x->plane[1].src.buf +=
-        uv_mb_height * x->plane[1].src.stride - uv_mb_height * cm->mb_cols;
-    x->plane[2].src.buf +=
-        uv_mb_height * x->plane[1].src.stride - uv_mb_height * cm->mb_cols;
+  xd->mi = cm->mi_grid_visible;
+  xd->mi[0] = cm->mi;
 
-    aom_clear_system_state();
+  av1_frame_init_quantizer(cpi);
+
+#if CONFIG_PVQ
+  // For pass 1 of 2-pass encoding, init here for PVQ for now.
+  {
+    od_adapt_ctx *adapt;
+
+    pvq_q.buf_len = 5000;
+    CHECK_MEM_ERROR(cm, pvq_q.buf, aom_malloc(pvq_q.buf_len * sizeof(PVQ_INFO)));
+    pvq_q.curr_pos = 0;
+    x->pvq_coded = 0;
+
+    x->pvq_q = &pvq_q;
+
+    // TODO(yushin): Since this init step is also called in 2nd pass,
+    // or 1-pass encoding, consider factoring out it as a function.
+    // TODO(yushin)
+    // If activity masking is enabled, change below to OD_HVS_QM
+    x->daala_enc.qm = OD_FLAT_QM;  // Hard coded. Enc/dec required to sync.
+    x->daala_enc.pvq_norm_lambda = OD_PVQ_LAMBDA;
+    x->daala_enc.pvq_norm_lambda_dc = OD_PVQ_LAMBDA;
+
+    od_init_qm(x->daala_enc.state.qm, x->daala_enc.state.qm_inv,
+               x->daala_enc.qm == OD_HVS_QM ? OD_QM8_Q4_HVS : OD_QM8_Q4_FLAT);
+    od_ec_enc_init(&x->daala_enc.ec, 65025);
+
+    adapt = &x->daala_enc.state.adapt;
+    od_ec_enc_reset(&x->daala_enc.ec);
+    od_adapt_ctx_reset(adapt, 0);
+  }
+#endif
+
+  av1_init_mv_probs(cm);
+#if CONFIG_ADAPT_SCAN
+  av1_init_scan_order(cm);
+#endif
+  av1_initialize_rd_consts(cpi);
+  av1_setup_me_pyramids(cpi);
+
+  alloc_row_stats(cpi);
+  if (twopass->frame_mb_mvs) {
+    for (i = 0; i < cpi->initial_mbs; ++i)
+      twopass->frame_mb_mvs[i].mv.as_int = INVALID_MV;
+  }
+
+  // PVQ codes all the macroblocks of a frame with one entropy coder, so the
+  // rows are only analysed in parallel without it.
+  if (!CONFIG_PVQ && cpi->oxcf.max_threads > 1 && cm->mb_rows > 1) {
+    av1_first_pass_rows_mt(cpi);
+  } else {
+    for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row)
+      av1_first_pass_row(cpi, &cpi->td, mb_row, NULL);
   }
 
 #if CONFIG_PVQ
@@ -958,6 +1089,40 @@ void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
   aom_free(pvq_q.buf);
 #endif
 
+  // Merge the rows in raster order, which gives the same result as analysing
+  // the whole frame on a single thread.
+  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
+    const FIRSTPASS_ROW_STATS *const stats = &twopass->row_stats[mb_row];
+
+    intra_error += stats->intra_error;
+    coded_error += stats->coded_error;
+    sr_coded_error += stats->sr_coded_error;
+    sum_mvr += stats->sum_mvr;
+    sum_mvc += stats->sum_mvc;
+    sum_mvr_abs += stats->sum_mvr_abs;
+    sum_mvc_abs += stats->sum_mvc_abs;
+    sum_mvrs += stats->sum_mvrs;
+    sum_mvcs += stats->sum_mvcs;
+    intercount += stats->intercount;
+    second_ref_count += stats->second_ref_count;
+    intra_skip_count += stats->intra_skip_count;
+    sum_in_vectors += stats->sum_in_vectors;
+    if (stats->image_data && image_data_start_row == INVALID_ROW)
+      image_data_start_row = mb_row;
+    if (stats->mvcount > 0) {
+      mvcount += stats->mvcount;
+      new_mv_count +=
+          stats->new_mv_count + !is_equal_mv(&stats->first_mv, &lastmv);
+      lastmv = stats->last_mv;
+    }
+  }
+
+  aom_clear_system_state();
+  for (i = 0; i < cm->MBs; ++i) {
+    intra_factor += twopass->mb_factors[i].intra_factor;
+    brightness_factor += twopass->mb_factors[i].brightness_factor;
+    neutral_count += twopass->mb_factors[i].neutral_count;
+  }
   // Clamp the image start to rows/2. This number of rows is discarded top
   // and bottom as dead data so rows / 2 means the frame is blank.
   if ((image_data_start_row > cm->mb_rows / 2) ||
@@ -1038,6 +1203,10 @@ void av1_first_pass(AV1_COMP *cpi, const struct lookahead_entry *source) {
                         cpi->output_pkt_list);
     }
 #endif
+    if (twopass->frame_mb_mvs) {
+      output_fpmv_stats(twopass->frame_mb_mvs, cpi->initial_mbs,
+                        cpi->output_pkt_list);
+    }
   }
 
   // Copy the previous Last Frame back into gf and and arf buffers if
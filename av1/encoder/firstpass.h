@@ -12,6 +12,7 @@
 #ifndef AV1_ENCODER_FIRSTPASS_H_
 #define AV1_ENCODER_FIRSTPASS_H_
 
+#include "av1/common/mv.h"
 #include "av1/encoder/lookahead.h"
 #include "av1/encoder/ratectrl.h"
 
@@ -98,6 +99,49 @@ typedef enum {
   FRAME_CONTENT_TYPES = 2
 } FRAME_CONTENT_TYPE;
 
+// Statistics of one macroblock row of a first pass frame. The rows may be
+// analysed by different threads and are merged in raster order, so that the
+// frame statistics do not depend on the number of threads.
+typedef struct {
+  int64_t intra_error;
+  int64_t coded_error;
+  int64_t sr_coded_error;
+  int64_t sum_mvrs;
+  int64_t sum_mvcs;
+  int sum_mvr;
+  int sum_mvc;
+  int sum_mvr_abs;
+  int sum_mvc_abs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int intra_skip_count;
+  int sum_in_vectors;
+  // Set if a macroblock other than the first one of the row is not flat.
+  int image_data;
+  // Number of non-zero motion vectors that differ from the previous non-zero
+  // one of the row. The first one is compared with the last one of the rows
+  // above when the rows are merged.
+  int new_mv_count;
+  MV first_mv;
+  MV last_mv;
+} FIRSTPASS_ROW_STATS;
+
+// Floating point statistics of one macroblock. They are summed in raster
+// order, as the result of a floating point sum depends on its order.
+typedef struct {
+  double intra_factor;
+  double brightness_factor;
+  double neutral_count;
+} FIRSTPASS_MB_FACTORS;
+
+// Motion vector of one macroblock found by the first pass against the previous
+// source frame, in 1/8 pel, or INVALID_MV when that search was not made. One
+// of these per macroblock of a frame forms an AOM_CODEC_FPMV_STATS_PKT.
+typedef struct {
+  int_mv mv;
+} FIRSTPASS_MB_MV;
+
 typedef struct {
   unsigned char index;
   RATE_FACTOR_LEVEL rf_level[(MAX_LAG_BUFFERS * 2) + 1];
@@ -132,6 +176,20 @@ typedef struct {
   uint8_t *this_frame_mb_stats;
   FIRSTPASS_MB_STATS firstpass_mb_stats;
 #endif
+  // Statistics of the rows and macroblocks of the first pass frame.
+  FIRSTPASS_ROW_STATS *row_stats;
+  int row_stats_rows;
+  FIRSTPASS_MB_FACTORS *mb_factors;
+  int mb_factors_size;
+
+  // Motion vectors of the macroblocks of the first pass frame, allocated when
+  // AV1EncoderConfig::use_firstpass_mvs is set.
+  FIRSTPASS_MB_MV *frame_mb_mvs;
+  // Motion vectors the first pass found for the source frame being coded, and
+  // the number of frames from that to the last shown frame.
+  const FIRSTPASS_MB_MV *this_frame_mb_mvs;
+  int this_frame_mvs_dist;
+
   // An indication of the content type of the current frame
   FRAME_CONTENT_TYPE fr_content_type;
 
@@ -159,12 +217,35 @@ typedef struct {
 } TWO_PASS;
 
 struct AV1_COMP;
+struct AV1RowMTSync;
+struct ThreadData;
+struct macroblock;
 
 void av1_init_first_pass(struct AV1_COMP *cpi);
 void av1_rc_get_first_pass_params(struct AV1_COMP *cpi);
 void av1_first_pass(struct AV1_COMP *cpi, const struct lookahead_entry *source);
+
+// Analyses macroblock row mb_row of the first pass frame into
+// cpi->twopass.row_stats[mb_row]. When row_mt_sync is not NULL, each
+// macroblock waits for the above right one to be reconstructed.
+void av1_first_pass_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                        int mb_row, struct AV1RowMTSync *row_mt_sync);
 void av1_end_first_pass(struct AV1_COMP *cpi);
 
+// Returns the first pass motion vectors of the macroblocks of source frame
+// frame_index, or NULL when the last pass has none for it.
+const FIRSTPASS_MB_MV *av1_get_firstpass_mvs(const struct AV1_COMP *cpi,
+                                             int frame_index);
+
+// Sets *mv to the full pel motion of macroblock mb_index from the frame dist
+// frames before the one mb_mvs belongs to, chaining the first pass vectors of
+// the frames in between, clamped to the search limits of x. Returns 0 when the
+// first pass has no vector for the macroblock in one of those frames.
+int av1_firstpass_mv_candidate(const struct AV1_COMP *cpi,
+                               const struct macroblock *x,
+                               const FIRSTPASS_MB_MV *mb_mvs, int dist,
+                               int mb_index, MV *mv);
+
 void av1_init_second_pass(struct AV1_COMP *cpi);
 void av1_rc_get_second_pass_params(struct AV1_COMP *cpi);
 void av1_twopass_postencode_update(struct AV1_COMP *cpi);
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "av1/encoder/hash.h"
+
+// Reflected CRC-32C polynomial.
+#define CRC32C_POLY 0x82F63B78u
+
+void av1_crc_calculator_init(CRC_CALCULATOR *p_crc_calculator) {
+  uint32_t(*const table)[256] = p_crc_calculator->table;
+  int i, j;
+  for (i = 0; i < 256; ++i) {
+    uint32_t crc = (uint32_t)i;
+    for (j = 0; j < 8; ++j) crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+    table[0][i] = crc;
+  }
+  // table[j][i] is the CRC of byte i followed by j zero bytes.
+  for (j = 1; j < 8; ++j)
+    for (i = 0; i < 256; ++i)
+      table[j][i] = (table[j - 1][i] >> 8) ^ table[0][table[j - 1][i] & 0xff];
+}
+
+uint32_t av1_get_crc_value(const CRC_CALCULATOR *p_crc_calculator,
+                           uint32_t crc, const uint8_t *p, int length) {
+  const uint32_t(*const table)[256] = p_crc_calculator->table;
+  crc = ~crc;
+  for (; length >= 8; length -= 8, p += 8) {
+    const uint32_t lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) |
+                               ((uint32_t)p[3] << 24));
+    crc = table[7][lo & 0xff] ^ table[6][(lo >> 8) & 0xff] ^
+          table[5][(lo >> 16) & 0xff] ^ table[4][lo >> 24] ^ table[3][p[4]] ^
+          table[2][p[5]] ^ table[1][p[6]] ^ table[0][p[7]];
+  }
+  for (; length > 0; --length, ++p)
+    crc = table[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AV1_ENCODER_HASH_H_
+#define AV1_ENCODER_HASH_H_
+
+#include "./aom_config.h"
+#include "aom/aom_integer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Table driven CRC-32C (Castagnoli), eight bytes per step.
+typedef struct CRC_CALCULATOR { uint32_t table[8][256]; } CRC_CALCULATOR;
+
+void av1_crc_calculator_init(CRC_CALCULATOR *p_crc_calculator);
+
+// Returns the CRC of the length bytes at p, continued from the CRC crc of
+// the bytes before them. crc is 0 for the first bytes.
+uint32_t av1_get_crc_value(const CRC_CALCULATOR *p_crc_calculator,
+                           uint32_t crc, const uint8_t *p, int length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AV1_ENCODER_HASH_H_
@@ -78,7 +78,18 @@ static unsigned int do_16x16_motion_iteration(AV1_COMP *cpi, const MV *ref_mv,
                       xd->plane[0].dst.buf, xd->plane[0].dst.stride);
 }
 
+// Returns the full pel SAD of the 16x16 block against the reference at mv,
+// after clamping mv to the search limits.
+static unsigned int start_mv_sad(const MACROBLOCK *x, MV *mv) {
+  const MACROBLOCKD *const xd = &x->e_mbd;
+  const struct buf_2d *const pre = &xd->plane[0].pre[0];
+  clamp_mv(mv, x->mv_col_min, x->mv_col_max, x->mv_row_min, x->mv_row_max);
+  return aom_sad16x16(x->plane[0].src.buf, x->plane[0].src.stride,
+                      pre->buf + mv->row * pre->stride + mv->col, pre->stride);
+}
+
 static int do_16x16_motion_search(AV1_COMP *cpi, const MV *ref_mv,
+                                  const FIRSTPASS_MB_MV *fp_mvs, int fp_mv_dist,
                                   int_mv *dst_mv, int mb_row, int mb_col) {
   MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
@@ -91,6 +102,35 @@ static int do_16x16_motion_search(AV1_COMP *cpi, const MV *ref_mv,
                      xd->plane[0].pre[0].buf, xd->plane[0].pre[0].stride);
   dst_mv->as_int = 0;
 
+  if (fp_mvs) {
+    // Start a single search from whichever of 0,0, the previous best mv and
+    // the first pass vector of this macroblock fits best at full pel.
+    MV start_mv = { 0, 0 };
+    unsigned int start_sad = err;
+    MV mv = { ref_mv->row >> 3, ref_mv->col >> 3 };
+
+    tmp_err = start_mv_sad(x, &mv);
+    if (tmp_err < start_sad) {
+      start_sad = tmp_err;
+      start_mv = mv;
+    }
+    if (av1_firstpass_mv_candidate(cpi, x, fp_mvs, fp_mv_dist,
+                                   mb_row * cpi->common.mb_cols + mb_col,
+                                   &mv) &&
+        start_mv_sad(x, &mv) < start_sad)
+      start_mv = mv;
+    start_mv.row *= 8;
+    start_mv.col *= 8;
+
+    tmp_err =
+        do_16x16_motion_iteration(cpi, &start_mv, &tmp_mv, mb_row, mb_col);
+    if (tmp_err < err) {
+      err = tmp_err;
+      dst_mv->as_mv = tmp_mv;
+    }
+    return err;
+  }
+
   // Test last reference frame using the previous best mv as the
   // starting point (best reference) for the search
   tmp_err = do_16x16_motion_iteration(cpi, ref_mv, &tmp_mv, mb_row, mb_col);
@@ -162,8 +202,9 @@ static void update_mbgraph_mb_stats(AV1_COMP *cpi, MBGRAPH_MB_STATS *stats,
                                     YV12_BUFFER_CONFIG *buf, int mb_y_offset,
                                     YV12_BUFFER_CONFIG *golden_ref,
                                     const MV *prev_golden_ref_mv,
-                                    YV12_BUFFER_CONFIG *alt_ref, int mb_row,
-                                    int mb_col) {
+                                    const FIRSTPASS_MB_MV *fp_mvs,
+                                    int fp_mv_dist, YV12_BUFFER_CONFIG *alt_ref,
+                                    int mb_row, int mb_col) {
   MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   int intra_error;
@@ -187,7 +228,7 @@ static void update_mbgraph_mb_stats(AV1_COMP *cpi, MBGRAPH_MB_STATS *stats,
     xd->plane[0].pre[0].buf = golden_ref->y_buffer + mb_y_offset;
     xd->plane[0].pre[0].stride = golden_ref->y_stride;
     g_motion_error =
-        do_16x16_motion_search(cpi, prev_golden_ref_mv,
+        do_16x16_motion_search(cpi, prev_golden_ref_mv, fp_mvs, fp_mv_dist,
                                &stats->ref[GOLDEN_FRAME].m.mv, mb_row, mb_col);
     stats->ref[GOLDEN_FRAME].err = g_motion_error;
   } else {
@@ -215,7 +256,9 @@ static void update_mbgraph_frame_stats(AV1_COMP *cpi,
                                        MBGRAPH_FRAME_STATS *stats,
                                        YV12_BUFFER_CONFIG *buf,
                                        YV12_BUFFER_CONFIG *golden_ref,
-                                       YV12_BUFFER_CONFIG *alt_ref) {
+                                       YV12_BUFFER_CONFIG *alt_ref,
+                                       const FIRSTPASS_MB_MV *fp_mvs,
+                                       int fp_mv_dist) {
   MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   AV1_COMMON *const cm = &cpi->common;
@@ -255,7 +298,8 @@ static void update_mbgraph_frame_stats(AV1_COMP *cpi,
       MBGRAPH_MB_STATS *mb_stats = &stats->mb_stats[offset + mb_col];
 
       update_mbgraph_mb_stats(cpi, mb_stats, buf, mb_y_in_offset, golden_ref,
-                              &gld_left_mv, alt_ref, mb_row, mb_col);
+                              &gld_left_mv, fp_mvs, fp_mv_dist, alt_ref,
+                              mb_row, mb_col);
       gld_left_mv = mb_stats->ref[GOLDEN_FRAME].m.mv.as_mv;
       if (mb_col == 0) {
         gld_top_mv = gld_left_mv;
@@ -359,6 +403,8 @@ void av1_update_mbgraph_stats(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   int i, n_frames = av1_lookahead_depth(cpi->lookahead);
   YV12_BUFFER_CONFIG *golden_ref = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
+  // Number of frames from the golden frame to the current one.
+  const int golden_dist = cpi->rc.frames_since_golden + 1;
 
   assert(golden_ref != NULL);
 
@@ -385,8 +431,10 @@ void av1_update_mbgraph_stats(AV1_COMP *cpi) {
 
     assert(q_cur != NULL);
 
-    update_mbgraph_frame_stats(cpi, frame_stats, &q_cur->img, golden_ref,
-                               cpi->Source);
+    update_mbgraph_frame_stats(
+        cpi, frame_stats, &q_cur->img, golden_ref, cpi->Source,
+        av1_get_firstpass_mvs(cpi, cm->current_video_frame + i),
+        golden_dist + i);
   }
 
   aom_clear_system_state();
@@ -9,6 +9,7 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <assert.h>
 #include <limits.h>
 #include <math.h>
 #include <stdio.h>
@@ -205,20 +206,19 @@ static INLINE const uint8_t *upre(const uint8_t *buf, int stride, int r,
 }
 
 /* checks if (r, c) has better score than previous best */
-#define CHECK_BETTER1(v, r, c)                                                \
-  if (c >= minc && c <= maxc && r >= minr && r <= maxr) {                     \
-    thismse =                                                                 \
-        upsampled_pref_error(xd, vfp, z, src_stride, upre(y, y_stride, r, c), \
-                             y_stride, second_pred, w, h, &sse);              \
-    if ((v = MVC(r, c) + thismse) < besterr) {                                \
-      besterr = v;                                                            \
-      br = r;                                                                 \
-      bc = c;                                                                 \
-      *distortion = thismse;                                                  \
-      *sse1 = sse;                                                            \
-    }                                                                         \
-  } else {                                                                    \
-    v = INT_MAX;                                                              \
+#define CHECK_BETTER1(v, r, c)                                          \
+  if (c >= minc && c <= maxc && r >= minr && r <= maxr) {               \
+    thismse = upsampled_pref_error(x, vfp, z, src_stride, y, y_stride, r, \
+                                   c, second_pred, w, h, &sse);         \
+    if ((v = MVC(r, c) + thismse) < besterr) {                          \
+      besterr = v;                                                      \
+      br = r;                                                           \
+      bc = c;                                                           \
+      *distortion = thismse;                                            \
+      *sse1 = sse;                                                      \
+    }                                                                   \
+  } else {                                                              \
+    v = INT_MAX;                                                        \
   }
 
 #define FIRST_LEVEL_CHECKS                                       \
@@ -614,33 +614,252 @@ static const MV search_step_table[12] = {
   { -2, 0 }, { 2, 0 }, { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 }
 };
 
-static int upsampled_pref_error(const MACROBLOCKD *xd,
+void av1_setup_upsampled_pred(const AV1_COMP *cpi, MACROBLOCK *x,
+                              MV_REFERENCE_FRAME ref, int ref_idx, int mi_row,
+                              int mi_col, int block) {
+  struct macroblockd_plane *const pd = &x->e_mbd.plane[0];
+  struct buf_2d *const pre = &pd->pre[ref_idx];
+  UPSAMPLED_PRED_CTX *const ctx = &x->upsampled_pred;
+
+  ctx->on_the_fly = !use_upsampled_ref_bufs(cpi);
+  if (ctx->on_the_fly) {
+    int i;
+
+    // pre already points to the block, sub8x8 blocks included.
+    ctx->row = (mi_row << 3) + ((block >> 1) << 2);
+    ctx->col = (mi_col << 3) + ((block & 1) << 2);
+    ctx->width = cpi->common.width;
+    ctx->height = cpi->common.height;
+    for (i = 0; i < UPSAMPLED_PRED_CACHE_SLOTS; ++i)
+      ctx->cache[i].col = INT_MAX;
+  } else {
+    const YV12_BUFFER_CONFIG *upsampled_ref = get_upsampled_ref(cpi, ref);
+
+    setup_pred_plane(pre, upsampled_ref->y_buffer, upsampled_ref->y_stride,
+                     (mi_row << 3), (mi_col << 3), NULL, pd->subsampling_x,
+                     pd->subsampling_y);
+    pre->buf += av1_raster_block_offset(BLOCK_8X8, block, pre->stride) << 3;
+  }
+}
+
+// Runs the horizontal (filter_x) or the vertical (filter_y) pass of the
+// interpolation, or copies the block if neither is given.
+static void upsampled_convolve(const MACROBLOCKD *xd, const uint8_t *src,
+                               int src_stride, uint8_t *dst, int dst_stride,
+                               const int16_t *filter_x,
+                               const int16_t *filter_y, int w, int h) {
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+    if (filter_x != NULL)
+      aom_highbd_convolve8_horiz(src, src_stride, dst, dst_stride, filter_x,
+                                 16, NULL, 16, w, h, xd->bd);
+    else if (filter_y != NULL)
+      aom_highbd_convolve8_vert(src, src_stride, dst, dst_stride, NULL, 16,
+                                filter_y, 16, w, h, xd->bd);
+    else
+      aom_highbd_convolve_copy(src, src_stride, dst, dst_stride, NULL, 0, NULL,
+                               0, w, h, xd->bd);
+    return;
+  }
+#else
+  (void)xd;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  if (filter_x != NULL)
+    aom_convolve8_horiz(src, src_stride, dst, dst_stride, filter_x, 16, NULL,
+                        16, w, h);
+  else if (filter_y != NULL)
+    aom_convolve8_vert(src, src_stride, dst, dst_stride, NULL, 16, filter_y, 16,
+                       w, h);
+  else
+    aom_convolve_copy(src, src_stride, dst, dst_stride, NULL, 0, NULL, 0, w, h);
+}
+
+// Pixel (r, c), in 1/8 pel, of the up-sampled reference frame ref.
+static int upsampled_pixel(const uint8_t *ref, int stride, int r, int c,
+                           int hbd, int bd) {
+  const InterpFilterParams params = get_interp_filter_params(EIGHTTAP);
+  const int16_t *const filter_x =
+      get_interp_filter_subpel_kernel(params, (c & 7) << 1);
+  const int16_t *const filter_y =
+      get_interp_filter_subpel_kernel(params, (r & 7) << 1);
+  const int row = (r >> 3) - (SUBPEL_TAPS / 2 - 1);
+  const int col = (c >> 3) - (SUBPEL_TAPS / 2 - 1);
+  int i, k, sum = 0;
+
+  for (i = 0; i < SUBPEL_TAPS; ++i) {
+    int hsum = 0;
+    for (k = 0; k < SUBPEL_TAPS; ++k) {
+      const int offset = (row + i) * stride + col + k;
+#if CONFIG_AOM_HIGHBITDEPTH
+      const int pixel = hbd ? CONVERT_TO_SHORTPTR(ref)[offset] : ref[offset];
+#else
+      const int pixel = ref[offset];
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      hsum += pixel * filter_x[k];
+    }
+    hsum = ROUND_POWER_OF_TWO(hsum, FILTER_BITS);
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (hbd)
+      sum += clip_pixel_highbd(hsum, bd) * filter_y[i];
+    else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+      sum += clip_pixel(hsum) * filter_y[i];
+  }
+  sum = ROUND_POWER_OF_TWO(sum, FILTER_BITS);
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (hbd) return clip_pixel_highbd(sum, bd);
+#else
+  (void)hbd;
+  (void)bd;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  return clip_pixel(sum);
+}
+
+// Interpolates the prediction at (r, c) from the block at y instead of
+// reading it from the stored up-sampled reference frame. That frame is made
+// by upsample_ref_frame() in encoder.c: every pixel is the EIGHTTAP
+// interpolation of the reference, filtered horizontally and rounded, then
+// filtered vertically, and pixels beyond the frame edges repeat the edge
+// pixels of the up-sampled frame.
+static void interp_upsampled_pred(const MACROBLOCK *x, uint8_t *pred, int w,
+                                  int h, const uint8_t *y, int y_stride, int r,
+                                  int c) {
+  const MACROBLOCKD *const xd = &x->e_mbd;
+  const UPSAMPLED_PRED_CTX *const ctx = &x->upsampled_pred;
+  const int row = (ctx->row << 3) + r;
+  const int col = (ctx->col << 3) + c;
+  const int max_row = (ctx->height << 3) - 1;
+  const int max_col = (ctx->width << 3) - 1;
+  const InterpFilterParams params = get_interp_filter_params(EIGHTTAP);
+  // Phase 0 is a plain copy.
+  const int16_t *const filter_x =
+      (c & 7) ? get_interp_filter_subpel_kernel(params, (c & 7) << 1) : NULL;
+  const int16_t *const filter_y =
+      (r & 7) ? get_interp_filter_subpel_kernel(params, (r & 7) << 1) : NULL;
+  const uint8_t *src = y + (r >> 3) * y_stride + (c >> 3);
+  int src_stride = y_stride;
+  int hbd = 0;
+  int bd = 8;
+#if CONFIG_AOM_HIGHBITDEPTH
+  hbd = (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  bd = xd->bd;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+
+  if (row < 0 || col < 0 || row + ((h - 1) << 3) > max_row ||
+      col + ((w - 1) << 3) > max_col) {
+    // The block crosses the frame edge, where the up-sampled frame is
+    // extended rather than interpolated.
+    const uint8_t *const ref = y - ctx->row * y_stride - ctx->col;
+    int i, j;
+
+    for (i = 0; i < h; ++i) {
+      const int pr = clamp(row + (i << 3), 0, max_row);
+      for (j = 0; j < w; ++j) {
+        const int pc = clamp(col + (j << 3), 0, max_col);
+        const int v = upsampled_pixel(ref, y_stride, pr, pc, hbd, bd);
+#if CONFIG_AOM_HIGHBITDEPTH
+        if (hbd)
+          CONVERT_TO_SHORTPTR(pred)[i * w + j] = v;
+        else
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+          pred[i * w + j] = v;
+      }
+    }
+    return;
+  }
+
+  if (filter_x != NULL) {
+    // The horizontal pass is kept for each column offset, with enough rows
+    // for the vertical offsets around r that the search tries next.
+    UPSAMPLED_PRED_CACHE *const slot =
+        &ctx->cache[c & (UPSAMPLED_PRED_CACHE_SLOTS - 1)];
+    const int top = (r >> 3) - (filter_y ? SUBPEL_TAPS / 2 - 1 : 0);
+    const int bottom = (r >> 3) + h + (filter_y ? SUBPEL_TAPS / 2 : 0);
+#if CONFIG_AOM_HIGHBITDEPTH
+    uint8_t *const buf =
+        hbd ? CONVERT_TO_BYTEPTR(slot->buf) : (uint8_t *)slot->buf;
+#else
+    uint8_t *const buf = (uint8_t *)slot->buf;
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+
+    if (slot->col != c || top < slot->row0 ||
+        bottom > slot->row0 + slot->rows) {
+      slot->col = c;
+      slot->row0 = (r >> 3) - SUBPEL_TAPS / 2;
+      slot->rows = h + SUBPEL_TAPS + 1;
+      upsampled_convolve(xd, y + slot->row0 * y_stride + (c >> 3), y_stride,
+                         buf, w, filter_x, NULL, w, slot->rows);
+    }
+    src = buf + ((r >> 3) - slot->row0) * w;
+    src_stride = w;
+  }
+  upsampled_convolve(xd, src, src_stride, pred, w, NULL, filter_y, w, h);
+}
+
+// Gets the w x h prediction at (r, c), in 1/8 pel, from the block at y in
+// the up-sampled reference, averaged with second_pred if it is not NULL.
+static void upsampled_pred(const MACROBLOCK *x, uint8_t *pred,
+                           const uint8_t *second_pred, int w, int h,
+                           const uint8_t *y, int y_stride, int r, int c) {
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (x->e_mbd.cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+    uint16_t *const pred16 = CONVERT_TO_SHORTPTR(pred);
+    if (x->upsampled_pred.on_the_fly) {
+      if (second_pred != NULL) {
+        DECLARE_ALIGNED(16, uint16_t, tmp16[MAX_SB_SQUARE]);
+        interp_upsampled_pred(x, CONVERT_TO_BYTEPTR(tmp16), w, h, y, y_stride,
+                              r, c);
+        aom_highbd_comp_avg_pred(pred16, second_pred, w, h,
+                                 CONVERT_TO_BYTEPTR(tmp16), w);
+      } else {
+        interp_upsampled_pred(x, pred, w, h, y, y_stride, r, c);
+      }
+    } else if (second_pred != NULL) {
+      aom_highbd_comp_avg_upsampled_pred(pred16, second_pred, w, h,
+                                         upre(y, y_stride, r, c), y_stride);
+    } else {
+      aom_highbd_upsampled_pred(pred16, w, h, upre(y, y_stride, r, c),
+                                y_stride);
+    }
+    return;
+  }
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  if (x->upsampled_pred.on_the_fly) {
+    if (second_pred != NULL) {
+      DECLARE_ALIGNED(16, uint8_t, tmp[MAX_SB_SQUARE]);
+      interp_upsampled_pred(x, tmp, w, h, y, y_stride, r, c);
+      aom_comp_avg_pred(pred, second_pred, w, h, tmp, w);
+    } else {
+      interp_upsampled_pred(x, pred, w, h, y, y_stride, r, c);
+    }
+  } else if (second_pred != NULL) {
+    aom_comp_avg_upsampled_pred(pred, second_pred, w, h,
+                                upre(y, y_stride, r, c), y_stride);
+  } else {
+    aom_upsampled_pred(pred, w, h, upre(y, y_stride, r, c), y_stride);
+  }
+}
+
+static int upsampled_pref_error(const MACROBLOCK *x,
                                 const aom_variance_fn_ptr_t *vfp,
                                 const uint8_t *const src, const int src_stride,
-                                const uint8_t *const y, int y_stride,
-                                const uint8_t *second_pred, int w, int h,
+                                const uint8_t *const y, int y_stride, int r,
+                                int c, const uint8_t *second_pred, int w, int h,
                                 unsigned int *sse) {
   unsigned int besterr;
 #if CONFIG_AOM_HIGHBITDEPTH
-  if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+  if (x->e_mbd.cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
     DECLARE_ALIGNED(16, uint16_t, pred16[64 * 64]);
-    if (second_pred != NULL)
-      aom_highbd_comp_avg_upsampled_pred(pred16, second_pred, w, h, y,
-                                         y_stride);
-    else
-      aom_highbd_upsampled_pred(pred16, w, h, y, y_stride);
+    upsampled_pred(x, CONVERT_TO_BYTEPTR(pred16), second_pred, w, h, y,
+                   y_stride, r, c);
 
     besterr = vfp->vf(CONVERT_TO_BYTEPTR(pred16), w, src, src_stride, sse);
   } else {
     DECLARE_ALIGNED(16, uint8_t, pred[64 * 64]);
 #else
   DECLARE_ALIGNED(16, uint8_t, pred[64 * 64]);
-  (void)xd;
 #endif  // CONFIG_AOM_HIGHBITDEPTH
-    if (second_pred != NULL)
-      aom_comp_avg_upsampled_pred(pred, second_pred, w, h, y, y_stride);
-    else
-      aom_upsampled_pred(pred, w, h, y, y_stride);
+    upsampled_pred(x, pred, second_pred, w, h, y, y_stride, r, c);
 
     besterr = vfp->vf(pred, w, src, src_stride, sse);
 #if CONFIG_AOM_HIGHBITDEPTH
@@ -650,13 +869,14 @@ static int upsampled_pref_error(const MACROBLOCKD *xd,
 }
 
 static unsigned int upsampled_setup_center_error(
-    const MACROBLOCKD *xd, const MV *bestmv, const MV *ref_mv,
-    int error_per_bit, const aom_variance_fn_ptr_t *vfp,
-    const uint8_t *const src, const int src_stride, const uint8_t *const y,
-    int y_stride, const uint8_t *second_pred, int w, int h, int offset,
-    int *mvjcost, int *mvcost[2], unsigned int *sse1, int *distortion) {
-  unsigned int besterr = upsampled_pref_error(
-      xd, vfp, src, src_stride, y + offset, y_stride, second_pred, w, h, sse1);
+    const MACROBLOCK *x, const MV *bestmv, const MV *ref_mv, int error_per_bit,
+    const aom_variance_fn_ptr_t *vfp, const uint8_t *const src,
+    const int src_stride, const uint8_t *const y, int y_stride,
+    const uint8_t *second_pred, int w, int h, int *mvjcost, int *mvcost[2],
+    unsigned int *sse1, int *distortion) {
+  unsigned int besterr =
+      upsampled_pref_error(x, vfp, src, src_stride, y, y_stride, bestmv->row,
+                           bestmv->col, second_pred, w, h, sse1);
   *distortion = besterr;
   besterr += mv_err_cost(bestmv, ref_mv, mvjcost, mvcost, error_per_bit);
   return besterr;
@@ -705,8 +925,8 @@ int av1_find_best_sub_pixel_tree(
   // use_upsampled_ref can be 0 or 1
   if (use_upsampled_ref)
     besterr = upsampled_setup_center_error(
-        xd, bestmv, ref_mv, error_per_bit, vfp, z, src_stride, y, y_stride,
-        second_pred, w, h, offset * 8, mvjcost, mvcost, sse1, distortion);
+        x, bestmv, ref_mv, error_per_bit, vfp, z, src_stride, y, y_stride,
+        second_pred, w, h, mvjcost, mvcost, sse1, distortion);
   else
     besterr = setup_center_error(xd, bestmv, ref_mv, error_per_bit, vfp, z,
                                  src_stride, y, y_stride, second_pred, w, h,
@@ -723,11 +943,9 @@ int av1_find_best_sub_pixel_tree(
         MV this_mv = { tr, tc };
 
         if (use_upsampled_ref) {
-          const uint8_t *const pre_address = y + tr * y_stride + tc;
-
-          thismse = upsampled_pref_error(xd, vfp, src_address, src_stride,
-                                         pre_address, y_stride, second_pred, w,
-                                         h, &sse);
+          thismse = upsampled_pref_error(x, vfp, src_address, src_stride, y,
+                                         y_stride, tr, tc, second_pred, w, h,
+                                         &sse);
         } else {
           const uint8_t *const pre_address =
               y + (tr >> 3) * y_stride + (tc >> 3);
@@ -763,11 +981,9 @@ int av1_find_best_sub_pixel_tree(
       MV this_mv = { tr, tc };
 
       if (use_upsampled_ref) {
-        const uint8_t *const pre_address = y + tr * y_stride + tc;
-
-        thismse =
-            upsampled_pref_error(xd, vfp, src_address, src_stride, pre_address,
-                                 y_stride, second_pred, w, h, &sse);
+        thismse = upsampled_pref_error(x, vfp, src_address, src_stride, y,
+                                       y_stride, tr, tc, second_pred, w, h,
+                                       &sse);
       } else {
         const uint8_t *const pre_address = y + (tr >> 3) * y_stride + (tc >> 3);
 
@@ -2635,6 +2851,339 @@ int av1_full_pixel_search(const AV1_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
   return var;
 }
 
+static void free_me_pyramid(ME_PYRAMID *p) {
+  int i;
+  for (i = 0; i < ME_PYRAMID_LEVELS; ++i) {
+    aom_free(p->level[i].alloc);
+    p->level[i].alloc = NULL;
+    p->level[i].buf = NULL;
+  }
+  p->levels = 0;
+}
+
+void av1_free_me_pyramids(AV1_COMP *cpi) {
+  int i;
+  free_me_pyramid(&cpi->src_pyramid);
+  for (i = 0; i < FRAME_BUFFERS; ++i) free_me_pyramid(&cpi->ref_pyramid[i]);
+}
+
+// Replicates the outermost pixels of the level into its border.
+static void extend_pyramid_level(ME_PYRAMID_LEVEL *l) {
+  const int b = ME_PYRAMID_BORDER;
+  uint8_t *row = l->buf;
+  int r;
+  for (r = 0; r < l->height; ++r) {
+    memset(row - b, row[0], b);
+    memset(row + l->width, row[l->width - 1], b);
+    row += l->stride;
+  }
+  row = l->buf - b;
+  for (r = 1; r <= b; ++r) {
+    memcpy(row - r * l->stride, row, l->stride);
+    memcpy(row + (l->height - 1 + r) * l->stride,
+           row + (l->height - 1) * l->stride, l->stride);
+  }
+}
+
+static void alloc_pyramid_level(AV1_COMMON *cm, ME_PYRAMID_LEVEL *l, int width,
+                                int height) {
+  const int stride = (width + 2 * ME_PYRAMID_BORDER + 15) & ~15;
+  if (l->alloc && l->width == width && l->height == height) return;
+  aom_free(l->alloc);
+  CHECK_MEM_ERROR(cm, l->alloc,
+                  (uint8_t *)aom_memalign(
+                      16, stride * (height + 2 * ME_PYRAMID_BORDER)));
+  l->width = width;
+  l->height = height;
+  l->stride = stride;
+  l->buf = l->alloc + ME_PYRAMID_BORDER * stride + ME_PYRAMID_BORDER;
+}
+
+// Averages each 2x2 block of src into one pixel of dst. src is read one pixel
+// past its right and bottom edges when its dimensions are odd, which the frame
+// and pyramid borders cover.
+static void downscale_2x2(const uint8_t *src, int src_stride,
+                          ME_PYRAMID_LEVEL *dst) {
+  uint8_t *d = dst->buf;
+  int r, c;
+  for (r = 0; r < dst->height; ++r) {
+    const uint8_t *s0 = src + 2 * r * src_stride;
+    const uint8_t *s1 = s0 + src_stride;
+    for (c = 0; c < dst->width; ++c)
+      d[c] = (s0[2 * c] + s0[2 * c + 1] + s1[2 * c] + s1[2 * c + 1] + 2) >> 2;
+    d += dst->stride;
+  }
+}
+
+#if CONFIG_AOM_HIGHBITDEPTH
+static void highbd_downscale_2x2(const uint16_t *src, int src_stride, int bd,
+                                 ME_PYRAMID_LEVEL *dst) {
+  const int shift = 2 + bd - 8;
+  uint8_t *d = dst->buf;
+  int r, c;
+  for (r = 0; r < dst->height; ++r) {
+    const uint16_t *s0 = src + 2 * r * src_stride;
+    const uint16_t *s1 = s0 + src_stride;
+    for (c = 0; c < dst->width; ++c)
+      d[c] = (s0[2 * c] + s0[2 * c + 1] + s1[2 * c] + s1[2 * c + 1] +
+              (1 << (shift - 1))) >>
+             shift;
+    d += dst->stride;
+  }
+}
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+
+static void build_me_pyramid(AV1_COMMON *cm, const YV12_BUFFER_CONFIG *frame,
+                             int levels, ME_PYRAMID *p) {
+  int width = frame->y_crop_width;
+  int height = frame->y_crop_height;
+  int i;
+
+  for (i = 0; i < levels; ++i) {
+    ME_PYRAMID_LEVEL *const l = &p->level[i];
+    width = (width + 1) >> 1;
+    height = (height + 1) >> 1;
+    alloc_pyramid_level(cm, l, width, height);
+    if (i > 0) {
+      downscale_2x2(p->level[i - 1].buf, p->level[i - 1].stride, l);
+#if CONFIG_AOM_HIGHBITDEPTH
+    } else if (frame->flags & YV12_FLAG_HIGHBITDEPTH) {
+      highbd_downscale_2x2(CONVERT_TO_SHORTPTR(frame->y_buffer),
+                           frame->y_stride, (int)cm->bit_depth, l);
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+    } else {
+      downscale_2x2(frame->y_buffer, frame->y_stride, l);
+    }
+    extend_pyramid_level(l);
+  }
+  p->levels = levels;
+}
+
+void av1_setup_me_pyramids(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int levels = cpi->sf.mv.pyramid_levels;
+  MV_REFERENCE_FRAME ref;
+
+  // The frame about to be coded overwrites its buffer.
+  cpi->ref_pyramid[cm->new_fb_idx].levels = 0;
+
+  if (levels == 0) return;
+
+  build_me_pyramid(cm, cpi->Source, levels, &cpi->src_pyramid);
+  if (frame_is_intra_only(cm)) return;
+
+  for (ref = LAST_FRAME; ref <= ALTREF_FRAME; ++ref) {
+    const int buf_idx = get_ref_frame_buf_idx(cpi, ref);
+    const YV12_BUFFER_CONFIG *buf;
+    if (buf_idx == INVALID_IDX) continue;
+    buf = &cm->buffer_pool->frame_bufs[buf_idx].buf;
+    // Scaled references are not searched in the pyramid.
+    if (buf->y_crop_width != cm->width || buf->y_crop_height != cm->height)
+      continue;
+    if (cpi->ref_pyramid[buf_idx].levels < levels)
+      build_me_pyramid(cm, buf, levels, &cpi->ref_pyramid[buf_idx]);
+  }
+}
+
+#define PYRAMID_SEARCH_RANGE 8
+
+// Returns the 8-bit SAD functions of bsize. The pyramid levels are always
+// 8-bit, so cpi->fn_ptr cannot be used in high bitdepth builds. The run time
+// lookup keeps the RTCD function pointers out of a static initializer.
+static void get_pyramid_sad_fns(BLOCK_SIZE bsize, aom_sad_fn_t *sdf,
+                                aom_sad_multi_d_fn_t *sdx4df) {
+  switch (bsize) {
+    case BLOCK_4X4:
+      *sdf = aom_sad4x4;
+      *sdx4df = aom_sad4x4x4d;
+      break;
+    case BLOCK_4X8:
+      *sdf = aom_sad4x8;
+      *sdx4df = aom_sad4x8x4d;
+      break;
+    case BLOCK_8X4:
+      *sdf = aom_sad8x4;
+      *sdx4df = aom_sad8x4x4d;
+      break;
+    case BLOCK_8X8:
+      *sdf = aom_sad8x8;
+      *sdx4df = aom_sad8x8x4d;
+      break;
+    case BLOCK_8X16:
+      *sdf = aom_sad8x16;
+      *sdx4df = aom_sad8x16x4d;
+      break;
+    case BLOCK_16X8:
+      *sdf = aom_sad16x8;
+      *sdx4df = aom_sad16x8x4d;
+      break;
+    case BLOCK_16X16:
+      *sdf = aom_sad16x16;
+      *sdx4df = aom_sad16x16x4d;
+      break;
+    case BLOCK_16X32:
+      *sdf = aom_sad16x32;
+      *sdx4df = aom_sad16x32x4d;
+      break;
+    case BLOCK_32X16:
+      *sdf = aom_sad32x16;
+      *sdx4df = aom_sad32x16x4d;
+      break;
+    case BLOCK_32X32:
+      *sdf = aom_sad32x32;
+      *sdx4df = aom_sad32x32x4d;
+      break;
+    case BLOCK_32X64:
+      *sdf = aom_sad32x64;
+      *sdx4df = aom_sad32x64x4d;
+      break;
+    case BLOCK_64X32:
+      *sdf = aom_sad64x32;
+      *sdx4df = aom_sad64x32x4d;
+      break;
+    default:
+      assert(bsize == BLOCK_64X64);
+      *sdf = aom_sad64x64;
+      *sdx4df = aom_sad64x64x4d;
+      break;
+  }
+}
+
+// Evaluates the SAD of the block at the vectors in the inclusive window
+// [row_lo, row_hi] x [col_lo, col_hi] of level l, four at a time, and keeps
+// the best of them in best_mv.
+static void pyramid_search_window(const ME_PYRAMID_LEVEL *src,
+                                  const ME_PYRAMID_LEVEL *ref, int r, int c,
+                                  BLOCK_SIZE bsize, int row_lo, int row_hi,
+                                  int col_lo, int col_hi,
+                                  unsigned int *best_sad, MV *best_mv) {
+  const uint8_t *const src_buf = src->buf + r * src->stride + c;
+  aom_sad_fn_t sdf;
+  aom_sad_multi_d_fn_t sdx4df;
+  int row, col, i;
+
+  get_pyramid_sad_fns(bsize, &sdf, &sdx4df);
+
+  for (row = row_lo; row <= row_hi; ++row) {
+    const uint8_t *const ref_row = ref->buf + (r + row) * ref->stride + c;
+    for (col = col_lo; col + 3 <= col_hi; col += 4) {
+      const uint8_t *const pos[4] = { ref_row + col, ref_row + col + 1,
+                                      ref_row + col + 2, ref_row + col + 3 };
+      unsigned int sads[4];
+      sdx4df(src_buf, src->stride, pos, ref->stride, sads);
+      for (i = 0; i < 4; ++i) {
+        if (sads[i] < *best_sad) {
+          *best_sad = sads[i];
+          best_mv->row = row;
+          best_mv->col = col + i;
+        }
+      }
+    }
+    for (; col <= col_hi; ++col) {
+      const unsigned int sad =
+          sdf(src_buf, src->stride, ref_row + col, ref->stride);
+      if (sad < *best_sad) {
+        *best_sad = sad;
+        best_mv->row = row;
+        best_mv->col = col;
+      }
+    }
+  }
+}
+
+static int pyramid_search(const AV1_COMP *cpi, const MACROBLOCK *x,
+                          BLOCK_SIZE bsize, int mi_row, int mi_col,
+                          MV_REFERENCE_FRAME ref, const MV *center_mv,
+                          MV *best_mv) {
+  const ME_PYRAMID *const src = &cpi->src_pyramid;
+  const int buf_idx = get_ref_frame_buf_idx(cpi, ref);
+  const int bw = 4 * num_4x4_blocks_wide_lookup[bsize];
+  const int bh = 4 * num_4x4_blocks_high_lookup[bsize];
+  const ME_PYRAMID *pyr;
+  BLOCK_SIZE level_bsize[ME_PYRAMID_LEVELS];
+  MV mv;
+  int levels = AOMMIN(cpi->sf.mv.pyramid_levels, src->levels);
+  int i;
+
+  if (buf_idx == INVALID_IDX || AOMMIN(bw, bh) < 16) return 0;
+  pyr = &cpi->ref_pyramid[buf_idx];
+  levels = AOMMIN(levels, pyr->levels);
+  // Keep at least 4x4 pixels of the block at the coarsest level.
+  while (levels > 0 && (AOMMIN(bw, bh) >> levels) < 4) --levels;
+  if (levels == 0 || pyr->level[0].width != src->level[0].width ||
+      pyr->level[0].height != src->level[0].height)
+    return 0;
+
+  level_bsize[0] = ss_size_lookup[bsize][1][1];
+  for (i = 1; i < levels; ++i)
+    level_bsize[i] = ss_size_lookup[level_bsize[i - 1]][1][1];
+
+  mv = *center_mv;
+  for (i = levels - 1; i >= 0; --i) {
+    const ME_PYRAMID_LEVEL *const s = &src->level[i];
+    const ME_PYRAMID_LEVEL *const p = &pyr->level[i];
+    const int shift = i + 1;
+    const int r = (mi_row * MI_SIZE) >> shift;
+    const int c = (mi_col * MI_SIZE) >> shift;
+    const int range = (i == levels - 1) ? PYRAMID_SEARCH_RANGE : 1;
+    // Vectors stay within the motion vector limits of the block and within
+    // the border of the level.
+    const int row_min =
+        AOMMAX(-((-x->mv_row_min) >> shift), -ME_PYRAMID_BORDER - r);
+    const int row_max =
+        AOMMIN(x->mv_row_max >> shift,
+               p->height + ME_PYRAMID_BORDER - (bh >> shift) - r);
+    const int col_min =
+        AOMMAX(-((-x->mv_col_min) >> shift), -ME_PYRAMID_BORDER - c);
+    const int col_max =
+        AOMMIN(x->mv_col_max >> shift,
+               p->width + ME_PYRAMID_BORDER - (bw >> shift) - c);
+    unsigned int best_sad = UINT_MAX;
+
+    if (row_min > row_max || col_min > col_max) return 0;
+
+    if (i == levels - 1) {
+      mv.row = mv.row >> shift;
+      mv.col = mv.col >> shift;
+    } else {
+      mv.row *= 2;
+      mv.col *= 2;
+    }
+    mv.row = clamp(mv.row, row_min, row_max);
+    mv.col = clamp(mv.col, col_min, col_max);
+
+    pyramid_search_window(s, p, r, c, level_bsize[i],
+                          AOMMAX(mv.row - range, row_min),
+                          AOMMIN(mv.row + range, row_max),
+                          AOMMAX(mv.col - range, col_min),
+                          AOMMIN(mv.col + range, col_max), &best_sad, &mv);
+  }
+
+  best_mv->row = clamp(mv.row * 2, x->mv_row_min, x->mv_row_max);
+  best_mv->col = clamp(mv.col * 2, x->mv_col_min, x->mv_col_max);
+  return 1;
+}
+
+int av1_pyramid_motion_search(const AV1_COMP *cpi, const MACROBLOCK *x,
+                              BLOCK_SIZE bsize, int mi_row, int mi_col,
+                              MV_REFERENCE_FRAME ref, const MV *ref_mv,
+                              const aom_variance_fn_ptr_t *vfp, MV *mvp_full) {
+  MV pyramid_mv, start_mv = *mvp_full;
+
+  if (!pyramid_search(cpi, x, bsize, mi_row, mi_col, ref, &start_mv,
+                      &pyramid_mv))
+    return 0;
+
+  clamp_mv(&start_mv, x->mv_col_min, x->mv_col_max, x->mv_row_min,
+           x->mv_row_max);
+  if (av1_get_mvpred_var(x, &pyramid_mv, ref_mv, vfp, 1) >=
+      av1_get_mvpred_var(x, &start_mv, ref_mv, vfp, 1))
+    return 0;
+
+  *mvp_full = pyramid_mv;
+  return 1;
+}
+
 #if CONFIG_MOTION_VAR
 /* returns subpixel variance error function */
 #define DIST(r, c) \
@@ -2670,8 +3219,8 @@ int av1_full_pixel_search(const AV1_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
 #undef CHECK_BETTER1
 #define CHECK_BETTER1(v, r, c)                                            \
   if (c >= minc && c <= maxc && r >= minr && r <= maxr) {                 \
-    thismse = upsampled_obmc_pref_error(                                  \
-        xd, mask, vfp, z, upre(y, y_stride, r, c), y_stride, w, h, &sse); \
+    thismse = upsampled_obmc_pref_error(x, mask, vfp, z, y, y_stride, r, c, \
+                                        w, h, &sse);                      \
     if ((v = MVC(r, c) + thismse) < besterr) {                            \
       besterr = v;                                                        \
       br = r;                                                             \
@@ -2695,25 +3244,26 @@ static unsigned int setup_obmc_center_error(
   return besterr;
 }
 
-static int upsampled_obmc_pref_error(const MACROBLOCKD *xd, const int32_t *mask,
+static int upsampled_obmc_pref_error(const MACROBLOCK *x, const int32_t *mask,
                                      const aom_variance_fn_ptr_t *vfp,
                                      const int32_t *const wsrc,
                                      const uint8_t *const y, int y_stride,
-                                     int w, int h, unsigned int *sse) {
+                                     int r, int c, int w, int h,
+                                     unsigned int *sse) {
   unsigned int besterr;
 #if CONFIG_AOM_HIGHBITDEPTH
-  if (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+  if (x->e_mbd.cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
     DECLARE_ALIGNED(16, uint16_t, pred16[MAX_SB_SQUARE]);
-    aom_highbd_upsampled_pred(pred16, w, h, y, y_stride);
+    upsampled_pred(x, CONVERT_TO_BYTEPTR(pred16), NULL, w, h, y, y_stride, r,
+                   c);
 
     besterr = vfp->ovf(CONVERT_TO_BYTEPTR(pred16), w, wsrc, mask, sse);
   } else {
     DECLARE_ALIGNED(16, uint8_t, pred[MAX_SB_SQUARE]);
 #else
   DECLARE_ALIGNED(16, uint8_t, pred[MAX_SB_SQUARE]);
-  (void)xd;
 #endif  // CONFIG_AOM_HIGHBITDEPTH
-    aom_upsampled_pred(pred, w, h, y, y_stride);
+    upsampled_pred(x, pred, NULL, w, h, y, y_stride, r, c);
 
     besterr = vfp->ovf(pred, w, wsrc, mask, sse);
 #if CONFIG_AOM_HIGHBITDEPTH
@@ -2723,13 +3273,13 @@ static int upsampled_obmc_pref_error(const MACROBLOCKD *xd, const int32_t *mask,
 }
 
 static unsigned int upsampled_setup_obmc_center_error(
-    const MACROBLOCKD *xd, const int32_t *mask, const MV *bestmv,
+    const MACROBLOCK *x, const int32_t *mask, const MV *bestmv,
     const MV *ref_mv, int error_per_bit, const aom_variance_fn_ptr_t *vfp,
     const int32_t *const wsrc, const uint8_t *const y, int y_stride, int w,
-    int h, int offset, int *mvjcost, int *mvcost[2], unsigned int *sse1,
-    int *distortion) {
-  unsigned int besterr = upsampled_obmc_pref_error(
-      xd, mask, vfp, wsrc, y + offset, y_stride, w, h, sse1);
+    int h, int *mvjcost, int *mvcost[2], unsigned int *sse1, int *distortion) {
+  unsigned int besterr =
+      upsampled_obmc_pref_error(x, mask, vfp, wsrc, y, y_stride, bestmv->row,
+                                bestmv->col, w, h, sse1);
   *distortion = besterr;
   besterr += mv_err_cost(bestmv, ref_mv, mvjcost, mvcost, error_per_bit);
   return besterr;
@@ -2776,13 +3326,9 @@ int av1_find_best_obmc_sub_pixel_tree_up(
   const uint8_t *y;
 
   const struct buf_2d backup_pred = pd->pre[is_second];
-  if (use_upsampled_ref) {
-    int ref = xd->mi[0]->mbmi.ref_frame[is_second];
-    const YV12_BUFFER_CONFIG *upsampled_ref = get_upsampled_ref(cpi, ref);
-    setup_pred_plane(&pd->pre[is_second], upsampled_ref->y_buffer,
-                     upsampled_ref->y_stride, (mi_row << 3), (mi_col << 3),
-                     NULL, pd->subsampling_x, pd->subsampling_y);
-  }
+  if (use_upsampled_ref)
+    av1_setup_upsampled_pred(cpi, x, mbmi->ref_frame[is_second], is_second,
+                             mi_row, mi_col, 0);
   y = pd->pre[is_second].buf;
   y_stride = pd->pre[is_second].stride;
   offset = bestmv->row * y_stride + bestmv->col;
@@ -2795,8 +3341,8 @@ int av1_find_best_obmc_sub_pixel_tree_up(
   // use_upsampled_ref can be 0 or 1
   if (use_upsampled_ref)
     besterr = upsampled_setup_obmc_center_error(
-        xd, mask, bestmv, ref_mv, error_per_bit, vfp, z, y, y_stride, w, h,
-        (offset << 3), mvjcost, mvcost, sse1, distortion);
+        x, mask, bestmv, ref_mv, error_per_bit, vfp, z, y, y_stride, w, h,
+        mvjcost, mvcost, sse1, distortion);
   else
     besterr = setup_obmc_center_error(mask, bestmv, ref_mv, error_per_bit, vfp,
                                       z, y, y_stride, offset, mvjcost, mvcost,
@@ -2811,10 +3357,8 @@ int av1_find_best_obmc_sub_pixel_tree_up(
         MV this_mv = { tr, tc };
 
         if (use_upsampled_ref) {
-          const uint8_t *const pre_address = y + tr * y_stride + tc;
-
-          thismse = upsampled_obmc_pref_error(
-              xd, mask, vfp, src_address, pre_address, y_stride, w, h, &sse);
+          thismse = upsampled_obmc_pref_error(x, mask, vfp, src_address, y,
+                                              y_stride, tr, tc, w, h, &sse);
         } else {
           const uint8_t *const pre_address =
               y + (tr >> 3) * y_stride + (tc >> 3);
@@ -2845,10 +3389,8 @@ int av1_find_best_obmc_sub_pixel_tree_up(
       MV this_mv = { tr, tc };
 
       if (use_upsampled_ref) {
-        const uint8_t *const pre_address = y + tr * y_stride + tc;
-
-        thismse = upsampled_obmc_pref_error(xd, mask, vfp, src_address,
-                                            pre_address, y_stride, w, h, &sse);
+        thismse = upsampled_obmc_pref_error(x, mask, vfp, src_address, y,
+                                            y_stride, tr, tc, w, h, &sse);
       } else {
         const uint8_t *const pre_address = y + (tr >> 3) * y_stride + (tc >> 3);
 
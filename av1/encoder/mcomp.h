@@ -43,6 +43,28 @@ typedef struct search_site_config {
   int searches_per_step;
 } search_site_config;
 
+// Number of 2:1 downscaled levels kept for the pyramid motion search, and the
+// border in pixels replicated around each of them.
+#define ME_PYRAMID_LEVELS 3
+#define ME_PYRAMID_BORDER 32
+
+// One downscaled level of a luma plane. Pixels are stored at 8 bits whatever
+// the bit depth of the frame.
+typedef struct ME_PYRAMID_LEVEL {
+  uint8_t *buf;  // Top-left visible pixel.
+  uint8_t *alloc;
+  int width;
+  int height;
+  int stride;
+} ME_PYRAMID_LEVEL;
+
+typedef struct ME_PYRAMID {
+  // level[i] is downscaled by 2^(i + 1) in each dimension.
+  ME_PYRAMID_LEVEL level[ME_PYRAMID_LEVELS];
+  // Number of levels holding the current contents of the frame.
+  int levels;
+} ME_PYRAMID;
+
 void av1_init_dsmotion_compensation(search_site_config *cfg, int stride);
 void av1_init3smotion_compensation(search_site_config *cfg, int stride);
 
@@ -133,6 +155,31 @@ int av1_full_pixel_search(const struct AV1_COMP *cpi, MACROBLOCK *x,
                           int error_per_bit, int *cost_list, const MV *ref_mv,
                           MV *tmp_mv, int var_max, int rd);
 
+// Builds the pyramids of the source and of the reference frames of the frame
+// being encoded, as configured by sf->mv.pyramid_levels. Reference pyramids
+// are kept with the frame buffers and are only rebuilt once a buffer has been
+// written again.
+void av1_setup_me_pyramids(struct AV1_COMP *cpi);
+void av1_free_me_pyramids(struct AV1_COMP *cpi);
+
+// Searches the pyramids of the source and of reference frame ref coarse to
+// fine around the full pel start vector mvp_full. The start vector is replaced
+// by the result when that has the lower variance and rate cost against ref_mv
+// at full resolution, in which case 1 is returned.
+int av1_pyramid_motion_search(const struct AV1_COMP *cpi, const MACROBLOCK *x,
+                              BLOCK_SIZE bsize, int mi_row, int mi_col,
+                              MV_REFERENCE_FRAME ref, const MV *ref_mv,
+                              const aom_variance_fn_ptr_t *vfp, MV *mvp_full);
+
+// Points the sub-pixel search of the Y plane of xd->plane[0].pre[ref_idx] at
+// the up-sampled reference frame ref, where block is the index of the 4x4
+// block within a sub8x8 partition. When the up-sampled frames are not stored,
+// pre[ref_idx] is left on the reference itself and the search interpolates
+// the up-sampled pixels on demand. The caller restores pre[ref_idx].
+void av1_setup_upsampled_pred(const struct AV1_COMP *cpi, MACROBLOCK *x,
+                              MV_REFERENCE_FRAME ref, int ref_idx, int mi_row,
+                              int mi_col, int block);
+
 #if CONFIG_MOTION_VAR
 int av1_obmc_full_pixel_diamond(const struct AV1_COMP *cpi, MACROBLOCK *x,
                                 MV *mvp_full, int step_param, int sadpb,
@@ -13,148 +13,239 @@
 #include <math.h>
 
 #include "./aom_scale_rtcd.h"
+#include "./av1_rtcd.h"
 #include "av1/common/dering.h"
 #include "av1/common/onyxc_int.h"
 #include "av1/common/reconinter.h"
 #include "av1/encoder/encoder.h"
 #include "aom/aom_integer.h"
 
-static double compute_dist(int16_t *x, int xstride, int16_t *y, int ystride,
-                           int nhb, int nvb, int coeff_shift) {
-  int i, j;
-  double sum;
-  sum = 0;
-  for (i = 0; i < nvb << 3; i++) {
-    for (j = 0; j < nhb << 3; j++) {
-      double tmp;
-      tmp = x[i * xstride + j] - y[i * ystride + j];
-      sum += tmp * tmp;
-    }
-  }
-  return sum / (double)(1 << 2 * coeff_shift);
-}
-
-int av1_dering_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
-                      AV1_COMMON *cm, MACROBLOCKD *xd) {
-  int r, c;
-  int sbr, sbc;
-  int nhsb, nvsb;
+// State of the dering level search, shared by the workers searching its
+// superblock rows.
+typedef struct DeringSearchData {
+  AV1_COMMON *cm;
+  const struct macroblockd_plane *plane;
+  const YV12_BUFFER_CONFIG *ref;
+  // 16-bit copies of the luma of the frame and of the source.
   int16_t *src;
   int16_t *ref_coeff;
-  dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
-  int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS] = { { 0 } };
   int stride;
-  int bsize[3];
-  int dec[3];
-  int pli;
-  int level;
-  int best_level;
-  int dering_count;
-  int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
-  src = aom_malloc(sizeof(*src) * cm->mi_rows * cm->mi_cols * 64);
-  ref_coeff = aom_malloc(sizeof(*ref_coeff) * cm->mi_rows * cm->mi_cols * 64);
-  av1_setup_dst_planes(xd->plane, frame, 0, 0);
-  for (pli = 0; pli < 3; pli++) {
-    dec[pli] = xd->plane[pli].subsampling_x;
-    bsize[pli] = OD_DERING_SIZE_LOG2 - dec[pli];
-  }
-  stride = cm->mi_cols << bsize[0];
-  for (r = 0; r < cm->mi_rows << bsize[0]; ++r) {
-    for (c = 0; c < cm->mi_cols << bsize[0]; ++c) {
+  int global_level;
+  // The worker searches superblock rows start, start + step, ...
+  int start;
+  int step;
+} DeringSearchData;
+
+static void copy_sb_row(DeringSearchData *data, int sbr) {
+  const AV1_COMMON *const cm = data->cm;
+  const struct macroblockd_plane *const pd = data->plane;
+  const YV12_BUFFER_CONFIG *const ref = data->ref;
+  const int stride = data->stride;
+  const int mi_row_end = AOMMIN((sbr + 1) * MAX_MIB_SIZE, cm->mi_rows);
+  int r, c;
+  for (r = sbr * MAX_MIB_SIZE << OD_DERING_SIZE_LOG2;
+       r < mi_row_end << OD_DERING_SIZE_LOG2; ++r) {
+    for (c = 0; c < cm->mi_cols << OD_DERING_SIZE_LOG2; ++c) {
 #if CONFIG_AOM_HIGHBITDEPTH
       if (cm->use_highbitdepth) {
-        src[r * stride + c] = CONVERT_TO_SHORTPTR(
-            xd->plane[0].dst.buf)[r * xd->plane[0].dst.stride + c];
-        ref_coeff[r * stride + c] =
+        data->src[r * stride + c] =
+            CONVERT_TO_SHORTPTR(pd->dst.buf)[r * pd->dst.stride + c];
+        data->ref_coeff[r * stride + c] =
             CONVERT_TO_SHORTPTR(ref->y_buffer)[r * ref->y_stride + c];
       } else {
 #endif
-        src[r * stride + c] =
-            xd->plane[0].dst.buf[r * xd->plane[0].dst.stride + c];
-        ref_coeff[r * stride + c] = ref->y_buffer[r * ref->y_stride + c];
+        data->src[r * stride + c] = pd->dst.buf[r * pd->dst.stride + c];
+        data->ref_coeff[r * stride + c] = ref->y_buffer[r * ref->y_stride + c];
 #if CONFIG_AOM_HIGHBITDEPTH
       }
 #endif
     }
   }
-  nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
-  nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+}
+
+// Picks the dering gain of superblock (sbr, sbc). Only the blocks in the
+// dering list change with the level, so the error of the unfiltered
+// superblock is computed once and then updated with the error of the
+// filtered blocks. The block directions do not depend on the level either,
+// so they are only searched for the first level that filters.
+static void search_sb(DeringSearchData *data, int sbr, int sbc) {
+  AV1_COMMON *const cm = data->cm;
+  const int stride = data->stride;
+  const int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int nhb = AOMMIN(MAX_MIB_SIZE, cm->mi_cols - MAX_MIB_SIZE * sbc);
+  const int nvb = AOMMIN(MAX_MIB_SIZE, cm->mi_rows - MAX_MIB_SIZE * sbr);
+  const int offset = (sbr * stride * MAX_MIB_SIZE << OD_DERING_SIZE_LOG2) +
+                     (sbc * MAX_MIB_SIZE << OD_DERING_SIZE_LOG2);
+  const int16_t *const x = &data->src[offset];
+  const int16_t *const ref = &data->ref_coeff[offset];
+  dering_list dlist[MAX_MIB_SIZE * MAX_MIB_SIZE];
+  int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS];
+  int32_t var[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS];
+  int dirinit = 0;
+  int16_t inbuf[OD_DERING_INBUF_SIZE];
+  int16_t filtbuf[OD_DERING_INBUF_SIZE];
+  int16_t tmp_dst[MAX_MIB_SIZE * MAX_MIB_SIZE * 8 * 8];
+  uint64_t sb_err = 0;
+  uint64_t blocks_err = 0;
+  int32_t best_mse = INT32_MAX;
+  int best_gi = 0;
+  int last_level = -1;
+  int dering_count;
+  int gi, bi, i, j;
+
+  dering_count =
+      sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE, sbc * MAX_MIB_SIZE, dlist);
+  if (dering_count == 0) return;
+
+  for (i = 0; i < nvb; i++)
+    for (j = 0; j < nhb; j++)
+      sb_err += od_compute_dist_8x8(&x[(i << 3) * stride + (j << 3)], stride,
+                                    &ref[(i << 3) * stride + (j << 3)], stride);
+  for (bi = 0; bi < dering_count; bi++) {
+    const int boffset = (dlist[bi].by << 3) * stride + (dlist[bi].bx << 3);
+    blocks_err += od_compute_dist_8x8(&x[boffset], stride, &ref[boffset],
+                                      stride);
+  }
+
+  /* We avoid filtering the pixels for which some of the pixels to average
+     are outside the frame. We could change the filter instead, but it would
+     add special cases for any future vectorization. */
+  for (i = 0; i < OD_DERING_INBUF_SIZE; i++) inbuf[i] = OD_DERING_VERY_LARGE;
+  for (i = -OD_FILT_VBORDER * (sbr != 0);
+       i < (nvb << OD_DERING_SIZE_LOG2) + OD_FILT_VBORDER * (sbr != nvsb - 1);
+       i++) {
+    for (j = -OD_FILT_HBORDER * (sbc != 0);
+         j < (nhb << OD_DERING_SIZE_LOG2) + OD_FILT_HBORDER * (sbc != nhsb - 1);
+         j++) {
+      inbuf[(i + OD_FILT_VBORDER) * OD_FILT_BSTRIDE + j + OD_FILT_HBORDER] =
+          x[i * stride + j];
+    }
+  }
+
+  for (gi = 0; gi < DERING_REFINEMENT_LEVELS; gi++) {
+    const int level = compute_level_from_index(data->global_level, gi);
+    const int threshold = level << coeff_shift;
+    uint64_t err = sb_err;
+    int32_t cur_mse;
+    if (level == last_level) continue;
+    last_level = level;
+    // A zero threshold leaves the superblock unfiltered.
+    if (threshold) {
+      // od_dering() overwrites its input.
+      memcpy(filtbuf, inbuf, sizeof(inbuf));
+      od_dering(tmp_dst,
+                &filtbuf[OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER],
+                0, dir, var, &dirinit, 0, dlist, dering_count, threshold,
+                coeff_shift);
+      err -= blocks_err;
+      for (bi = 0; bi < dering_count; bi++) {
+        const int boffset = (dlist[bi].by << 3) * stride + (dlist[bi].bx << 3);
+        err += od_compute_dist_8x8(&tmp_dst[bi << 6], 8, &ref[boffset], stride);
+      }
+    }
+    cur_mse = (int32_t)(err >> 2 * coeff_shift);
+    if (cur_mse < best_mse) {
+      best_gi = gi;
+      best_mse = cur_mse;
+    }
+  }
+  cm->mi_grid_visible[MAX_MIB_SIZE * sbr * cm->mi_stride + MAX_MIB_SIZE * sbc]
+      ->mbmi.dering_gain = best_gi;
+}
+
+static int dering_copy_worker(DeringSearchData *const data, void *unused) {
+  const AV1_COMMON *const cm = data->cm;
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  int sbr;
+  (void)unused;
+  for (sbr = data->start; sbr < nvsb; sbr += data->step)
+    copy_sb_row(data, sbr);
+  return 1;
+}
+
+static int dering_search_worker(DeringSearchData *const data, void *unused) {
+  const AV1_COMMON *const cm = data->cm;
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int nhsb = (cm->mi_cols + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  int sbr, sbc;
+  (void)unused;
+  for (sbr = data->start; sbr < nvsb; sbr += data->step)
+    for (sbc = 0; sbc < nhsb; sbc++) search_sb(data, sbr, sbc);
+  return 1;
+}
+
+static void launch_search_workers(DeringSearchData *data, AVxWorkerHook hook,
+                                  AVxWorker *workers, int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = hook;
+    worker->data1 = &data[i];
+    worker->data2 = NULL;
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (i = 0; i < num_workers; ++i) winterface->sync(&workers[i]);
+}
+
+int av1_dering_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
+                      AV1_COMMON *cm, MACROBLOCKD *xd, AVxWorker *workers,
+                      int nworkers) {
+  const int nvsb = (cm->mi_rows + MAX_MIB_SIZE - 1) / MAX_MIB_SIZE;
+  const int num_workers = AOMMAX(AOMMIN(nworkers, nvsb), 1);
   /* Pick a base threshold based on the quantizer. The threshold will then be
      adjusted on a 64x64 basis. We use a threshold of the form T = a*Q^b,
      where a and b are derived empirically trying to optimize rate-distortion
      at different quantizer settings. */
-  best_level = AOMMIN(
+  const int best_level = AOMMIN(
       MAX_DERING_LEVEL - 1,
       (int)floor(.5 +
                  .45 * pow(av1_ac_quant(cm->base_qindex, 0, cm->bit_depth) >>
                                (cm->bit_depth - 8),
                            0.6)));
-  for (sbr = 0; sbr < nvsb; sbr++) {
-    for (sbc = 0; sbc < nhsb; sbc++) {
-      int nvb, nhb;
-      int gi;
-      int best_gi;
-      int32_t best_mse = INT32_MAX;
-      int16_t dst[MAX_MIB_SIZE * MAX_MIB_SIZE * 8 * 8];
-      int16_t tmp_dst[MAX_MIB_SIZE * MAX_MIB_SIZE * 8 * 8];
-      nhb = AOMMIN(MAX_MIB_SIZE, cm->mi_cols - MAX_MIB_SIZE * sbc);
-      nvb = AOMMIN(MAX_MIB_SIZE, cm->mi_rows - MAX_MIB_SIZE * sbr);
-      dering_count = sb_compute_dering_list(cm, sbr * MAX_MIB_SIZE,
-                                            sbc * MAX_MIB_SIZE, dlist);
-      if (dering_count == 0) continue;
-      best_gi = 0;
-      for (gi = 0; gi < DERING_REFINEMENT_LEVELS; gi++) {
-        int cur_mse;
-        int threshold;
-        int16_t inbuf[OD_DERING_INBUF_SIZE];
-        int16_t *in;
-        int i, j;
-        level = compute_level_from_index(best_level, gi);
-        threshold = level << coeff_shift;
-        for (r = 0; r < nvb << bsize[0]; r++) {
-          for (c = 0; c < nhb << bsize[0]; c++) {
-            dst[(r * MAX_MIB_SIZE << bsize[0]) + c] =
-                src[((sbr * MAX_MIB_SIZE << bsize[0]) + r) * stride +
-                    (sbc * MAX_MIB_SIZE << bsize[0]) + c];
-          }
-        }
-        in = inbuf + OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER;
-        /* We avoid filtering the pixels for which some of the pixels to average
-           are outside the frame. We could change the filter instead, but it
-           would
-           add special cases for any future vectorization. */
-        for (i = 0; i < OD_DERING_INBUF_SIZE; i++)
-          inbuf[i] = OD_DERING_VERY_LARGE;
-        for (i = -OD_FILT_VBORDER * (sbr != 0);
-             i < (nvb << bsize[0]) + OD_FILT_VBORDER * (sbr != nvsb - 1); i++) {
-          for (j = -OD_FILT_HBORDER * (sbc != 0);
-               j < (nhb << bsize[0]) + OD_FILT_HBORDER * (sbc != nhsb - 1);
-               j++) {
-            int16_t *x;
-            x = &src[(sbr * stride * MAX_MIB_SIZE << bsize[0]) +
-                     (sbc * MAX_MIB_SIZE << bsize[0])];
-            in[i * OD_FILT_BSTRIDE + j] = x[i * stride + j];
-          }
-        }
-        od_dering(tmp_dst, in, 0, dir, 0, dlist, dering_count, threshold,
-                  coeff_shift);
-        copy_dering_16bit_to_16bit(dst, MAX_MIB_SIZE << bsize[0], tmp_dst,
-                                   dlist, dering_count, bsize[0]);
-        cur_mse = (int)compute_dist(
-            dst, MAX_MIB_SIZE << bsize[0],
-            &ref_coeff[(sbr * stride * MAX_MIB_SIZE << bsize[0]) +
-                       (sbc * MAX_MIB_SIZE << bsize[0])],
-            stride, nhb, nvb, coeff_shift);
-        if (cur_mse < best_mse) {
-          best_gi = gi;
-          best_mse = cur_mse;
-        }
-      }
-      cm->mi_grid_visible[MAX_MIB_SIZE * sbr * cm->mi_stride +
-                          MAX_MIB_SIZE * sbc]
-          ->mbmi.dering_gain = best_gi;
-    }
+  DeringSearchData *data;
+  int16_t *src;
+  int16_t *ref_coeff;
+  int i;
+
+  CHECK_MEM_ERROR(cm, src,
+                  aom_malloc(sizeof(*src) * cm->mi_rows * cm->mi_cols * 64));
+  CHECK_MEM_ERROR(
+      cm, ref_coeff,
+      aom_malloc(sizeof(*ref_coeff) * cm->mi_rows * cm->mi_cols * 64));
+  CHECK_MEM_ERROR(cm, data, aom_malloc(num_workers * sizeof(*data)));
+  av1_setup_dst_planes(xd->plane, frame, 0, 0);
+  data[0].cm = cm;
+  data[0].plane = &xd->plane[0];
+  data[0].ref = ref;
+  data[0].src = src;
+  data[0].ref_coeff = ref_coeff;
+  data[0].stride = cm->mi_cols << OD_DERING_SIZE_LOG2;
+  data[0].global_level = best_level;
+  for (i = 0; i < num_workers; ++i) {
+    data[i] = data[0];
+    data[i].start = i;
+    data[i].step = num_workers;
   }
+
+  if (num_workers > 1) {
+    // The whole frame is copied before any superblock is searched, as the
+    // search reads the pixels around the superblock.
+    launch_search_workers(data, (AVxWorkerHook)dering_copy_worker, workers,
+                          num_workers);
+    launch_search_workers(data, (AVxWorkerHook)dering_search_worker, workers,
+                          num_workers);
+  } else {
+    dering_copy_worker(data, NULL);
+    dering_search_worker(data, NULL);
+  }
+
+  aom_free(data);
   aom_free(src);
   aom_free(ref_coeff);
   return best_level;
@@ -24,9 +24,13 @@
 #include "av1/common/quant_common.h"
 
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/picklpf.h"
 #include "av1/encoder/quantize.h"
 
+// Distance between the superblock rows of LPF_PICK_FROM_SAMPLED_ROWS.
+#define LPF_SAMPLED_ROW_STEP 4
+
 static int get_max_filter_level(const AV1_COMP *cpi) {
   if (cpi->oxcf.pass == 2) {
     return cpi->twopass.section_intra_rating > 8 ? MAX_LOOP_FILTER * 3 / 4
@@ -36,42 +40,131 @@ static int get_max_filter_level(const AV1_COMP *cpi) {
   }
 }
 
+void av1_try_filter_sb_row(AV1_COMP *cpi, ThreadData *td, int job) {
+  AV1_COMMON *const cm = &cpi->common;
+  LPFSearchData *const lpf = &cpi->lpf_search_data;
+  YV12_BUFFER_CONFIG *const frame = cm->frame_to_show;
+  const int mi_row = (lpf->first_row + job * lpf->row_step) * MAX_MIB_SIZE;
+  const int mi_row_end = AOMMIN(mi_row + MAX_MIB_SIZE, cm->mi_rows);
+  const int end = mi_row_end * MI_SIZE;
+  const int sse_end = AOMMIN(end, frame->y_crop_height);
+  int start = mi_row * MI_SIZE;
+  int64_t err = 0;
+
+  if (lpf->filter_rows && lpf->filter_level) {
+    av1_loop_filter_rows(frame, cm, td->mb.e_mbd.plane, mi_row, mi_row_end, 1);
+    // Filtering the top edge of the superblock row also changes the bottom
+    // rows of the superblock row above it.
+    start = AOMMAX(start - MI_SIZE, 0);
+  }
+
+  if (sse_end > start) {
+#if CONFIG_AOM_HIGHBITDEPTH
+    if (cm->use_highbitdepth)
+      err = aom_highbd_get_y_sse_part(lpf->sd, frame, 0, frame->y_crop_width,
+                                      start, sse_end - start);
+    else
+      err = aom_get_y_sse_part(lpf->sd, frame, 0, frame->y_crop_width, start,
+                               sse_end - start);
+#else
+    err = aom_get_y_sse_part(lpf->sd, frame, 0, frame->y_crop_width, start,
+                             sse_end - start);
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+  }
+
+  // Re-instate the unfiltered rows
+  aom_yv12_partial_copy_y(&cpi->last_frame_uf, frame, start, end);
+
+  lpf->row_err[job] = err;
+}
+
 static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
                                 AV1_COMP *const cpi, int filt_level,
                                 int partial_frame) {
   AV1_COMMON *const cm = &cpi->common;
-  int64_t filt_err;
+  LPFSearchData *const lpf = &cpi->lpf_search_data;
+  int64_t filt_err = 0;
+  int job;
 
-  if (cpi->num_workers > 1)
+  if (lpf->filter_rows) {
+    // The superblock rows are filtered by the jobs.
+    av1_loop_filter_frame_init(cm, filt_level);
+  } else if (cpi->num_workers > 1) {
     av1_loop_filter_frame_mt(cm->frame_to_show, cm, cpi->td.mb.e_mbd.plane,
                              filt_level, 1, partial_frame, cpi->workers,
                              cpi->num_workers, &cpi->lf_row_sync);
-  else
+  } else {
     av1_loop_filter_frame(cm->frame_to_show, cm, &cpi->td.mb.e_mbd, filt_level,
                           1, partial_frame);
+  }
 
+  if (lpf->num_jobs == 0) {
 #if CONFIG_AOM_HIGHBITDEPTH
-  if (cm->use_highbitdepth) {
-    filt_err = aom_highbd_get_y_sse(sd, cm->frame_to_show);
-  } else {
-    filt_err = aom_get_y_sse(sd, cm->frame_to_show);
-  }
+    if (cm->use_highbitdepth) {
+      filt_err = aom_highbd_get_y_sse(sd, cm->frame_to_show);
+    } else {
+      filt_err = aom_get_y_sse(sd, cm->frame_to_show);
+    }
 #else
-  filt_err = aom_get_y_sse(sd, cm->frame_to_show);
+    filt_err = aom_get_y_sse(sd, cm->frame_to_show);
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 
-  // Re-instate the unfiltered frame
-  aom_yv12_copy_y(&cpi->last_frame_uf, cm->frame_to_show);
+    // Re-instate the unfiltered frame
+    aom_yv12_copy_y(&cpi->last_frame_uf, cm->frame_to_show);
+
+    return filt_err;
+  }
+
+  lpf->filter_level = filt_level;
+  if (cpi->oxcf.max_threads > 1 && lpf->num_jobs > 1)
+    av1_try_filter_sb_rows_mt(cpi, lpf->num_jobs);
+  else
+    for (job = 0; job < lpf->num_jobs; ++job)
+      av1_try_filter_sb_row(cpi, &cpi->td, job);
+
+  for (job = 0; job < lpf->num_jobs; ++job) filt_err += lpf->row_err[job];
 
   return filt_err;
 }
 
+// Sets up the superblock rows the filter levels are measured on. With
+// multiple threads the rows are measured in parallel, but otherwise the whole
+// frame is measured at once. When sampling, every LPF_SAMPLED_ROW_STEP-th
+// superblock row is filtered and measured on its own.
+static void init_search_rows(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
+                             LPF_PICK_METHOD method) {
+  AV1_COMMON *const cm = &cpi->common;
+  LPFSearchData *const lpf = &cpi->lpf_search_data;
+  const int sb_rows = mi_cols_aligned_to_sb(cm->mi_rows) >> MAX_MIB_SIZE_LOG2;
+
+  lpf->sd = sd;
+  lpf->filter_rows = method == LPF_PICK_FROM_SAMPLED_ROWS;
+  if (lpf->filter_rows) {
+    lpf->row_step = AOMMIN(LPF_SAMPLED_ROW_STEP, sb_rows);
+    lpf->first_row = lpf->row_step >> 1;
+    lpf->num_jobs = (sb_rows - lpf->first_row + lpf->row_step - 1) /
+                    lpf->row_step;
+  } else {
+    lpf->row_step = 1;
+    lpf->first_row = 0;
+    lpf->num_jobs = cpi->oxcf.max_threads > 1 ? sb_rows : 0;
+  }
+
+  if (lpf->row_err_size < lpf->num_jobs) {
+    aom_free(lpf->row_err);
+    CHECK_MEM_ERROR(cm, lpf->row_err,
+                    aom_malloc(lpf->num_jobs * sizeof(*lpf->row_err)));
+    lpf->row_err_size = lpf->num_jobs;
+  }
+}
+
 static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
-                               int partial_frame) {
+                               LPF_PICK_METHOD method) {
   const AV1_COMMON *const cm = &cpi->common;
   const struct loopfilter *const lf = &cm->lf;
   const int min_filter_level = 0;
   const int max_filter_level = get_max_filter_level(cpi);
+  const int partial_frame = method == LPF_PICK_FROM_SUBIMAGE;
   int filt_direction = 0;
   int64_t best_err;
   int filt_best;
@@ -89,6 +182,8 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
   //  Make a copy of the unfiltered / processed recon buffer
   aom_yv12_copy_y(cm->frame_to_show, &cpi->last_frame_uf);
 
+  init_search_rows(sd, cpi, method);
+
   best_err = try_filter_frame(sd, cpi, filt_mid, partial_frame);
   filt_best = filt_mid;
   ss_err[filt_mid] = best_err;
@@ -185,7 +280,6 @@ void av1_pick_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
     if (cm->frame_type == KEY_FRAME) filt_guess -= 4;
     lf->filter_level = clamp(filt_guess, min_filter_level, max_filter_level);
   } else {
-    lf->filter_level =
-        search_filter_level(sd, cpi, method == LPF_PICK_FROM_SUBIMAGE);
+    lf->filter_level = search_filter_level(sd, cpi, method);
   }
 }
@@ -20,9 +20,16 @@ extern "C" {
 
 struct yv12_buffer_config;
 struct AV1_COMP;
+struct ThreadData;
 
 void av1_pick_filter_level(const struct yv12_buffer_config *sd,
                            struct AV1_COMP *cpi, LPF_PICK_METHOD method);
+
+// Measures the luma SSE of the superblock row of job of the filter level
+// search, filtering it first when the rows are sampled, and restores its
+// unfiltered pixels.
+void av1_try_filter_sb_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                           int job);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
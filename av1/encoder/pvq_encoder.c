@@ -18,6 +18,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "./av1_rtcd.h"
 #include "aom_dsp/entcode.h"
 #include "aom_dsp/entenc.h"
 #include "av1/common/blockd.h"
@@ -66,9 +67,48 @@ static void od_fill_dynamic_rqrt_table(double *table, const int table_size,
     table[i] = od_rsqrt_table(start + 2*i + 1);
 }
 
+/** Finds the position where adding one pulse maximizes the normalized
+ * correlation (xy + x[j])^2/(yy + 2*y[j] + 1). Both terms are scaled down to
+ * 15 bits so that the cross-multiplied comparison fits in 32 bits.
+ *
+ * @param [in]      x       magnitudes of the input vector
+ * @param [in]      y       magnitudes of the current codevector
+ * @param [in]      n       number of dimensions
+ * @param [in]      xy      current correlation between x and y
+ * @param [in]      yy      current energy of y
+ * @param [in]      xshift  right shift bringing xy + max(x) below 2^15
+ *                          (negative for a left shift)
+ * @param [in]      yshift  right shift bringing yy + 2*max(y) + 1 below 2^15
+ * @return                  first position with the best correlation
+ */
+int od_pvq_search_argmax_c(const int16_t *x, const int32_t *y, int n,
+ int32_t xy, int32_t yy, int xshift, int yshift) {
+  int j;
+  int pos;
+  int32_t best_num;
+  int32_t best_den;
+  pos = 0;
+  best_num = -1;
+  best_den = 1;
+  for (j = 0; j < n; j++) {
+    int32_t num;
+    int32_t den;
+    num = xy + x[j];
+    num = xshift >= 0 ? num >> xshift : num << -xshift;
+    num = (num*num) >> 15;
+    den = (yy + 2*y[j] + 1) >> yshift;
+    if (num*best_den > best_num*den) {
+      best_num = num;
+      best_den = den;
+      pos = j;
+    }
+  }
+  return pos;
+}
+
 /** Find the codepoint on the given PSphere closest to the desired
- * vector. Double-precision PVQ search just to make sure our tests
- * aren't limited by numerical accuracy.
+ * vector. The greedy part of the search runs in fixed point; only the last
+ * few pulses, which are placed using RDO, use floating point.
  *
  * @param [in]      xcoeff  input vector to quantize (x in the math doc)
  * @param [in]      n       number of dimensions
@@ -81,23 +121,26 @@ static void od_fill_dynamic_rqrt_table(double *table, const int table_size,
  *                          reuse for the search (or 0 for a new search)
  * @return                  cosine distance between x and y (between 0 and 1)
  */
-static double pvq_search_rdo_double(const od_val16 *xcoeff, int n, int k,
+static double pvq_search_rdo(const od_val16 *xcoeff, int n, int k,
  od_coeff *ypulse, double g2, double pvq_norm_lambda, int prev_k) {
   int i, j;
-  double xy;
-  double yy;
-  /* TODO - This blows our 8kB stack space budget and should be fixed when
-   converting PVQ to fixed point. */
-  double x[MAXN];
+  int32_t xy;
+  int32_t yy;
+  int16_t x[MAXN];
+  int xmax;
+  int ymax;
   double xx;
   double lambda;
   double norm_1;
   int rdo_pulses;
   double delta_rate;
-  xx = xy = yy = 0;
+  xy = yy = 0;
+  xx = 0;
+  xmax = ymax = 0;
   for (j = 0; j < n; j++) {
-    x[j] = fabs((float)xcoeff[j]);
-    xx += x[j]*x[j];
+    x[j] = OD_MINI(abs(xcoeff[j]), 32767);
+    xmax = OD_MAXI(xmax, x[j]);
+    xx += x[j]*(double)x[j];
   }
   norm_1 = 1./sqrt(1e-30 + xx);
   lambda = pvq_norm_lambda/(1e-30 + g2);
@@ -109,21 +152,19 @@ static double pvq_search_rdo_double(const od_val16 *xcoeff, int n, int k,
       ypulse[j] = abs(ypulse[j]);
       xy += x[j]*ypulse[j];
       yy += ypulse[j]*ypulse[j];
+      ymax = OD_MAXI(ymax, ypulse[j]);
       i += ypulse[j];
     }
   }
   else if (k > 2) {
-    double l1_norm;
-    double l1_inv;
+    int32_t l1_norm;
     l1_norm = 0;
     for (j = 0; j < n; j++) l1_norm += x[j];
-    l1_inv = 1./OD_MAXF(l1_norm, 1e-100);
     for (j = 0; j < n; j++) {
-      double tmp;
-      tmp = k*x[j]*l1_inv;
-      ypulse[j] = OD_MAXI(0, (int)floor(tmp));
+      ypulse[j] = l1_norm > 0 ? (int)((int64_t)k*x[j]/l1_norm) : 0;
       xy += x[j]*ypulse[j];
       yy += ypulse[j]*ypulse[j];
+      ymax = OD_MAXI(ymax, ypulse[j]);
       i += ypulse[j];
     }
   }
@@ -139,26 +180,15 @@ static double pvq_search_rdo_double(const od_val16 *xcoeff, int n, int k,
   /* Search one pulse at a time */
   for (; i < k - rdo_pulses; i++) {
     int pos;
-    double best_xy;
-    double best_yy;
-    pos = 0;
-    best_xy = -10;
-    best_yy = 1;
-    for (j = 0; j < n; j++) {
-      double tmp_xy;
-      double tmp_yy;
-      tmp_xy = xy + x[j];
-      tmp_yy = yy + 2*ypulse[j] + 1;
-      tmp_xy *= tmp_xy;
-      if (j == 0 || tmp_xy*best_yy > best_xy*tmp_yy) {
-        best_xy = tmp_xy;
-        best_yy = tmp_yy;
-        pos = j;
-      }
-    }
+    int xshift;
+    int yshift;
+    xshift = OD_ILOG(xy + xmax) - 15;
+    yshift = OD_MAXI(0, OD_ILOG_NZ(yy + 2*ymax + 1) - 15);
+    pos = od_pvq_search_argmax(x, ypulse, n, xy, yy, xshift, yshift);
     xy = xy + x[pos];
     yy = yy + 2*ypulse[pos] + 1;
     ypulse[pos]++;
+    ymax = OD_MAXI(ymax, ypulse[pos]);
   }
   /* Search last pulses with RDO. Distortion is D = (x-y)^2 = x^2 - 2*x*y + y^2
      and since x^2 and y^2 are constant, we just maximize x*y, plus a
@@ -512,7 +542,7 @@ static int pvq_theta(od_coeff *out, const od_coeff *x0, const od_coeff *r0,
         OD_CLEAR(y_tmp, n-1);
       }
       else if (k != prev_k) {
-        cos_dist = pvq_search_rdo_double(xr, n - 1, k, y_tmp,
+        cos_dist = pvq_search_rdo(xr, n - 1, k, y_tmp,
          qcg*(double)cg*sin_prod*OD_CGAIN_SCALE_2, pvq_norm_lambda, prev_k);
       }
       prev_k = k;
@@ -559,7 +589,7 @@ static int pvq_theta(od_coeff *out, const od_coeff *x0, const od_coeff *r0,
       dist = gain_weight*(qcg - cg)*(qcg - cg);
       dist *= OD_CGAIN_SCALE_2;
       if (dist > dist0 && k != 0) continue;
-      cos_dist = pvq_search_rdo_double(x16, n, k, y_tmp,
+      cos_dist = pvq_search_rdo(x16, n, k, y_tmp,
        qcg*(double)cg*OD_CGAIN_SCALE_2, pvq_norm_lambda, prev_k);
       prev_k = k;
       /* See Jmspeex' Journal of Dubious Theoretical Results. */
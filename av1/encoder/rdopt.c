@@ -38,6 +38,7 @@
 #include "av1/encoder/encodemb.h"
 #include "av1/encoder/encodemv.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/hash.h"
 #include "av1/encoder/hybrid_fwd_txfm.h"
 #include "av1/encoder/mcomp.h"
 #if CONFIG_PALETTE
@@ -241,24 +242,50 @@ static const REF_DEFINITION av1_ref_order[MAX_REFS] = {
   { { INTRA_FRAME, NONE } },
 };
 
+// Models the rate and distortion of coding a prediction error of sse in the
+// bs sized block of pd.
+static void model_rd_from_sse(const AV1_COMP *const cpi, const MACROBLOCKD *xd,
+                              const struct macroblockd_plane *pd, BLOCK_SIZE bs,
+                              unsigned int sse, int *rate, int64_t *dist) {
+  // Note our transform coeffs are 8 times an orthogonal transform.
+  // Hence quantizer step is also 8 times. To get effective quantizer
+  // we need to divide by 8 before sending to modeling function.
+  const int dequant_shift =
+#if CONFIG_AOM_HIGHBITDEPTH
+      (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) ? xd->bd - 5 :
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+                                                    3;
+#if !CONFIG_AOM_HIGHBITDEPTH
+  (void)xd;
+#endif  // !CONFIG_AOM_HIGHBITDEPTH
+
+  // Fast approximate the modelling function.
+  if (cpi->sf.simple_model_rd_from_var) {
+    const int64_t square_error = sse;
+    const int quantizer = (pd->dequant[1] >> dequant_shift);
+    const int64_t rate_temp =
+        (quantizer < 120)
+            ? (square_error * (280 - quantizer)) >> (16 - AV1_PROB_COST_SHIFT)
+            : 0;
+    assert(rate_temp == (int)rate_temp);
+    *rate = (int)rate_temp;
+    *dist = (square_error * quantizer) >> 8;
+  } else {
+    av1_model_rd_from_var_lapndz(sse, num_pels_log2_lookup[bs],
+                                 pd->dequant[1] >> dequant_shift, rate, dist);
+  }
+}
+
 static void model_rd_for_sb(const AV1_COMP *const cpi, BLOCK_SIZE bsize,
                             MACROBLOCK *x, MACROBLOCKD *xd, int *out_rate_sum,
                             int64_t *out_dist_sum, int *skip_txfm_sb,
                             int64_t *skip_sse_sb) {
-  // Note our transform coeffs are 8 times an orthogonal transform.
-  // Hence quantizer step is also 8 times. To get effective quantizer
-  // we need to divide by 8 before sending to modeling function.
   int plane;
   const int ref = xd->mi[0]->mbmi.ref_frame[0];
 
   int64_t rate_sum = 0;
   int64_t dist_sum = 0;
   int64_t total_sse = 0;
-  const int dequant_shift =
-#if CONFIG_AOM_HIGHBITDEPTH
-      (xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) ? xd->bd - 5 :
-#endif  // CONFIG_AOM_HIGHBITDEPTH
-                                                    3;
 
   x->pred_sse[ref] = 0;
 
@@ -280,22 +307,7 @@ static void model_rd_for_sb(const AV1_COMP *const cpi, BLOCK_SIZE bsize,
 
     total_sse += sse;
 
-    // Fast approximate the modelling function.
-    if (cpi->sf.simple_model_rd_from_var) {
-      const int64_t square_error = sse;
-      const int quantizer = (pd->dequant[1] >> dequant_shift);
-      const int64_t rate_temp =
-          (quantizer < 120)
-              ? (square_error * (280 - quantizer)) >> (16 - AV1_PROB_COST_SHIFT)
-              : 0;
-      assert(rate_temp == (int)rate_temp);
-      rate = (int)rate_temp;
-      dist = (square_error * quantizer) >> 8;
-    } else {
-      av1_model_rd_from_var_lapndz(sse, num_pels_log2_lookup[bs],
-                                   pd->dequant[1] >> dequant_shift, &rate,
-                                   &dist);
-    }
+    model_rd_from_sse(cpi, xd, pd, bs, sse, &rate, &dist);
     rate_sum += rate;
     dist_sum += dist;
   }
@@ -527,6 +539,52 @@ static int rate_block(int plane, int block, int blk_row, int blk_col,
 }
 #endif
 
+void av1_reset_tx_rd_cache(TX_RD_CACHE *cache) {
+  memset(cache->records, 0, sizeof(cache->records));
+  av1_crc_calculator_init(&cache->crc);
+}
+
+#if !CONFIG_PVQ
+// Returns the record of the cache that holds, or will hold, the results of the
+// inter transform block, and sets *hash and *key to its residual CRC and to
+// the packed state its results depend on.
+static TX_RD_RECORD *get_tx_rd_record(const MACROBLOCK *x, int plane,
+                                      int block, int blk_row, int blk_col,
+                                      BLOCK_SIZE plane_bsize, TX_SIZE tx_size,
+                                      const struct rdcost_block_args *args,
+                                      uint32_t *hash, uint32_t *key) {
+  const MACROBLOCKD *const xd = &x->e_mbd;
+  const PLANE_TYPE plane_type = xd->plane[plane].plane_type;
+  const TX_TYPE tx_type = get_tx_type(plane_type, xd, block);
+  const int diff_stride = 4 * num_4x4_blocks_wide_lookup[plane_bsize];
+  const int16_t *src_diff =
+      &x->plane[plane].src_diff[4 * (blk_row * diff_stride + blk_col)];
+  const int tx_bsize = tx_size_1d[tx_size];
+  const int pt =
+      combine_entropy_contexts(args->t_above[blk_col], args->t_left[blk_row]);
+  uint32_t crc = 0;
+  int r;
+
+  for (r = 0; r < tx_bsize; ++r)
+    crc = av1_get_crc_value(&x->tx_rd_cache->crc, crc,
+                            (const uint8_t *)&src_diff[r * diff_stride],
+                            tx_bsize * (int)sizeof(*src_diff));
+
+  // Every field has its own bits: skip_block, use_lp32x32fdct and
+  // use_fast_coef_costing in bits 0 to 2, pt in 3 and 4, plane_type in 5,
+  // tx_type in 6 to 9, tx_size in 10 to 12 and q_index in 13 to 20. Bit 31
+  // tells a used record from an empty one.
+  assert(pt < 4 && tx_type < 16 && tx_size < 8 && x->q_index < 256);
+  *hash = crc;
+  *key = (1u << 31) | ((uint32_t)x->q_index << 13) | (tx_size << 10) |
+         (tx_type << 6) | (plane_type << 5) | (pt << 3) |
+         (args->use_fast_coef_costing << 2) | (x->use_lp32x32fdct << 1) |
+         x->skip_block;
+  return &x->tx_rd_cache->records[(crc ^ (*key * 2654435761u)) &
+                                  ((1 << TX_RD_CACHE_BITS) - 1)];
+}
+#endif
+
 static void block_rd_txfm(int plane, int block, int blk_row, int blk_col,
                           BLOCK_SIZE plane_bsize, TX_SIZE tx_size, void *arg) {
   struct rdcost_block_args *args = arg;
@@ -538,6 +596,11 @@ static void block_rd_txfm(int plane, int block, int blk_row, int blk_col,
   int rate;
   int64_t dist;
   int64_t sse;
+#if !CONFIG_PVQ
+  TX_RD_RECORD *record = NULL;
+  uint32_t hash = 0, key = 0;
+  int cache_hit = 0;
+#endif
 
   if (args->exit_early) return;
 
@@ -547,10 +610,29 @@ static void block_rd_txfm(int plane, int block, int blk_row, int blk_col,
                            &b_args);
     dist_block(x, plane, block, tx_size, &dist, &sse);
   } else {
-    // full forward transform and quantization
-    av1_xform_quant(cm, x, plane, block, blk_row, blk_col, plane_bsize,
-                    tx_size);
-    dist_block(x, plane, block, tx_size, &dist, &sse);
+#if !CONFIG_PVQ
+    // The results of an inter block only depend on its residual and on the
+    // key, so a residual seen before in the frame needs no transform.
+    if (x->tx_rd_cache) {
+      record = get_tx_rd_record(x, plane, block, blk_row, blk_col, plane_bsize,
+                                tx_size, args, &hash, &key);
+      cache_hit = record->hash == hash && record->key == key;
+      ++(*x->tx_rd_lookup_count_ptr);
+      *x->tx_rd_hit_count_ptr += cache_hit;
+    }
+    if (cache_hit) {
+      x->plane[plane].eobs[block] = record->eob;
+      dist = record->dist;
+      sse = record->sse;
+    } else {
+#endif
+      // full forward transform and quantization
+      av1_xform_quant(cm, x, plane, block, blk_row, blk_col, plane_bsize,
+                      tx_size);
+      dist_block(x, plane, block, tx_size, &dist, &sse);
+#if !CONFIG_PVQ
+    }
+#endif
   }
 
   rd = RDCOST(x->rdmult, x->rddiv, 0, dist);
@@ -559,7 +641,20 @@ static void block_rd_txfm(int plane, int block, int blk_row, int blk_col,
     return;
   }
 #if !CONFIG_PVQ
-  rate = rate_block(plane, block, blk_row, blk_col, tx_size, args);
+  if (cache_hit) {
+    rate = record->rate;
+    args->t_above[blk_col] = args->t_left[blk_row] = record->eob > 0;
+  } else {
+    rate = rate_block(plane, block, blk_row, blk_col, tx_size, args);
+    if (record) {
+      record->hash = hash;
+      record->key = key;
+      record->rate = rate;
+      record->eob = x->plane[plane].eobs[block];
+      record->dist = dist;
+      record->sse = sse;
+    }
+  }
 #else
   rate = x->rate;
 #endif
@@ -2758,20 +2853,10 @@ static void joint_motion_search(const AV1_COMP *cpi, MACROBLOCK *x,
         // Use up-sampled reference frames.
         struct macroblockd_plane *const pd = &xd->plane[0];
         struct buf_2d backup_pred = pd->pre[0];
-        const YV12_BUFFER_CONFIG *upsampled_ref =
-            get_upsampled_ref(cpi, refs[id]);
 
-        // Set pred for Y plane
-        setup_pred_plane(&pd->pre[0], upsampled_ref->y_buffer,
-                         upsampled_ref->y_stride, (mi_row << 3), (mi_col << 3),
-                         NULL, pd->subsampling_x, pd->subsampling_y);
-
-        // If bsize < BLOCK_8X8, adjust pred pointer for this block
-        if (bsize < BLOCK_8X8)
-          pd->pre[0].buf =
-              &pd->pre[0].buf[(av1_raster_block_offset(BLOCK_8X8, block,
-                                                       pd->pre[0].stride))
-                              << 3];
+        // Set pred for Y plane, for this block if bsize < BLOCK_8X8
+        av1_setup_upsampled_pred(cpi, x, refs[id], 0, mi_row, mi_col,
+                                 bsize < BLOCK_8X8 ? block : 0);
 
         bestsme = cpi->find_fractional_mv_step(
             x, &tmp_mv, &ref_mv[id].as_mv, cpi->common.allow_high_precision_mv,
@@ -2997,20 +3082,10 @@ static int64_t rd_pick_best_sub8x8_mode(
               const int ph = 4 * num_4x4_blocks_high_lookup[bsize];
               // Use up-sampled reference frames.
               struct buf_2d backup_pred = pd->pre[0];
-              const YV12_BUFFER_CONFIG *upsampled_ref =
-                  get_upsampled_ref(cpi, mbmi->ref_frame[0]);
-
-              // Set pred for Y plane
-              setup_pred_plane(&pd->pre[0], upsampled_ref->y_buffer,
-                               upsampled_ref->y_stride, (mi_row << 3),
-                               (mi_col << 3), NULL, pd->subsampling_x,
-                               pd->subsampling_y);
 
-              // adjust pred pointer for this block
-              pd->pre[0].buf =
-                  &pd->pre[0].buf[(av1_raster_block_offset(BLOCK_8X8, index,
-                                                           pd->pre[0].stride))
-                                  << 3];
+              // Set pred for Y plane, for this block
+              av1_setup_upsampled_pred(cpi, x, mbmi->ref_frame[0], 0, mi_row,
+                                       mi_col, index);
 
               cpi->find_fractional_mv_step(
                   x, new_mv, &bsi->ref_mv[0]->as_mv,
@@ -3436,6 +3511,126 @@ static void setup_buffer_inter(const AV1_COMP *const cpi, MACROBLOCK *x,
                 block_size);
 }
 
+// Scales the error of a full pel motion vector for the block to the 64
+// pixels of an 8x8 cell.
+static int mv_field_cost(BLOCK_SIZE bsize, int err) {
+  const int pels_log2 =
+      b_width_log2_lookup[bsize] + b_height_log2_lookup[bsize] + 4;
+  return (int)(((int64_t)err << 6) >> pels_log2);
+}
+
+// Looks up the cells of the block in the motion field of the superblock.
+// If the cells all hold the same vector and it fits the block no more than
+// half worse than it fit the blocks it was found for, sets *best_mv and
+// *bestsme to skip the full pel search and returns 1, or 2 with the sub pel
+// vector in *sub_mv if the cells also agree on it. Otherwise replaces
+// *mvp_full with the best vector of the cells if it fits the block better, and
+// returns 0.
+static int load_mv_field(const AV1_COMP *cpi, const MACROBLOCK *x,
+                         BLOCK_SIZE bsize, int mi_row, int mi_col, int ref,
+                         const MV *ref_mv, MV *mvp_full, MV *best_mv,
+                         int *bestsme, MV *sub_mv) {
+  const aom_variance_fn_ptr_t *const fn_ptr = &cpi->fn_ptr[bsize];
+  const int row0 = mi_row & MAX_MIB_MASK;
+  const int col0 = mi_col & MAX_MIB_MASK;
+  const int rows = num_8x8_blocks_high_lookup[bsize];
+  const int cols = num_8x8_blocks_wide_lookup[bsize];
+  const MV_FIELD_CELL *best = NULL;
+  int uniform = 1, uniform_sub = 1;
+  int64_t cost_sum = 0;
+  int mv_var, r, c;
+
+  for (r = row0; r < row0 + rows; ++r) {
+    for (c = col0; c < col0 + cols; ++c) {
+      const MV_FIELD_CELL *const cell = &x->mv_field[r * MAX_MIB_SIZE + c][ref];
+      if (!cell->valid) {
+        uniform = 0;
+        continue;
+      }
+      if (best && (cell->full_mv.row != best->full_mv.row ||
+                   cell->full_mv.col != best->full_mv.col))
+        uniform = 0;
+      if (best && (cell->sub_mv.row != best->sub_mv.row ||
+                   cell->sub_mv.col != best->sub_mv.col))
+        uniform_sub = 0;
+      if (!best || cell->cost < best->cost) best = cell;
+      cost_sum += cell->cost;
+    }
+  }
+
+  if (!best || best->full_mv.col < x->mv_col_min ||
+      best->full_mv.col > x->mv_col_max || best->full_mv.row < x->mv_row_min ||
+      best->full_mv.row > x->mv_row_max)
+    return 0;
+
+  mv_var = av1_get_mvpred_var(x, &best->full_mv, ref_mv, fn_ptr, 1);
+  if (uniform &&
+      mv_field_cost(bsize, mv_var) <= cost_sum * 3 / (2 * rows * cols)) {
+    *best_mv = best->full_mv;
+    *bestsme = mv_var;
+    if (!uniform_sub) return 1;
+    *sub_mv = best->sub_mv;
+    return 2;
+  }
+
+  if (mvp_full->col < x->mv_col_min || mvp_full->col > x->mv_col_max ||
+      mvp_full->row < x->mv_row_min || mvp_full->row > x->mv_row_max ||
+      mv_var < av1_get_mvpred_var(x, mvp_full, ref_mv, fn_ptr, 1))
+    *mvp_full = best->full_mv;
+  return 0;
+}
+
+// Records the result of a motion search in the cells of the block, unless they
+// hold a vector that fit its own block better.
+static void store_mv_field(MACROBLOCK *x, BLOCK_SIZE bsize, int mi_row,
+                           int mi_col, int ref, const MV *full_mv, int err,
+                           const MV *sub_mv) {
+  const int row0 = mi_row & MAX_MIB_MASK;
+  const int col0 = mi_col & MAX_MIB_MASK;
+  const int rows = num_8x8_blocks_high_lookup[bsize];
+  const int cols = num_8x8_blocks_wide_lookup[bsize];
+  const int cost = mv_field_cost(bsize, err);
+  int r, c;
+
+  for (r = row0; r < row0 + rows; ++r) {
+    for (c = col0; c < col0 + cols; ++c) {
+      MV_FIELD_CELL *const cell = &x->mv_field[r * MAX_MIB_SIZE + c][ref];
+      if (cell->valid && cell->cost <= cost) continue;
+      cell->valid = 1;
+      cell->full_mv = *full_mv;
+      cell->cost = cost;
+      cell->sub_mv = *sub_mv;
+    }
+  }
+}
+
+// Replaces the full pel start vector *mvp_full with the motion the first pass
+// found from the LAST frame for the macroblock at the centre of the block, if
+// that fits the block better.
+static void firstpass_mv_candidate(const AV1_COMP *cpi, const MACROBLOCK *x,
+                                   BLOCK_SIZE bsize, int mi_row, int mi_col,
+                                   const MV *ref_mv, MV *mvp_full) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const aom_variance_fn_ptr_t *const fn_ptr = &cpi->fn_ptr[bsize];
+  const int mb_row = AOMMIN(
+      (mi_row + num_8x8_blocks_high_lookup[bsize] / 2) >> 1, cm->mb_rows - 1);
+  const int mb_col = AOMMIN(
+      (mi_col + num_8x8_blocks_wide_lookup[bsize] / 2) >> 1, cm->mb_cols - 1);
+  MV start_mv = *mvp_full, mv;
+
+  if (!av1_firstpass_mv_candidate(cpi, x, cpi->twopass.this_frame_mb_mvs,
+                                  cpi->twopass.this_frame_mvs_dist,
+                                  mb_row * cm->mb_cols + mb_col, &mv))
+    return;
+
+  clamp_mv(&start_mv, x->mv_col_min, x->mv_col_max, x->mv_row_min,
+           x->mv_row_max);
+  if ((mv.row != start_mv.row || mv.col != start_mv.col) &&
+      av1_get_mvpred_var(x, &mv, ref_mv, fn_ptr, 1) <
+          av1_get_mvpred_var(x, &start_mv, ref_mv, fn_ptr, 1))
+    *mvp_full = mv;
+}
+
 static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
                                  BLOCK_SIZE bsize, int mi_row, int mi_col,
                                  int_mv *tmp_mv, int *rate_mv) {
@@ -3455,6 +3650,15 @@ static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
   int tmp_row_min = x->mv_row_min;
   int tmp_row_max = x->mv_row_max;
   int cost_list[5];
+#if CONFIG_MOTION_VAR
+  const int use_mv_field =
+      cpi->sf.reuse_mv_field && mbmi->motion_mode == SIMPLE_TRANSLATION;
+#else
+  const int use_mv_field = cpi->sf.reuse_mv_field;
+#endif  // CONFIG_MOTION_VAR
+  int skip_full_search = 0;
+  MV full_mv, sub_mv;
+  int full_sme;
 
   const YV12_BUFFER_CONFIG *scaled_ref_frame =
       av1_get_scaled_ref_frame(cpi, ref);
@@ -3537,13 +3741,29 @@ static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
   mvp_full.col >>= 3;
   mvp_full.row >>= 3;
 
+  if (use_mv_field)
+    skip_full_search =
+        load_mv_field(cpi, x, bsize, mi_row, mi_col, ref, &ref_mv, &mvp_full,
+                      &tmp_mv->as_mv, &bestsme, &sub_mv);
+
 #if CONFIG_MOTION_VAR
   switch (mbmi->motion_mode) {
     case SIMPLE_TRANSLATION:
 #endif  // CONFIG_MOTION_VAR
-      bestsme = av1_full_pixel_search(cpi, x, bsize, &mvp_full, step_param,
-                                      sadpb, cond_cost_list(cpi, cost_list),
-                                      &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
+      if (skip_full_search) {
+        int i;
+        for (i = 0; i < 5; ++i) cost_list[i] = INT_MAX;
+      } else {
+        if (cpi->twopass.this_frame_mb_mvs && ref == LAST_FRAME)
+          firstpass_mv_candidate(cpi, x, bsize, mi_row, mi_col, &ref_mv,
+                                 &mvp_full);
+        if (cpi->sf.mv.pyramid_levels)
+          av1_pyramid_motion_search(cpi, x, bsize, mi_row, mi_col, ref,
+                                    &ref_mv, &cpi->fn_ptr[bsize], &mvp_full);
+        bestsme = av1_full_pixel_search(cpi, x, bsize, &mvp_full, step_param,
+                                        sadpb, cond_cost_list(cpi, cost_list),
+                                        &ref_mv, &tmp_mv->as_mv, INT_MAX, 1);
+      }
 #if CONFIG_MOTION_VAR
       break;
     case OBMC_CAUSAL:
@@ -3561,7 +3781,19 @@ static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
   x->mv_row_min = tmp_row_min;
   x->mv_row_max = tmp_row_max;
 
-  if (bestsme < INT_MAX) {
+  full_mv = tmp_mv->as_mv;
+  full_sme = bestsme;
+
+  if (skip_full_search == 2) {
+    // The cells also agree on the sub pel refinement of the vector.
+    const struct buf_2d *const src = &x->plane[0].src;
+    const struct buf_2d *const pre = &xd->plane[0].pre[0];
+    tmp_mv->as_mv = sub_mv;
+    cpi->fn_ptr[bsize].svf(
+        pre->buf + (sub_mv.row >> 3) * pre->stride + (sub_mv.col >> 3),
+        pre->stride, sub_mv.col & 7, sub_mv.row & 7, src->buf, src->stride,
+        &x->pred_sse[ref]);
+  } else if (bestsme < INT_MAX) {
     int dis; /* TODO: use dis in distortion calculation later. */
 #if CONFIG_MOTION_VAR
     switch (mbmi->motion_mode) {
@@ -3573,13 +3805,9 @@ static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
           // Use up-sampled reference frames.
           struct macroblockd_plane *const pd = &xd->plane[0];
           struct buf_2d backup_pred = pd->pre[0];
-          const YV12_BUFFER_CONFIG *upsampled_ref = get_upsampled_ref(cpi, ref);
 
           // Set pred for Y plane
-          setup_pred_plane(&pd->pre[0], upsampled_ref->y_buffer,
-                           upsampled_ref->y_stride, (mi_row << 3),
-                           (mi_col << 3), NULL, pd->subsampling_x,
-                           pd->subsampling_y);
+          av1_setup_upsampled_pred(cpi, x, ref, 0, mi_row, mi_col, 0);
 
           bestsme = cpi->find_fractional_mv_step(
               x, &tmp_mv->as_mv, &ref_mv, cm->allow_high_precision_mv,
@@ -3615,6 +3843,10 @@ static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
   *rate_mv = av1_mv_bit_cost(&tmp_mv->as_mv, &ref_mv, x->nmvjointcost,
                              x->mvcost, MV_COST_WEIGHT);
 
+  if (use_mv_field && full_sme < INT_MAX)
+    store_mv_field(x, bsize, mi_row, mi_col, ref, &full_mv, full_sme,
+                   &tmp_mv->as_mv);
+
 #if CONFIG_MOTION_VAR
   if (cpi->sf.adaptive_motion_search && mbmi->motion_mode == SIMPLE_TRANSLATION)
 #else
@@ -5484,6 +5716,296 @@ void av1_rd_pick_inter_mode_sb_seg_skip(const AV1_COMP *cpi,
   store_coding_context(x, ctx, THR_ZEROMV, best_pred_diff, 0);
 }
 
+struct estimate_block_intra_args {
+  const AV1_COMP *cpi;
+  MACROBLOCK *x;
+  unsigned int sse;
+};
+
+// Predicts a transform block with DC_PRED and accumulates the prediction
+// error. Blocks to the left and above within the same block are predicted but
+// not reconstructed, so this is only an estimate of the final prediction.
+static void estimate_block_intra(int plane, int block, int blk_row, int blk_col,
+                                 BLOCK_SIZE plane_bsize, TX_SIZE tx_size,
+                                 void *arg) {
+  struct estimate_block_intra_args *const args = arg;
+  MACROBLOCK *const x = args->x;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  const struct macroblock_plane *const p = &x->plane[plane];
+  const struct macroblockd_plane *const pd = &xd->plane[plane];
+  const int src_stride = p->src.stride;
+  const int dst_stride = pd->dst.stride;
+  const uint8_t *const src = &p->src.buf[4 * (blk_row * src_stride + blk_col)];
+  uint8_t *const dst = &pd->dst.buf[4 * (blk_row * dst_stride + blk_col)];
+  unsigned int sse;
+  (void)block;
+
+  av1_predict_intra_block(xd, b_width_log2_lookup[plane_bsize],
+                          b_height_log2_lookup[plane_bsize], tx_size, DC_PRED,
+                          dst, dst_stride, dst, dst_stride, blk_col, blk_row,
+                          plane);
+  args->cpi->fn_ptr[txsize_to_bsize[tx_size]].vf(src, src_stride, dst,
+                                                 dst_stride, &sse);
+  args->sse += sse;
+}
+
+static int get_single_ref_mode_index(PREDICTION_MODE mode,
+                                     MV_REFERENCE_FRAME ref_frame) {
+  int i;
+  for (i = 0; i < MAX_MODES; ++i) {
+    if (av1_mode_order[i].mode == mode &&
+        av1_mode_order[i].ref_frame[0] == ref_frame &&
+        av1_mode_order[i].ref_frame[1] == NONE)
+      return i;
+  }
+  assert(0 && "Invalid mode");
+  return THR_DC;
+}
+
+void av1_nonrd_pick_inter_mode_sb(const AV1_COMP *cpi, TileDataEnc *tile_data,
+                                  MACROBLOCK *x, int mi_row, int mi_col,
+                                  RD_COST *rd_cost, BLOCK_SIZE bsize,
+                                  PICK_MODE_CONTEXT *ctx,
+                                  int64_t best_rd_so_far) {
+  const AV1_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  MB_MODE_INFO *const mbmi = &xd->mi[0]->mbmi;
+  MB_MODE_INFO_EXT *const mbmi_ext = x->mbmi_ext;
+  const struct segmentation *const seg = &cm->seg;
+  unsigned char segment_id = mbmi->segment_id;
+  static const int flag_list[REFS_PER_FRAME + 1] = {
+    0,
+    AOM_LAST_FLAG,
+#if CONFIG_EXT_REFS
+    AOM_LAST2_FLAG,
+    AOM_LAST3_FLAG,
+#endif  // CONFIG_EXT_REFS
+    AOM_GOLD_FLAG,
+#if CONFIG_EXT_REFS
+    AOM_BWD_FLAG,
+#endif  // CONFIG_EXT_REFS
+    AOM_ALT_FLAG
+  };
+  static const PREDICTION_MODE inter_modes[] = { NEARESTMV, NEARMV, ZEROMV,
+                                                 NEWMV };
+  int_mv frame_mv[MB_MODE_COUNT][MAX_REF_FRAMES];
+  struct buf_2d yv12_mb[MAX_REF_FRAMES][MAX_MB_PLANE];
+  unsigned int ref_costs_single[MAX_REF_FRAMES], ref_costs_comp[MAX_REF_FRAMES];
+  aom_prob comp_mode_p;
+  const aom_prob skip_prob = av1_get_skip_prob(cm, xd);
+  const int skip_cost0 = av1_cost_bit(skip_prob, 0);
+  const int skip_cost1 = av1_cost_bit(skip_prob, 1);
+  int64_t best_rd = best_rd_so_far;
+  int64_t best_pred_diff[REFERENCE_MODES];
+  MB_MODE_INFO best_mbmode;
+  int best_mode_index = -1;
+  int best_skip = 0;
+  MV_REFERENCE_FRAME ref_frame;
+  int i;
+
+  (void)tile_data;
+
+  estimate_ref_frame_costs(cm, xd, segment_id, ref_costs_single, ref_costs_comp,
+                           &comp_mode_p);
+  av1_zero(best_mbmode);
+
+  for (i = 0; i < MAX_REF_FRAMES; ++i) x->pred_sse[i] = INT_MAX;
+
+  rd_cost->rate = INT_MAX;
+
+  // Only the modes are searched. The transform size is the largest allowed
+  // and the interpolation filter is not searched.
+  mbmi->uv_mode = DC_PRED;
+  mbmi->ref_frame[1] = NONE;
+  mbmi->tx_size =
+      AOMMIN(max_txsize_lookup[bsize], tx_mode_to_biggest_tx_size[cm->tx_mode]);
+  mbmi->tx_type = DCT_DCT;
+  mbmi->interp_filter =
+      cm->interp_filter == SWITCHABLE ? EIGHTTAP : cm->interp_filter;
+#if CONFIG_MOTION_VAR
+  mbmi->motion_mode = SIMPLE_TRANSLATION;
+#endif  // CONFIG_MOTION_VAR
+#if CONFIG_REF_MV
+  mbmi->ref_mv_idx = 0;
+#endif
+#if CONFIG_PALETTE
+  mbmi->palette_mode_info.palette_size[0] = 0;
+  mbmi->palette_mode_info.palette_size[1] = 0;
+#endif  // CONFIG_PALETTE
+#if CONFIG_EXT_INTRA
+  mbmi->intra_angle_delta[0] = 0;
+  mbmi->intra_angle_delta[1] = 0;
+#endif  // CONFIG_EXT_INTRA
+
+  for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
+    x->pred_mv_sad[ref_frame] = INT_MAX;
+    mbmi_ext->mode_context[ref_frame] = 0;
+    if (cpi->ref_frame_flags & flag_list[ref_frame]) {
+      assert(get_ref_frame_buffer(cpi, ref_frame) != NULL);
+      setup_buffer_inter(cpi, x, ref_frame, bsize, mi_row, mi_col,
+                         frame_mv[NEARESTMV], frame_mv[NEARMV], yv12_mb);
+    }
+    frame_mv[NEWMV][ref_frame].as_int = INVALID_MV;
+    frame_mv[ZEROMV][ref_frame].as_int = 0;
+  }
+
+  for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
+    int16_t mode_ctx;
+    int m;
+
+    if (!(cpi->ref_frame_flags & flag_list[ref_frame])) continue;
+    if (segfeature_active(seg, segment_id, SEG_LVL_REF_FRAME) &&
+        get_segdata(seg, segment_id, SEG_LVL_REF_FRAME) != (int)ref_frame)
+      continue;
+
+    mbmi->ref_frame[0] = ref_frame;
+    for (i = 0; i < MAX_MB_PLANE; i++)
+      xd->plane[i].pre[0] = yv12_mb[ref_frame][i];
+#if CONFIG_REF_MV
+    mode_ctx = av1_mode_context_analyzer(mbmi_ext->mode_context,
+                                         mbmi->ref_frame, bsize, -1);
+#else
+    mode_ctx = mbmi_ext->mode_context[ref_frame];
+#endif
+
+    for (m = 0; m < (int)(sizeof(inter_modes) / sizeof(inter_modes[0])); ++m) {
+      const PREDICTION_MODE this_mode = inter_modes[m];
+      int_mv this_mv;
+      int rate = ref_costs_single[ref_frame];
+      int model_rate, skip_txfm_sb, this_skip = 0;
+      int64_t dist, skip_sse_sb, this_rd;
+
+      if (!(cpi->sf.inter_mode_mask[bsize] & (1 << this_mode))) continue;
+
+      mbmi->mode = this_mode;
+      if (this_mode == NEWMV) {
+        int rate_mv;
+#if CONFIG_REF_MV
+        const int_mv backup_ref_mv = mbmi_ext->ref_mvs[ref_frame][0];
+        if (mbmi_ext->ref_mv_count[ref_frame] > 1) {
+          int_mv ref_mv = mbmi_ext->ref_mv_stack[ref_frame][0].this_mv;
+          clamp_mv_ref(&ref_mv.as_mv, xd->n8_w << 3, xd->n8_h << 3, xd);
+          lower_mv_precision(&ref_mv.as_mv, cm->allow_high_precision_mv);
+          mbmi_ext->ref_mvs[ref_frame][0] = ref_mv;
+        }
+#endif
+        single_motion_search(cpi, x, bsize, mi_row, mi_col, &this_mv,
+                             &rate_mv);
+#if CONFIG_REF_MV
+        mbmi_ext->ref_mvs[ref_frame][0] = backup_ref_mv;
+#endif
+        if (this_mv.as_int == INVALID_MV) continue;
+        // A new mv that matches a predicted one is cheaper to code with
+        // NEARESTMV or ZEROMV, which are checked as well.
+        if (this_mv.as_int == frame_mv[NEARESTMV][ref_frame].as_int ||
+            this_mv.as_int == 0)
+          continue;
+        rate += rate_mv;
+      } else {
+        this_mv = frame_mv[this_mode][ref_frame];
+        clamp_mv2(&this_mv.as_mv, xd);
+        if (this_mode == NEARMV &&
+            this_mv.as_int == frame_mv[NEARESTMV][ref_frame].as_int)
+          continue;
+#if CONFIG_REF_MV
+        // A zero mv can only be coded as ZEROMV when all candidates are zero.
+        if (this_mode != ZEROMV && this_mv.as_int == 0 &&
+            (mode_ctx & (1 << ALL_ZERO_FLAG_OFFSET)))
+          continue;
+#endif
+      }
+      if (mv_check_bounds(x, &this_mv.as_mv)) continue;
+      mbmi->mv[0].as_int = this_mv.as_int;
+
+      rate += cost_mv_ref(cpi, this_mode, mode_ctx);
+      rate += av1_get_switchable_rate(cpi, xd);
+      av1_build_inter_predictors_sb(xd, mi_row, mi_col, bsize);
+      model_rd_for_sb(cpi, bsize, x, xd, &model_rate, &dist, &skip_txfm_sb,
+                      &skip_sse_sb);
+
+      if (skip_txfm_sb ||
+          RDCOST(x->rdmult, x->rddiv, skip_cost1, skip_sse_sb) <=
+              RDCOST(x->rdmult, x->rddiv, model_rate + skip_cost0, dist)) {
+        rate += skip_cost1;
+        dist = skip_sse_sb;
+        this_skip = 1;
+      } else {
+        rate += model_rate + skip_cost0;
+      }
+
+      this_rd = RDCOST(x->rdmult, x->rddiv, rate, dist);
+      if (this_rd < best_rd) {
+        best_rd = this_rd;
+        best_mbmode = *mbmi;
+        best_skip = this_skip;
+        best_mode_index = get_single_ref_mode_index(this_mode, ref_frame);
+        rd_cost->rate = rate;
+        rd_cost->dist = dist;
+        rd_cost->rdcost = this_rd;
+      }
+    }
+  }
+
+  // Check DC_PRED when no inter mode predicts the block well enough to skip
+  // its residual.
+  if ((best_mode_index < 0 || !best_skip) && bsize <= cpi->sf.max_intra_bsize &&
+      !(segfeature_active(seg, segment_id, SEG_LVL_REF_FRAME) &&
+        get_segdata(seg, segment_id, SEG_LVL_REF_FRAME) != INTRA_FRAME)) {
+    struct estimate_block_intra_args args = { cpi, x, 0 };
+    int rate = ref_costs_single[INTRA_FRAME] + cpi->mbmode_cost[DC_PRED] +
+               cpi->intra_uv_mode_cost[DC_PRED][DC_PRED] + skip_cost0;
+    int64_t dist = 0, this_rd;
+    int plane;
+
+    mbmi->mode = DC_PRED;
+    mbmi->ref_frame[0] = INTRA_FRAME;
+    mbmi->mv[0].as_int = 0;
+    for (plane = 0; plane < MAX_MB_PLANE; ++plane) {
+      const struct macroblockd_plane *const pd = &xd->plane[plane];
+      int plane_rate;
+      int64_t plane_dist;
+
+      args.sse = 0;
+      av1_foreach_transformed_block_in_plane(xd, bsize, plane,
+                                             estimate_block_intra, &args);
+      model_rd_from_sse(cpi, xd, pd, get_plane_block_size(bsize, pd), args.sse,
+                        &plane_rate, &plane_dist);
+      rate += plane_rate;
+      dist += plane_dist << 4;
+    }
+
+    this_rd = RDCOST(x->rdmult, x->rddiv, rate, dist);
+    if (this_rd < best_rd) {
+      best_rd = this_rd;
+      best_mbmode = *mbmi;
+      best_skip = 0;
+      best_mode_index = THR_DC;
+      rd_cost->rate = rate;
+      rd_cost->dist = dist;
+      rd_cost->rdcost = this_rd;
+    }
+  }
+
+  if (best_mode_index < 0 || best_rd >= best_rd_so_far) {
+    rd_cost->rate = INT_MAX;
+    rd_cost->rdcost = INT64_MAX;
+    return;
+  }
+
+  *mbmi = best_mbmode;
+  x->skip = best_skip;
+
+#if CONFIG_REF_MV
+  mbmi->pred_mv[0].as_int =
+      mbmi->mode == NEWMV ? mbmi_ext->ref_mvs[mbmi->ref_frame[0]][0].as_int
+                          : mbmi->mv[0].as_int;
+#endif
+
+  av1_zero(best_pred_diff);
+
+  store_coding_context(x, ctx, best_mode_index, best_pred_diff, best_skip);
+}
+
 void av1_rd_pick_inter_mode_sub8x8(const AV1_COMP *cpi, TileDataEnc *tile_data,
                                    MACROBLOCK *x, int mi_row, int mi_col,
                                    RD_COST *rd_cost, BLOCK_SIZE bsize,
@@ -26,6 +26,10 @@ struct AV1_COMP;
 struct macroblock;
 struct RD_COST;
 
+// Empties the transform rate distortion cache of a thread. Called before each
+// frame, as its results depend on the token costs of the frame.
+void av1_reset_tx_rd_cache(TX_RD_CACHE *cache);
+
 void av1_rd_pick_intra_mode_sb(const struct AV1_COMP *cpi, struct macroblock *x,
                                struct RD_COST *rd_cost, BLOCK_SIZE bsize,
                                PICK_MODE_CONTEXT *ctx, int64_t best_rd);
@@ -50,6 +54,16 @@ void av1_rd_pick_inter_mode_sb_seg_skip(
     struct macroblock *x, struct RD_COST *rd_cost, BLOCK_SIZE bsize,
     PICK_MODE_CONTEXT *ctx, int64_t best_rd_so_far);
 
+// Picks the mode of a block of at least 8x8 in an inter frame without rate
+// distortion search: the rate and distortion of each candidate are modelled
+// from the variance of its prediction error, and no transform is searched.
+void av1_nonrd_pick_inter_mode_sb(const struct AV1_COMP *cpi,
+                                  struct TileDataEnc *tile_data,
+                                  struct macroblock *x, int mi_row, int mi_col,
+                                  struct RD_COST *rd_cost, BLOCK_SIZE bsize,
+                                  PICK_MODE_CONTEXT *ctx,
+                                  int64_t best_rd_so_far);
+
 int av1_internal_image_edge(const struct AV1_COMP *cpi);
 int av1_active_h_edge(const struct AV1_COMP *cpi, int mi_row, int mi_step);
 int av1_active_v_edge(const struct AV1_COMP *cpi, int mi_col, int mi_step);
@@ -64,16 +64,28 @@ static BLOCK_SIZE set_partition_min_limit(AV1_COMMON *const cm) {
   }
 }
 
+// Number of pyramid levels searched ahead of the full pel motion search. The
+// downscaled levels only pay off once large motion vectors are common.
+static int get_pyramid_levels(const AV1_COMMON *cm) {
+  const int min_dim = AOMMIN(cm->width, cm->height);
+  if (min_dim > 1080) return 3;
+  if (min_dim >= 720) return 2;
+  return 0;
+}
+
 static void set_good_speed_feature_framesize_dependent(AV1_COMP *cpi,
                                                        SPEED_FEATURES *sf,
                                                        int speed) {
   AV1_COMMON *const cm = &cpi->common;
 
   // Limit memory usage for high resolutions
-  if (AOMMIN(cm->width, cm->height) > 1080) {
-    sf->use_upsampled_references = 0;
+  if (AOMMIN(cm->width, cm->height) > 1080 ||
+      cpi->oxcf.upsampled_refs_on_the_fly) {
+    sf->upsampled_refs_on_the_fly = 1;
   }
 
+  sf->mv.pyramid_levels = get_pyramid_levels(cm);
+
   if (speed >= 1) {
     if (AOMMIN(cm->width, cm->height) >= 720) {
       sf->disable_split_mask =
@@ -152,6 +164,7 @@ static void set_good_speed_feature(AV1_COMP *cpi, AV1_COMMON *cm,
 
     sf->use_rd_breakout = 1;
     sf->adaptive_motion_search = 1;
+    sf->reuse_mv_field = 1;
     sf->mv.auto_mv_step_size = 1;
     sf->adaptive_rd_thresh = 2;
     sf->mv.subpel_iters_per_step = 1;
@@ -215,6 +228,7 @@ static void set_good_speed_feature(AV1_COMP *cpi, AV1_COMMON *cm,
     sf->use_fast_coef_updates = ONE_LOOP_REDUCED;
     sf->use_fast_coef_costing = 1;
     sf->partition_search_breakout_rate_thr = 300;
+    sf->lpf_pick = LPF_PICK_FROM_SAMPLED_ROWS;
   }
 
   if (speed >= 5) {
@@ -237,6 +251,8 @@ static void set_rt_speed_feature_framesize_dependent(AV1_COMP *cpi,
                                                      int speed) {
   AV1_COMMON *const cm = &cpi->common;
 
+  sf->mv.pyramid_levels = get_pyramid_levels(cm);
+
   if (speed >= 1) {
     if (AOMMIN(cm->width, cm->height) >= 720) {
       sf->disable_split_mask =
@@ -285,6 +301,7 @@ static void set_rt_speed_feature(AV1_COMP *cpi, SPEED_FEATURES *sf, int speed,
     sf->use_rd_breakout = 1;
 
     sf->adaptive_motion_search = 1;
+    sf->reuse_mv_field = 1;
     sf->adaptive_pred_interp_filter = 1;
     sf->mv.auto_mv_step_size = 1;
     sf->adaptive_rd_thresh = 2;
@@ -406,6 +423,9 @@ static void set_rt_speed_feature(AV1_COMP *cpi, SPEED_FEATURES *sf, int speed,
     sf->mv.subpel_force_stop = 2;
     sf->lpf_pick = LPF_PICK_MINIMAL_LPF;
   }
+  if (speed >= 9) {
+    sf->use_nonrd_pick_mode = 1;
+  }
 }
 
 void av1_set_speed_features_framesize_dependent(AV1_COMP *cpi) {
@@ -451,11 +471,13 @@ void av1_set_speed_features_framesize_independent(AV1_COMP *cpi) {
   sf->coeff_prob_appx_step = 1;
   sf->mv.auto_mv_step_size = 0;
   sf->mv.fullpel_search_step_param = 6;
+  sf->mv.pyramid_levels = 0;
   sf->comp_inter_joint_search_thresh = BLOCK_4X4;
   sf->adaptive_rd_thresh = 0;
   sf->tx_size_search_method = USE_FULL_RD;
   sf->use_lp32x32fdct = 0;
   sf->adaptive_motion_search = 0;
+  sf->reuse_mv_field = 0;
   sf->adaptive_pred_interp_filter = 0;
   sf->adaptive_mode_search = 0;
   sf->cb_pred_filter_search = 0;
@@ -479,6 +501,7 @@ void av1_set_speed_features_framesize_independent(AV1_COMP *cpi) {
   sf->adaptive_interp_filter_search = 0;
   sf->allow_partition_search_skip = 0;
   sf->use_upsampled_references = 1;
+  sf->upsampled_refs_on_the_fly = 0;
 
   for (i = 0; i < TX_SIZES; i++) {
     sf->intra_y_mode_mask[i] = INTRA_ALL;
@@ -493,6 +516,7 @@ void av1_set_speed_features_framesize_independent(AV1_COMP *cpi) {
   for (i = 0; i < BLOCK_SIZES; ++i) sf->inter_mode_mask[i] = INTER_ALL;
   sf->max_intra_bsize = BLOCK_64X64;
   sf->reuse_inter_pred_sby = 0;
+  sf->use_nonrd_pick_mode = 0;
   // This setting only takes effect when partition_search_type is set
   // to FIXED_PARTITION.
   sf->always_this_block_size = BLOCK_16X16;
@@ -102,6 +102,8 @@ typedef enum {
   LPF_PICK_FROM_FULL_IMAGE,
   // Try a small portion of the image with different values.
   LPF_PICK_FROM_SUBIMAGE,
+  // Try every fourth superblock row of the image with different values.
+  LPF_PICK_FROM_SAMPLED_ROWS,
   // Estimate the level based on quantizer and frame type
   LPF_PICK_FROM_Q,
   // Pick 0 to disable LPF if LPF was enabled last frame
@@ -186,6 +188,11 @@ typedef struct MV_SPEED_FEATURES {
 
   // This variable sets the step_param used in full pel motion search.
   int fullpel_search_step_param;
+
+  // Number of 2:1 downscaled levels of the source and reference frames that
+  // are searched coarse-to-fine to seed the full pel motion search. 0 turns
+  // the pyramid search off.
+  int pyramid_levels;
 } MV_SPEED_FEATURES;
 
 #define MAX_MESH_STEP 4
@@ -286,6 +293,11 @@ typedef struct SPEED_FEATURES {
   // point for this motion search and limits the search range around it.
   int adaptive_motion_search;
 
+  // Keeps the best motion vectors found in each 8x8 cell of the superblock.
+  // Motion searches of other block sizes start from them, and skip the search
+  // if the cells of the block agree on a vector that fits it.
+  int reuse_mv_field;
+
   // Flag for allowing some use of exhaustive searches;
   int allow_exhaustive_searches;
 
@@ -382,6 +394,11 @@ typedef struct SPEED_FEATURES {
   // time mode speed 6.
   int reuse_inter_pred_sby;
 
+  // Pick the modes of inter frame blocks from modelled rate and distortion,
+  // without transform or rate distortion search. Key frames and blocks smaller
+  // than 8x8 still use the rate distortion search.
+  int use_nonrd_pick_mode;
+
   // default interp filter choice
   InterpFilter default_interp_filter;
 
@@ -407,6 +424,10 @@ typedef struct SPEED_FEATURES {
 
   // Do sub-pixel search in up-sampled reference frames
   int use_upsampled_references;
+
+  // Interpolate the up-sampled reference frames on demand instead of storing
+  // them at 64 times the size of the luma plane.
+  int upsampled_refs_on_the_fly;
 } SPEED_FEATURES;
 
 struct AV1_COMP;
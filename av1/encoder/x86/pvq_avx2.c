@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+
+/* Same per-lane search as the SSE4.1 version, eight positions at a time. */
+int od_pvq_search_argmax_avx2(const int16_t *x, const int32_t *y, int n,
+                              int32_t xy, int32_t yy, int xshift, int yshift) {
+  int32_t nums[8];
+  int32_t dens[8];
+  int32_t poss[8];
+  int32_t best_num;
+  int32_t best_den;
+  int pos;
+  int i;
+  int j;
+  __m256i best_num_v;
+  __m256i best_den_v;
+  __m256i best_pos_v;
+  __m256i pos_v;
+  const __m256i xy_v = _mm256_set1_epi32(xy);
+  const __m256i yy_v = _mm256_set1_epi32(yy + 1);
+  const __m256i eight = _mm256_set1_epi32(8);
+  const __m128i xshift_v = _mm_cvtsi32_si128(xshift >= 0 ? xshift : 0);
+  const __m128i xlshift_v = _mm_cvtsi32_si128(xshift >= 0 ? 0 : -xshift);
+  const __m128i yshift_v = _mm_cvtsi32_si128(yshift);
+  if (n < 8) return od_pvq_search_argmax_c(x, y, n, xy, yy, xshift, yshift);
+  best_num_v = _mm256_set1_epi32(-1);
+  best_den_v = _mm256_set1_epi32(1);
+  best_pos_v = _mm256_setzero_si256();
+  pos_v = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  for (j = 0; j + 8 <= n; j += 8) {
+    __m256i num;
+    __m256i den;
+    __m256i better;
+    num = _mm256_add_epi32(
+        xy_v, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(x + j))));
+    num = _mm256_sll_epi32(_mm256_sra_epi32(num, xshift_v), xlshift_v);
+    num = _mm256_srai_epi32(_mm256_mullo_epi32(num, num), 15);
+    den = _mm256_loadu_si256((const __m256i *)(y + j));
+    den = _mm256_sra_epi32(_mm256_add_epi32(yy_v, _mm256_add_epi32(den, den)),
+                           yshift_v);
+    better = _mm256_cmpgt_epi32(_mm256_mullo_epi32(num, best_den_v),
+                                _mm256_mullo_epi32(best_num_v, den));
+    best_num_v = _mm256_blendv_epi8(best_num_v, num, better);
+    best_den_v = _mm256_blendv_epi8(best_den_v, den, better);
+    best_pos_v = _mm256_blendv_epi8(best_pos_v, pos_v, better);
+    pos_v = _mm256_add_epi32(pos_v, eight);
+  }
+  _mm256_storeu_si256((__m256i *)nums, best_num_v);
+  _mm256_storeu_si256((__m256i *)dens, best_den_v);
+  _mm256_storeu_si256((__m256i *)poss, best_pos_v);
+  best_num = nums[0];
+  best_den = dens[0];
+  pos = poss[0];
+  for (i = 1; i < 8; i++) {
+    int32_t lhs = nums[i] * best_den;
+    int32_t rhs = best_num * dens[i];
+    if (lhs > rhs || (lhs == rhs && poss[i] < pos)) {
+      best_num = nums[i];
+      best_den = dens[i];
+      pos = poss[i];
+    }
+  }
+  for (; j < n; j++) {
+    int32_t num = xy + x[j];
+    int32_t den = (yy + 2 * y[j] + 1) >> yshift;
+    num = xshift >= 0 ? num >> xshift : num << -xshift;
+    num = (num * num) >> 15;
+    if (num * best_den > best_num * den) {
+      best_num = num;
+      best_den = den;
+      pos = j;
+    }
+  }
+  return pos;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>
+
+#include "./av1_rtcd.h"
+
+/* Each lane keeps the best candidate among the positions it visits. Since
+   positions are visited in increasing order and a lane only moves on a
+   strictly better score, ties between lanes are resolved in favour of the
+   lowest position, which matches the C version. */
+int od_pvq_search_argmax_sse4_1(const int16_t *x, const int32_t *y, int n,
+                                int32_t xy, int32_t yy, int xshift,
+                                int yshift) {
+  int32_t nums[4];
+  int32_t dens[4];
+  int32_t poss[4];
+  int32_t best_num;
+  int32_t best_den;
+  int pos;
+  int i;
+  int j;
+  __m128i best_num_v;
+  __m128i best_den_v;
+  __m128i best_pos_v;
+  __m128i pos_v;
+  const __m128i xy_v = _mm_set1_epi32(xy);
+  const __m128i yy_v = _mm_set1_epi32(yy + 1);
+  const __m128i four = _mm_set1_epi32(4);
+  const __m128i xshift_v = _mm_cvtsi32_si128(xshift >= 0 ? xshift : 0);
+  const __m128i xlshift_v = _mm_cvtsi32_si128(xshift >= 0 ? 0 : -xshift);
+  const __m128i yshift_v = _mm_cvtsi32_si128(yshift);
+  if (n < 4) return od_pvq_search_argmax_c(x, y, n, xy, yy, xshift, yshift);
+  best_num_v = _mm_set1_epi32(-1);
+  best_den_v = _mm_set1_epi32(1);
+  best_pos_v = _mm_setzero_si128();
+  pos_v = _mm_setr_epi32(0, 1, 2, 3);
+  for (j = 0; j + 4 <= n; j += 4) {
+    __m128i num;
+    __m128i den;
+    __m128i better;
+    num = _mm_add_epi32(
+        xy_v, _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(x + j))));
+    num = _mm_sll_epi32(_mm_sra_epi32(num, xshift_v), xlshift_v);
+    num = _mm_srai_epi32(_mm_mullo_epi32(num, num), 15);
+    den = _mm_loadu_si128((const __m128i *)(y + j));
+    den = _mm_sra_epi32(_mm_add_epi32(yy_v, _mm_add_epi32(den, den)),
+                        yshift_v);
+    better = _mm_cmpgt_epi32(_mm_mullo_epi32(num, best_den_v),
+                             _mm_mullo_epi32(best_num_v, den));
+    best_num_v = _mm_blendv_epi8(best_num_v, num, better);
+    best_den_v = _mm_blendv_epi8(best_den_v, den, better);
+    best_pos_v = _mm_blendv_epi8(best_pos_v, pos_v, better);
+    pos_v = _mm_add_epi32(pos_v, four);
+  }
+  _mm_storeu_si128((__m128i *)nums, best_num_v);
+  _mm_storeu_si128((__m128i *)dens, best_den_v);
+  _mm_storeu_si128((__m128i *)poss, best_pos_v);
+  best_num = nums[0];
+  best_den = dens[0];
+  pos = poss[0];
+  for (i = 1; i < 4; i++) {
+    int32_t lhs = nums[i] * best_den;
+    int32_t rhs = best_num * dens[i];
+    if (lhs > rhs || (lhs == rhs && poss[i] < pos)) {
+      best_num = nums[i];
+      best_den = dens[i];
+      pos = poss[i];
+    }
+  }
+  for (; j < n; j++) {
+    int32_t num = xy + x[j];
+    int32_t den = (yy + 2 * y[j] + 1) >> yshift;
+    num = xshift >= 0 ? num >> xshift : num << -xshift;
+    num = (num * num) >> 15;
+    if (num * best_den > best_num * den) {
+      best_num = num;
+      best_den = den;
+      pos = j;
+    }
+  }
+  return pos;
+}
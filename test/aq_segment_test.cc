@@ -123,5 +123,5 @@ TEST_P(AqSegmentTest, TestNoMisMatchAQ4) {
 AV1_INSTANTIATE_TEST_CASE(AqSegmentTest,
                           ::testing::Values(::libaom_test::kRealTime,
                                             ::libaom_test::kOnePassGood),
-                          ::testing::Range(3, 9));
+                          ::testing::Range(3, 10));
 }  // namespace
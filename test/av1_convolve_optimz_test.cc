@@ -12,6 +12,7 @@
 #include "third_party/googletest/src/include/gtest/gtest.h"
 
 #include "./av1_rtcd.h"
+#include "aom_ports/aom_timer.h"
 #include "av1/common/filter.h"
 #include "test/acm_random.h"
 #include "test/clear_system_state.h"
@@ -89,6 +90,7 @@ class AV1ConvolveOptimzTest : public ::testing::TestWithParam<ConvParams> {
  protected:
   void RunHorizFilterBitExactCheck();
   void RunVertFilterBitExactCheck();
+  void RunFilterSpeed(int horiz);
 
  private:
   void PrepFilterBuffer(int w, int h);
@@ -194,16 +196,47 @@ void AV1ConvolveOptimzTest::RunVertFilterBitExactCheck() {
   DiffFilterBuffer();
 }
 
+void AV1ConvolveOptimzTest::RunFilterSpeed(int horiz) {
+  const int kNumIters = (1 << 22) / (width_ * height_);
+  conv_filter_t ref = horiz ? av1_convolve_horiz_c : av1_convolve_vert_c;
+  conv_filter_t tst = horiz ? conv_horiz_ : conv_vert_;
+  InterpFilterParams filter_params = get_interp_filter_params(filter_);
+  aom_usec_timer ref_timer;
+  aom_usec_timer timer;
+  int i;
+
+  PrepFilterBuffer(testMaxBlk, testMaxBlk);
+
+  aom_usec_timer_start(&ref_timer);
+  for (i = 0; i < kNumIters; ++i)
+    ref(src_ref_, stride, dst_ref_, stride, width_, height_, filter_params,
+        subpel_, x_step_q4, avg_);
+  aom_usec_timer_mark(&ref_timer);
+
+  aom_usec_timer_start(&timer);
+  for (i = 0; i < kNumIters; ++i)
+    tst(src_, stride, dst_, stride, width_, height_, filter_params, subpel_,
+        x_step_q4, avg_);
+  aom_usec_timer_mark(&timer);
+
+  printf("%s %dx%d taps %d: C %d us, opt %d us\n", horiz ? "horiz" : "vert",
+         width_, height_, filter_params.taps,
+         static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(aom_usec_timer_elapsed(&timer)));
+}
+
 TEST_P(AV1ConvolveOptimzTest, HorizBitExactCheck) {
   RunHorizFilterBitExactCheck();
 }
 TEST_P(AV1ConvolveOptimzTest, VerticalBitExactCheck) {
   RunVertFilterBitExactCheck();
 }
+TEST_P(AV1ConvolveOptimzTest, DISABLED_HorizSpeed) { RunFilterSpeed(1); }
+TEST_P(AV1ConvolveOptimzTest, DISABLED_VertSpeed) { RunFilterSpeed(0); }
 
 using std::tr1::make_tuple;
 
-#if (HAVE_SSSE3 || HAVE_SSE4_1) && CONFIG_EXT_INTERP
+#if ((HAVE_SSSE3 || HAVE_SSE4_1) && CONFIG_EXT_INTERP) || HAVE_AVX2
 const BlockDimension kBlockDim[] = {
   make_tuple(2, 2),    make_tuple(2, 4),    make_tuple(4, 4),
   make_tuple(4, 8),    make_tuple(8, 4),    make_tuple(8, 8),
@@ -213,14 +246,28 @@ const BlockDimension kBlockDim[] = {
   make_tuple(64, 128), make_tuple(128, 64), make_tuple(128, 128),
 };
 
-// 10/12-tap filters
-const InterpFilter kFilter[] = { 6, 4, 2 };
-
 const int kSubpelQ4[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
 
 const int kAvg[] = { 0, 1 };
+#endif
+
+#if (HAVE_SSSE3 || HAVE_SSE4_1) && CONFIG_EXT_INTERP
+// 10/12-tap filters
+const InterpFilter kFilter[] = { 6, 4, 2 };
 #endif  // (HAVE_SSSE3 || HAVE_SSE4_1) && CONFIG_EXT_INTERP
 
+#if HAVE_AVX2
+// All filter banks, 8-tap as well as 10/12-tap
+const InterpFilter kAllFilter[] = { EIGHTTAP,
+                                    EIGHTTAP_SMOOTH,
+                                    EIGHTTAP_SHARP,
+#if CONFIG_EXT_INTERP
+                                    EIGHTTAP_SMOOTH2,
+                                    MULTITAP_SHARP2,
+#endif
+                                    BILINEAR };
+#endif  // HAVE_AVX2
+
 #if HAVE_SSSE3 && CONFIG_EXT_INTERP
 INSTANTIATE_TEST_CASE_P(
     SSSE3, AV1ConvolveOptimzTest,
@@ -232,6 +279,17 @@ INSTANTIATE_TEST_CASE_P(
                        ::testing::ValuesIn(kAvg)));
 #endif  // HAVE_SSSE3 && CONFIG_EXT_INTERP
 
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, AV1ConvolveOptimzTest,
+    ::testing::Combine(::testing::Values(av1_convolve_horiz_avx2),
+                       ::testing::Values(av1_convolve_vert_avx2),
+                       ::testing::ValuesIn(kBlockDim),
+                       ::testing::ValuesIn(kAllFilter),
+                       ::testing::ValuesIn(kSubpelQ4),
+                       ::testing::ValuesIn(kAvg)));
+#endif  // HAVE_AVX2
+
 #if CONFIG_AOM_HIGHBITDEPTH
 typedef ::testing::TestWithParam<HbdConvParams> TestWithHbdConvParams;
 class AV1HbdConvolveOptimzTest : public TestWithHbdConvParams {
@@ -265,6 +323,7 @@ class AV1HbdConvolveOptimzTest : public TestWithHbdConvParams {
  protected:
   void RunHorizFilterBitExactCheck();
   void RunVertFilterBitExactCheck();
+  void RunFilterSpeed(int horiz);
 
  private:
   void PrepFilterBuffer(int w, int h);
@@ -372,16 +431,50 @@ void AV1HbdConvolveOptimzTest::RunVertFilterBitExactCheck() {
   DiffFilterBuffer();
 }
 
+void AV1HbdConvolveOptimzTest::RunFilterSpeed(int horiz) {
+  const int kNumIters = (1 << 22) / (width_ * height_);
+  hbd_conv_filter_t ref =
+      horiz ? av1_highbd_convolve_horiz_c : av1_highbd_convolve_vert_c;
+  hbd_conv_filter_t tst = horiz ? conv_horiz_ : conv_vert_;
+  InterpFilterParams filter_params = get_interp_filter_params(filter_);
+  aom_usec_timer ref_timer;
+  aom_usec_timer timer;
+  int i;
+
+  PrepFilterBuffer(testMaxBlk, testMaxBlk);
+
+  aom_usec_timer_start(&ref_timer);
+  for (i = 0; i < kNumIters; ++i)
+    ref(src_, stride, dst_ref_, stride, width_, height_, filter_params,
+        subpel_, x_step_q4, avg_, bit_depth_);
+  aom_usec_timer_mark(&ref_timer);
+
+  aom_usec_timer_start(&timer);
+  for (i = 0; i < kNumIters; ++i)
+    tst(src_, stride, dst_, stride, width_, height_, filter_params, subpel_,
+        x_step_q4, avg_, bit_depth_);
+  aom_usec_timer_mark(&timer);
+
+  printf("%s %dx%d taps %d bd %d: C %d us, opt %d us\n",
+         horiz ? "horiz" : "vert", width_, height_, filter_params.taps,
+         bit_depth_, static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(aom_usec_timer_elapsed(&timer)));
+}
+
 TEST_P(AV1HbdConvolveOptimzTest, HorizBitExactCheck) {
   RunHorizFilterBitExactCheck();
 }
 TEST_P(AV1HbdConvolveOptimzTest, VertBitExactCheck) {
   RunVertFilterBitExactCheck();
 }
+TEST_P(AV1HbdConvolveOptimzTest, DISABLED_HorizSpeed) { RunFilterSpeed(1); }
+TEST_P(AV1HbdConvolveOptimzTest, DISABLED_VertSpeed) { RunFilterSpeed(0); }
 
-#if HAVE_SSE4_1 && CONFIG_EXT_INTERP
-
+#if (HAVE_SSE4_1 && CONFIG_EXT_INTERP) || HAVE_AVX2
 const int kBitdepth[] = { 10, 12 };
+#endif
+
+#if HAVE_SSE4_1 && CONFIG_EXT_INTERP
 
 INSTANTIATE_TEST_CASE_P(
     SSE4_1, AV1HbdConvolveOptimzTest,
@@ -393,5 +486,17 @@ INSTANTIATE_TEST_CASE_P(
                        ::testing::ValuesIn(kAvg),
                        ::testing::ValuesIn(kBitdepth)));
 #endif  // HAVE_SSE4_1 && CONFIG_EXT_INTERP
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, AV1HbdConvolveOptimzTest,
+    ::testing::Combine(::testing::Values(av1_highbd_convolve_horiz_avx2),
+                       ::testing::Values(av1_highbd_convolve_vert_avx2),
+                       ::testing::ValuesIn(kBlockDim),
+                       ::testing::ValuesIn(kAllFilter),
+                       ::testing::ValuesIn(kSubpelQ4),
+                       ::testing::ValuesIn(kAvg),
+                       ::testing::ValuesIn(kBitdepth)));
+#endif  // HAVE_AVX2
 #endif  // CONFIG_AOM_HIGHBITDEPTH
 }  // namespace
@@ -24,6 +24,8 @@
 #include "av1/common/blockd.h"
 #include "av1/common/scan.h"
 #include "aom/aom_integer.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_ports/mem.h"
 #include "av1/common/av1_inv_txfm.h"
 
 using libaom_test::ACMRandom;
@@ -109,6 +111,130 @@ INSTANTIATE_TEST_CASE_P(
                       IdctParam(&av1_idct16_c, &reference_idct_1d, 16, 4),
                       IdctParam(&av1_idct32_c, &reference_idct_1d, 32, 6)));
 
+#if CONFIG_AOM_HIGHBITDEPTH
+typedef void (*HighbdIhtFunc)(const tran_low_t *in, uint8_t *out, int stride,
+                              int tx_type, int bd);
+// <reference function, function under test, transform size>
+typedef std::tr1::tuple<HighbdIhtFunc, HighbdIhtFunc, int> HighbdIhtFuncs;
+// <functions, tx_type, bit depth>
+typedef std::tr1::tuple<HighbdIhtFuncs, int, int> HighbdIhtParam;
+
+const int kMaxHtSize = 16;
+
+class AV1HighbdInvHtTest : public ::testing::TestWithParam<HighbdIhtParam> {
+ public:
+  virtual ~AV1HighbdInvHtTest() {}
+  virtual void SetUp() {
+    ref_func_ = std::tr1::get<0>(GET_PARAM(0));
+    tst_func_ = std::tr1::get<1>(GET_PARAM(0));
+    size_ = std::tr1::get<2>(GET_PARAM(0));
+    tx_type_ = GET_PARAM(1);
+    bd_ = GET_PARAM(2);
+  }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  // Fills the coefficients with values of up to max_coeff in magnitude, or
+  // exactly max_coeff with random signs when extreme is set, and both
+  // destinations with the same random pixels.
+  void FillBlock(ACMRandom *rnd, int max_coeff, bool extreme) {
+    const int mask = (1 << bd_) - 1;
+    for (int i = 0; i < size_ * size_; ++i) {
+      if (extreme)
+        coeff_[i] = (rnd->Rand8() & 1) ? max_coeff : -max_coeff;
+      else
+        coeff_[i] = rnd->Rand31() % (2 * max_coeff + 1) - max_coeff;
+    }
+    for (int i = 0; i < kMaxHtSize * kMaxHtSize; ++i)
+      ref_dst_[i] = tst_dst_[i] = rnd->Rand16() & mask;
+  }
+
+  void RunCheck(bool extreme) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    // Coefficients of valid streams fit in a signed (bd + 8)-bit range.
+    const int max_coeff = (1 << (bd_ + 7)) - 1;
+    const int count_test_block = 1000;
+
+    for (int n = 0; n < count_test_block; ++n) {
+      // Alternate full-range blocks with typical small residuals.
+      FillBlock(&rnd, (n & 1) ? max_coeff : max_coeff >> 6, extreme);
+      ref_func_(coeff_, CONVERT_TO_BYTEPTR(ref_dst_), kMaxHtSize, tx_type_,
+                bd_);
+      ASM_REGISTER_STATE_CHECK(tst_func_(coeff_, CONVERT_TO_BYTEPTR(tst_dst_),
+                                         kMaxHtSize, tx_type_, bd_));
+
+      for (int i = 0; i < kMaxHtSize * kMaxHtSize; ++i) {
+        ASSERT_EQ(ref_dst_[i], tst_dst_[i])
+            << "tx_type " << tx_type_ << ", bd " << bd_ << ": mismatch at ("
+            << i / kMaxHtSize << ", " << i % kMaxHtSize << ") in block " << n;
+      }
+    }
+  }
+
+  HighbdIhtFunc ref_func_;
+  HighbdIhtFunc tst_func_;
+  int size_;
+  int tx_type_;
+  int bd_;
+  DECLARE_ALIGNED(16, tran_low_t, coeff_[kMaxHtSize * kMaxHtSize]);
+  DECLARE_ALIGNED(16, uint16_t, ref_dst_[kMaxHtSize * kMaxHtSize]);
+  DECLARE_ALIGNED(16, uint16_t, tst_dst_[kMaxHtSize * kMaxHtSize]);
+};
+
+TEST_P(AV1HighbdInvHtTest, RandomValues) { RunCheck(false); }
+
+TEST_P(AV1HighbdInvHtTest, ExtremeValues) { RunCheck(true); }
+
+TEST_P(AV1HighbdInvHtTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const int num_iterations = 4000000 / (size_ * size_);
+  aom_usec_timer ref_timer;
+  aom_usec_timer tst_timer;
+
+  FillBlock(&rnd, (1 << (bd_ + 1)) - 1, false);
+
+  aom_usec_timer_start(&ref_timer);
+  for (int i = 0; i < num_iterations; ++i)
+    ref_func_(coeff_, CONVERT_TO_BYTEPTR(ref_dst_), kMaxHtSize, tx_type_, bd_);
+  aom_usec_timer_mark(&ref_timer);
+
+  aom_usec_timer_start(&tst_timer);
+  for (int i = 0; i < num_iterations; ++i)
+    tst_func_(coeff_, CONVERT_TO_BYTEPTR(tst_dst_), kMaxHtSize, tx_type_, bd_);
+  aom_usec_timer_mark(&tst_timer);
+
+  printf("ref: %d us, tst: %d us\n",
+         static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+}
+
+#if HAVE_SSE4_1 && !CONFIG_EMULATE_HARDWARE
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, AV1HighbdInvHtTest,
+    ::testing::Combine(
+        ::testing::Values(
+            HighbdIhtFuncs(&av1_highbd_iht4x4_16_add_c,
+                           &av1_highbd_iht4x4_16_add_sse4_1, 4),
+            HighbdIhtFuncs(&av1_highbd_iht8x8_64_add_c,
+                           &av1_highbd_iht8x8_64_add_sse4_1, 8),
+            HighbdIhtFuncs(&av1_highbd_iht16x16_256_add_c,
+                           &av1_highbd_iht16x16_256_add_sse4_1, 16)),
+        ::testing::Range(0, 4), ::testing::Values(8, 10, 12)));
+#endif  // HAVE_SSE4_1 && !CONFIG_EMULATE_HARDWARE
+
+#if HAVE_AVX2 && !CONFIG_EMULATE_HARDWARE
+INSTANTIATE_TEST_CASE_P(
+    AVX2, AV1HighbdInvHtTest,
+    ::testing::Combine(
+        ::testing::Values(HighbdIhtFuncs(&av1_highbd_iht8x8_64_add_c,
+                                         &av1_highbd_iht8x8_64_add_avx2, 8),
+                          HighbdIhtFuncs(&av1_highbd_iht16x16_256_add_c,
+                                         &av1_highbd_iht16x16_256_add_avx2,
+                                         16)),
+        ::testing::Range(0, 4), ::testing::Values(8, 10, 12)));
+#endif  // HAVE_AVX2 && !CONFIG_EMULATE_HARDWARE
+#endif  // CONFIG_AOM_HIGHBITDEPTH
+
 #if CONFIG_AV1_ENCODER
 typedef void (*FwdTxfmFunc)(const int16_t *in, tran_low_t *out, int stride);
 typedef void (*InvTxfmFunc)(const tran_low_t *in, uint8_t *out, int stride);
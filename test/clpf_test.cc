@@ -11,12 +11,15 @@
 
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 #include "third_party/googletest/src/include/gtest/gtest.h"
 
 #include "./aom_config.h"
 #include "./aom_dsp_rtcd.h"
 #include "aom_ports/aom_timer.h"
+#include "aom_scale/yv12config.h"
+#include "av1/common/clpf.h"
 #include "test/acm_random.h"
 #include "test/clear_system_state.h"
 #include "test/register_state_check.h"
@@ -211,6 +214,412 @@ TEST_P(ClpfHbdSpeedTest, TestSpeed) {
 }
 #endif
 
+typedef void (*clpf_detect_t)(const uint8_t *rec, const uint8_t *org,
+                              int rstride, int ostride, int x0, int y0,
+                              int width, int height, int *sum0, int *sum1,
+                              unsigned int strength, int size);
+typedef void (*clpf_detect_multi_t)(const uint8_t *rec, const uint8_t *org,
+                                    int rstride, int ostride, int x0, int y0,
+                                    int width, int height, int *sum, int size);
+
+typedef std::tr1::tuple<clpf_detect_t, clpf_detect_t, clpf_detect_multi_t,
+                        clpf_detect_multi_t>
+    clpf_detect_param_t;
+
+class ClpfDetectTest : public ::testing::TestWithParam<clpf_detect_param_t> {
+ public:
+  virtual ~ClpfDetectTest() {}
+  virtual void SetUp() {
+    detect = GET_PARAM(0);
+    ref_detect = GET_PARAM(1);
+    detect_multi = GET_PARAM(2);
+    ref_detect_multi = GET_PARAM(3);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  clpf_detect_t detect;
+  clpf_detect_t ref_detect;
+  clpf_detect_multi_t detect_multi;
+  clpf_detect_multi_t ref_detect_multi;
+};
+
+#if CONFIG_AOM_HIGHBITDEPTH
+typedef void (*clpf_detect_hbd_t)(const uint16_t *rec, const uint16_t *org,
+                                  int rstride, int ostride, int x0, int y0,
+                                  int width, int height, int *sum0, int *sum1,
+                                  unsigned int strength, int shift, int size);
+typedef void (*clpf_detect_multi_hbd_t)(const uint16_t *rec,
+                                        const uint16_t *org, int rstride,
+                                        int ostride, int x0, int y0, int width,
+                                        int height, int *sum, int shift,
+                                        int size);
+
+typedef std::tr1::tuple<clpf_detect_hbd_t, clpf_detect_hbd_t,
+                        clpf_detect_multi_hbd_t, clpf_detect_multi_hbd_t>
+    clpf_detect_hbd_param_t;
+
+class ClpfDetectHbdTest
+    : public ::testing::TestWithParam<clpf_detect_hbd_param_t> {
+ public:
+  virtual ~ClpfDetectHbdTest() {}
+  virtual void SetUp() {
+    detect = GET_PARAM(0);
+    ref_detect = GET_PARAM(1);
+    detect_multi = GET_PARAM(2);
+    ref_detect_multi = GET_PARAM(3);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  clpf_detect_hbd_t detect;
+  clpf_detect_hbd_t ref_detect;
+  clpf_detect_multi_hbd_t detect_multi;
+  clpf_detect_multi_hbd_t ref_detect_multi;
+};
+#endif
+
+// Compares the error sums of every 8x8 block of a frame, along all edges and
+// fully inside, for all strengths.
+template <typename pixel, typename detect_fn, typename multi_fn>
+void test_clpf_detect(int depth, detect_fn detect, detect_fn ref_detect,
+                      multi_fn detect_multi, multi_fn ref_detect_multi,
+                      void (*call)(detect_fn, const pixel *, const pixel *,
+                                   int, int, int *, int *, int, int),
+                      void (*call_multi)(multi_fn, const pixel *,
+                                         const pixel *, int, int, int *,
+                                         int)) {
+  const int size = 24;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  DECLARE_ALIGNED(16, pixel, rec[size * size]);
+  DECLARE_ALIGNED(16, pixel, org[size * size]);
+
+  for (int level = 0; level < (1 << depth); level += 1 << (depth - 6)) {
+    for (int bits = 1; bits <= depth; bits++) {
+      for (int i = 0; i < size * size; i++) {
+        rec[i] = clamp((rnd.Rand16() & ((1 << bits) - 1)) + level, 0,
+                       (1 << depth) - 1);
+        org[i] = clamp(rec[i] + (rnd.Rand16() & 15) - 8, 0, (1 << depth) - 1);
+      }
+      for (int ypos = 0; ypos < size; ypos += 8) {
+        for (int xpos = 0; xpos < size; xpos += 8) {
+          for (int strength = 0; strength < 3; strength++) {
+            int sum[2] = { 0, 0 }, ref_sum[2] = { 0, 0 };
+            call(ref_detect, rec, org, xpos, ypos, &ref_sum[0], &ref_sum[1],
+                 1 << strength, depth - 8);
+            ASM_REGISTER_STATE_CHECK(call(detect, rec, org, xpos, ypos,
+                                          &sum[0], &sum[1], 1 << strength,
+                                          depth - 8));
+            ASSERT_EQ(ref_sum[0], sum[0]) << "xpos: " << xpos
+                                          << " ypos: " << ypos;
+            ASSERT_EQ(ref_sum[1], sum[1]) << "xpos: " << xpos
+                                          << " ypos: " << ypos
+                                          << " strength: " << (1 << strength);
+          }
+          int sums[4] = { 0, 0, 0, 0 }, ref_sums[4] = { 0, 0, 0, 0 };
+          call_multi(ref_detect_multi, rec, org, xpos, ypos, ref_sums,
+                     depth - 8);
+          ASM_REGISTER_STATE_CHECK(call_multi(detect_multi, rec, org, xpos,
+                                              ypos, sums, depth - 8));
+          for (int i = 0; i < 4; i++)
+            ASSERT_EQ(ref_sums[i], sums[i]) << "xpos: " << xpos
+                                            << " ypos: " << ypos
+                                            << " sum: " << i;
+        }
+      }
+    }
+  }
+}
+
+void call_detect(clpf_detect_t fn, const uint8_t *rec, const uint8_t *org,
+                 int x0, int y0, int *sum0, int *sum1, int strength,
+                 int shift) {
+  (void)shift;
+  fn(rec, org, 24, 24, x0, y0, 24, 24, sum0, sum1, strength, 8);
+}
+
+void call_detect_multi(clpf_detect_multi_t fn, const uint8_t *rec,
+                       const uint8_t *org, int x0, int y0, int *sum,
+                       int shift) {
+  (void)shift;
+  fn(rec, org, 24, 24, x0, y0, 24, 24, sum, 8);
+}
+
+TEST_P(ClpfDetectTest, TestSIMDNoMismatch) {
+  test_clpf_detect<uint8_t>(8, detect, ref_detect, detect_multi,
+                            ref_detect_multi, call_detect, call_detect_multi);
+}
+
+#if CONFIG_AOM_HIGHBITDEPTH
+void call_detect_hbd(clpf_detect_hbd_t fn, const uint16_t *rec,
+                     const uint16_t *org, int x0, int y0, int *sum0, int *sum1,
+                     int strength, int shift) {
+  fn(rec, org, 24, 24, x0, y0, 24, 24, sum0, sum1, strength << shift, shift, 8);
+}
+
+void call_detect_multi_hbd(clpf_detect_multi_hbd_t fn, const uint16_t *rec,
+                           const uint16_t *org, int x0, int y0, int *sum,
+                           int shift) {
+  fn(rec, org, 24, 24, x0, y0, 24, 24, sum, shift, 8);
+}
+
+TEST_P(ClpfDetectHbdTest, TestSIMDNoMismatch) {
+  test_clpf_detect<uint16_t>(10, detect, ref_detect, detect_multi,
+                             ref_detect_multi, call_detect_hbd,
+                             call_detect_multi_hbd);
+  test_clpf_detect<uint16_t>(12, detect, ref_detect, detect_multi,
+                             ref_detect_multi, call_detect_hbd,
+                             call_detect_multi_hbd);
+}
+#endif
+
+// Decides to filter about three in four filter blocks.
+int test_decision(int k, int l, const YV12_BUFFER_CONFIG *,
+                  const YV12_BUFFER_CONFIG *, const AV1_COMMON *, int, int,
+                  int, unsigned int, unsigned int, int8_t *) {
+  return (k * 5 + l * 3) % 4 != 0;
+}
+
+// Copies a filtered block back into the frame like the CLPF did before it was
+// split into rows: 4 and 8 wide blocks in full, other widths by sizex bytes.
+template <typename pixel>
+void copy_block_back(pixel *dst, int dstride, const pixel *block, int bs,
+                     int sizex, int sizey) {
+  const int bytes =
+      sizex == 4 || sizex == 8 ? sizex * static_cast<int>(sizeof(pixel))
+                               : sizex;
+  for (int c = 0; c < sizey; c++)
+    memcpy(dst + c * dstride, block + c * bs, bytes);
+}
+
+// The CLPF of one plane before it was split into rows, on the C block
+// filter. The filtered blocks go through a ring of buffers one filter block
+// row in size, and each is copied back into the frame with the size of the
+// block that takes its buffer.
+template <typename pixel>
+void ref_clpf_plane(pixel *src, int stride, int width, int height, int subx,
+                    int suby, const AV1_COMMON *cm, int enable_fb_flag,
+                    unsigned int strength, int fb_size_log2,
+                    av1_clpf_decision_fn decision,
+                    void (*clpf)(const pixel *src, pixel *dst, int sstride,
+                                 int dstride, int x0, int y0, int sizex,
+                                 int sizey, int width, int height,
+                                 unsigned int strength)) {
+  const int bs = (subx || suby) ? 4 : 8;
+  const int fb_size = 1 << fb_size_log2;
+  const int num_fb_hor = (width + fb_size - 1) >> fb_size_log2;
+  const int num_fb_ver = (height + fb_size - 1) >> fb_size_log2;
+  const int cache_blocks = (num_fb_hor << 2 * fb_size_log2) / (bs * bs);
+  std::vector<pixel> cache(cache_blocks * bs * bs);
+  std::vector<pixel *> cache_dst(cache_blocks, static_cast<pixel *>(NULL));
+  int cache_idx = 0;
+
+  for (int k = 0; k < num_fb_ver; k++) {
+    for (int l = 0; l < num_fb_hor; l++) {
+      const int xoff = l << fb_size_log2;
+      const int yoff = k << fb_size_log2;
+      const int w = AOMMIN(width - xoff, fb_size);
+      const int h = AOMMIN(height - yoff, fb_size);
+      int allskip = !(enable_fb_flag && fb_size_log2 == MAX_FB_SIZE_LOG2);
+      for (int m = 0; allskip && m < fb_size / bs; m++) {
+        for (int n = 0; allskip && n < fb_size / bs; n++) {
+          const int xpos = xoff + n * bs;
+          const int ypos = yoff + m * bs;
+          if (xpos < width && ypos < height) {
+            allskip &=
+                cm->mi_grid_visible[(ypos << suby) / MI_SIZE * cm->mi_stride +
+                                    (xpos << subx) / MI_SIZE]
+                    ->mbmi.skip;
+          }
+        }
+      }
+      if (allskip || (enable_fb_flag &&
+                      !decision(k, l, NULL, NULL, cm, bs, w / bs, h / bs,
+                                strength, fb_size_log2, NULL)))
+        continue;
+
+      for (int m = 0; m < (h + bs - 1) / bs; m++) {
+        for (int n = 0; n < (w + bs - 1) / bs; n++) {
+          const int xpos = xoff + n * bs;
+          const int ypos = yoff + m * bs;
+          const int sizex = AOMMIN(width - xpos, bs);
+          const int sizey = AOMMIN(height - ypos, bs);
+          if (cm->mi_grid_visible[(ypos << suby) / MI_SIZE * cm->mi_stride +
+                                  (xpos << subx) / MI_SIZE]
+                  ->mbmi.skip &&
+              !(enable_fb_flag && fb_size_log2 == MAX_FB_SIZE_LOG2))
+            continue;
+          pixel *const block = &cache[cache_idx * bs * bs];
+          if (cache_dst[cache_idx])
+            copy_block_back(cache_dst[cache_idx], stride, block, bs, sizex,
+                            sizey);
+          cache_dst[cache_idx] = src + ypos * stride + xpos;
+          clpf(src, block - ypos * bs - xpos, stride, bs, xpos, ypos, sizex,
+               sizey, width, height, strength);
+          if (++cache_idx >= cache_blocks) cache_idx = 0;
+        }
+      }
+    }
+  }
+
+  for (cache_idx = 0; cache_idx < cache_blocks && cache_dst[cache_idx];
+       cache_idx++) {
+    copy_block_back(cache_dst[cache_idx], stride, &cache[cache_idx * bs * bs],
+                    bs, bs, bs);
+  }
+}
+
+// Frame size, bit depth and number of workers.
+typedef std::tr1::tuple<int, int, int, int> clpf_frame_param_t;
+
+// Checks the CLPF of whole frames against the CLPF before it was split into
+// rows, which only differ at the right and bottom edges of frames whose size
+// is not a multiple of the block size.
+class ClpfFrameTest : public ::testing::TestWithParam<clpf_frame_param_t> {
+ public:
+  virtual ~ClpfFrameTest() {}
+  virtual void SetUp() {
+    width_ = GET_PARAM(0);
+    height_ = GET_PARAM(1);
+    bit_depth_ = GET_PARAM(2);
+    num_workers_ = GET_PARAM(3);
+    mi_cols_ = (width_ + MI_SIZE - 1) / MI_SIZE;
+    mi_rows_ = (height_ + MI_SIZE - 1) / MI_SIZE;
+
+    cm_ = new AV1_COMMON;
+    memset(cm_, 0, sizeof(*cm_));
+    mi_.resize(mi_rows_ * mi_cols_);
+    mi_grid_.resize(mi_rows_ * mi_cols_);
+    for (int i = 0; i < mi_rows_ * mi_cols_; i++) mi_grid_[i] = &mi_[i];
+    cm_->mi_grid_visible = &mi_grid_[0];
+    cm_->mi_stride = mi_cols_;
+    cm_->bit_depth = static_cast<aom_bit_depth_t>(bit_depth_);
+#if CONFIG_AOM_HIGHBITDEPTH
+    cm_->use_highbitdepth = bit_depth_ > 8;
+#endif
+
+    memset(&frame_, 0, sizeof(frame_));
+    ASSERT_EQ(0, aom_alloc_frame_buffer(&frame_, width_, height_, 1, 1,
+#if CONFIG_AOM_HIGHBITDEPTH
+                                        bit_depth_ > 8,
+#endif
+                                        32, 0));
+
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    workers_.resize(num_workers_);
+    for (int i = 0; i < num_workers_; i++) {
+      winterface->init(&workers_[i]);
+      ASSERT_TRUE(winterface->reset(&workers_[i]));
+    }
+  }
+
+  virtual void TearDown() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < num_workers_; i++) winterface->end(&workers_[i]);
+    av1_clpf_free_scratch(cm_);
+    aom_free_frame_buffer(&frame_);
+    delete cm_;
+    libaom_test::ClearSystemState();
+  }
+
+ protected:
+  template <typename pixel>
+  void RunCheck(pixel *(*plane_buffer)(const YV12_BUFFER_CONFIG *, int),
+                void (*clpf)(const pixel *src, pixel *dst, int sstride,
+                             int dstride, int x0, int y0, int sizex,
+                             int sizey, int width, int height,
+                             unsigned int strength)) {
+    // Filter settings of luma with and without filter block signalling, and
+    // of chroma.
+    const int kSettings[][3] = { { AOM_PLANE_Y, 1, 5 }, { AOM_PLANE_Y, 1, 6 },
+                                 { AOM_PLANE_Y, 1, 7 }, { AOM_PLANE_Y, 0, 4 },
+                                 { AOM_PLANE_U, 0, 4 }, { AOM_PLANE_V, 0, 4 } };
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+    for (int s = 0; s < static_cast<int>(sizeof(kSettings) /
+                                         sizeof(kSettings[0]));
+         s++) {
+      const int plane = kSettings[s][0];
+      const int enable_fb_flag = kSettings[s][1];
+      const int fb_size_log2 = kSettings[s][2];
+      const int subx = plane != AOM_PLANE_Y;
+      const int width = subx ? frame_.uv_crop_width : frame_.y_crop_width;
+      const int height = subx ? frame_.uv_crop_height : frame_.y_crop_height;
+      const int stride = subx ? frame_.uv_stride : frame_.y_stride;
+      // The reference writes up to a block beyond the right and bottom edges.
+      const int ref_stride = width + 8;
+      std::vector<pixel> ref((height + 8) * ref_stride);
+      pixel *const buffer = plane_buffer(&frame_, plane);
+
+      for (int i = 0; i < mi_rows_ * mi_cols_; i++)
+        mi_[i].mbmi.skip = rnd(4) == 0;
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+          buffer[y * stride + x] = ref[y * ref_stride + x] =
+              rnd.Rand16() & ((1 << bit_depth_) - 1);
+        }
+      }
+
+      for (unsigned int strength = 1; strength <= 4; strength <<= 1) {
+        ref_clpf_plane(&ref[0], ref_stride, width, height, subx, subx, cm_,
+                       enable_fb_flag, strength << (bit_depth_ - 8),
+                       fb_size_log2, test_decision, clpf);
+        if (num_workers_ > 1) {
+          av1_clpf_frame_mt(&frame_, NULL, cm_, enable_fb_flag, strength,
+                            fb_size_log2, plane, test_decision, &workers_[0],
+                            num_workers_);
+        } else {
+          av1_clpf_frame(&frame_, NULL, cm_, enable_fb_flag, strength,
+                         fb_size_log2, plane, test_decision);
+        }
+        for (int y = 0; y < height; y++) {
+          for (int x = 0; x < width; x++) {
+            ASSERT_EQ(ref[y * ref_stride + x], buffer[y * stride + x])
+                << "plane: " << plane << " fb_size_log2: " << fb_size_log2
+                << " strength: " << strength << " x: " << x << " y: " << y;
+          }
+        }
+      }
+    }
+  }
+
+  int width_;
+  int height_;
+  int bit_depth_;
+  int num_workers_;
+  int mi_cols_;
+  int mi_rows_;
+  AV1_COMMON *cm_;
+  std::vector<MODE_INFO> mi_;
+  std::vector<MODE_INFO *> mi_grid_;
+  YV12_BUFFER_CONFIG frame_;
+  std::vector<AVxWorker> workers_;
+};
+
+uint8_t *frame_plane(const YV12_BUFFER_CONFIG *frame, int plane) {
+  return plane == AOM_PLANE_Y
+             ? frame->y_buffer
+             : plane == AOM_PLANE_U ? frame->u_buffer : frame->v_buffer;
+}
+
+#if CONFIG_AOM_HIGHBITDEPTH
+uint16_t *frame_plane_hbd(const YV12_BUFFER_CONFIG *frame, int plane) {
+  return CONVERT_TO_SHORTPTR(frame_plane(frame, plane));
+}
+#endif
+
+TEST_P(ClpfFrameTest, MatchesRingCacheFilter) {
+#if CONFIG_AOM_HIGHBITDEPTH
+  if (bit_depth_ > 8) {
+    RunCheck<uint16_t>(frame_plane_hbd, aom_clpf_block_hbd_c);
+    return;
+  }
+#endif
+  RunCheck<uint8_t>(frame_plane, aom_clpf_block_c);
+}
+
 using std::tr1::make_tuple;
 
 // Test all supported architectures and block sizes
@@ -351,4 +760,105 @@ INSTANTIATE_TEST_CASE_P(NEON, ClpfHbdSpeedTest,
 #endif
 #endif
 
+// Test the error measurements of the RDO for all supported architectures
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(
+    SSE2, ClpfDetectTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_sse2, &aom_clpf_detect_c,
+                                 &aom_clpf_detect_multi_sse2,
+                                 &aom_clpf_detect_multi_c)));
+#endif
+
+#if HAVE_SSSE3
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, ClpfDetectTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_ssse3, &aom_clpf_detect_c,
+                                 &aom_clpf_detect_multi_ssse3,
+                                 &aom_clpf_detect_multi_c)));
+#endif
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, ClpfDetectTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_sse4_1, &aom_clpf_detect_c,
+                                 &aom_clpf_detect_multi_sse4_1,
+                                 &aom_clpf_detect_multi_c)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, ClpfDetectTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_avx2, &aom_clpf_detect_c,
+                                 &aom_clpf_detect_multi_avx2,
+                                 &aom_clpf_detect_multi_c)));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_CASE_P(
+    NEON, ClpfDetectTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_neon, &aom_clpf_detect_c,
+                                 &aom_clpf_detect_multi_neon,
+                                 &aom_clpf_detect_multi_c)));
+#endif
+
+#if CONFIG_AOM_HIGHBITDEPTH
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(
+    SSE2, ClpfDetectHbdTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_hbd_sse2,
+                                 &aom_clpf_detect_hbd_c,
+                                 &aom_clpf_detect_multi_hbd_sse2,
+                                 &aom_clpf_detect_multi_hbd_c)));
+#endif
+
+#if HAVE_SSSE3
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, ClpfDetectHbdTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_hbd_ssse3,
+                                 &aom_clpf_detect_hbd_c,
+                                 &aom_clpf_detect_multi_hbd_ssse3,
+                                 &aom_clpf_detect_multi_hbd_c)));
+#endif
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, ClpfDetectHbdTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_hbd_sse4_1,
+                                 &aom_clpf_detect_hbd_c,
+                                 &aom_clpf_detect_multi_hbd_sse4_1,
+                                 &aom_clpf_detect_multi_hbd_c)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, ClpfDetectHbdTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_hbd_avx2,
+                                 &aom_clpf_detect_hbd_c,
+                                 &aom_clpf_detect_multi_hbd_avx2,
+                                 &aom_clpf_detect_multi_hbd_c)));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_CASE_P(
+    NEON, ClpfDetectHbdTest,
+    ::testing::Values(make_tuple(&aom_clpf_detect_hbd_neon,
+                                 &aom_clpf_detect_hbd_c,
+                                 &aom_clpf_detect_multi_hbd_neon,
+                                 &aom_clpf_detect_multi_hbd_c)));
+#endif
+#endif
+
+// Test frames of sizes with and without partial blocks at the right and bottom
+// edges, on one thread and on workers.
+INSTANTIATE_TEST_CASE_P(
+    C, ClpfFrameTest,
+    ::testing::Combine(::testing::Values(64, 100, 131),
+                       ::testing::Values(64, 70, 97),
+#if CONFIG_AOM_HIGHBITDEPTH
+                       ::testing::Values(8, 10),
+#else
+                       ::testing::Values(8),
+#endif
+                       ::testing::Values(1, 3)));
+
 }  // namespace
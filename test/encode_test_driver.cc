@@ -30,6 +30,7 @@ void Encoder::InitEncoder(VideoSource *video) {
     cfg_.g_h = img->d_h;
     cfg_.g_timebase = video->timebase();
     cfg_.rc_twopass_stats_in = stats_->buf();
+    cfg_.rc_firstpass_mvs_in = stats_->firstpass_mvs_buf();
 
     res = aom_codec_enc_init(&encoder_, CodecInterface(), &cfg_, init_flags_);
     ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
@@ -56,9 +57,10 @@ void Encoder::EncodeFrame(VideoSource *video, const unsigned long frame_flags) {
   CxDataIterator iter = GetCxData();
 
   while (const aom_codec_cx_pkt_t *pkt = iter.Next()) {
-    if (pkt->kind != AOM_CODEC_STATS_PKT) continue;
-
-    stats_->Append(*pkt);
+    if (pkt->kind == AOM_CODEC_STATS_PKT)
+      stats_->Append(*pkt);
+    else if (pkt->kind == AOM_CODEC_FPMV_STATS_PKT)
+      stats_->AppendFirstpassMvs(*pkt);
   }
 }
 
@@ -69,15 +69,29 @@ class TwopassStatsStore {
                    pkt.data.twopass_stats.sz);
   }
 
+  void AppendFirstpassMvs(const aom_codec_cx_pkt_t &pkt) {
+    mvs_buffer_.append(reinterpret_cast<char *>(pkt.data.firstpass_mvs.buf),
+                       pkt.data.firstpass_mvs.sz);
+  }
+
   aom_fixed_buf_t buf() {
     const aom_fixed_buf_t buf = { &buffer_[0], buffer_.size() };
     return buf;
   }
 
-  void Reset() { buffer_.clear(); }
+  aom_fixed_buf_t firstpass_mvs_buf() {
+    const aom_fixed_buf_t buf = { &mvs_buffer_[0], mvs_buffer_.size() };
+    return buf;
+  }
+
+  void Reset() {
+    buffer_.clear();
+    mvs_buffer_.clear();
+  }
 
  protected:
   std::string buffer_;
+  std::string mvs_buffer_;
 };
 
 // Provides a simplified interface to manage one video encoding pass, given
@@ -129,6 +143,11 @@ class Encoder {
     ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
   }
 
+  void Control(int ctrl_id, aom_thread_pool_cfg_t *arg) {
+    const aom_codec_err_t res = aom_codec_control_(&encoder_, ctrl_id, arg);
+    ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
+  }
+
 #if CONFIG_AV1_ENCODER
   void Control(int ctrl_id, aom_active_map_t *arg) {
     const aom_codec_err_t res = aom_codec_control_(&encoder_, ctrl_id, arg);
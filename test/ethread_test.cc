@@ -16,16 +16,80 @@
 #include "test/encode_test_driver.h"
 #include "test/md5_helper.h"
 #include "test/util.h"
+#include "test/video_source.h"
 #include "test/y4m_video_source.h"
 
 namespace {
+
+// Encodes key frames only, whose intra mode counts of every tile go into the
+// probability updates of the frame header, and checks that the stream does
+// not depend on the threads the tiles are encoded by.
+class AVxEncoderThreadIntraTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWithParam<libaom_test::TestMode> {
+ protected:
+  AVxEncoderThreadIntraTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)) {}
+  virtual ~AVxEncoderThreadIntraTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.kf_max_dist = 0;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 2000;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) { md5_.clear(); }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      // Encode 4 column tiles.
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 2);
+      encoder->Control(AOME_SET_CPUUSED, 2);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    ::libaom_test::MD5 md5_res;
+    md5_res.Add(reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+                pkt->data.frame.sz);
+    md5_.push_back(md5_res.Get());
+  }
+
+  std::vector<std::string> Encode(unsigned int threads) {
+    ::libaom_test::RandomVideoSource video;
+    video.SetSize(1024, 128);
+    video.set_limit(3);
+    cfg_.g_threads = threads;
+    RunLoop(&video);
+    return md5_;
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  std::vector<std::string> md5_;
+};
+
+TEST_P(AVxEncoderThreadIntraTest, EncoderResultTest) {
+  std::vector<std::string> single_thr_md5, multi_thr_md5;
+
+  ASSERT_NO_FATAL_FAILURE(single_thr_md5 = Encode(1));
+  ASSERT_NO_FATAL_FAILURE(multi_thr_md5 = Encode(4));
+  ASSERT_FALSE(single_thr_md5.empty());
+  ASSERT_EQ(single_thr_md5, multi_thr_md5);
+}
+
 class AVxEncoderThreadTest
     : public ::libaom_test::EncoderTest,
-      public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int> {
+      public ::libaom_test::CodecTestWith3Params<libaom_test::TestMode, int,
+                                                 int> {
  protected:
   AVxEncoderThreadTest()
       : EncoderTest(GET_PARAM(0)), encoder_initialized_(false), tiles_(2),
-        encoding_mode_(GET_PARAM(1)), set_cpu_used_(GET_PARAM(2)) {
+        encoding_mode_(GET_PARAM(1)), set_cpu_used_(GET_PARAM(2)),
+        row_mt_(GET_PARAM(3)), thread_pool_threads_(0) {
     init_flags_ = AOM_CODEC_USE_PSNR;
 
     md5_.clear();
@@ -60,6 +124,11 @@ class AVxEncoderThreadTest
       // Encode 4 column tiles.
       encoder->Control(AV1E_SET_TILE_COLUMNS, tiles_);
       encoder->Control(AOME_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(AV1E_SET_ROW_MT, row_mt_);
+      if (thread_pool_threads_ > 0) {
+        aom_thread_pool_cfg_t thread_pool_cfg = { thread_pool_threads_, 0 };
+        encoder->Control(AV1_SET_THREAD_POOL, &thread_pool_cfg);
+      }
       if (encoding_mode_ != ::libaom_test::kRealTime) {
         encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
         encoder->Control(AOME_SET_ARNR_MAXFRAMES, 7);
@@ -93,6 +162,8 @@ class AVxEncoderThreadTest
   int tiles_;
   ::libaom_test::TestMode encoding_mode_;
   int set_cpu_used_;
+  int row_mt_;
+  unsigned int thread_pool_threads_;
   std::vector<std::string> md5_;
 };
 
@@ -118,7 +189,92 @@ TEST_P(AVxEncoderThreadTest, EncoderResultTest) {
 
   // Compare to check if two vectors are equal.
   ASSERT_EQ(single_thr_md5, multi_thr_md5);
+
+#if CONFIG_MULTITHREAD
+  // Encode using multiple threads on a shared pool with fewer threads.
+  thread_pool_threads_ = 2;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  thread_pool_threads_ = 0;
+  ASSERT_EQ(single_thr_md5, md5_);
+  md5_.clear();
+#endif
 }
+
+// Decodes the output of the encoder with a multi-threaded decoder of its own,
+// which joins the shared pool along with the encoder.
+class AVxSharedPoolTest : public AVxEncoderThreadTest {
+ protected:
+  AVxSharedPoolTest() : decoder_(NULL) {}
+  virtual ~AVxSharedPoolTest() { delete decoder_; }
+
+  virtual void BeginPassHook(unsigned int pass) {
+    aom_codec_dec_cfg_t dec_cfg = aom_codec_dec_cfg_t();
+
+    AVxEncoderThreadTest::BeginPassHook(pass);
+    dec_cfg.threads = 4;
+    delete decoder_;
+    decoder_ = codec_->CreateDecoder(dec_cfg, 0, 0);
+    ASSERT_TRUE(decoder_ != NULL);
+    if (thread_pool_threads_ > 0) {
+      aom_thread_pool_cfg_t thread_pool_cfg = { thread_pool_threads_, 0 };
+      decoder_->Control(AV1_SET_THREAD_POOL, &thread_pool_cfg);
+    }
+  }
+
+  virtual void EndPassHook() {
+    delete decoder_;
+    decoder_ = NULL;
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const aom_codec_err_t res = decoder_->DecodeFrame(
+        (const uint8_t *)pkt->data.frame.buf, pkt->data.frame.sz);
+    ASSERT_EQ(AOM_CODEC_OK, res) << decoder_->DecodeError();
+
+    ::libaom_test::DxDataIterator dec_iter = decoder_->GetDxData();
+    while (const aom_image_t *img = dec_iter.Next()) {
+      ::libaom_test::MD5 md5_res;
+      md5_res.Add(img);
+      dec_md5_.push_back(md5_res.Get());
+    }
+  }
+
+  ::libaom_test::Decoder *decoder_;
+  std::vector<std::string> dec_md5_;
+};
+
+TEST_P(AVxSharedPoolTest, EncoderAndDecoderResultTest) {
+  std::vector<std::string> enc_md5, dec_md5;
+
+  ::libaom_test::Y4mVideoSource video("niklas_1280_720_30.y4m", 15, 20);
+
+  cfg_.rc_target_bitrate = 1000;
+  cfg_.g_threads = 4;
+
+  // Encode and decode using threads of their own.
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  enc_md5 = md5_;
+  dec_md5 = dec_md5_;
+  md5_.clear();
+  dec_md5_.clear();
+
+  // Encode and decode with both instances alive on a shared pool with fewer
+  // threads than their workers combined.
+  thread_pool_threads_ = 2;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  thread_pool_threads_ = 0;
+  ASSERT_EQ(enc_md5, md5_);
+  ASSERT_EQ(dec_md5, dec_md5_);
+  md5_.clear();
+  dec_md5_.clear();
+}
+
+#if !CONFIG_EC_ADAPT
+AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadIntraTest,
+                          ::testing::Values(::libaom_test::kOnePassGood,
+                                            ::libaom_test::kTwoPassGood));
+#endif
+
 #if CONFIG_EC_ADAPT
 // TODO(thdavies): EC_ADAPT does not support tiles
 INSTANTIATE_TEST_CASE_P(
@@ -128,11 +284,17 @@ INSTANTIATE_TEST_CASE_P(
             static_cast<const libaom_test::CodecFactory *>(&libaom_test::kAV1)),
         ::testing::Values(::libaom_test::kTwoPassGood,
                           ::libaom_test::kOnePassGood),
-        ::testing::Range(1, 3)));
+        ::testing::Range(1, 3), ::testing::Range(0, 2)));
 #else
 AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadTest,
                           ::testing::Values(::libaom_test::kTwoPassGood,
                                             ::libaom_test::kOnePassGood),
-                          ::testing::Range(1, 3));
+                          ::testing::Range(1, 3), ::testing::Range(0, 2));
+#endif
+
+#if CONFIG_MULTITHREAD && !CONFIG_EC_ADAPT
+AV1_INSTANTIATE_TEST_CASE(AVxSharedPoolTest,
+                          ::testing::Values(::libaom_test::kOnePassGood),
+                          ::testing::Values(2), ::testing::Values(1));
 #endif
 }  // namespace
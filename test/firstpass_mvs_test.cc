@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/util.h"
+
+namespace {
+
+const int kFrames = 10;
+
+class FirstpassMvsTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWithParam<int> {
+ protected:
+  FirstpassMvsTest()
+      : EncoderTest(GET_PARAM(0)), set_cpu_used_(GET_PARAM(1)),
+        firstpass_mvs_(0), pass_(0), mv_pkts_(0), mv_pkt_size_(0),
+        psnr_(0.0), frames_(0) {}
+  virtual ~FirstpassMvsTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libaom_test::kTwoPassGood);
+    cfg_.g_lag_in_frames = 25;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 600;
+  }
+
+  virtual void BeginPassHook(unsigned int pass) {
+    pass_ = pass;
+    psnr_ = 0.0;
+    frames_ = 0;
+  }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(AV1E_SET_FIRSTPASS_MVS, firstpass_mvs_);
+    }
+  }
+
+  virtual const aom_codec_cx_pkt_t *MutateEncoderOutputHook(
+      const aom_codec_cx_pkt_t *pkt) {
+    if (pkt->kind == AOM_CODEC_FPMV_STATS_PKT) {
+      EXPECT_EQ(0u, pass_);
+      if (mv_pkts_ == 0) mv_pkt_size_ = pkt->data.firstpass_mvs.sz;
+      EXPECT_EQ(mv_pkt_size_, pkt->data.firstpass_mvs.sz);
+      ++mv_pkts_;
+    }
+    return pkt;
+  }
+
+  virtual void PSNRPktHook(const aom_codec_cx_pkt_t *pkt) {
+    psnr_ += pkt->data.psnr.psnr[0];
+    ++frames_;
+  }
+
+  double Encode(int firstpass_mvs) {
+    ::libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352,
+                                         288, 30, 1, 0, kFrames);
+    firstpass_mvs_ = firstpass_mvs;
+    mv_pkts_ = 0;
+    init_flags_ = AOM_CODEC_USE_PSNR;
+    RunLoop(&video);
+    return frames_ ? psnr_ / frames_ : 0.0;
+  }
+
+  int set_cpu_used_;
+  int firstpass_mvs_;
+  unsigned int pass_;
+  int mv_pkts_;
+  size_t mv_pkt_size_;
+  double psnr_;
+  int frames_;
+};
+
+TEST_P(FirstpassMvsTest, ReusesFirstPassMvs) {
+  double psnr = 0.0, psnr_mvs = 0.0;
+
+  ASSERT_NO_FATAL_FAILURE(psnr = Encode(0));
+  EXPECT_EQ(0, mv_pkts_);
+
+  // The first pass outputs one packet of vectors per frame, which the last
+  // pass reads back without mismatching the decoder or losing quality.
+  ASSERT_NO_FATAL_FAILURE(psnr_mvs = Encode(1));
+  EXPECT_EQ(kFrames, mv_pkts_);
+  EXPECT_GT(mv_pkt_size_, 0u);
+  EXPECT_GT(psnr_mvs, psnr - 0.5);
+}
+
+AV1_INSTANTIATE_TEST_CASE(FirstpassMvsTest, ::testing::Values(1, 2));
+}  // namespace
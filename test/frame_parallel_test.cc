@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/decode_test_driver.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+
+namespace {
+
+const int kFrames = 10;
+
+// Encodes an inter stream with hidden alt-ref frames in a single tile column,
+// then checks that frame parallel decoding and superblock row multithreaded
+// decoding output the same frames as serial decoding.
+class AVxFrameParallelTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWithParam<libaom_test::TestMode> {
+ protected:
+  AVxFrameParallelTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)) {}
+  virtual ~AVxFrameParallelTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 6;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, 2);
+      encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 0);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf = (const uint8_t *)pkt->data.frame.buf;
+    frames_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  // Decodes every frame of the stream followed by a flush, and returns the
+  // MD5 of each output frame in output order.
+  std::vector<std::string> DecodeStream(unsigned int threads,
+                                        aom_codec_flags_t flags) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    std::vector<std::string> md5;
+
+    cfg.threads = threads;
+    ::libaom_test::Decoder *const decoder =
+        codec_->CreateDecoder(cfg, flags, 0);
+    for (size_t i = 0; i <= frames_.size(); ++i) {
+      const aom_codec_err_t res =
+          i < frames_.size()
+              ? decoder->DecodeFrame(&frames_[i][0], frames_[i].size())
+              : decoder->DecodeFrame(NULL, 0);
+      EXPECT_EQ(AOM_CODEC_OK, res) << decoder->DecodeError();
+      if (res != AOM_CODEC_OK) break;
+
+      ::libaom_test::DxDataIterator dec_iter = decoder->GetDxData();
+      while (const aom_image_t *img = dec_iter.Next()) {
+        ::libaom_test::MD5 md5_res;
+        md5_res.Add(img);
+        md5.push_back(md5_res.Get());
+      }
+    }
+    delete decoder;
+    return md5;
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  std::vector<std::vector<uint8_t> > frames_;
+};
+
+TEST_P(AVxFrameParallelTest, MatchesSerialDecode) {
+  std::vector<std::string> serial_md5, frame_parallel_md5;
+
+  ::libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_GT(frames_.size(), 1u);
+
+  serial_md5 = DecodeStream(1, 0);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial_md5.size());
+
+  frame_parallel_md5 = DecodeStream(4, AOM_CODEC_USE_FRAME_THREADING);
+  ASSERT_EQ(serial_md5, frame_parallel_md5);
+}
+
+TEST_P(AVxFrameParallelTest, RowMTMatchesSerialDecode) {
+  std::vector<std::string> serial_md5;
+
+  ::libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, kFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_GT(frames_.size(), 1u);
+
+  serial_md5 = DecodeStream(1, 0);
+  ASSERT_EQ(static_cast<size_t>(kFrames), serial_md5.size());
+
+  for (unsigned int threads = 2; threads <= 4; threads += 2)
+    ASSERT_EQ(serial_md5, DecodeStream(threads, 0)) << threads << " threads";
+}
+
+AV1_INSTANTIATE_TEST_CASE(AVxFrameParallelTest,
+                          ::testing::Values(::libaom_test::kOnePassGood,
+                                            ::libaom_test::kTwoPassGood));
+}  // namespace
@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstdlib>
+#include <string>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/aom_timer.h"
+#include "av1/common/od_dering.h"
+#include "test/function_equivalence_test.h"
+#include "test/register_state_check.h"
+
+using libaom_test::FunctionEquivalenceTest;
+
+namespace {
+
+static const int kIterations = 10000;
+static const int kSpeedIterations = 1000000;
+// Offset of the top-left filtered pixel in the padded input buffer.
+static const int kInOffset =
+    OD_FILT_VBORDER * OD_FILT_BSTRIDE + OD_FILT_HBORDER;
+
+// Fills buf with 8-bit noise of random amplitude around a random level,
+// scaled up by coeff_shift.
+static void fill_noise(ACMRandom *rng, int16_t *buf, int size,
+                       int coeff_shift) {
+  const int level = rng->Rand8();
+  const int bits = 1 + (*rng)(8);
+  for (int i = 0; i < size; ++i) {
+    const int v = level + (rng->Rand8() & ((1 << bits) - 1)) - (1 << bits) / 2;
+    buf[i] = clamp(v, 0, 255) << coeff_shift;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Direction search
+//////////////////////////////////////////////////////////////////////////////
+
+typedef int (*DirFindFunc)(const od_dering_in *img, int stride, int32_t *var,
+                           int coeff_shift);
+typedef libaom_test::FuncParam<DirFindFunc> DirFindFuncs;
+
+class DeringDirFindTest : public FunctionEquivalenceTest<DirFindFunc> {
+ protected:
+  static const int kStride = 16;
+
+  void Common(int coeff_shift) {
+    int32_t ref_var = 0;
+    int32_t tst_var = 0;
+    int ref_dir = params_.ref_func(img_, kStride, &ref_var, coeff_shift);
+    int tst_dir = 0;
+    ASM_REGISTER_STATE_CHECK(
+        tst_dir = params_.tst_func(img_, kStride, &tst_var, coeff_shift));
+    ASSERT_EQ(ref_dir, tst_dir);
+    ASSERT_EQ(ref_var, tst_var);
+  }
+
+  od_dering_in img_[8 * kStride];
+};
+
+TEST_P(DeringDirFindTest, RandomValues) {
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    const int coeff_shift = rng_(5);
+    fill_noise(&rng_, img_, 8 * kStride, coeff_shift);
+    Common(coeff_shift);
+  }
+}
+
+TEST_P(DeringDirFindTest, ExtremeValues) {
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    const int coeff_shift = rng_(5);
+    for (int i = 0; i < 8 * kStride; ++i)
+      img_[i] = (rng_(2) ? 255 : 0) << coeff_shift;
+    Common(coeff_shift);
+  }
+}
+
+TEST_P(DeringDirFindTest, DISABLED_Speed) {
+  int32_t var;
+  aom_usec_timer ref_timer;
+  aom_usec_timer tst_timer;
+  for (int i = 0; i < 8 * kStride; ++i) img_[i] = rng_.Rand8();
+
+  aom_usec_timer_start(&ref_timer);
+  for (int iter = 0; iter < kSpeedIterations; ++iter)
+    params_.ref_func(img_, kStride, &var, 0);
+  aom_usec_timer_mark(&ref_timer);
+
+  aom_usec_timer_start(&tst_timer);
+  for (int iter = 0; iter < kSpeedIterations; ++iter)
+    params_.tst_func(img_, kStride, &var, 0);
+  aom_usec_timer_mark(&tst_timer);
+
+  printf("ref: %d us, tst: %d us\n",
+         static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+}
+
+INSTANTIATE_TEST_CASE_P(C, DeringDirFindTest,
+                        ::testing::Values(DirFindFuncs(od_dir_find8_c,
+                                                       od_dir_find8_c)));
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(SSE4_1, DeringDirFindTest,
+                        ::testing::Values(DirFindFuncs(od_dir_find8_c,
+                                                       od_dir_find8_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, DeringDirFindTest,
+                        ::testing::Values(DirFindFuncs(od_dir_find8_c,
+                                                       od_dir_find8_avx2)));
+#endif  // HAVE_AVX2
+
+//////////////////////////////////////////////////////////////////////////////
+// Directional and orthogonal filters
+//////////////////////////////////////////////////////////////////////////////
+
+template <typename F>
+class DeringFilterTest : public FunctionEquivalenceTest<F> {
+ public:
+  static const int kOutStride = 16;
+  static const int kInSize =
+      OD_FILT_BSTRIDE * (8 + 2 * OD_FILT_VBORDER) + OD_FILT_HBORDER;
+
+ protected:
+  virtual int Execute(int16_t *y, const int16_t *in, int threshold,
+                      int dir) = 0;
+  virtual int ExecuteRef(int16_t *y, const int16_t *in, int threshold,
+                         int dir) = 0;
+
+  void Common(int coeff_shift) {
+    const int threshold = this->rng_(32 << coeff_shift);
+    for (int dir = 0; dir < 8; ++dir) {
+      for (int i = 0; i < 8 * kOutStride; ++i) y_ref_[i] = y_tst_[i] = 0;
+      const int ref = ExecuteRef(y_ref_, in_ + kInOffset, threshold, dir);
+      int tst = 0;
+      ASM_REGISTER_STATE_CHECK(
+          tst = Execute(y_tst_, in_ + kInOffset, threshold, dir));
+      ASSERT_EQ(ref, tst) << "dir " << dir;
+      for (int i = 0; i < 8 * kOutStride; ++i)
+        ASSERT_EQ(y_ref_[i], y_tst_[i]) << "dir " << dir << " pos " << i;
+    }
+  }
+
+  void RunRandomValues() {
+    for (int iter = 0; iter < kIterations && !this->HasFatalFailure();
+         ++iter) {
+      const int coeff_shift = this->rng_(5);
+      fill_noise(&this->rng_, in_, kInSize, coeff_shift);
+      // Mark some pixels as unavailable, as done along frame borders.
+      for (int i = 0; i < kInSize; ++i)
+        if (this->rng_(64) == 0) in_[i] = OD_DERING_VERY_LARGE;
+      Common(coeff_shift);
+    }
+  }
+
+  void RunSpeed() {
+    aom_usec_timer ref_timer;
+    aom_usec_timer tst_timer;
+    fill_noise(&this->rng_, in_, kInSize, 0);
+
+    aom_usec_timer_start(&ref_timer);
+    for (int iter = 0; iter < kSpeedIterations; ++iter)
+      ExecuteRef(y_ref_, in_ + kInOffset, 16, iter & 7);
+    aom_usec_timer_mark(&ref_timer);
+
+    aom_usec_timer_start(&tst_timer);
+    for (int iter = 0; iter < kSpeedIterations; ++iter)
+      Execute(y_tst_, in_ + kInOffset, 16, iter & 7);
+    aom_usec_timer_mark(&tst_timer);
+
+    printf("ref: %d us, tst: %d us\n",
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+
+  int16_t in_[kInSize];
+  int16_t y_ref_[8 * kOutStride];
+  int16_t y_tst_[8 * kOutStride];
+};
+
+typedef libaom_test::FuncParam<od_filter_dering_direction_func>
+    DirectionFuncs;
+
+class DeringDirectionTest
+    : public DeringFilterTest<od_filter_dering_direction_func> {
+ protected:
+  int Execute(int16_t *y, const int16_t *in, int threshold, int dir) {
+    return params_.tst_func(y, kOutStride, in, threshold, dir);
+  }
+  int ExecuteRef(int16_t *y, const int16_t *in, int threshold, int dir) {
+    return params_.ref_func(y, kOutStride, in, threshold, dir);
+  }
+};
+
+TEST_P(DeringDirectionTest, RandomValues) { RunRandomValues(); }
+
+TEST_P(DeringDirectionTest, DISABLED_Speed) { RunSpeed(); }
+
+INSTANTIATE_TEST_CASE_P(
+    C, DeringDirectionTest,
+    ::testing::Values(DirectionFuncs(od_filter_dering_direction_4x4_c,
+                                     od_filter_dering_direction_4x4_c),
+                      DirectionFuncs(od_filter_dering_direction_8x8_c,
+                                     od_filter_dering_direction_8x8_c)));
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, DeringDirectionTest,
+    ::testing::Values(DirectionFuncs(od_filter_dering_direction_4x4_c,
+                                     od_filter_dering_direction_4x4_sse4_1),
+                      DirectionFuncs(od_filter_dering_direction_8x8_c,
+                                     od_filter_dering_direction_8x8_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, DeringDirectionTest,
+    ::testing::Values(DirectionFuncs(od_filter_dering_direction_4x4_c,
+                                     od_filter_dering_direction_4x4_avx2),
+                      DirectionFuncs(od_filter_dering_direction_8x8_c,
+                                     od_filter_dering_direction_8x8_avx2)));
+#endif  // HAVE_AVX2
+
+typedef libaom_test::FuncParam<od_filter_dering_orthogonal_func>
+    OrthogonalFuncs;
+
+class DeringOrthogonalTest
+    : public DeringFilterTest<od_filter_dering_orthogonal_func> {
+ protected:
+  int Execute(int16_t *y, const int16_t *in, int threshold, int dir) {
+    params_.tst_func(y, kOutStride, in, threshold, dir);
+    return 0;
+  }
+  int ExecuteRef(int16_t *y, const int16_t *in, int threshold, int dir) {
+    params_.ref_func(y, kOutStride, in, threshold, dir);
+    return 0;
+  }
+};
+
+TEST_P(DeringOrthogonalTest, RandomValues) { RunRandomValues(); }
+
+TEST_P(DeringOrthogonalTest, DISABLED_Speed) { RunSpeed(); }
+
+INSTANTIATE_TEST_CASE_P(
+    C, DeringOrthogonalTest,
+    ::testing::Values(OrthogonalFuncs(od_filter_dering_orthogonal_4x4_c,
+                                      od_filter_dering_orthogonal_4x4_c),
+                      OrthogonalFuncs(od_filter_dering_orthogonal_8x8_c,
+                                      od_filter_dering_orthogonal_8x8_c)));
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, DeringOrthogonalTest,
+    ::testing::Values(
+        OrthogonalFuncs(od_filter_dering_orthogonal_4x4_c,
+                        od_filter_dering_orthogonal_4x4_sse4_1),
+        OrthogonalFuncs(od_filter_dering_orthogonal_8x8_c,
+                        od_filter_dering_orthogonal_8x8_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, DeringOrthogonalTest,
+    ::testing::Values(
+        OrthogonalFuncs(od_filter_dering_orthogonal_4x4_c,
+                        od_filter_dering_orthogonal_4x4_avx2),
+        OrthogonalFuncs(od_filter_dering_orthogonal_8x8_c,
+                        od_filter_dering_orthogonal_8x8_avx2)));
+#endif  // HAVE_AVX2
+
+//////////////////////////////////////////////////////////////////////////////
+// Distortion
+//////////////////////////////////////////////////////////////////////////////
+
+typedef uint64_t (*ComputeDistFunc)(const int16_t *x, int xstride,
+                                    const int16_t *y, int ystride);
+typedef libaom_test::FuncParam<ComputeDistFunc> ComputeDistFuncs;
+
+class DeringComputeDistTest : public FunctionEquivalenceTest<ComputeDistFunc> {
+ protected:
+  static const int kXStride = 16;
+  static const int kYStride = 8;
+
+  void Common() {
+    const uint64_t ref = params_.ref_func(x_, kXStride, y_, kYStride);
+    uint64_t tst = 0;
+    ASM_REGISTER_STATE_CHECK(
+        tst = params_.tst_func(x_, kXStride, y_, kYStride));
+    ASSERT_EQ(ref, tst);
+  }
+
+  int16_t x_[8 * kXStride];
+  int16_t y_[8 * kYStride];
+};
+
+TEST_P(DeringComputeDistTest, RandomValues) {
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    const int coeff_shift = rng_(5);
+    fill_noise(&rng_, x_, 8 * kXStride, coeff_shift);
+    fill_noise(&rng_, y_, 8 * kYStride, coeff_shift);
+    Common();
+  }
+}
+
+TEST_P(DeringComputeDistTest, ExtremeValues) {
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    for (int i = 0; i < 8 * kXStride; ++i) x_[i] = rng_(2) ? 4095 : 0;
+    for (int i = 0; i < 8 * kYStride; ++i) y_[i] = rng_(2) ? 4095 : 0;
+    Common();
+  }
+}
+
+TEST_P(DeringComputeDistTest, DISABLED_Speed) {
+  aom_usec_timer ref_timer;
+  aom_usec_timer tst_timer;
+  fill_noise(&rng_, x_, 8 * kXStride, 0);
+  fill_noise(&rng_, y_, 8 * kYStride, 0);
+
+  aom_usec_timer_start(&ref_timer);
+  for (int iter = 0; iter < kSpeedIterations; ++iter)
+    params_.ref_func(x_, kXStride, y_, kYStride);
+  aom_usec_timer_mark(&ref_timer);
+
+  aom_usec_timer_start(&tst_timer);
+  for (int iter = 0; iter < kSpeedIterations; ++iter)
+    params_.tst_func(x_, kXStride, y_, kYStride);
+  aom_usec_timer_mark(&tst_timer);
+
+  printf("ref: %d us, tst: %d us\n",
+         static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+}
+
+INSTANTIATE_TEST_CASE_P(C, DeringComputeDistTest,
+                        ::testing::Values(ComputeDistFuncs(
+                            od_compute_dist_8x8_c, od_compute_dist_8x8_c)));
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(SSE4_1, DeringComputeDistTest,
+                        ::testing::Values(ComputeDistFuncs(
+                            od_compute_dist_8x8_c,
+                            od_compute_dist_8x8_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, DeringComputeDistTest,
+                        ::testing::Values(ComputeDistFuncs(
+                            od_compute_dist_8x8_c, od_compute_dist_8x8_avx2)));
+#endif  // HAVE_AVX2
+}  // namespace
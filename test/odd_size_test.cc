@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+const int kFrames = 6;
+
+// Frame sizes that leave partial 8x8 luma and 4x4 chroma blocks at the right
+// and bottom edges.
+const int kSizes[][2] = { { 131, 97 }, { 100, 70 }, { 66, 41 } };
+
+// A textured frame moving by a few pixels per frame.
+class MovingVideoSource : public ::libaom_test::DummyVideoSource {
+ protected:
+  virtual void FillFrame() {
+    int plane, x, y;
+    if (!img_) return;
+    for (plane = 0; plane < 3; ++plane) {
+      const int ss = plane ? 1 : 0;
+      const int w = (img_->d_w + ss) >> ss;
+      const int h = (img_->d_h + ss) >> ss;
+      for (y = 0; y < h; ++y) {
+        uint8_t *const row = img_->planes[plane] + y * img_->stride[plane];
+        for (x = 0; x < w; ++x) {
+          const int u = x + ((frame_ * 3) >> ss), v = y + ((frame_ * 2) >> ss);
+          row[x] = (uint8_t)(((u >> 2) * 53 + (v >> 2) * 29 + ((u * v) >> 3) +
+                              plane * 64) &
+                             0xff);
+        }
+      }
+    }
+  }
+};
+
+// Encodes frames whose sizes are not a multiple of the block sizes of the
+// post filters. The driver checks that the decoder, which post-filters each
+// superblock row as it is decoded, reconstructs the same frames as the
+// encoder, which filters whole frames.
+class AV1OddSizeTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWithParam<libaom_test::TestMode> {
+ protected:
+  AV1OddSizeTest() : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)) {}
+  virtual ~AV1OddSizeTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 3;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 200;
+  }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) encoder->Control(AOME_SET_CPUUSED, 2);
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+};
+
+TEST_P(AV1OddSizeTest, MatchesDecoder) {
+  for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+    MovingVideoSource video;
+    video.SetSize(kSizes[i][0], kSizes[i][1]);
+    video.set_limit(kFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video)) << kSizes[i][0] << "x"
+                                             << kSizes[i][1];
+  }
+}
+
+AV1_INSTANTIATE_TEST_CASE(AV1OddSizeTest,
+                          ::testing::Values(::libaom_test::kOnePassGood,
+                                            ::libaom_test::kTwoPassGood));
+}  // namespace
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+*/
+
+#include <cstdlib>
+#include <string>
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./av1_rtcd.h"
+#include "aom_ports/aom_timer.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+typedef int (*pvq_search_argmax_t)(const int16_t *x, const int32_t *y, int n,
+                                   int32_t xy, int32_t yy, int xshift,
+                                   int yshift);
+
+typedef std::tr1::tuple<pvq_search_argmax_t, pvq_search_argmax_t>
+    pvq_search_param_t;
+
+class PvqSearchTest : public ::testing::TestWithParam<pvq_search_param_t> {
+ public:
+  virtual ~PvqSearchTest() {}
+  virtual void SetUp() {
+    search = GET_PARAM(0);
+    ref_search = GET_PARAM(1);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  pvq_search_argmax_t search;
+  pvq_search_argmax_t ref_search;
+};
+
+typedef PvqSearchTest PvqSearchSpeedTest;
+
+static int ilog(int32_t v) {
+  int l = 0;
+  while (v) {
+    l++;
+    v >>= 1;
+  }
+  return l;
+}
+
+// Runs the greedy part of the PVQ search on random vectors, comparing the
+// position picked at every step. If search and ref_search are the same,
+// we're just testing speed.
+void test_pvq_search(int iterations, pvq_search_argmax_t search,
+                     pvq_search_argmax_t ref_search) {
+  const int max_n = 128;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  DECLARE_ALIGNED(16, int16_t, x[max_n]);
+  DECLARE_ALIGNED(16, int32_t, y[max_n]);
+  int error = 0, n = 0, k = 0, pos = 0, ref_pos = 0;
+
+  for (int count = 0; count < iterations && !error; count++) {
+    for (int bits = 1; bits <= 15 && !error; bits++) {
+      int32_t xy = 0, yy = 0;
+      int xmax = 0, ymax = 0;
+      n = 1 + rnd(max_n);
+      for (int i = 0; i < n; i++) {
+        x[i] = rnd.Rand16() & ((1 << bits) - 1);
+        // Repeat values to exercise the tie breaking.
+        if (rnd(4) == 0) x[i] = x[0];
+        y[i] = 0;
+        xmax = x[i] > xmax ? x[i] : xmax;
+      }
+      for (k = 0; k < 64 && !error; k++) {
+        const int xshift = ilog(xy + xmax) - 15;
+        const int yshift =
+            ilog(yy + 2 * ymax + 1) > 15 ? ilog(yy + 2 * ymax + 1) - 15 : 0;
+        ref_pos = ref_search(x, y, n, xy, yy, xshift, yshift);
+        if (search != ref_search) {
+          ASM_REGISTER_STATE_CHECK(
+              pos = search(x, y, n, xy, yy, xshift, yshift));
+          error = pos != ref_pos;
+        } else {
+          pos = ref_pos;
+        }
+        xy += x[pos];
+        yy += 2 * y[pos] + 1;
+        y[pos]++;
+        ymax = y[pos] > ymax ? y[pos] : ymax;
+      }
+    }
+  }
+
+  EXPECT_EQ(0, error) << "Error: PvqSearchTest, SIMD and C mismatch."
+                      << std::endl
+                      << "n: " << n << std::endl
+                      << "pulse: " << k << std::endl
+                      << "SIMD position: " << pos << std::endl
+                      << "C position: " << ref_pos << std::endl;
+}
+
+void test_pvq_search_speed(int iterations, pvq_search_argmax_t search,
+                           pvq_search_argmax_t ref_search) {
+  aom_usec_timer ref_timer;
+  aom_usec_timer timer;
+
+  aom_usec_timer_start(&ref_timer);
+  test_pvq_search(iterations, ref_search, ref_search);
+  aom_usec_timer_mark(&ref_timer);
+  int ref_elapsed_time = aom_usec_timer_elapsed(&ref_timer);
+
+  aom_usec_timer_start(&timer);
+  test_pvq_search(iterations, search, search);
+  aom_usec_timer_mark(&timer);
+  int elapsed_time = aom_usec_timer_elapsed(&timer);
+
+  EXPECT_GT(ref_elapsed_time, elapsed_time)
+      << "Error: PvqSearchSpeedTest, SIMD slower than C." << std::endl
+      << "C time: " << ref_elapsed_time << " us" << std::endl
+      << "SIMD time: " << elapsed_time << " us" << std::endl;
+}
+
+// The correlation (xy + x[j])^2/(yy + 2*y[j] + 1) of position j, in double
+// precision.
+static double pvq_correlation(const int16_t *x, const int32_t *y, int32_t xy,
+                              int32_t yy, int j) {
+  const double num = (double)xy + x[j];
+  return num * num / ((double)yy + 2 * y[j] + 1);
+}
+
+// The fixed-point search scales its operands down to 15 bits, so when two
+// positions are within rounding of each other it may pick a different one
+// than a double-precision search. Check that the correlation of the position
+// it picks is always within 2^-10 of the best one.
+TEST(PvqSearchBoundTest, CloseToDoublePrecision) {
+  const int max_n = 128;
+  const double tolerance = 1.0 / 1024;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  DECLARE_ALIGNED(16, int16_t, x[max_n]);
+  DECLARE_ALIGNED(16, int32_t, y[max_n]);
+  double worst = 0;
+
+  for (int count = 0; count < 256; count++) {
+    for (int bits = 1; bits <= 15; bits++) {
+      int32_t xy = 0, yy = 0;
+      int xmax = 0, ymax = 0;
+      const int n = 1 + rnd(max_n);
+      for (int i = 0; i < n; i++) {
+        x[i] = rnd.Rand16() & ((1 << bits) - 1);
+        if (rnd(4) == 0) x[i] = x[0];
+        y[i] = 0;
+        xmax = x[i] > xmax ? x[i] : xmax;
+      }
+      for (int k = 0; k < 64; k++) {
+        const int xshift = ilog(xy + xmax) - 15;
+        const int yshift =
+            ilog(yy + 2 * ymax + 1) > 15 ? ilog(yy + 2 * ymax + 1) - 15 : 0;
+        const int pos = od_pvq_search_argmax_c(x, y, n, xy, yy, xshift, yshift);
+        double best = 0;
+        for (int j = 0; j < n; j++) {
+          const double c = pvq_correlation(x, y, xy, yy, j);
+          best = c > best ? c : best;
+        }
+        if (best > 0) {
+          const double c = pvq_correlation(x, y, xy, yy, pos);
+          const double loss = (best - c) / best;
+          worst = loss > worst ? loss : worst;
+        }
+        xy += x[pos];
+        yy += 2 * y[pos] + 1;
+        y[pos]++;
+        ymax = y[pos] > ymax ? y[pos] : ymax;
+      }
+    }
+  }
+
+  EXPECT_LE(worst, tolerance)
+      << "Error: PvqSearchBoundTest, fixed-point search too far from the best "
+      << "double-precision correlation." << std::endl;
+}
+
+TEST_P(PvqSearchTest, TestSIMDNoMismatch) {
+  test_pvq_search(256, search, ref_search);
+}
+
+TEST_P(PvqSearchSpeedTest, TestSpeed) {
+  test_pvq_search_speed(1024, search, ref_search);
+}
+
+using std::tr1::make_tuple;
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(SSE4_1, PvqSearchTest,
+                        ::testing::Values(make_tuple(
+                            &od_pvq_search_argmax_sse4_1,
+                            &od_pvq_search_argmax_c)));
+
+INSTANTIATE_TEST_CASE_P(SSE4_1, PvqSearchSpeedTest,
+                        ::testing::Values(make_tuple(
+                            &od_pvq_search_argmax_sse4_1,
+                            &od_pvq_search_argmax_c)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, PvqSearchTest,
+                        ::testing::Values(make_tuple(
+                            &od_pvq_search_argmax_avx2,
+                            &od_pvq_search_argmax_c)));
+
+INSTANTIATE_TEST_CASE_P(AVX2, PvqSearchSpeedTest,
+                        ::testing::Values(make_tuple(
+                            &od_pvq_search_argmax_avx2,
+                            &od_pvq_search_argmax_c)));
+#endif
+}  // namespace
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+const int kFrames = 3;
+const int kWidth = 1280;
+const int kHeight = 720;
+
+// A textured frame panning by (kPanX, kPanY) pixels per frame.
+const int kPanX = 60;
+const int kPanY = 24;
+
+class PanningVideoSource : public ::libaom_test::DummyVideoSource {
+ protected:
+  virtual void FillFrame() {
+    int plane, x, y;
+    if (!img_) return;
+    for (plane = 0; plane < 3; ++plane) {
+      const int ss = plane ? 1 : 0;
+      const int w = (img_->d_w + ss) >> ss;
+      const int h = (img_->d_h + ss) >> ss;
+      const int ox = (frame_ * kPanX) >> ss;
+      const int oy = (frame_ * kPanY) >> ss;
+      for (y = 0; y < h; ++y) {
+        uint8_t *const row = img_->planes[plane] + y * img_->stride[plane];
+        for (x = 0; x < w; ++x) {
+          const int u = x + ox, v = y + oy;
+          row[x] = (uint8_t)(((u >> 3) * 37 + (v >> 3) * 91 + ((u * v) >> 6) +
+                              plane * 64) &
+                             0xff);
+        }
+      }
+    }
+  }
+};
+
+// At speed 0 the good quality encoder searches the motion pyramid of frames
+// of 720 lines and more. The driver checks that the decoder reconstructs the
+// same frames as the encoder.
+class PyramidSearchTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWithParam<libaom_test::TestMode> {
+ protected:
+  PyramidSearchTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)), psnr_(0.0),
+        frames_(0) {}
+  virtual ~PyramidSearchTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 2000;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    psnr_ = 0.0;
+    frames_ = 0;
+  }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) encoder->Control(AOME_SET_CPUUSED, 0);
+  }
+
+  virtual void PSNRPktHook(const aom_codec_cx_pkt_t *pkt) {
+    psnr_ += pkt->data.psnr.psnr[0];
+    ++frames_;
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  double psnr_;
+  int frames_;
+};
+
+TEST_P(PyramidSearchTest, MatchesDecoderAt720p) {
+  PanningVideoSource video;
+  video.SetSize(kWidth, kHeight);
+  video.set_limit(kFrames);
+  init_flags_ = AOM_CODEC_USE_PSNR;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_EQ(kFrames, frames_);
+  EXPECT_GT(psnr_ / frames_, 30.0);
+}
+
+AV1_INSTANTIATE_TEST_CASE(PyramidSearchTest,
+                          ::testing::Values(::libaom_test::kOnePassGood,
+                                            ::libaom_test::kTwoPassGood));
+}  // namespace
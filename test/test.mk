@@ -31,9 +31,15 @@ LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += active_map_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += borders_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += cpu_speed_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += frame_size_tests.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += odd_size_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += lossless_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += end_to_end_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += ethread_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += firstpass_mvs_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += frame_parallel_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += pyramid_search_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += tx_rd_cache_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += upsampled_refs_test.cc
 
 LIBAOM_TEST_SRCS-yes                   += decode_test_driver.cc
 LIBAOM_TEST_SRCS-yes                   += decode_test_driver.h
@@ -109,6 +115,10 @@ LIBAOM_TEST_SRCS-yes                   += convolve_test.cc
 LIBAOM_TEST_SRCS-yes                   += av1_convolve_test.cc
 LIBAOM_TEST_SRCS-yes                   += lpf_8_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_CLPF)        += clpf_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_DERING)      += od_dering_test.cc
+ifeq ($(CONFIG_AV1_ENCODER),yes)
+LIBAOM_TEST_SRCS-$(CONFIG_PVQ)         += pvq_test.cc
+endif
 LIBAOM_TEST_SRCS-yes                   += intrapred_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += dct16x16_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += dct32x32_test.cc
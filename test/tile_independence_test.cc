@@ -21,12 +21,13 @@
 #include "aom_mem/aom_mem.h"
 
 namespace {
-class TileIndependenceTest : public ::libaom_test::EncoderTest,
-                             public ::libaom_test::CodecTestWithParam<int> {
+class TileIndependenceTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWith2Params<int, int> {
  protected:
   TileIndependenceTest()
       : EncoderTest(GET_PARAM(0)), md5_fw_order_(), md5_inv_order_(),
-        n_tiles_(GET_PARAM(1)) {
+        md5_mt_(), n_tile_cols_(GET_PARAM(1)), n_tile_rows_(GET_PARAM(2)) {
     init_flags_ = AOM_CODEC_USE_PSNR;
     aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
     cfg.w = 704;
@@ -35,11 +36,14 @@ class TileIndependenceTest : public ::libaom_test::EncoderTest,
     fw_dec_ = codec_->CreateDecoder(cfg, 0);
     inv_dec_ = codec_->CreateDecoder(cfg, 0);
     inv_dec_->Control(AV1_INVERT_TILE_DECODE_ORDER, 1);
+    cfg.threads = 3;
+    mt_dec_ = codec_->CreateDecoder(cfg, 0);
   }
 
   virtual ~TileIndependenceTest() {
     delete fw_dec_;
     delete inv_dec_;
+    delete mt_dec_;
   }
 
   virtual void SetUp() {
@@ -50,7 +54,8 @@ class TileIndependenceTest : public ::libaom_test::EncoderTest,
   virtual void PreEncodeFrameHook(libaom_test::VideoSource *video,
                                   libaom_test::Encoder *encoder) {
     if (video->frame() == 1) {
-      encoder->Control(AV1E_SET_TILE_COLUMNS, n_tiles_);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, n_tile_cols_);
+      encoder->Control(AV1E_SET_TILE_ROWS, n_tile_rows_);
     }
   }
 
@@ -69,18 +74,21 @@ class TileIndependenceTest : public ::libaom_test::EncoderTest,
   virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
     UpdateMD5(fw_dec_, pkt, &md5_fw_order_);
     UpdateMD5(inv_dec_, pkt, &md5_inv_order_);
+    UpdateMD5(mt_dec_, pkt, &md5_mt_);
   }
 
-  ::libaom_test::MD5 md5_fw_order_, md5_inv_order_;
-  ::libaom_test::Decoder *fw_dec_, *inv_dec_;
+  ::libaom_test::MD5 md5_fw_order_, md5_inv_order_, md5_mt_;
+  ::libaom_test::Decoder *fw_dec_, *inv_dec_, *mt_dec_;
 
  private:
-  int n_tiles_;
+  int n_tile_cols_;
+  int n_tile_rows_;
 };
 
-// run an encode with 2 or 4 tiles, and do the decode both in normal and
-// inverted tile ordering. Ensure that the MD5 of the output in both cases
-// is identical. If so, tiles are considered independent and the test passes.
+// run an encode with 1 or 2 tile columns and 1 or 2 tile rows, and do the
+// decode in normal and inverted tile ordering and with multiple threads.
+// Ensure that the MD5 of the output in all cases is identical. If so, tiles
+// are considered independent and the test passes.
 TEST_P(TileIndependenceTest, MD5Match) {
   const aom_rational timebase = { 33333333, 1000000000 };
   cfg_.g_timebase = timebase;
@@ -94,11 +102,13 @@ TEST_P(TileIndependenceTest, MD5Match) {
 
   const char *md5_fw_str = md5_fw_order_.Get();
   const char *md5_inv_str = md5_inv_order_.Get();
+  const char *md5_mt_str = md5_mt_.Get();
 
   // could use ASSERT_EQ(!memcmp(.., .., 16) here, but this gives nicer
   // output if it fails. Not sure if it's helpful since it's really just
   // a MD5...
   ASSERT_STREQ(md5_fw_str, md5_inv_str);
+  ASSERT_STREQ(md5_fw_str, md5_mt_str);
 }
 #if CONFIG_EC_ADAPT
 // TODO(thdavies): EC_ADAPT does not support tiles
@@ -107,9 +117,10 @@ INSTANTIATE_TEST_CASE_P(
     ::testing::Combine(
         ::testing::Values(
             static_cast<const libaom_test::CodecFactory *>(&libaom_test::kAV1)),
-        ::testing::Range(0, 2, 1)));
+        ::testing::Range(0, 2, 1), ::testing::Range(0, 2, 1)));
 #else
-AV1_INSTANTIATE_TEST_CASE(TileIndependenceTest, ::testing::Range(0, 2, 1));
+AV1_INSTANTIATE_TEST_CASE(TileIndependenceTest, ::testing::Range(0, 2, 1),
+                          ::testing::Range(0, 2, 1));
 #endif
 
 }  // namespace
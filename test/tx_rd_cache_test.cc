@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+
+namespace {
+
+const int kFrames = 10;
+
+// Checks that caching the transform RD results of inter blocks does not
+// change the encoded stream. With CONFIG_EXT_TX every transform type of the
+// extended set is part of the cache key.
+class TxRdCacheTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int> {
+ protected:
+  TxRdCacheTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        set_cpu_used_(GET_PARAM(2)), tx_rd_cache_(1) {}
+  virtual ~TxRdCacheTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 6;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) { md5_.clear(); }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(AV1E_SET_TX_RD_CACHE, tx_rd_cache_);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    ::libaom_test::MD5 md5_res;
+    md5_res.Add(reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+                pkt->data.frame.sz);
+    md5_.push_back(md5_res.Get());
+  }
+
+  std::vector<std::string> Encode(int tx_rd_cache) {
+    ::libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352,
+                                         288, 30, 1, 0, kFrames);
+    tx_rd_cache_ = tx_rd_cache;
+    RunLoop(&video);
+    return md5_;
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int set_cpu_used_;
+  int tx_rd_cache_;
+  std::vector<std::string> md5_;
+};
+
+TEST_P(TxRdCacheTest, MatchesUncachedEncode) {
+  std::vector<std::string> uncached_md5, cached_md5;
+
+  ASSERT_NO_FATAL_FAILURE(uncached_md5 = Encode(0));
+  ASSERT_NO_FATAL_FAILURE(cached_md5 = Encode(1));
+  ASSERT_FALSE(uncached_md5.empty());
+  ASSERT_EQ(uncached_md5, cached_md5);
+}
+
+AV1_INSTANTIATE_TEST_CASE(TxRdCacheTest,
+                          ::testing::Values(::libaom_test::kOnePassGood,
+                                            ::libaom_test::kTwoPassGood),
+                          ::testing::Values(1, 2));
+}  // namespace
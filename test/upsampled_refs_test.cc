@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+
+namespace {
+
+const int kFrames = 10;
+
+// Checks that interpolating the up-sampled references of the sub-pixel
+// motion search on the fly finds the same motion vectors as reading them from
+// the stored up-sampled reference frames, so the encoded stream is unchanged.
+class UpsampledRefsTest
+    : public ::libaom_test::EncoderTest,
+      public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int> {
+ protected:
+  UpsampledRefsTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        set_cpu_used_(GET_PARAM(2)), on_the_fly_(0) {}
+  virtual ~UpsampledRefsTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(encoding_mode_);
+    cfg_.g_lag_in_frames = 6;
+    cfg_.rc_end_usage = AOM_VBR;
+    cfg_.rc_target_bitrate = 500;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) { md5_.clear(); }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(AV1E_SET_UPSAMPLED_REFS_ON_THE_FLY, on_the_fly_);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    ::libaom_test::MD5 md5_res;
+    md5_res.Add(reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+                pkt->data.frame.sz);
+    md5_.push_back(md5_res.Get());
+  }
+
+  std::vector<std::string> Encode(int on_the_fly) {
+    ::libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352,
+                                         288, 30, 1, 0, kFrames);
+    on_the_fly_ = on_the_fly;
+    RunLoop(&video);
+    return md5_;
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int set_cpu_used_;
+  int on_the_fly_;
+  std::vector<std::string> md5_;
+};
+
+TEST_P(UpsampledRefsTest, MatchesStoredReferences) {
+  std::vector<std::string> stored_md5, on_the_fly_md5;
+
+  ASSERT_NO_FATAL_FAILURE(stored_md5 = Encode(0));
+  ASSERT_NO_FATAL_FAILURE(on_the_fly_md5 = Encode(1));
+  ASSERT_FALSE(stored_md5.empty());
+  ASSERT_EQ(stored_md5, on_the_fly_md5);
+}
+
+AV1_INSTANTIATE_TEST_CASE(UpsampledRefsTest,
+                          ::testing::Values(::libaom_test::kOnePassGood,
+                                            ::libaom_test::kTwoPassGood),
+                          ::testing::Values(0, 1));
+}  // namespace